@@ -1,6 +1,7 @@
 #include "CloudInterface.hpp"
 #include "../Messages/Components/Cloud/QueueReceiveCloudTypes.hpp"
 #include "../Messages/EventsType.hpp"
+#include "../Messages/EventPayloads.hpp"
 
 
 #include <atomic>
@@ -30,7 +31,7 @@ CloudInterface::CloudInterface(std::string cloudURL, std::string controlBoxName,
     controlBoxName (std::move(controlBoxName )),
     tmcName(std::move(tmcName)),
     _shutdown_request(_shutdown_request),
-    cloudThread(t_cloud)
+    cloudThread(t_cloud, CppWrapper::ThreadRole::NETWORK, "cloud")
 {
 
 }
@@ -52,13 +53,65 @@ json load_json(const std::string& path) {
 void CloudInterface::cloudNotify()
 {
     std::string test_path = "/root/";
-    json psem = load_json(test_path + "correct_PSEM.json");
-    json tsem = load_json(test_path + "correct_TSEM.json");
-    rx_cloud::TSEM_data ts_d={std::make_shared<json>(tsem)};
-    rx_cloud::PSEM_data ps_d = {std::make_shared<json>(psem)};
+    notifyConfiguration(load_json(test_path + "correct_PSEM.json"), load_json(test_path + "correct_TSEM.json"));
+}
+
+/*  Configuration files to the TCS, by payload handle (EventPayloads)
+ *  An Event is only posted with a handle holding its file; a handle whose Event is not posted is released
+ *  Returns -EAGAIN if a file was not posted (every payload slot in flight, or the event queue full)
+ */
+int CloudInterface::notifyConfiguration(json psem, json tsem)
+{
+    auto& payloads = EventPayloads::instance();
+    const int psemFile = payloads.put(std::make_shared<json>(std::move(psem)));
+    const int tsemFile = payloads.put(std::make_shared<json>(std::move(tsem)));
+    if (psemFile < 0 || tsemFile < 0)
+    {
+        payloads.release(psemFile);
+        payloads.release(tsemFile);
+        std::cerr << "Cloud: configuration not posted (no payload slot)\n";
+        return -EAGAIN;
+    }
 
-    mediator->notify(this, Event{ CloudReceiveType{ ps_d } });
-    mediator->notify(this, Event{ CloudReceiveType{ ts_d } });
+    if (mediator->notify(this, Event{ CloudReceiveType{ rx_cloud::PSEM_data{psemFile} } }) < 0)
+    {
+        payloads.release(psemFile);
+        payloads.release(tsemFile);
+        std::cerr << "Cloud: configuration not posted (event queue full)\n";
+        return -EAGAIN;
+    }
+    if (mediator->notify(this, Event{ CloudReceiveType{ rx_cloud::TSEM_data{tsemFile} } }) < 0)
+    {
+        payloads.release(tsemFile);
+        std::cerr << "Cloud: TSEM configuration not posted (event queue full)\n";
+        return -EAGAIN;
+    }
+    return 0;
+}
+
+/*  Live reconfiguration of one Intersection Element (applied by the TCS at its next phase boundary)
+ *  ADD, MODIFY: 'data' is posted by payload handle, as the configuration files; REMOVE: only the Location
+ *  Returns -EAGAIN if the request was not posted
+ */
+int CloudInterface::notifyComponentUpdate(const rx_cloud::Component_update::Operation operation, const int location,
+    json data)
+{
+    rx_cloud::Component_update update{operation, location};
+    auto& payloads = EventPayloads::instance();
+    if (operation != rx_cloud::Component_update::Operation::REMOVE &&
+        (update.file = payloads.put(std::make_shared<json>(std::move(data)))) < 0)
+    {
+        std::cerr << "Cloud: component update not posted (no payload slot)\n";
+        return -EAGAIN;
+    }
+
+    if (mediator->notify(this, Event{ CloudReceiveType{ update } }) < 0)
+    {
+        payloads.release(update.file);
+        std::cerr << "Cloud: component update not posted (event queue full)\n";
+        return -EAGAIN;
+    }
+    return 0;
 }
 
 /* ACTUAL API  */
@@ -72,6 +125,7 @@ void CloudInterface::stop()
 {
     cloudSendQueue.interrupt();
     cloudThread.join();
+    cloudSendQueue.dump(std::cerr);
 }
 
 void CloudInterface::cloudConnect() const
@@ -261,7 +315,9 @@ void* CloudInterface::t_cloud(void* arg)
 
     while (!self->_shutdown_request.load())
     {
-        auto data = self->cloudSendQueue.receive();
+        CloudSendType data;
+        if (!self->cloudSendQueue.receive(data))
+            break;
 
         auto visitor = [&] (auto&& obj)
         {
@@ -269,14 +325,8 @@ void* CloudInterface::t_cloud(void* arg)
 
             if  constexpr (std::is_same_v<T, tx_cloud::Configure>)
             {
-                json psem = self->query_database(obj.psem_table, CONTROL_BOX_FK, self->controlboxID);
-                json tsem = self->query_database(obj.tsem_table, CONTROL_BOX_FK, self->controlboxID);
-
-                rx_cloud::TSEM_data ts_d={std::make_shared<json>(tsem)};
-                rx_cloud::PSEM_data ps_d = {std::make_shared<json>(psem)};
-
-                self->mediator->notify(self, Event{ CloudReceiveType{ ps_d } });
-                self->mediator->notify(self, Event{ CloudReceiveType{ ts_d } });
+                self->notifyConfiguration(self->query_database(obj.psem_table, CONTROL_BOX_FK, self->controlboxID),
+                    self->query_database(obj.tsem_table, CONTROL_BOX_FK, self->controlboxID));
             }
             else if constexpr (std::is_same_v<T, tx_cloud::EmergencyContext>)
             {
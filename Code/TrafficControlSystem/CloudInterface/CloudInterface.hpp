@@ -7,6 +7,8 @@
 #include "../Mediator.hpp"
 #include "../CppWrapper/CppWrapper.hpp"
 #include "../Messages/Components/Cloud/QueueSendCloudTypes.hpp"
+#include "../Messages/Components/Cloud/QueueReceiveCloudTypes.hpp"
+#include "CloudSendBuffer.hpp"
 
 class CloudInterface: public Component
 {
@@ -28,6 +30,7 @@ private:
         const std::string& body = "");
     static size_t writeCallback(void* contents, size_t size, size_t nmemb, void* userp);
     static std::string get_iso8601_timestamp();
+    int notifyConfiguration(json psem, json tsem);
 
 public:
     /*---Constructor/Destructor---------------------------------------------------------------------------------------*/
@@ -42,6 +45,7 @@ public:
     void stop();
 
     void cloudNotify(); // TEST METHOD
+    int notifyComponentUpdate(rx_cloud::Component_update::Operation operation, int location, json data = {});
 
     void cloudConnect() const;
     /*GET*/
@@ -61,7 +65,7 @@ public:
     static void* t_cloud(void* arg);
 
     CppWrapper::Mutex cloudMutex;
-    CppWrapper::Queue<CloudSendType> cloudSendQueue;
+    CloudSendBuffer cloudSendQueue;     // coalescing, bounded (CloudSendBuffer)
 
 };
 
@@ -0,0 +1,142 @@
+#include "CloudSendBuffer.hpp"
+
+#include <iterator>
+#include <type_traits>
+
+static const char* kindNames[] = {
+    "configure", "emergency", "validate RFID", "TSEM status", "PSEM status"
+};
+static_assert(std::size(kindNames) == CloudSendBuffer::KINDS, "CloudSendBuffer: one name per CloudSendType");
+
+CloudSendBuffer::CloudSendBuffer(): available(mutex), nextSeq(0), stopping(false),
+    statusPolicy(DropPolicy::DROP_OLDEST), requestPolicy(DropPolicy::DROP_OLDEST), stats{}
+{
+}
+
+void CloudSendBuffer::setDropPolicy(const DropPolicy statusUpdates, const DropPolicy otherRequests)
+{
+    CppWrapper::LockGuard lock(mutex);
+    statusPolicy = statusUpdates;
+    requestPolicy = otherRequests;
+}
+
+template <size_t Capacity>
+void CloudSendBuffer::append(Ring<Capacity>& ring, CloudSendType&& message, const DropPolicy policy)
+{
+    if (ring.full())
+    {
+        if (policy == DropPolicy::DROP_NEWEST)
+        {
+            ++stats.dropped[message.index()];
+            return;
+        }
+        ++stats.dropped[ring.pop().message.index()];
+    }
+    ring.push(Pending{std::move(message), nextSeq++});
+    ++stats.queued;
+}
+
+// Pending update of the same (table, location); nullptr if none, or if 'message' is no status update
+CloudSendBuffer::Pending* CloudSendBuffer::findStatus(const CloudSendType& message)
+{
+    for (size_t i = 0; i < status.count; ++i)
+    {
+        Pending& pending = status.at(i);
+        const bool same = std::visit([](const auto& a, const auto& b)
+        {
+            using A = std::decay_t<decltype(a)>;
+            using B = std::decay_t<decltype(b)>;
+            if constexpr (std::is_same_v<A, B> && (std::is_same_v<A, tx_cloud::TrafficSemaphoreUpdate> ||
+                std::is_same_v<A, tx_cloud::PedestrianSemaphoreUpdate>))
+                return a.location == b.location && a.table == b.table;
+            else
+                return false;
+        }, pending.message, message);
+
+        if (same)
+            return &pending;
+    }
+    return nullptr;
+}
+
+void CloudSendBuffer::send(CloudSendType&& message)
+{
+    const bool isStatus = std::holds_alternative<tx_cloud::TrafficSemaphoreUpdate>(message) ||
+        std::holds_alternative<tx_cloud::PedestrianSemaphoreUpdate>(message);
+    {
+        CppWrapper::LockGuard lock(mutex);
+        if (!isStatus)
+            append(requests, std::move(message), requestPolicy);
+        else if (Pending* pending = findStatus(message))
+        {
+            pending->message = std::move(message);     // latest value wins, in the place of the first
+            ++stats.merged;
+            ++stats.queued;
+        }
+        else
+            append(status, std::move(message), statusPolicy);
+    }
+    available.condSignal();
+}
+
+// Mutex locked: the oldest pending message of both rings
+bool CloudSendBuffer::popNext(CloudSendType& message)
+{
+    if (!status.count && !requests.count)
+        return false;
+
+    if (!status.count || (requests.count && requests.at(0).seq < status.at(0).seq))
+        message = requests.pop().message;
+    else
+        message = status.pop().message;
+    return true;
+}
+
+bool CloudSendBuffer::tryReceive(CloudSendType& message)
+{
+    CppWrapper::LockGuard lock(mutex);
+    return popNext(message);
+}
+
+bool CloudSendBuffer::receive(CloudSendType& message)
+{
+    CppWrapper::LockGuard lock(mutex);
+    while (!popNext(message))
+    {
+        if (stopping)
+            return false;
+        available.condWait();
+    }
+    return true;
+}
+
+void CloudSendBuffer::interrupt()
+{
+    {
+        CppWrapper::LockGuard lock(mutex);
+        stopping = true;
+    }
+    available.condBroadcast();
+}
+
+size_t CloudSendBuffer::pending()
+{
+    CppWrapper::LockGuard lock(mutex);
+    return status.count + requests.count;
+}
+
+CloudSendBuffer::Stats CloudSendBuffer::counters()
+{
+    CppWrapper::LockGuard lock(mutex);
+    return stats;
+}
+
+void CloudSendBuffer::dump(std::ostream& out)
+{
+    const Stats now = counters();
+    out << "Cloud send buffer: " << now.queued << " queued, " << now.merged << " merged";
+    for (size_t kind = 0; kind < KINDS; ++kind)
+        if (now.dropped[kind])
+            out << ", " << now.dropped[kind] << " " << kindNames[kind] << " dropped";
+    out << "\n";
+}
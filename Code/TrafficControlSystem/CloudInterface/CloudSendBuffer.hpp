@@ -0,0 +1,100 @@
+#ifndef TRAFFICCONTROLSYSTEM_CLOUDSENDBUFFER_HPP
+#define TRAFFICCONTROLSYSTEM_CLOUDSENDBUFFER_HPP
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <variant>
+
+#include "../CppWrapper/CppWrapper.hpp"
+#include "../Messages/Components/Cloud/QueueSendCloudTypes.hpp"
+
+/*
+ *  Messages waiting for the Cloud thread: fixed memory, whatever the Cloud's latency (outages included)
+ *   *  Semaphore updates (TSEM/PSEM status): coalesced by (table, location) - the latest status wins and
+ *      keeps the place of the first one not sent yet (the Cloud never receives a YELLOW after the RED)
+ *   *  Requests (configuration, EV, RFID validation): in order, CLOUD_REQUEST_SLOTS at most
+ *   *  Full: the oldest (DROP_OLDEST) or the new (DROP_NEWEST) message is dropped; counted per kind
+ *   Sent in the order they were queued; any thread sends (never waits on the Cloud), one thread receives
+ */
+
+#define CLOUD_STATUS_SLOTS 64       // (table, location) updates pending: one per head and crosswalk light
+#define CLOUD_REQUEST_SLOTS 32      // requests pending
+
+class CloudSendBuffer
+{
+public:
+    enum class DropPolicy
+    {
+        DROP_OLDEST,        // the freshest information is kept
+        DROP_NEWEST
+    };
+
+    static constexpr size_t KINDS = std::variant_size_v<CloudSendType>;
+
+    struct Stats
+    {
+        uint64_t queued;                        // accepted (merged included)
+        uint64_t merged;                        // status updates overwriting a pending one
+        std::array<uint64_t, KINDS> dropped;    // per CloudSendType alternative
+    };
+
+private:
+    struct Pending
+    {
+        CloudSendType message;
+        uint64_t seq;           // order of queueing (of the first update, when merged)
+    };
+
+    template <size_t Capacity>
+    struct Ring
+    {
+        std::array<Pending, Capacity> slots;
+        size_t head = 0;
+        size_t count = 0;
+
+        Pending& at(const size_t i) { return slots[(head + i) % Capacity]; }
+        [[nodiscard]] bool full() const { return count == Capacity; }
+        void push(Pending&& pending) { slots[(head + count++) % Capacity] = std::move(pending); }
+        Pending pop()
+        {
+            Pending front = std::move(slots[head]);
+            head = (head + 1) % Capacity;
+            --count;
+            return front;
+        }
+    };
+
+    CppWrapper::Mutex mutex;
+    CppWrapper::CondVar available;
+    Ring<CLOUD_STATUS_SLOTS> status;
+    Ring<CLOUD_REQUEST_SLOTS> requests;
+    uint64_t nextSeq;
+    bool stopping;
+    DropPolicy statusPolicy;
+    DropPolicy requestPolicy;
+    Stats stats;
+
+    template <size_t Capacity>
+    void append(Ring<Capacity>& ring, CloudSendType&& message, DropPolicy policy);
+    Pending* findStatus(const CloudSendType& message);
+    bool popNext(CloudSendType& message);
+
+public:
+    CloudSendBuffer();
+    CloudSendBuffer(const CloudSendBuffer&) = delete;
+    CloudSendBuffer& operator=(const CloudSendBuffer&) = delete;
+
+    void setDropPolicy(DropPolicy statusUpdates, DropPolicy otherRequests);
+
+    void send(CloudSendType&& message);             // never waits
+    bool tryReceive(CloudSendType& message);
+    bool receive(CloudSendType& message);           // waits: false once interrupted (and drained)
+    void interrupt();
+
+    [[nodiscard]] size_t pending();
+    [[nodiscard]] Stats counters();
+    void dump(std::ostream& out);
+};
+
+#endif //TRAFFICCONTROLSYSTEM_CLOUDSENDBUFFER_HPP
@@ -0,0 +1,333 @@
+#include "ConfigurationEngine.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+
+#include "../CppWrapper/CppWrapper.hpp"
+
+ConfigurationEngine::ConfigurationEngine(const ConflictGraph& graph): graph(graph) {}
+
+std::vector<LocationSet> ConfigurationEngine::enumerate(const LocationSet& vertices, const Algorithm algorithm,
+    const unsigned workers) const
+{
+    std::vector<LocationSet> result;
+
+    if (workers > 1 && vertices.count() >= ENGINE_PARALLEL_MIN_LOCATIONS)
+    {
+        std::vector<Branch> branches = split(vertices, algorithm, workers * ENGINE_BRANCHES_PER_WORKER);
+        std::vector<std::vector<LocationSet>> results(branches.size());
+        ParallelSearch job{this, &vertices, algorithm, &branches, &results, 0};
+
+        // The calling thread is one of the workers
+        std::vector<std::unique_ptr<CppWrapper::Thread>> pool;
+        const size_t poolSize = std::min<size_t>(workers, branches.size()) - 1;
+        for (size_t w = 0; w < poolSize; ++w)
+        {
+            auto worker = std::make_unique<CppWrapper::Thread>(t_searchBranches, CppWrapper::ThreadRole::WORKER,
+                "config-search");
+            try
+            {
+                worker->run(&job);
+            }
+            catch (const std::runtime_error& e)
+            {
+                std::cerr << "Configuration search: " << e.what() << ", " << pool.size() + 1 << " workers\n";
+                break;      // the running workers search every branch anyway
+            }
+            pool.push_back(std::move(worker));
+        }
+        t_searchBranches(&job);
+        for (const auto& worker : pool)
+            worker->join();
+
+        // Deterministic merge: branches in the order of the serial search
+        for (auto& branchResult : results)
+            result.insert(result.end(), std::make_move_iterator(branchResult.begin()),
+                std::make_move_iterator(branchResult.end()));
+
+        if (algorithm == Algorithm::BRON_KERBOSCH)
+            std::sort(result.begin(), result.end(), canonicalOrder);
+        return result;
+    }
+
+    switch (algorithm)
+    {
+        case Algorithm::BACKTRACK:
+        {
+            LocationSet current = graph.emptySet();
+            LocationSet candidates = vertices;
+            backtrack(vertices, current, candidates, result);
+            break;  // already in canonical order
+        }
+        case Algorithm::BRON_KERBOSCH:
+        {
+            if (vertices.none())
+                break;
+            LocationSet R = graph.emptySet();
+            LocationSet P = vertices;
+            LocationSet X = graph.emptySet();
+            bronKerbosch(R, P, X, result);
+            std::sort(result.begin(), result.end(), canonicalOrder);
+            break;
+        }
+    }
+    return result;
+}
+
+/*  New Location 'loc' (already in the graph and in vertices):
+ *      - Configurations with a Location conflicting with it stay maximal => kept
+ *      - Configurations compatible with it absorb it; every maximal set containing it is found by
+ *        extending {loc} over its compatible Locations (the absorbing Configurations are among them)
+ */
+std::vector<LocationSet> ConfigurationEngine::addVertex(const std::vector<LocationSet>& configurations,
+    const LocationSet& vertices, const int loc) const
+{
+    std::vector<LocationSet> result;
+
+    for (const auto& cfg : configurations)
+        if (!cfg.disjoint(graph.row(loc)))
+            result.push_back(cfg);
+
+    LocationSet R = graph.emptySet();
+    R.set(loc);
+    extend(R, vertices, result);
+
+    std::sort(result.begin(), result.end(), canonicalOrder);
+    return result;
+}
+
+/*  Removed Location 'loc' (already cleared from the graph and from vertices):
+ *      - Configurations without it stay maximal => kept
+ *      - Configurations with it lose it and are extended again over the Locations it was blocking
+ *        (different Configurations may lead to the same set => duplicates are removed)
+ */
+std::vector<LocationSet> ConfigurationEngine::removeVertex(const std::vector<LocationSet>& configurations,
+    const LocationSet& vertices, const int loc) const
+{
+    std::vector<LocationSet> result;
+
+    for (const auto& cfg : configurations)
+    {
+        if (!cfg.test(loc))
+        {
+            result.push_back(cfg);
+            continue;
+        }
+        LocationSet R = cfg;
+        R.reset(loc);
+        extend(R, vertices, result);
+    }
+
+    std::sort(result.begin(), result.end(), canonicalOrder);
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+// Reports every maximal set containing R (R must be independent)
+void ConfigurationEngine::extend(LocationSet R, const LocationSet& vertices, std::vector<LocationSet>& result) const
+{
+    LocationSet P = vertices;
+    P.andNot(R.data());
+    R.forEach([&](const int u) { P.andNot(graph.row(u)); });
+    LocationSet X = graph.emptySet();
+
+    if (P.none())
+    {
+        if (!R.none())
+            result.push_back(R);
+        return;
+    }
+    bronKerbosch(R, P, X, result);
+}
+
+/*  Top of the search tree, expanded level by level (in search order) until there are, at least, 'target' branches
+ *      Leaves are kept as branches: searching them reports the same as the serial search
+ */
+std::vector<ConfigurationEngine::Branch> ConfigurationEngine::split(const LocationSet& vertices,
+    const Algorithm algorithm, const size_t target) const
+{
+    std::vector<Branch> frontier;
+    frontier.push_back({graph.emptySet(), vertices, graph.emptySet()});
+
+    for (int depth = 0; depth < ENGINE_SPLIT_DEPTH_MAX && frontier.size() < target; ++depth)
+    {
+        std::vector<Branch> expanded;
+        bool progress = false;
+
+        for (auto& [R, P, X] : frontier)
+        {
+            if (P.none())
+            {
+                expanded.push_back({std::move(R), std::move(P), std::move(X)});
+                continue;
+            }
+            progress = true;
+
+            if (algorithm == Algorithm::BACKTRACK)     // same steps as backtrack()
+            {
+                while (!P.none())
+                {
+                    const int v = P.highest();
+                    P.reset(v);
+                    Branch child{R, P, X};
+                    child.P.andNot(graph.row(v));
+                    child.R.set(v);
+                    expanded.push_back(std::move(child));
+                }
+                continue;
+            }
+
+            // Same steps as bronKerbosch()
+            const int pivot = choosePivot(P, X);
+            LocationSet branch = P;
+            branch.andWith(graph.row(pivot));
+            if (P.test(pivot))
+                branch.set(pivot);
+
+            branch.forEach([&](const int v)
+            {
+                Branch child{R, P, X};
+                child.R.set(v);
+                child.P.andNot(graph.row(v));
+                child.P.reset(v);
+                child.X.andNot(graph.row(v));
+                child.X.reset(v);
+                expanded.push_back(std::move(child));
+
+                P.reset(v);
+                X.set(v);
+            });
+        }
+
+        frontier = std::move(expanded);
+        if (!progress)
+            break;
+    }
+    return frontier;
+}
+
+void ConfigurationEngine::search(const LocationSet& vertices, const Algorithm algorithm, Branch& branch,
+    std::vector<LocationSet>& result) const
+{
+    if (algorithm == Algorithm::BACKTRACK)
+        backtrack(vertices, branch.R, branch.P, result);
+    else
+        bronKerbosch(branch.R, branch.P, branch.X, result);
+}
+
+// Worker: searches the next unsearched branch, until there are none (arg: ParallelSearch)
+void* ConfigurationEngine::t_searchBranches(void* arg)
+{
+    auto* job = static_cast<ParallelSearch*>(arg);
+
+    for (size_t i = job->next.fetch_add(1, std::memory_order_relaxed); i < job->branches->size();
+         i = job->next.fetch_add(1, std::memory_order_relaxed))
+        job->engine->search(*job->vertices, job->algorithm, (*job->branches)[i], (*job->results)[i]);
+
+    return nullptr;
+}
+
+// Apply backtracking w/ pruning Algorithm
+/*      set current holds the current locations to insert on the same configuration
+ *      set candidates holds all the locations, initially
+ */
+void ConfigurationEngine::backtrack(const LocationSet& vertices, LocationSet& current, LocationSet& candidates,
+    std::vector<LocationSet>& result) const
+{
+    if (candidates.none()) {       // Last iteration of each configuration
+        // Check if it is a maximal independent set - local validation:
+        //      if any of the other locations (vertices) are compatible with this config
+        if (!current.none() && graph.isMaximal(current, vertices))
+            result.push_back(current);
+        return;
+    }
+
+    while (!candidates.none()) {
+        const int v = candidates.highest();
+        candidates.reset(v);
+
+        // New subset of compatible candidates - next recursive iteration
+        LocationSet newCandidates = candidates;
+        newCandidates.andNot(graph.row(v));     // pruning
+
+        current.set(v);
+        backtrack(vertices, current, newCandidates, result);
+        current.reset(v);
+    }
+}
+
+/*  Bron-Kerbosch w/ pivoting, on the complement of the Conflict Graph (compatibility graph)
+ *      R: Locations of the configuration being built
+ *      P: Locations compatible with all of R, still to be explored
+ *      X: Locations compatible with all of R, already explored (any set extended with them was already reported)
+ *   Compatible neighbourhood of v: N(v) = ~row(v) \ {v}
+ */
+void ConfigurationEngine::bronKerbosch(LocationSet& R, LocationSet& P, LocationSet& X,
+    std::vector<LocationSet>& result) const
+{
+    if (P.none())
+    {
+        if (X.none())
+            result.push_back(R);    // R is maximal
+        return;
+    }
+
+    // Only Locations conflicting with the pivot need to be branched: the others are reached through the pivot
+    const int pivot = choosePivot(P, X);
+    LocationSet branch = P;
+    branch.andWith(graph.row(pivot));
+    if (P.test(pivot))
+        branch.set(pivot);
+
+    branch.forEach([&](const int v)
+    {
+        LocationSet newP = P;
+        newP.andNot(graph.row(v));
+        newP.reset(v);
+        LocationSet newX = X;
+        newX.andNot(graph.row(v));
+        newX.reset(v);
+
+        R.set(v);
+        bronKerbosch(R, newP, newX, result);
+        R.reset(v);
+
+        P.reset(v);
+        X.set(v);
+    });
+}
+
+// Pivot: Location (in P or X) compatible with most of P => fewest branches
+int ConfigurationEngine::choosePivot(const LocationSet& P, const LocationSet& X) const
+{
+    int pivot = -1;
+    int best = -1;
+
+    auto evaluate = [&](const int u)
+    {
+        const int n = P.countAndNot(graph.row(u)) - (P.test(u) ? 1 : 0);
+        if (n > best)
+        {
+            best = n;
+            pivot = u;
+        }
+    };
+
+    P.forEach(evaluate);
+    X.forEach(evaluate);
+    return pivot;
+}
+
+bool ConfigurationEngine::canonicalOrder(const LocationSet& a, const LocationSet& b)
+{
+    for (size_t i = a.numWords(); i-- > 0;)
+    {
+        if (const uint64_t diff = a.data()[i] ^ b.data()[i])
+        {
+            const int bit = LOCATION_WORD_BITS - 1 - std::countl_zero(diff);
+            return (a.data()[i] >> bit) & 1;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,88 @@
+#ifndef TRAFFICCONTROLSYSTEM_CONFIGURATIONENGINE_HPP
+#define TRAFFICCONTROLSYSTEM_CONFIGURATIONENGINE_HPP
+
+#include <atomic>
+#include <vector>
+
+#include "ConflictGraph.hpp"
+
+/*
+ *  Enumerates the Intersection's Configurations: every maximal set of mutually compatible Locations
+ *  (maximal independent sets of the Conflict Graph)
+ *   *  BACKTRACK: original search - explores compatible subsets and filters the maximal ones at the leaves
+ *   *  BRON_KERBOSCH: Bron-Kerbosch w/ pivoting on the complement of the Conflict Graph - only visits
+ *      maximal sets, each one exactly once
+ *
+ *   Both algorithms return the same sets, in the same (canonical) order: sets are ordered by
+ *  their highest Location, then by the next highest, and so on - the order the backtracking search finds them
+ *
+ *   Parallel enumeration (workers > 1): the top of the search tree is expanded on the calling thread until there
+ *  are ENGINE_BRANCHES_PER_WORKER branches per worker; the branches are then searched by a pool of workers
+ *  (each takes the next unsearched branch) and their results are merged in branch order - the output is the same
+ *  as the serial search, whatever the number of workers and the scheduling
+ *
+ *   Incremental maintenance (one Location added/removed): only the Configurations which contain the Location,
+ *  or could absorb it, are recomputed. The Conflict Graph and 'vertices' must already reflect the change
+ */
+#define ENGINE_BRANCHES_PER_WORKER 8
+#define ENGINE_SPLIT_DEPTH_MAX 4            // levels of the search tree expanded before the workers start
+#define ENGINE_PARALLEL_MIN_LOCATIONS 32    // smaller plans are searched on the calling thread
+
+class ConfigurationEngine
+{
+public:
+    enum class Algorithm
+    {
+        BACKTRACK,
+        BRON_KERBOSCH
+    };
+
+private:
+    const ConflictGraph& graph;
+
+    void backtrack(const LocationSet& vertices, LocationSet& current, LocationSet& candidates,
+        std::vector<LocationSet>& result) const;
+    void bronKerbosch(LocationSet& R, LocationSet& P, LocationSet& X, std::vector<LocationSet>& result) const;
+    [[nodiscard]] int choosePivot(const LocationSet& P, const LocationSet& X) const;
+    void extend(LocationSet R, const LocationSet& vertices, std::vector<LocationSet>& result) const;
+
+    /*--- Parallel enumeration ---------------------------------------------------------------------------------------*/
+    // Subtree of the search: R/P/X of Bron-Kerbosch, current/candidates/- of the backtracking search
+    struct Branch
+    {
+        LocationSet R;
+        LocationSet P;
+        LocationSet X;
+    };
+
+    struct ParallelSearch
+    {
+        const ConfigurationEngine* engine;
+        const LocationSet* vertices;
+        Algorithm algorithm;
+        std::vector<Branch>* branches;
+        std::vector<std::vector<LocationSet>>* results;     // one per branch
+        std::atomic<size_t> next;
+    };
+
+    [[nodiscard]] std::vector<Branch> split(const LocationSet& vertices, Algorithm algorithm, size_t target) const;
+    void search(const LocationSet& vertices, Algorithm algorithm, Branch& branch,
+        std::vector<LocationSet>& result) const;
+    static void* t_searchBranches(void* arg);
+
+public:
+    explicit ConfigurationEngine(const ConflictGraph& graph);
+
+    [[nodiscard]] std::vector<LocationSet> enumerate(const LocationSet& vertices, Algorithm algorithm,
+        unsigned workers = 1) const;
+
+    [[nodiscard]] std::vector<LocationSet> addVertex(const std::vector<LocationSet>& configurations,
+        const LocationSet& vertices, int loc) const;
+    [[nodiscard]] std::vector<LocationSet> removeVertex(const std::vector<LocationSet>& configurations,
+        const LocationSet& vertices, int loc) const;
+
+    // Canonical order: true if 'a' comes before 'b' (a holds the highest Location in which they differ)
+    static bool canonicalOrder(const LocationSet& a, const LocationSet& b);
+};
+
+#endif //TRAFFICCONTROLSYSTEM_CONFIGURATIONENGINE_HPP
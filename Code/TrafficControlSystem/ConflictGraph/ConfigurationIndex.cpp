@@ -0,0 +1,39 @@
+#include "ConfigurationIndex.hpp"
+
+void ConfigurationIndex::build(const std::vector<LocationSet>& configurations, const size_t locations)
+{
+    this->locations = locations;
+    wordsPerRow = (configurations.size() + LOCATION_WORD_BITS - 1) / LOCATION_WORD_BITS;
+    rows.assign(locations * wordsPerRow, 0);
+    sets = configurations;
+    emergencyTable.assign(locations * locations, -1);
+
+    for (size_t c = 0; c < sets.size(); ++c)
+    {
+        sets[c].forEach([&](const int loc)
+        {
+            if (static_cast<size_t>(loc) < locations)
+                rows[loc * wordsPerRow + c / LOCATION_WORD_BITS] |= uint64_t{1} << (c % LOCATION_WORD_BITS);
+        });
+    }
+}
+
+bool ConfigurationIndex::serves(const int loc, const int config) const
+{
+    if (loc < 0 || static_cast<size_t>(loc) >= locations || config < 0 || static_cast<size_t>(config) >= sets.size())
+        return false;
+    return (row(loc)[config / LOCATION_WORD_BITS] >> (config % LOCATION_WORD_BITS)) & 1;
+}
+
+void ConfigurationIndex::setEmergency(const int origin, const int destination, const int config)
+{
+    emergencyTable[origin * locations + destination] = config;
+}
+
+int ConfigurationIndex::emergency(const int origin, const int destination) const
+{
+    if (origin < 0 || static_cast<size_t>(origin) >= locations ||
+        destination < 0 || static_cast<size_t>(destination) >= locations)
+        return -1;
+    return emergencyTable[origin * locations + destination];
+}
@@ -0,0 +1,57 @@
+#ifndef TRAFFICCONTROLSYSTEM_CONFIGURATIONINDEX_HPP
+#define TRAFFICCONTROLSYSTEM_CONFIGURATIONINDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ConflictGraph.hpp"
+
+/*
+ *  Inverted index of the active plan: Location -> Configurations serving it
+ *   *  One bitmap of 64-bit words per Location (bit c: Configuration c turns the Location on)
+ *   *  Keeps each Configuration's Location set (Configuration -> Locations)
+ *   *  Emergency table: precomputed Configuration for each (origin, destination) pair, -1 if none
+ *  Every query is a word lookup: independent of the number of Configurations
+ */
+
+class ConfigurationIndex
+{
+    size_t locations = 0;
+    size_t wordsPerRow = 0;                 // words of a Configuration bitmap
+    std::vector<uint64_t> rows;             // locations * wordsPerRow words, row-major
+    std::vector<LocationSet> sets;          // Configuration -> Locations
+    std::vector<int> emergencyTable;        // [origin * locations + destination]
+
+public:
+    void build(const std::vector<LocationSet>& configurations, size_t locations);
+
+    [[nodiscard]] size_t size() const { return sets.size(); }
+    [[nodiscard]] size_t numLocations() const { return locations; }
+
+    [[nodiscard]] const uint64_t* row(const int loc) const { return rows.data() + loc * wordsPerRow; }
+    [[nodiscard]] const LocationSet& locationsOf(const int config) const { return sets[config]; }
+    [[nodiscard]] bool serves(int loc, int config) const;
+
+    // Visits every Configuration serving the Location, in ascending order
+    template <typename F>
+    void forEachServing(const int loc, F&& visit) const
+    {
+        if (loc < 0 || static_cast<size_t>(loc) >= locations)
+            return;
+        for (size_t i = 0; i < wordsPerRow; ++i)
+        {
+            uint64_t w = row(loc)[i];
+            while (w)
+            {
+                visit(static_cast<int>(i * LOCATION_WORD_BITS) + std::countr_zero(w));
+                w &= w - 1;
+            }
+        }
+    }
+
+    void setEmergency(int origin, int destination, int config);
+    [[nodiscard]] int emergency(int origin, int destination) const;
+};
+
+#endif //TRAFFICCONTROLSYSTEM_CONFIGURATIONINDEX_HPP
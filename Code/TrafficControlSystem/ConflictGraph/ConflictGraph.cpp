@@ -0,0 +1,73 @@
+#include "ConflictGraph.hpp"
+
+#include <algorithm>
+
+ConflictGraph::ConflictGraph(const size_t locations)
+{
+    resize(locations);
+}
+
+void ConflictGraph::resize(const size_t locations)
+{
+    this->locations = locations;
+    wordsPerRow = (locations + LOCATION_WORD_BITS - 1) / LOCATION_WORD_BITS;
+    rows.assign(locations * wordsPerRow, 0);
+}
+
+void ConflictGraph::assign(const size_t locations, const uint64_t* packedRows)
+{
+    resize(locations);
+    std::copy_n(packedRows, rows.size(), rows.begin());
+}
+
+void ConflictGraph::grow(const size_t locations)
+{
+    if (locations <= this->locations)
+        return;
+
+    const size_t newWordsPerRow = (locations + LOCATION_WORD_BITS - 1) / LOCATION_WORD_BITS;
+    std::vector<uint64_t> newRows(locations * newWordsPerRow, 0);
+    for (size_t loc = 0; loc < this->locations; ++loc)
+        std::copy_n(rows.begin() + loc * wordsPerRow, wordsPerRow, newRows.begin() + loc * newWordsPerRow);
+
+    this->locations = locations;
+    wordsPerRow = newWordsPerRow;
+    rows = std::move(newRows);
+}
+
+void ConflictGraph::addConflict(const int a, const int b)
+{
+    rows[a * wordsPerRow + b / LOCATION_WORD_BITS] |= (uint64_t{1} << (b % LOCATION_WORD_BITS));
+    rows[b * wordsPerRow + a / LOCATION_WORD_BITS] |= (uint64_t{1} << (a % LOCATION_WORD_BITS));
+}
+
+void ConflictGraph::clearVertex(const int loc)
+{
+    const uint64_t mask = ~(uint64_t{1} << (loc % LOCATION_WORD_BITS));
+    for (size_t other = 0; other < locations; ++other)
+        rows[other * wordsPerRow + loc / LOCATION_WORD_BITS] &= mask;
+
+    std::fill_n(rows.begin() + loc * wordsPerRow, wordsPerRow, 0);
+}
+
+bool ConflictGraph::isIndependent(const LocationSet& set) const
+{
+    bool independent = true;
+    set.forEach([&](const int loc)
+    {
+        if (independent && !set.disjoint(row(loc)))
+            independent = false;
+    });
+    return independent;
+}
+
+/*  A set is maximal if every vertex outside of it conflicts with, at least, one of its members:
+ *      compatible = vertices & ~set & ~(row(u0) | row(u1) | ...)  must be empty
+ */
+bool ConflictGraph::isMaximal(const LocationSet& set, const LocationSet& vertices) const
+{
+    LocationSet compatible = vertices;
+    compatible.andNot(set.data());
+    set.forEach([&](const int loc) { compatible.andNot(row(loc)); });
+    return compatible.none();
+}
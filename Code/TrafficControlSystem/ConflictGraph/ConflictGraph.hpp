@@ -0,0 +1,172 @@
+#ifndef TRAFFICCONTROLSYSTEM_CONFLICTGRAPH_HPP
+#define TRAFFICCONTROLSYSTEM_CONFLICTGRAPH_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ *  Packed representation of the Intersection's Undirected Conflict Graph
+ *   *  Vertices are identified by Location (Locations are contiguous, starting at 0)
+ *   *  Each Location owns one row of 64-bit words: bit j of row i is set if i and j conflict
+ *   *  Rows are stored contiguously in a single buffer (no per-row allocation)
+ *   *  LocationSet shares the row word layout, so independence/maximality checks are done
+ *      one word at a time with AND / ANDN / popcount instead of one bit at a time
+ */
+
+#define LOCATION_WORD_BITS 64
+
+/*--- Set of Locations (packed bitset) -------------------------------------------------------------------------------*/
+class LocationSet
+{
+    std::vector<uint64_t> words;
+
+public:
+    LocationSet() = default;
+    explicit LocationSet(const size_t locations): words((locations + LOCATION_WORD_BITS - 1) / LOCATION_WORD_BITS, 0) {}
+
+    [[nodiscard]] size_t numWords() const { return words.size(); }
+    [[nodiscard]] const uint64_t* data() const { return words.data(); }
+    [[nodiscard]] uint64_t* data() { return words.data(); }
+
+    void set(const int loc) { words[loc / LOCATION_WORD_BITS] |= (uint64_t{1} << (loc % LOCATION_WORD_BITS)); }
+    void reset(const int loc) { words[loc / LOCATION_WORD_BITS] &= ~(uint64_t{1} << (loc % LOCATION_WORD_BITS)); }
+    [[nodiscard]] bool test(const int loc) const
+    {
+        return (words[loc / LOCATION_WORD_BITS] >> (loc % LOCATION_WORD_BITS)) & 1;
+    }
+
+    void resize(const size_t locations)   // keeps the Locations already set
+    {
+        words.resize((locations + LOCATION_WORD_BITS - 1) / LOCATION_WORD_BITS, 0);
+    }
+
+    void clear()
+    {
+        for (auto& w : words) w = 0;
+    }
+
+    [[nodiscard]] bool none() const
+    {
+        for (const auto w : words)
+            if (w) return false;
+        return true;
+    }
+
+    [[nodiscard]] int count() const
+    {
+        int total = 0;
+        for (const auto w : words)
+            total += std::popcount(w);
+        return total;
+    }
+
+    // Highest Location in the set, -1 if empty
+    [[nodiscard]] int highest() const
+    {
+        for (size_t i = words.size(); i-- > 0;)
+            if (words[i])
+                return static_cast<int>(i * LOCATION_WORD_BITS) + (LOCATION_WORD_BITS - 1 - std::countl_zero(words[i]));
+        return -1;
+    }
+
+    // this = this & ~other (other has the same word layout, e.g. a Conflict Graph row)
+    void andNot(const uint64_t* other)
+    {
+        for (size_t i = 0; i < words.size(); ++i)
+            words[i] &= ~other[i];
+    }
+
+    void andWith(const uint64_t* other)
+    {
+        for (size_t i = 0; i < words.size(); ++i)
+            words[i] &= other[i];
+    }
+
+    void orWith(const uint64_t* other)
+    {
+        for (size_t i = 0; i < words.size(); ++i)
+            words[i] |= other[i];
+    }
+
+    // popcount(this & ~other), without building the intermediate set
+    [[nodiscard]] int countAndNot(const uint64_t* other) const
+    {
+        int total = 0;
+        for (size_t i = 0; i < words.size(); ++i)
+            total += std::popcount(words[i] & ~other[i]);
+        return total;
+    }
+
+    // popcount(this & ~other & mask)
+    [[nodiscard]] int countAndNot(const uint64_t* other, const uint64_t* mask) const
+    {
+        int total = 0;
+        for (size_t i = 0; i < words.size(); ++i)
+            total += std::popcount(words[i] & ~other[i] & mask[i]);
+        return total;
+    }
+
+    // true if (this & other) has no Location in common
+    [[nodiscard]] bool disjoint(const uint64_t* other) const
+    {
+        for (size_t i = 0; i < words.size(); ++i)
+            if (words[i] & other[i]) return false;
+        return true;
+    }
+
+    // Visits every Location in the set, in ascending order
+    template <typename F>
+    void forEach(F&& visit) const
+    {
+        for (size_t i = 0; i < words.size(); ++i)
+        {
+            uint64_t w = words[i];
+            while (w)
+            {
+                visit(static_cast<int>(i * LOCATION_WORD_BITS) + std::countr_zero(w));
+                w &= w - 1;     // clear lowest set bit
+            }
+        }
+    }
+
+    bool operator==(const LocationSet& other) const = default;
+};
+
+/*--- Conflict Graph -------------------------------------------------------------------------------------------------*/
+class ConflictGraph
+{
+    size_t locations = 0;
+    size_t wordsPerRow = 0;
+    std::vector<uint64_t> rows;     // locations * wordsPerRow words, row-major
+
+public:
+    ConflictGraph() = default;
+    explicit ConflictGraph(size_t locations);
+
+    void resize(size_t locations);      // resizes and clears every conflict
+    void assign(size_t locations, const uint64_t* packedRows);  // copies precompiled rows (same layout)
+    void grow(size_t locations);        // adds Locations, keeps every conflict
+
+    [[nodiscard]] size_t size() const { return locations; }
+    [[nodiscard]] size_t numWords() const { return wordsPerRow; }
+
+    void addConflict(int a, int b);     // Undirected
+    void clearVertex(int loc);          // removes every conflict of the Location (row and column)
+    [[nodiscard]] bool conflicts(const int a, const int b) const
+    {
+        return (row(a)[b / LOCATION_WORD_BITS] >> (b % LOCATION_WORD_BITS)) & 1;
+    }
+    [[nodiscard]] const uint64_t* row(const int loc) const { return rows.data() + loc * wordsPerRow; }
+    [[nodiscard]] const uint64_t* data() const { return rows.data(); }
+
+    [[nodiscard]] LocationSet emptySet() const { return LocationSet(locations); }
+
+    // true if no two Locations of the set conflict
+    [[nodiscard]] bool isIndependent(const LocationSet& set) const;
+    // true if no Location of 'vertices' (outside 'set') is compatible with every Location of 'set'
+    [[nodiscard]] bool isMaximal(const LocationSet& set, const LocationSet& vertices) const;
+};
+
+#endif //TRAFFICCONTROLSYSTEM_CONFLICTGRAPH_HPP
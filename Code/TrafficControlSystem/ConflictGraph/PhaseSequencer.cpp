@@ -0,0 +1,185 @@
+#include "PhaseSequencer.hpp"
+
+#include <algorithm>
+#include <limits>
+
+std::vector<int> PhaseSequencer::optimize(const std::vector<LocationSet>& configurations,
+    const LocationSet& vertices, const LocationSet& heads, const std::vector<double>& demand)
+{
+    Workspace ws;
+    return optimize(configurations, vertices, heads, demand, ws);
+}
+
+const std::vector<int>& PhaseSequencer::optimize(const std::vector<LocationSet>& configurations,
+    const LocationSet& vertices, const LocationSet& heads, const std::vector<double>& demand, Workspace& ws)
+{
+    cover(configurations, vertices, demand, ws);
+    order(configurations, heads, ws);
+    return ws.cycle;
+}
+
+void PhaseSequencer::cover(const std::vector<LocationSet>& configurations, const LocationSet& vertices,
+    const std::vector<double>& demand, Workspace& ws)
+{
+    // Every Location weighs, at least, 1: Locations with no observed demand must still be served
+    auto weight = [&demand](const LocationSet& set)
+    {
+        double w = 0;
+        set.forEach([&](const int loc)
+        {
+            w += 1.0 + (static_cast<size_t>(loc) < demand.size() ? demand[loc] : 0.0);
+        });
+        return w;
+    };
+
+    std::vector<int>& phases = ws.phases;
+    LocationSet& served = ws.served;
+    phases.clear();
+    ws.uncovered = vertices;
+
+    while (!ws.uncovered.none())
+    {
+        int best = -1;
+        double bestWeight = 0;
+        for (int i = 0; i < static_cast<int>(configurations.size()); ++i)
+        {
+            served = configurations[i];
+            served.andWith(ws.uncovered.data());
+            if (const double w = weight(served); w > bestWeight)
+            {
+                bestWeight = w;
+                best = i;
+            }
+        }
+        if (best < 0)
+            break;      // remaining Locations are in no Configuration
+
+        phases.push_back(best);
+        ws.uncovered.andNot(configurations[best].data());
+    }
+
+    // Drop phases whose Locations are all served by the other phases (lightest first)
+    ws.byWeight = phases;
+    std::ranges::sort(ws.byWeight, [&](const int a, const int b)
+    {
+        return weight(configurations[a]) < weight(configurations[b]);
+    });
+
+    for (const int candidate : ws.byWeight)
+    {
+        served = vertices;
+        served.andWith(configurations[candidate].data());
+        for (const int other : phases)
+            if (other != candidate)
+                served.andNot(configurations[other].data());
+
+        if (served.none())
+            std::erase(phases, candidate);
+    }
+}
+
+void PhaseSequencer::order(const std::vector<LocationSet>& configurations, const LocationSet& heads, Workspace& ws)
+{
+    const std::vector<int>& phases = ws.phases;
+    std::vector<int>& cycle = ws.cycle;
+    const int k = static_cast<int>(phases.size());
+    // Cycle cost = sum |a & heads| - sum |a & next & heads| : up to 3 phases, every cyclic order costs the same
+    if (k <= 3)
+    {
+        cycle = phases;
+        return;
+    }
+
+    std::vector<int>& cost = ws.cost;
+    cost.resize(k * k);
+    for (int i = 0; i < k; ++i)
+        for (int j = 0; j < k; ++j)
+            cost[i * k + j] = transitionCost(configurations[phases[i]], configurations[phases[j]], heads);
+
+    std::vector<int>& route = ws.route;
+    route.clear();
+    route.push_back(0);
+
+    if (k <= SEQUENCER_EXACT_ORDER_MAX)
+    {
+        // Held-Karp: best[mask][j] = cheapest path from phase 0 through 'mask', ending on j
+        constexpr int INF = std::numeric_limits<int>::max() / 2;
+        const int full = 1 << k;
+        std::vector<int>& best = ws.best;
+        std::vector<int>& parent = ws.parent;
+        best.assign(full * k, INF);
+        parent.assign(full * k, -1);
+        best[1 * k + 0] = 0;
+
+        for (int mask = 1; mask < full; mask += 2)      // phase 0 always visited
+        {
+            for (int j = 0; j < k; ++j)
+            {
+                const int current = best[mask * k + j];
+                if (current >= INF)
+                    continue;
+                for (int next = 1; next < k; ++next)
+                {
+                    if (mask & (1 << next))
+                        continue;
+                    const int nextMask = mask | (1 << next);
+                    if (current + cost[j * k + next] < best[nextMask * k + next])
+                    {
+                        best[nextMask * k + next] = current + cost[j * k + next];
+                        parent[nextMask * k + next] = j;
+                    }
+                }
+            }
+        }
+
+        int last = 1;
+        for (int j = 2; j < k; ++j)
+            if (best[(full - 1) * k + j] + cost[j * k] < best[(full - 1) * k + last] + cost[last * k])
+                last = j;
+
+        std::vector<int>& reversed = ws.reversed;
+        reversed.clear();
+        for (int mask = full - 1, j = last; j != 0;)
+        {
+            reversed.push_back(j);
+            const int prev = parent[mask * k + j];
+            mask &= ~(1 << j);
+            j = prev;
+        }
+        route.insert(route.end(), reversed.rbegin(), reversed.rend());
+    }
+    else
+    {
+        // Nearest neighbour
+        std::vector<bool>& visited = ws.visited;
+        visited.assign(k, false);
+        visited[0] = true;
+        for (int step = 1; step < k; ++step)
+        {
+            int next = -1;
+            for (int j = 0; j < k; ++j)
+                if (!visited[j] && (next < 0 || cost[route.back() * k + j] < cost[route.back() * k + next]))
+                    next = j;
+            visited[next] = true;
+            route.push_back(next);
+        }
+    }
+
+    cycle.clear();
+    for (const int i : route)
+        cycle.push_back(phases[i]);
+}
+
+int PhaseSequencer::transitionCost(const LocationSet& from, const LocationSet& to, const LocationSet& heads)
+{
+    return from.countAndNot(to.data(), heads.data());
+}
+
+int PhaseSequencer::cycleCost(const std::vector<LocationSet>& configurations, const std::vector<int>& cycle,
+    const LocationSet& heads)
+{
+    int total = 0;
+    for (size_t i = 0; i < cycle.size(); ++i)
+        total += transitionCost(configurations[cycle[i]], configurations[cycle[(i + 1) % cycle.size()]], heads);
+    return total;
+}
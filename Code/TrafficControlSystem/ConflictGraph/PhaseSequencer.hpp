@@ -0,0 +1,54 @@
+#ifndef TRAFFICCONTROLSYSTEM_PHASESEQUENCER_HPP
+#define TRAFFICCONTROLSYSTEM_PHASESEQUENCER_HPP
+
+#include <vector>
+
+#include "ConflictGraph.hpp"
+
+/*
+ *  Chooses the phase cycle run in Normal operation, out of the Intersection's Configurations
+ *   *  Cover: every Location must get green once per cycle, with as few phases as possible - each phase
+ *      costs a yellow + red transition. Greedy weighted set cover: the next phase is the Configuration
+ *      serving most of the still unserved demand; phases made redundant by later picks are dropped
+ *   *  Order: cyclic order with the fewest heads switched off between consecutive phases
+ *      (exact - Held-Karp - for short cycles, nearest neighbour otherwise)
+ *
+ *   demand[loc]: observed demand of each Location (>= 0); Locations without demand weigh the same
+ *   heads: the Locations the transition cost counts, one per signal head switched - a Crosswalk has two
+ *      Locations (one per PSEM) switched together: only one of them is a head
+ *   Returns indexes of 'configurations'
+ *   Workspace: the scratch buffers of a caller running it on every event - reused, no allocation once warm
+ */
+
+#define SEQUENCER_EXACT_ORDER_MAX 12   // Held-Karp: O(2^k * k^2)
+
+class PhaseSequencer
+{
+public:
+    struct Workspace
+    {
+        LocationSet served, uncovered;
+        std::vector<int> phases, byWeight, cost, route, reversed, best, parent;
+        std::vector<bool> visited;
+        std::vector<int> cycle;     // result
+    };
+
+private:
+    static void cover(const std::vector<LocationSet>& configurations, const LocationSet& vertices,
+        const std::vector<double>& demand, Workspace& ws);
+    static void order(const std::vector<LocationSet>& configurations, const LocationSet& heads, Workspace& ws);
+
+public:
+    static std::vector<int> optimize(const std::vector<LocationSet>& configurations, const LocationSet& vertices,
+        const LocationSet& heads, const std::vector<double>& demand);
+    // Same cycle, in ws.cycle
+    static const std::vector<int>& optimize(const std::vector<LocationSet>& configurations, const LocationSet& vertices,
+        const LocationSet& heads, const std::vector<double>& demand, Workspace& ws);
+
+    // Heads switched off going from 'from' to 'to' (its OFF_Tsem/OFF_Crosswalk lights)
+    static int transitionCost(const LocationSet& from, const LocationSet& to, const LocationSet& heads);
+    static int cycleCost(const std::vector<LocationSet>& configurations, const std::vector<int>& cycle,
+        const LocationSet& heads);
+};
+
+#endif //TRAFFICCONTROLSYSTEM_PHASESEQUENCER_HPP
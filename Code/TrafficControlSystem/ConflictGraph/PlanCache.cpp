@@ -0,0 +1,196 @@
+#include "PlanCache.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+PlanCache::PlanCache(): mapping(nullptr), mappingSize(0), header(nullptr), elementMap(nullptr),
+    conflictRows(nullptr), configurationRows(nullptr) {}
+
+PlanCache::~PlanCache()
+{
+    unmap();
+}
+
+void PlanCache::unmap()
+{
+    if (mapping != nullptr)
+        munmap(mapping, mappingSize);
+
+    mapping = nullptr;
+    mappingSize = 0;
+    header = nullptr;
+    elementMap = nullptr;
+    conflictRows = nullptr;
+    configurationRows = nullptr;
+}
+
+size_t PlanCache::elementsSize(const size_t locations)
+{
+    return (locations + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+}
+
+uint64_t PlanCache::hash(const std::string& data, uint64_t seed)
+{
+    for (const unsigned char c : data)
+    {
+        seed ^= c;
+        seed *= 0x100000001b3ull;   // FNV prime
+    }
+    return seed;
+}
+
+/*  Writes to a temporary file and renames it: a power cut while writing never leaves a half-written plan
+ *  under the final path
+ */
+int PlanCache::save(const std::string& path, const uint64_t configHash, const ConflictGraph& graph,
+    const std::vector<Element>& elements, const std::vector<LocationSet>& configurations)
+{
+    if (elements.size() != graph.size())
+        return -EINVAL;
+
+    const PlanHeader planHeader = {
+        .magic = PLAN_CACHE_MAGIC,
+        .version = PLAN_CACHE_VERSION,
+        .configHash = configHash,
+        .locations = static_cast<uint32_t>(graph.size()),
+        .wordsPerRow = static_cast<uint32_t>(graph.numWords()),
+        .numConfigurations = static_cast<uint32_t>(configurations.size()),
+        .reserved = 0
+    };
+
+    const std::string tmpPath = path + ".tmp";
+    FILE* file = fopen(tmpPath.c_str(), "wb");
+    if (file == nullptr)
+        return -errno;
+
+    std::vector<uint8_t> elementBytes(elementsSize(elements.size()), static_cast<uint8_t>(Element::NONE));
+    for (size_t i = 0; i < elements.size(); ++i)
+        elementBytes[i] = static_cast<uint8_t>(elements[i]);
+
+    // First failure, with its errno - or EIO if it set none (a short fwrite() needn't): never a stale errno
+    int err = 0;
+    const auto step = [&err](const auto& call)
+    {
+        errno = 0;
+        if (!call() && err == 0)
+            err = errno ? errno : EIO;
+    };
+
+    step([&] { return fwrite(&planHeader, sizeof(planHeader), 1, file) == 1; });
+    step([&] { return fwrite(elementBytes.data(), 1, elementBytes.size(), file) == elementBytes.size(); });
+    step([&] { return fwrite(graph.data(), sizeof(uint64_t), graph.size() * graph.numWords(), file)
+                      == graph.size() * graph.numWords(); });
+    for (const auto& cfg : configurations)
+        step([&] { return fwrite(cfg.data(), sizeof(uint64_t), cfg.numWords(), file) == cfg.numWords(); });
+
+    step([&] { return fflush(file) == 0; });
+    step([&] { return fsync(fileno(file)) == 0; });
+    step([&] { return fclose(file) == 0; });
+    if (err == 0)
+        step([&] { return rename(tmpPath.c_str(), path.c_str()) == 0; });
+
+    if (err != 0)
+    {
+        unlink(tmpPath.c_str());
+        return -err;
+    }
+    return 0;
+}
+
+int PlanCache::load(const std::string& path, const uint64_t configHash)
+{
+    unmap();
+
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return -errno;
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(PlanHeader))
+    {
+        close(fd);
+        return -EINVAL;
+    }
+
+    void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // mapping stays valid after closing the descriptor
+    if (addr == MAP_FAILED)
+        return -errno;
+
+    mapping = addr;
+    mappingSize = st.st_size;
+
+    // Validate: magic, version, key and sizes
+    const auto planHeader = static_cast<const PlanHeader*>(mapping);
+    if (planHeader->magic != PLAN_CACHE_MAGIC || planHeader->version != PLAN_CACHE_VERSION)
+    {
+        unmap();
+        return -EINVAL;
+    }
+    if (planHeader->configHash != configHash)
+    {
+        unmap();
+        return -ESTALE;     // Cloud configuration changed since the plan was compiled
+    }
+
+    const size_t words = planHeader->wordsPerRow;
+    const size_t expected = sizeof(PlanHeader) + elementsSize(planHeader->locations)
+                          + (planHeader->locations + planHeader->numConfigurations) * words * sizeof(uint64_t);
+    if (words != (planHeader->locations + LOCATION_WORD_BITS - 1) / LOCATION_WORD_BITS || expected != mappingSize)
+    {
+        unmap();
+        return -EINVAL;
+    }
+
+    const auto base = static_cast<const uint8_t*>(mapping);
+    header = planHeader;
+    elementMap = reinterpret_cast<const Element*>(base + sizeof(PlanHeader));
+    conflictRows = reinterpret_cast<const uint64_t*>(base + sizeof(PlanHeader) + elementsSize(header->locations));
+    configurationRows = conflictRows + header->locations * words;
+
+    return 0;
+}
+
+bool PlanCache::isLoaded() const
+{
+    return header != nullptr;
+}
+
+size_t PlanCache::locations() const
+{
+    return isLoaded() ? header->locations : 0;
+}
+
+PlanCache::Element PlanCache::element(const int loc) const
+{
+    if (!isLoaded() || loc < 0 || static_cast<size_t>(loc) >= header->locations)
+        return Element::NONE;
+    return elementMap[loc];
+}
+
+void PlanCache::conflictGraph(ConflictGraph& graph) const
+{
+    if (isLoaded())
+        graph.assign(header->locations, conflictRows);
+}
+
+std::vector<LocationSet> PlanCache::configurations() const
+{
+    std::vector<LocationSet> result;
+    if (!isLoaded())
+        return result;
+
+    result.reserve(header->numConfigurations);
+    for (size_t i = 0; i < header->numConfigurations; ++i)
+    {
+        LocationSet set(header->locations);
+        std::copy_n(configurationRows + i * header->wordsPerRow, header->wordsPerRow, set.data());
+        result.push_back(std::move(set));
+    }
+    return result;
+}
@@ -0,0 +1,87 @@
+#ifndef TRAFFICCONTROLSYSTEM_PLANCACHE_HPP
+#define TRAFFICCONTROLSYSTEM_PLANCACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ConflictGraph.hpp"
+
+/*
+ *  Precompiled Intersection Plan - binary file memory-mapped on boot
+ *   *  Holds the compiled Conflict Graph rows, the Configuration list (as Location sets)
+ *      and the Location -> Intersection Element map
+ *   *  Keyed by a hash of the PSEM/TSEM JSON received from the Cloud: if the configuration did not change,
+ *      the plan is reused and the Configuration search (findConfigurations) is skipped
+ *
+ *   File layout (native endianness, every section 8-byte aligned):
+ *      PlanHeader
+ *      uint8_t   elements [locations]                      (padded to 8 bytes)
+ *      uint64_t  conflictRows [locations * wordsPerRow]
+ *      uint64_t  configurations [numConfigurations * wordsPerRow]
+ *
+ *  Methods -> return -errno (e.g. -ENOENT, -EINVAL) if the plan can't be written/used
+ */
+
+#define PLAN_CACHE_MAGIC    0x4C504153u    // "SAPL"
+#define PLAN_CACHE_VERSION  1u
+
+class PlanCache
+{
+public:
+    // What is placed on each Location
+    enum class Element : uint8_t
+    {
+        NONE,
+        TRAFFIC_SEMAPHORE,
+        CROSSWALK
+    };
+
+private:
+    struct PlanHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t configHash;
+        uint32_t locations;
+        uint32_t wordsPerRow;
+        uint32_t numConfigurations;
+        uint32_t reserved;
+    };
+
+    void* mapping;
+    size_t mappingSize;
+
+    const PlanHeader* header;
+    const Element* elementMap;
+    const uint64_t* conflictRows;
+    const uint64_t* configurationRows;
+
+    static size_t elementsSize(size_t locations);
+    void unmap();
+
+public:
+    PlanCache();
+    PlanCache(const PlanCache&) = delete;
+    PlanCache& operator=(const PlanCache&) = delete;
+    ~PlanCache();
+
+    /* --- Hash of the Cloud Configuration (FNV-1a 64) ------------------------------------------------------------- */
+    static uint64_t hash(const std::string& data, uint64_t seed = 0xcbf29ce484222325ull);
+
+    /* --- Write (after a successful Set Up) ----------------------------------------------------------------------- */
+    static int save(const std::string& path, uint64_t configHash, const ConflictGraph& graph,
+        const std::vector<Element>& elements, const std::vector<LocationSet>& configurations);
+
+    /* --- Read (memory-mapped) ------------------------------------------------------------------------------------ */
+    int load(const std::string& path, uint64_t configHash);
+    [[nodiscard]] bool isLoaded() const;
+
+    [[nodiscard]] size_t locations() const;
+    [[nodiscard]] Element element(int loc) const;
+    void conflictGraph(ConflictGraph& graph) const;
+    [[nodiscard]] std::vector<LocationSet> configurations() const;
+};
+
+#endif //TRAFFICCONTROLSYSTEM_PLANCACHE_HPP
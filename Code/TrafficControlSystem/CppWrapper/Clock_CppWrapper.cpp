@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <limits>
+
+#include "CppWrapper.hpp"
+
+using namespace CppWrapper;
+
+/*--- Monotonic Clock ------------------------------------------------------------------------------------------------*/
+double MonotonicClock::now() const
+{
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+}
+
+MonotonicClock& MonotonicClock::instance()
+{
+    static MonotonicClock clock;
+    return clock;
+}
+
+/*--- Virtual Clock --------------------------------------------------------------------------------------------------*/
+VirtualClock::VirtualClock(): current(0) {}
+
+VirtualClock::~VirtualClock()
+{
+    for (const auto timer : timers)
+    {
+        LockGuard lock (timer->mutexTimer);
+        timer->virtualClock = nullptr;
+        timer->armed = false;
+    }
+}
+
+double VirtualClock::now() const
+{
+    return current;
+}
+
+void VirtualClock::attach(Timer* timer)
+{
+    if (std::ranges::find(timers, timer) == timers.end())
+        timers.push_back(timer);
+}
+
+void VirtualClock::detach(Timer* timer)
+{
+    std::erase(timers, timer);
+}
+
+double VirtualClock::nextDeadline() const
+{
+    double next = std::numeric_limits<double>::infinity();
+    for (const auto timer : timers)
+        if (timer->armed && timer->deadline < next)
+            next = timer->deadline;
+    return next;
+}
+
+/*  Timers expire one at a time, at their own deadline (earliest first; ties in attach order):
+ *  a Timer's owner sees the time of its expiration
+ */
+void VirtualClock::advanceTo(const double time)
+{
+    while (true)
+    {
+        Timer* due = nullptr;
+        for (const auto timer : timers)
+            if (timer->armed && timer->deadline <= time && (!due || timer->deadline < due->deadline))
+                due = timer;
+        if (!due)
+            break;
+
+        current = std::max(current, due->deadline);
+        due->expire();
+    }
+    current = std::max(current, time);
+}
@@ -1,9 +1,13 @@
 #ifndef PTHREADS_CPPWRAPPER_HPP
 #define PTHREADS_CPPWRAPPER_HPP
 
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <pthread.h>
 #include <mqueue.h>
+#include <sched.h>
 #include <string>
 #include <stdexcept>
 #include <cstring>
@@ -12,6 +16,8 @@
 #include <iostream>
 #include <list>
 #include <queue>
+#include <unordered_set>
+#include <vector>
 
 /*
  *  C++ Wrapper of PThreads/POSIX IPC/POSIX Interval Timers relevant mechanisms for the project
@@ -28,25 +34,69 @@
 
 namespace CppWrapper
 {
+    /*  Thread roles: every Thread runs with the profile of its role - stack size, scheduling, CPU affinity
+     *   *  Real time roles (SCHED_FIFO, PTHREAD_EXPLICIT_SCHED) preempt the others: timers > phase machine >
+     *      control loop > devices, pinned together; network, workers, reports: SCHED_OTHER on every CPU;
+     *      GENERIC: the creator's scheduling and affinity
+     *   *  Real time denied (no CAP_SYS_NICE): the Thread still starts, with the creator's scheduling - reported
+     *   *  Profiles: set before the Threads of the role start (Executor::setProfile)
+     */
+    enum class ThreadRole
+    {
+        GENERIC,        // creator's scheduling
+        TIMER,          // TimerService: every Timer's latency
+        PHASE,          // t_switchLight: drives the lights
+        CONTROL,        // TCS thread: event consumer
+        DEVICE,         // button, card reader
+        NETWORK,        // Cloud, DDS
+        WORKER,         // configuration search
+        BACKGROUND      // reports
+    };
+
+#define THREAD_ROLES 8
+#define ROLE_CPU_INHERIT (-1)   // the creator's affinity
+#define ROLE_CPU_ALL (-2)       // every CPU (not the creator's pinning)
+#define ROLE_CPU_LAST (-3)      // the last online CPU (the real time roles share it)
+
+    struct RoleProfile
+    {
+        const char* name;
+        size_t stackSize;       // bytes
+        bool inheritSched;      // true: the creator's policy and priority (policy/priority ignored)
+        int policy;             // SCHED_FIFO, SCHED_RR, SCHED_OTHER
+        int priority;
+        int cpu;                // CPU it is pinned to, or ROLE_CPU_*
+    };
+
     class Thread
     {
-        static int sched_policy;
+        friend class Executor;
+
         pthread_t thread;
+        pthread_t self;              // set by the thread itself (Executor reports)
         pthread_attr_t attr;
         bool isDetachable;
         void* userArg;
+        ThreadRole role;
+        const char* name;
+        bool rtDenied;               // real time scheduling requested, not permitted: creator's scheduling
+        std::atomic<bool> started;   // enrolled in the Executor: run() returns
+
+        void applyProfile(const RoleProfile& profile);
 
     public:
         bool isRunning;              // Used internally for Error Checking
         void*(*entry_point)(void *); // function the Thread is going to run
 
-        explicit Thread(void*(*ep)(void *));
+        explicit Thread(void*(*ep)(void *), ThreadRole role = ThreadRole::GENERIC, const char* name = nullptr);
         Thread(const Thread&)=delete;
         Thread& operator=(const Thread&)=delete;
 
         ~Thread();
 
-        int setPriority(int priority);
+        int setPriority(int priority);      // real time (SCHED_RR unless the role sets SCHED_FIFO), explicit
+        int setAffinity(int cpu);           // CPU >= 0, ROLE_CPU_ALL or ROLE_CPU_LAST
+        int setInheritSched(bool inherit);
         int setDetachAttribute();
 
         static void* runFromInside(void* arg);
@@ -55,6 +105,24 @@ namespace CppWrapper
         [[nodiscard]] int detach();
     };
 
+    /*  Thread roles and the running Threads: profiles per role, report of the effective scheduling
+     *  Threads enroll when they start running and leave when their function returns
+     */
+    class Executor
+    {
+        friend class Thread;
+
+        static void enroll(Thread* thread);
+        static void leave(Thread* thread);
+
+    public:
+        static RoleProfile profile(ThreadRole role);
+        static void setProfile(ThreadRole role, const RoleProfile& profile);    // -> Threads created afterwards
+        static const char* roleName(ThreadRole role);
+
+        static void report(std::ostream& out);      // one line per running Thread
+    };
+
     class Mutex
     {
         static int mutex_type;
@@ -178,27 +246,114 @@ namespace CppWrapper
         void unlink() const;  // removes name from system
     };
 
+    class Timer;
+
+    /*  Time source of the control loop (seconds)
+     *   *  MonotonicClock: CLOCK_MONOTONIC, the clock of the Timers (timerfd)
+     *   *  VirtualClock: simulated time - only moves when advanced, expiring the Timers attached to it in deadline
+     *      order. Deterministic; used by a single thread (the simulation)
+     */
+    class Clock
+    {
+    public:
+        virtual ~Clock() = default;
+        [[nodiscard]] virtual double now() const = 0;
+    };
+
+    class MonotonicClock : public Clock
+    {
+    public:
+        [[nodiscard]] double now() const override;
+        static MonotonicClock& instance();
+    };
+
+    class VirtualClock : public Clock
+    {
+        double current;
+        std::vector<Timer*> timers;
+
+    public:
+        VirtualClock();
+        VirtualClock(const VirtualClock&) = delete;
+        VirtualClock& operator=(const VirtualClock&) = delete;
+        ~VirtualClock() override;   // Timers still attached go back to real time, disarmed
+
+        [[nodiscard]] double now() const override;
+
+        void attach(Timer* timer);
+        void detach(Timer* timer);
+        [[nodiscard]] double nextDeadline() const;  // earliest armed Timer (infinity if none)
+        void advanceTo(double time);                // expires the Timers due until 'time'
+    };
+
+    /*  Real time expirations of every Timer, on a single thread
+     *   *  Each Timer owns a timerfd (CLOCK_MONOTONIC, ns resolution): arming, re-arming and cancelling
+     *      are one timerfd_settime() on the caller's thread
+     *   *  The service thread waits on all of them through one epoll set and expires the Timers due:
+     *      no thread is created per expiration (as with SIGEV_THREAD)
+     *   *  Started by the first Timer; stopped (eventfd) on destruction, after every Timer is gone
+     */
+    class TimerService
+    {
+        int epfd;
+        int stopFd;
+        Mutex mutexService;                     // dispatch vs remove(): a removed Timer is never expired
+        std::unordered_set<Timer*> timers;
+        Thread thread;
+
+        TimerService();
+        static void* t_service(void* arg);
+    public:
+        TimerService(const TimerService&) = delete;
+        TimerService& operator=(const TimerService&) = delete;
+        ~TimerService();
+
+        static TimerService& instance();
+        void add(Timer* timer);
+        void remove(Timer* timer);
+    };
+
     class Timer
     {
-        timer_t timerid;
-        sigevent sev{};
-        itimerspec its{};
+        friend class VirtualClock;
+        friend class TimerService;
+
+        int fd;                         // timerfd, watched by the TimerService
 
         Mutex mutexTimer;
         CondVar condTimer;
 
         int fired;
+
+        VirtualClock* virtualClock;     // nullptr: timerfd (real time)
+        double deadline;                // virtual time
+        bool armed;
+        double period;                  // s between expirations (0: one shot)
+
+        void (*expireCallback)(void*);  // on each expiration, outside the Timer's lock
+        void* expireArg;
+
+        void arm(const itimerspec& its, int flags);
+        void expire();
     public:
         Timer();
         Timer(const Timer&) = delete;
         Timer& operator=(const Timer&) = delete;
         ~Timer();
 
-        void timerRun(double value);
+        void timerRun(double value);        // expires 'value' seconds from now (re-arms if armed)
+        void timerRunAt(double time);       // expires at 'time' (MonotonicClock / VirtualClock seconds)
+        void timerRunPeriodic(double value);    // expires every 'value' seconds from now, until cancelled/re-armed
+        void cancel();                      // disarms; timerWait() keeps waiting
         void timerWait();
         void fireImmediately();
-        static void timerCallback(union sigval sv);
         int getTime();
+
+        void useClock(VirtualClock& clock);     // runs on virtual time from now on
+        [[nodiscard]] bool hasFired();
+
+        // Set before arming: runs on the TimerService thread (or the one advancing the VirtualClock)
+        void onExpire(void (*callback)(void*), void* arg);
     };
 
     // Queue allows to have non-trivially copiable data, contrary to MQueue
@@ -249,6 +404,19 @@ namespace CppWrapper
             return data;
         }
 
+        // Non-blocking receive: returns false if the Queue is empty
+        bool tryReceive (T& data)
+        {
+            CppWrapper::LockGuard lock(mutexQueue);
+
+            if (queueData.empty())
+                return false;
+
+            data = std::move(queueData.front());
+            queueData.pop();
+            return true;
+        }
+
         void interrupt ()
         {
             CppWrapper::LockGuard lock(mutexQueue);
@@ -256,6 +424,202 @@ namespace CppWrapper
             condQueue.condBroadcast();
         }
     };
+
+    /*  Counter of wake-ups (eventfd): any thread signals, one thread waits
+     *   *  Signals not waited for yet are coalesced: the next wait() returns at once
+     */
+    class EventFd
+    {
+        int fd;
+    public:
+        EventFd();
+        EventFd(const EventFd&) = delete;
+        EventFd& operator=(const EventFd&) = delete;
+        ~EventFd();
+
+        void signal() const;
+        void wait() const;      // blocks until signalled (clears the counter)
+    };
+
+    /*  Bounded multi producer / single consumer queue - lock-free, drop-in for Queue<T> on the event path
+     *   *  Slots carry a sequence number (Vyukov): a producer claims a slot with one CAS on the tail, writes it
+     *      and publishes it (release); the consumer reads slots in order - no lock, no allocation after construction
+     *   *  The consumer sleeps on an eventfd, only when it found the queue empty: producers issue a write() only
+     *      if it is asleep (or about to)
+     *   *  Full: send() yields until a slot is free (backpressure on the producers); trySend() fails instead
+     *   *  interrupt(): receive() returns T{} once the queue is drained - the caller checks interrupted()
+     *  Capacity: power of two; T default constructible and move assignable
+     */
+    template <typename T, size_t Capacity>
+    class MpscQueue
+    {
+        static_assert(Capacity > 1 && (Capacity & (Capacity - 1)) == 0, "MpscQueue: capacity must be a power of two");
+
+        struct Slot
+        {
+            std::atomic<size_t> seq;    // pos: free for the producer at pos; pos + 1: holds the data sent at pos
+            T data;
+        };
+
+        std::array<Slot, Capacity> slots;
+        alignas(64) std::atomic<size_t> tail{0};    // next position claimed (producers)
+        alignas(64) size_t head = 0;                // next position received (consumer)
+        alignas(64) std::atomic<bool> sleeping{false};
+        std::atomic<bool> _interrupted{false};
+        EventFd wakeUp;
+
+        void wake()
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);    // publish before reading 'sleeping'
+            if (sleeping.load(std::memory_order_relaxed) && sleeping.exchange(false))
+                wakeUp.signal();
+        }
+
+    public:
+        MpscQueue()
+        {
+            for (size_t i = 0; i < Capacity; ++i)
+                slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+
+        // Any thread: false if full ('data' is left untouched)
+        bool trySend(T&& data)
+        {
+            return trySend(std::move(data), 0);
+        }
+
+        // Any thread: false unless 'reserve' more slots stay free - kept for the senders passing a lower reserve
+        bool trySend(T&& data, const size_t reserve)
+        {
+            size_t pos = tail.load(std::memory_order_relaxed);
+            Slot* slot;
+            while (true)
+            {
+                slot = &slots[pos & (Capacity - 1)];
+                const auto lag = static_cast<std::ptrdiff_t>(slot->seq.load(std::memory_order_acquire) - pos);
+                if (lag == 0)
+                {
+                    // Slots are received in order: 'reserve' more are free if the last of them is
+                    const Slot& last = slots[(pos + reserve) & (Capacity - 1)];
+                    if (reserve && static_cast<std::ptrdiff_t>(last.seq.load(std::memory_order_acquire) - (pos + reserve)) < 0)
+                        return false;
+                    if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (lag < 0)       // not received yet, one lap behind
+                    return false;
+                else                    // claimed by another producer
+                    pos = tail.load(std::memory_order_relaxed);
+            }
+
+            slot->data = std::move(data);
+            slot->seq.store(pos + 1, std::memory_order_release);
+            wake();
+            return true;
+        }
+
+        void send(T&& data)
+        {
+            while (!trySend(std::move(data)))
+                sched_yield();
+        }
+
+        // Consumer: false if empty
+        bool tryReceive(T& data)
+        {
+            Slot& slot = slots[head & (Capacity - 1)];
+            if (slot.seq.load(std::memory_order_acquire) != head + 1)
+                return false;
+
+            data = std::move(slot.data);
+            slot.seq.store(head + Capacity, std::memory_order_release);
+            ++head;
+            return true;
+        }
+
+        // Consumer: blocks until data is sent (or T{} once interrupted and drained)
+        T receive()
+        {
+            T data{};
+            while (!tryReceive(data))
+            {
+                if (_interrupted.load())
+                    return T{};
+
+                sleeping.store(true);
+                std::atomic_thread_fence(std::memory_order_seq_cst);    // 'sleeping' visible before the re-check
+                if (tryReceive(data))
+                {
+                    sleeping.store(false);
+                    break;
+                }
+                if (!_interrupted.load())
+                    wakeUp.wait();
+                sleeping.store(false);
+            }
+            return data;
+        }
+
+        void interrupt()
+        {
+            _interrupted = true;
+            wakeUp.signal();
+        }
+
+        [[nodiscard]] bool interrupted() const { return _interrupted.load(); }
+    };
+
+    /*  Bounded single producer / single consumer ring - lock-free, never blocks
+     *   *  One thread pushes, one thread pops: each index is only written by its side (acquire/release pairs)
+     *   *  Capacity: power of two; the indexes only grow (free running, wrap-around by masking)
+     *   *  No wake-up: the consumer polls it when it has something else waking it up (e.g. a timer expiration)
+     */
+    template <typename T, size_t Capacity>
+    class SpscRing
+    {
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SpscRing: capacity must be a power of two");
+
+        std::array<T, Capacity> slots;
+        alignas(64) std::atomic<size_t> head{0};    // next slot popped (consumer)
+        alignas(64) std::atomic<size_t> tail{0};    // next slot pushed (producer)
+
+    public:
+        SpscRing() = default;
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+        // Producer: false if full
+        bool tryPush(const T& data)
+        {
+            const size_t t = tail.load(std::memory_order_relaxed);
+            if (t - head.load(std::memory_order_acquire) == Capacity)
+                return false;
+
+            slots[t & (Capacity - 1)] = data;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer: false if empty
+        bool tryPop(T& data)
+        {
+            const size_t h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire))
+                return false;
+
+            data = slots[h & (Capacity - 1)];
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Producer: free slots (it only grows until the next push)
+        [[nodiscard]] size_t space() const
+        {
+            return Capacity - (tail.load(std::memory_order_relaxed) - head.load(std::memory_order_acquire));
+        }
+    };
 }
 
 #endif //PTHREADS_CPPWRAPPER_HPP
\ No newline at end of file
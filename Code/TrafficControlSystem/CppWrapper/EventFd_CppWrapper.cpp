@@ -0,0 +1,31 @@
+#include <cerrno>
+#include <cstdint>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "CppWrapper.hpp"
+
+using namespace CppWrapper;
+
+EventFd::EventFd(): fd(eventfd(0, EFD_CLOEXEC))
+{
+    if (fd == -1)
+        throw std::runtime_error("EventFd: eventfd()");
+}
+
+EventFd::~EventFd()
+{
+    close(fd);
+}
+
+void EventFd::signal() const
+{
+    constexpr uint64_t one = 1;
+    while (write(fd, &one, sizeof(one)) == -1 && errno == EINTR) {}
+}
+
+void EventFd::wait() const
+{
+    uint64_t count;
+    while (read(fd, &count, sizeof(count)) == -1 && errno == EINTR) {}
+}
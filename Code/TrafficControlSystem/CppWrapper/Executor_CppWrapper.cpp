@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <iomanip>
+#include <sched.h>
+#include <unistd.h>
+#include <vector>
+
+#include "CppWrapper.hpp"
+
+using namespace CppWrapper;
+
+#define KB 1024
+
+/*  Role profiles: real time roles pinned together (ROLE_CPU_LAST), the others on every CPU - with SCHED_OTHER
+ *  explicit: never inherited from a real time creator (e.g. the configuration search started by the TCS thread)
+ *  Stacks: what each role needs, with margin (JSON parsing, libcurl, Fast DDS: 1 MB)
+ */
+static const RoleProfile defaultProfiles[THREAD_ROLES] = {
+    //  name           stack       inherit  policy       prio  cpu
+    {"generic",     1024 * KB,  true,    SCHED_OTHER, 0,    ROLE_CPU_INHERIT},
+    {"timer",       256 * KB,   false,   SCHED_FIFO,  80,   ROLE_CPU_LAST},
+    {"phase",       256 * KB,   false,   SCHED_FIFO,  70,   ROLE_CPU_LAST},
+    {"control",     1024 * KB,  false,   SCHED_FIFO,  60,   ROLE_CPU_LAST},
+    {"device",      256 * KB,   false,   SCHED_FIFO,  50,   ROLE_CPU_LAST},
+    {"network",     1024 * KB,  false,   SCHED_OTHER, 0,    ROLE_CPU_ALL},
+    {"worker",      1024 * KB,  false,   SCHED_OTHER, 0,    ROLE_CPU_ALL},
+    {"background",  256 * KB,   false,   SCHED_OTHER, 0,    ROLE_CPU_ALL},
+};
+
+namespace
+{
+    struct Registry
+    {
+        Mutex mutex;
+        std::vector<Thread*> running;
+        RoleProfile profiles[THREAD_ROLES];
+
+        Registry() { std::copy(std::begin(defaultProfiles), std::end(defaultProfiles), profiles); }
+    };
+
+    // Never destroyed: Threads of static objects leave after main returns
+    Registry& registry()
+    {
+        static auto instance = new Registry;
+        return *instance;
+    }
+
+    const char* policyName(const int policy)
+    {
+        switch (policy)
+        {
+        case SCHED_FIFO:  return "SCHED_FIFO";
+        case SCHED_RR:    return "SCHED_RR";
+        case SCHED_OTHER: return "SCHED_OTHER";
+        default:          return "other";
+        }
+    }
+}
+
+RoleProfile Executor::profile(const ThreadRole role)
+{
+    Registry& r = registry();
+    LockGuard lock(r.mutex);
+    return r.profiles[static_cast<size_t>(role)];
+}
+
+void Executor::setProfile(const ThreadRole role, const RoleProfile& profile)
+{
+    Registry& r = registry();
+    LockGuard lock(r.mutex);
+    r.profiles[static_cast<size_t>(role)] = profile;
+}
+
+const char* Executor::roleName(const ThreadRole role)
+{
+    return defaultProfiles[static_cast<size_t>(role)].name;
+}
+
+void Executor::enroll(Thread* thread)
+{
+    Registry& r = registry();
+    LockGuard lock(r.mutex);
+    r.running.push_back(thread);
+}
+
+void Executor::leave(Thread* thread)
+{
+    Registry& r = registry();
+    LockGuard lock(r.mutex);
+    std::erase(r.running, thread);
+}
+
+// Effective scheduling, read from the kernel: what the Threads got, not what was asked
+void Executor::report(std::ostream& out)
+{
+    Registry& r = registry();
+    LockGuard lock(r.mutex);
+
+    out << std::left << std::setw(16) << "thread" << std::setw(12) << "role" << std::setw(13) << "policy"
+        << std::right << std::setw(5) << "prio" << std::setw(10) << "stack[KB]" << "  CPUs\n";
+    for (Thread* thread : r.running)
+    {
+        int policy = SCHED_OTHER;
+        sched_param sp{};
+        pthread_getschedparam(thread->self, &policy, &sp);
+
+        size_t stack = 0;
+        pthread_attr_getstacksize(&thread->attr, &stack);
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        pthread_getaffinity_np(thread->self, sizeof(set), &set);
+
+        out << std::left << std::setw(16) << thread->name << std::setw(12) << roleName(thread->role)
+            << std::setw(13) << policyName(policy) << std::right << std::setw(5) << sp.sched_priority
+            << std::setw(10) << stack / KB << "  ";
+        if (CPU_COUNT(&set) == sysconf(_SC_NPROCESSORS_ONLN))
+            out << "all";
+        else
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                if (CPU_ISSET(cpu, &set))
+                    out << cpu << " ";
+        if (thread->rtDenied)
+            out << "  (real time denied: creator's scheduling)";
+        out << "\n";
+    }
+}
@@ -1,16 +1,38 @@
 #include "CppWrapper.hpp"
 
+#include <algorithm>
 #include <sched.h>
 #include <cerrno>
+#include <climits>
 #include <stdexcept>
+#include <unistd.h>
 
 using namespace CppWrapper;
 
-int Thread::sched_policy = SCHED_RR; // SCHED_OTHER, SCHED_FIFO
+// CPU of ROLE_CPU_LAST / ROLE_CPU_ALL, or the one given: false if not a CPU of this system
+static bool cpuSet(const int cpu, cpu_set_t& set)
+{
+    const long online = sysconf(_SC_NPROCESSORS_ONLN);
+    CPU_ZERO(&set);
+    if (cpu == ROLE_CPU_ALL)
+    {
+        for (long i = 0; i < online && i < CPU_SETSIZE; ++i)
+            CPU_SET(i, &set);
+        return true;
+    }
+
+    const long target = cpu == ROLE_CPU_LAST ? online - 1 : cpu;
+    if (target < 0 || target >= online || target >= CPU_SETSIZE)
+        return false;
+    CPU_SET(target, &set);
+    return true;
+}
 
 // Init internal variables with default values
-// thread is joinable (default)
-Thread::Thread(void*(*ep)(void *)) : thread(), attr(), isRunning(false), isDetachable(false), userArg(nullptr)
+// thread is joinable (default); attributes from the profile of its role
+Thread::Thread(void*(*ep)(void *), const ThreadRole role, const char* name) : thread(), self(), attr(),
+    isDetachable(false), userArg(nullptr), role(role), name(name ? name : Executor::roleName(role)), rtDenied(false),
+    started(false), isRunning(false)
 {
     entry_point = ep; // Set executing function
 
@@ -18,12 +40,31 @@ Thread::Thread(void*(*ep)(void *)) : thread(), attr(), isRunning(false), isDetac
     if (s != 0)
         throw std::runtime_error("Thread: pthread_attr_init");
 
-    s = pthread_attr_setstacksize(&attr, 20 * 1024 * 1024); // Set to 8MB
-    if (s != 0)
-            throw std::runtime_error("Thread: pthread_attr_setstacksize");
-    s = pthread_attr_setschedpolicy(&attr, sched_policy);
+    applyProfile(Executor::profile(role));
+}
+
+void Thread::applyProfile(const RoleProfile& profile)
+{
+    int s = pthread_attr_setstacksize(&attr, std::max<size_t>(profile.stackSize, PTHREAD_STACK_MIN));
     if (s != 0)
-        throw std::runtime_error("Thread: pthread_attr_setschedpolicy");
+        throw std::runtime_error("Thread: pthread_attr_setstacksize");
+
+    if (profile.inheritSched)
+        setInheritSched(true);
+    else
+    {
+        s = pthread_attr_setschedpolicy(&attr, profile.policy);
+        if (s != 0)
+            throw std::runtime_error("Thread: pthread_attr_setschedpolicy");
+        const sched_param sp = {.sched_priority = profile.priority};
+        s = pthread_attr_setschedparam(&attr, &sp);
+        if (s != 0)
+            throw std::runtime_error("Thread: pthread_attr_setschedparam");
+        setInheritSched(false);
+    }
+
+    if (profile.cpu != ROLE_CPU_INHERIT && setAffinity(profile.cpu) != 0)
+        throw std::runtime_error("Thread: role pinned to a CPU this system does not have");
 }
 
 Thread::~Thread ()
@@ -34,24 +75,60 @@ Thread::~Thread ()
     pthread_attr_destroy(&attr);      /* No longer needed */
 }
 
-// Sets priority of the thread. If not used, priority = default SCHED_RR/SCHED_FIFO (min) = 1, SCHED_OTHER = 0
+// Sets priority of the thread: real time, explicit (not inherited from the creator)
+// SCHED_RR, unless the role already asks for a real time policy
 int Thread::setPriority(const int priority)
 {
     if (isRunning)
         return -EPERM;
 
-    int min_prio = sched_get_priority_min(sched_policy);
-    int max_prio = sched_get_priority_max(sched_policy);
+    int policy;
+    pthread_attr_getschedpolicy(&attr, &policy);
+    if (policy != SCHED_FIFO && policy != SCHED_RR)
+        policy = SCHED_RR;
+
+    int min_prio = sched_get_priority_min(policy);
+    int max_prio = sched_get_priority_max(policy);
 
     if (priority < min_prio || priority > max_prio)
         return -EINVAL;
 
     const struct sched_param sp ={.sched_priority = priority};
 
-    int s = pthread_attr_setschedparam(&attr, &sp);
+    int s = pthread_attr_setschedpolicy(&attr, policy);
+    if (s != 0)
+        throw std::runtime_error("Thread: pthread_attr_setschedpolicy");
+    s = pthread_attr_setschedparam(&attr, &sp);
     if (s != 0)
         throw std::runtime_error("Thread: pthread_attr_setschedparam");
 
+    // Without it, the policy and priority above are silently ignored: the creator's are used
+    return setInheritSched(false);
+}
+
+int Thread::setAffinity(const int cpu)
+{
+    if (isRunning)
+        return -EPERM;
+
+    cpu_set_t set;
+    if (!cpuSet(cpu, set))
+        return -EINVAL;
+
+    int s = pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+    if (s != 0)
+        throw std::runtime_error("Thread: pthread_attr_setaffinity_np");
+    return 0;
+}
+
+int Thread::setInheritSched(const bool inherit)
+{
+    if (isRunning)
+        return -EPERM;
+
+    int s = pthread_attr_setinheritsched(&attr, inherit ? PTHREAD_INHERIT_SCHED : PTHREAD_EXPLICIT_SCHED);
+    if (s != 0)
+        throw std::runtime_error("Thread: pthread_attr_setinheritsched");
     return 0;
 }
 
@@ -72,8 +149,19 @@ int Thread::setDetachAttribute()
 void* Thread::runFromInside(void* arg)
 {
     auto caller_thread = static_cast<Thread*>(arg);
+
+    caller_thread->self = pthread_self();
+    char threadName[16] = {};       // kernel limit, NUL included
+    strncpy(threadName, caller_thread->name, sizeof(threadName) - 1);
+    pthread_setname_np(caller_thread->self, threadName);
+
+    Executor::enroll(caller_thread);
+    caller_thread->started = true;
+    caller_thread->started.notify_one();
+
     void* ret = caller_thread->entry_point(caller_thread->userArg);
     // Code will reach this point upon Thread function completion
+    Executor::leave(caller_thread);
     caller_thread->isRunning = false;
 
     return ret;
@@ -82,19 +170,34 @@ void* Thread::runFromInside(void* arg)
 // creates the thread (it starts running) sets isRunning.
 // &Thread::runFromInside  is passed to ensure variable isRunning is updated correctly
 // arg is the executing function received argument
+// Returns once the thread runs (enrolled: Executor::report lists it)
 int Thread::run(void* arg)
 {
     if (isRunning)
         return -EPERM;
 
     userArg = arg;
+    started = false;
+    isRunning = true;
 
     int s = pthread_create(&thread, &attr, &Thread::runFromInside, this); // this: is the argument to the runFromInside function
+
+    // Real time scheduling not permitted (no CAP_SYS_NICE): runs with the creator's scheduling instead
+    int inherit;
+    pthread_attr_getinheritsched(&attr, &inherit);
+    if (s == EPERM && inherit == PTHREAD_EXPLICIT_SCHED)
+    {
+        rtDenied = true;
+        pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+        s = pthread_create(&thread, &attr, &Thread::runFromInside, this);
+    }
     if (s != 0)
+    {
+        isRunning = false;
         throw std::runtime_error("Thread: pthread_create");
+    }
 
-    isRunning = true;
-
+    started.wait(false);
     return 0;
 }
 
@@ -117,4 +220,4 @@ int Thread::detach()
 
     isDetachable = false;
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,109 @@
+#include <cerrno>
+#include <cstdint>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "CppWrapper.hpp"
+
+#define TIMER_SERVICE_EVENTS 16     // expirations handled per epoll_wait()
+
+using namespace CppWrapper;
+
+TimerService::TimerService(): epfd(-1), stopFd(-1), thread(t_service, ThreadRole::TIMER, "timers")
+{
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd == -1)
+        throw std::runtime_error("TimerService: epoll_create1()");
+
+    stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (stopFd == -1)
+    {
+        close(epfd);
+        throw std::runtime_error("TimerService: eventfd()");
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;          // stop request
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, stopFd, &ev) == -1 || thread.run(this) != 0)
+    {
+        close(stopFd);
+        close(epfd);
+        throw std::runtime_error("TimerService: start");
+    }
+}
+
+TimerService::~TimerService()
+{
+    constexpr uint64_t stop = 1;
+    if (write(stopFd, &stop, sizeof(stop)) == sizeof(stop))
+        thread.join();
+    close(stopFd);
+    close(epfd);
+}
+
+// Constructed by the first Timer: destroyed after the last static Timer
+TimerService& TimerService::instance()
+{
+    static TimerService service;
+    return service;
+}
+
+void TimerService::add(Timer* timer)
+{
+    LockGuard lock (mutexService);
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = timer;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, timer->fd, &ev) == -1)
+        throw std::runtime_error("TimerService: epoll_ctl(ADD)");
+    timers.insert(timer);
+}
+
+// On return, 'timer' is not being expired and will not be
+void TimerService::remove(Timer* timer)
+{
+    LockGuard lock (mutexService);
+
+    epoll_ctl(epfd, EPOLL_CTL_DEL, timer->fd, nullptr);
+    timers.erase(timer);
+}
+
+/*  Events already returned by epoll_wait() may belong to a Timer removed meanwhile: only registered Timers
+ *  are expired. A new Timer at the same address owns another timerfd, with nothing to read (EAGAIN)
+ */
+void* TimerService::t_service(void* arg)
+{
+    const auto self = static_cast<TimerService*>(arg);
+    epoll_event events[TIMER_SERVICE_EVENTS];
+
+    // Every Timer's latency depends on this thread: ThreadRole::TIMER, the highest real time priority
+    while (true)
+    {
+        const int n = epoll_wait(self->epfd, events, TIMER_SERVICE_EVENTS, -1);
+        if (n == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            std::cerr << "TimerService: epoll_wait() " << strerror(errno) << std::endl;
+            return nullptr;
+        }
+
+        LockGuard lock (self->mutexService);
+        for (int i = 0; i < n; ++i)
+        {
+            const auto timer = static_cast<Timer*>(events[i].data.ptr);
+            if (!timer)
+                return nullptr;
+            if (!self->timers.contains(timer))
+                continue;
+
+            uint64_t expirations = 0;
+            if (read(timer->fd, &expirations, sizeof(expirations)) == sizeof(expirations) && expirations)
+                timer->expire();
+        }
+    }
+}
@@ -1,4 +1,6 @@
-#include <csignal>
+#include <cerrno>
+#include <sys/timerfd.h>
+#include <unistd.h>
 
 #include "CppWrapper.hpp"
 
@@ -8,26 +10,33 @@ using namespace CppWrapper;
 
 /* Timer has a Mutex and has a condition variable (the latter is related to the former) */
 
-Timer::Timer (): timerid(), condTimer(mutexTimer), fired (0)
+Timer::Timer (): fd(-1), condTimer(mutexTimer), fired (0), virtualClock(nullptr), deadline(0), armed(false),
+    period(0), expireCallback(nullptr), expireArg(nullptr)
 {
     std::cerr << "Timer Created at " << this << std::endl;
-    sev.sigev_notify = SIGEV_THREAD;
-    sev.sigev_notify_function = timerCallback;
-    sev.sigev_value.sival_ptr = this;
-    /*  */
-    its.it_value.tv_sec = 0;
-    its.it_value.tv_nsec = 0;
-    its.it_interval.tv_sec = 0;
-    its.it_interval.tv_nsec = 0;
-
-    if (timer_create(CLOCK_MONOTONIC, &sev, &timerid) != 0)
-        throw std::runtime_error("Timer: timer_create()");
+
+    fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd == -1)
+        throw std::runtime_error("Timer: timerfd_create()");
+
+    try
+    {
+        TimerService::instance().add(this);
+    }
+    catch (...)
+    {
+        close(fd);
+        throw;
+    }
 }
 
 Timer::~Timer()
 {
     std::cerr << "Timer Deleted at " << this << std::endl;
-    timer_delete(timerid);
+    if (virtualClock)
+        virtualClock->detach(this);
+    TimerService::instance().remove(this);
+    close(fd);
 }
 
 std::pair<long, long> splitNumber(const double value)
@@ -44,8 +53,13 @@ std::pair<long, long> splitNumber(const double value)
         To arm a timer, we make a call to timer_settime() in which either or both of the
     subfields of value.it_value are nonzero. If the timer was previously armed, timer_settime()
     replaces the previous settings.
- *
+ *  timerfd_settime() behaves the same, and discards the expirations not yet read by the TimerService
  */
+void Timer::arm(const itimerspec& its, const int flags)
+{
+    if (timerfd_settime(fd, flags, &its, nullptr) == -1)
+        throw std::runtime_error("Timer: timerfd_settime()");
+}
 
 void Timer::timerRun(const double value)
 {
@@ -56,12 +70,81 @@ void Timer::timerRun(const double value)
     std::cerr << "Timer RUN at " << this << std::endl;
 
     fired = 0;
+    period = 0;
 
+    if (virtualClock)
+    {
+        deadline = virtualClock->now() + value;
+        armed = true;
+        return;
+    }
+
+    itimerspec its{};
+    its.it_value.tv_sec = seconds;  its.it_value.tv_nsec = nanoseconds;
+    if (its.it_value.tv_sec <= 0 && its.it_value.tv_nsec <= 0)
+        its.it_value.tv_nsec = 1;   // zero would disarm it: expires now instead
+    armed = true;
+    arm(its, 0);
+}
+
+void Timer::timerRunAt(const double time)
+{
+    LockGuard lock (mutexTimer);
+
+    fired = 0;
+    armed = true;
+    period = 0;
+
+    if (virtualClock)
+    {
+        deadline = time;
+        return;
+    }
+
+    // Absolute expiration: no drift from the time spent since 'time' was computed
+    auto [seconds, nanoseconds] = splitNumber(time);
+    itimerspec its{};
     its.it_value.tv_sec = seconds;  its.it_value.tv_nsec = nanoseconds;
-    /* period for periodic timer expirations. */
-    its.it_interval.tv_sec = 0;  its.it_interval.tv_nsec = 0;
+    if (its.it_value.tv_sec <= 0 && its.it_value.tv_nsec <= 0)
+        its.it_value.tv_nsec = 1;
+    arm(its, TFD_TIMER_ABSTIME);
+}
+
+/*  Periodic: the timerfd reloads itself (it_interval) - no re-arming, no drift
+ *  Expirations missed by a late TimerService are coalesced into one (one read, one callback)
+ */
+void Timer::timerRunPeriodic(const double value)
+{
+    auto [seconds, nanoseconds] = splitNumber(value);
+    if (seconds <= 0 && nanoseconds <= 0)
+        throw std::runtime_error("Timer: timerRunPeriodic() needs a period");
 
-    timer_settime(timerid, 0, &its, nullptr);
+    LockGuard lock (mutexTimer);
+
+    fired = 0;
+    armed = true;
+    period = value;
+
+    if (virtualClock)
+    {
+        deadline = virtualClock->now() + value;
+        return;
+    }
+
+    itimerspec its{};
+    its.it_value.tv_sec = seconds;  its.it_value.tv_nsec = nanoseconds;
+    its.it_interval = its.it_value;
+    arm(its, 0);
+}
+
+void Timer::cancel()
+{
+    LockGuard lock (mutexTimer);
+
+    armed = false;
+    period = 0;
+    if (!virtualClock)
+        arm(itimerspec{}, 0);
 }
 
 void Timer::fireImmediately()
@@ -77,18 +160,77 @@ void Timer::timerWait()
 
 }
 
-// Called when timer stops
-void Timer::timerCallback(union sigval sv)
+/*  Called by the TimerService after reading an expiration of 'fd', or by the Virtual Clock
+ *  An expiration read just before the Timer was re-armed (or cancelled) is stale: the timerfd is armed again
+ *  (or the Timer is no longer armed). A periodic Timer stays armed (its timerfd is always armed)
+ */
+void Timer::expire()
 {
-    const auto self = static_cast<Timer*>(sv.sival_ptr);
-
-    LockGuard lock (self->mutexTimer);
-    self->fired = 1;
-    self->condTimer.condBroadcast();
+    {
+        LockGuard lock (mutexTimer);
+        if (!armed)
+            return;
+        if (period > 0)
+        {
+            if (virtualClock)
+                deadline += period;
+        }
+        else
+        {
+            if (!virtualClock)
+            {
+                itimerspec its{};
+                timerfd_gettime(fd, &its);
+                if (its.it_value.tv_sec != 0 || its.it_value.tv_nsec != 0)
+                    return;
+            }
+            armed = false;
+        }
+        fired = 1;
+        condTimer.condBroadcast();
+    }
+
+    if (expireCallback)
+        expireCallback(expireArg);
 }
 
 int Timer::getTime()
 {
-    timer_gettime(this->timerid, &its);
+    if (virtualClock)
+    {
+        LockGuard lock (mutexTimer);
+        return armed ? static_cast<int>(deadline - virtualClock->now()) : 0;
+    }
+
+    itimerspec its{};
+    timerfd_gettime(fd, &its);
     return its.it_value.tv_sec;
 }
+
+// The timerfd is disarmed: expirations only come from the Virtual Clock
+void Timer::useClock(VirtualClock& clock)
+{
+    LockGuard lock (mutexTimer);
+
+    arm(itimerspec{}, 0);
+
+    if (virtualClock)
+        virtualClock->detach(this);
+    virtualClock = &clock;
+    virtualClock->attach(this);
+    armed = false;
+    period = 0;
+}
+
+void Timer::onExpire(void (*callback)(void*), void* arg)
+{
+    LockGuard lock (mutexTimer);
+    expireCallback = callback;
+    expireArg = arg;
+}
+
+bool Timer::hasFired()
+{
+    LockGuard lock (mutexTimer);
+    return fired;
+}
@@ -0,0 +1,101 @@
+#include "EmergencyArbiter.hpp"
+
+#include <algorithm>
+#include <bit>
+
+bool EmergencyArbiter::arrive(const std::string& id, const int origin, const int destination, const int priority)
+{
+    const auto [it, inserted] = vehicles.try_emplace(id, EmergencyVehicle{id, origin, destination, priority, arrivals});
+    if (inserted)
+    {
+        ++arrivals;
+        return true;
+    }
+
+    // Refreshed: keeps its place among the EVs of its priority
+    EmergencyVehicle& ev = it->second;
+    if (ev.origin == origin && ev.destination == destination && ev.priority == priority)
+        return false;
+    ev.origin = origin;
+    ev.destination = destination;
+    ev.priority = priority;
+    return true;
+}
+
+bool EmergencyArbiter::leave(const std::string& id)
+{
+    return vehicles.erase(id) > 0;
+}
+
+void EmergencyArbiter::clear()
+{
+    vehicles.clear();
+}
+
+const EmergencyVehicle* EmergencyArbiter::find(const std::string& id) const
+{
+    const auto it = vehicles.find(id);
+    return it != vehicles.end() ? &it->second : nullptr;
+}
+
+std::vector<const EmergencyVehicle*> EmergencyArbiter::ranked() const
+{
+    std::vector<const EmergencyVehicle*> order;
+    order.reserve(vehicles.size());
+    for (const auto& [id, ev] : vehicles)
+        order.push_back(&ev);
+
+    std::ranges::sort(order, [](const EmergencyVehicle* a, const EmergencyVehicle* b)
+    {
+        return a->priority != b->priority ? a->priority > b->priority : a->arrival < b->arrival;
+    });
+    return order;
+}
+
+int EmergencyArbiter::preempt(const ConfigurationIndex& index, const int current,
+    std::vector<const EmergencyVehicle*>* merged) const
+{
+    const size_t words = (index.size() + LOCATION_WORD_BITS - 1) / LOCATION_WORD_BITS;
+    std::vector<uint64_t> candidates(words, ~uint64_t{0});     // Configurations serving every origin taken
+    const EmergencyVehicle* first = nullptr;
+    if (merged)
+        merged->clear();
+
+    for (const EmergencyVehicle* ev : ranked())
+    {
+        if (ev->origin < 0 || static_cast<size_t>(ev->origin) >= index.numLocations())
+            continue;
+
+        const uint64_t* row = index.row(ev->origin);
+        uint64_t any = 0;
+        for (size_t i = 0; i < words; ++i)
+            any |= candidates[i] & row[i];
+        if (!any)
+            continue;       // not with the EVs ahead of it (or not a TSEM): waits
+
+        for (size_t i = 0; i < words; ++i)
+            candidates[i] &= row[i];
+        if (!first)
+            first = ev;
+        if (merged)
+            merged->push_back(ev);
+    }
+
+    if (!first)
+        return -1;
+
+    const auto candidate = [&candidates, &index](const int config)
+    {
+        return config >= 0 && static_cast<size_t>(config) < index.size() &&
+               (candidates[config / LOCATION_WORD_BITS] >> (config % LOCATION_WORD_BITS) & 1);
+    };
+    if (candidate(current))
+        return current;
+    if (const int config = index.emergency(first->origin, first->destination); candidate(config))
+        return config;
+
+    for (size_t i = 0; i < words; ++i)
+        if (candidates[i])
+            return static_cast<int>(i * LOCATION_WORD_BITS) + std::countr_zero(candidates[i]);
+    return -1;
+}
@@ -0,0 +1,53 @@
+#ifndef TRAFFICCONTROLSYSTEM_EMERGENCYARBITER_HPP
+#define TRAFFICCONTROLSYSTEM_EMERGENCYARBITER_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../ConflictGraph/ConfigurationIndex.hpp"
+
+/*
+ *  Emergency Vehicles active at the Intersection, keyed by sender_id (DDS EmergencyMSG)
+ *   *  An EV publishes its message periodically: every sample refreshes it; it leaves when its publisher is gone
+ *   *  Ranked by priority (higher priority_level first), then by arrival
+ *   *  Preemption: one Configuration for as many EVs as possible - taken in rank order, an EV joins when some
+ *      Configuration serves its origin together with the origins already taken (ConfigurationIndex bitmaps).
+ *      The others wait for the EVs ahead of them to leave
+ *  Only used by the TCS thread (not thread-safe)
+ */
+
+struct EmergencyVehicle
+{
+    std::string id;         // sender_id (license plate)
+    int origin;             // Location it comes from (a TSEM)
+    int destination;
+    int priority;
+    uint64_t arrival;       // order of arrival
+};
+
+class EmergencyArbiter
+{
+    std::unordered_map<std::string, EmergencyVehicle> vehicles;
+    uint64_t arrivals = 0;
+
+public:
+    // New EV, or one whose origin/destination/priority changed: true (the preemption may change)
+    bool arrive(const std::string& id, int origin, int destination, int priority);
+    bool leave(const std::string& id);      // true if it was active
+    void clear();
+
+    [[nodiscard]] bool empty() const { return vehicles.empty(); }
+    [[nodiscard]] size_t size() const { return vehicles.size(); }
+    [[nodiscard]] const EmergencyVehicle* find(const std::string& id) const;
+    [[nodiscard]] std::vector<const EmergencyVehicle*> ranked() const;
+
+    /*  Configuration serving the merged EVs (in rank order, in 'merged' if given); -1 if none can be served
+     *      'current' is kept if it serves them; otherwise, the highest ranked EV's precomputed emergency
+     *      Configuration, or the lowest serving them all
+     */
+    int preempt(const ConfigurationIndex& index, int current, std::vector<const EmergencyVehicle*>* merged = nullptr) const;
+};
+
+#endif //TRAFFICCONTROLSYSTEM_EMERGENCYARBITER_HPP
@@ -1,13 +1,53 @@
 #include "../GPIOHandling/rasp_gpio.hpp"
+#include <errno.h>
 #include <gpiod.h>
+#include <pthread.h>
 #include <stdio.h>
 
 #define DEFAULT_CHIP "gpiochip0"
 
+#define GROUP_LINES 64      // lines a rasp_gpio_mask can address
+
 static struct gpiod_chip *chip = NULL;
 static struct gpiod_line *lines[128] = {0};
 
+static uint64_t outputs = 0;            // value last driven on lines 0..63 (bit n = line n)
+static uint64_t group = 0;              // lines requested together
+static struct gpiod_line_bulk groupBulk;
+static int groupRequested = 0;          // the group is requested once (rasp_gpio_group_output)
+
+/*
+ * Every access to the lines, 'outputs' and the group: the phase machine, the flash (TimerService thread) and the
+ * Semaphores commit from different threads. Recursive: rasp_gpio_set/clear commit, and so may a rasp_gpio_lock() owner
+ */
+static pthread_mutex_t gpioMutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+struct GpioGuard {
+    GpioGuard() { pthread_mutex_lock(&gpioMutex); }
+    ~GpioGuard() { pthread_mutex_unlock(&gpioMutex); }
+    GpioGuard(const GpioGuard&) = delete;
+    GpioGuard& operator=(const GpioGuard&) = delete;
+};
+
+void rasp_gpio_lock(void) {
+    pthread_mutex_lock(&gpioMutex);
+}
+
+void rasp_gpio_unlock(void) {
+    pthread_mutex_unlock(&gpioMutex);
+}
+
+static void track(const int line, const int value) {
+    if (line >= 0 && line < GROUP_LINES)
+        outputs = value ? outputs | (UINT64_C(1) << line) : outputs & ~(UINT64_C(1) << line);
+}
+
+static int inGroup(const int line) {
+    return line >= 0 && line < GROUP_LINES && (group >> line & 1);
+}
+
 int set_output_mode(const int line_offset) {
+    GpioGuard guard;
     if (!chip) chip = gpiod_chip_open_by_name(DEFAULT_CHIP);
     if (!chip) return -1;
 
@@ -23,6 +63,7 @@ int set_output_mode(const int line_offset) {
 
 
 int set_input_mode(const int line_offset) {
+    GpioGuard guard;
     if (!chip) chip = gpiod_chip_open_by_name(DEFAULT_CHIP);
     if (!chip) return -1;
 
@@ -36,19 +77,35 @@ int set_input_mode(const int line_offset) {
     return 0;
 }
 
+/*
+ * A line of the group can't be set alone: the request drives all its lines at once
+ */
 int rasp_gpio_set(const int line) {
+    GpioGuard guard;
+    if (inGroup(line))
+        return rasp_gpio_commit(rasp_gpio_mask{UINT64_C(1) << line, 0});
+    track(line, 1);
     return gpiod_line_set_value(lines[line], 1);
 }
 
 int rasp_gpio_clear(const int line) {
+    GpioGuard guard;
+    if (inGroup(line))
+        return rasp_gpio_commit(rasp_gpio_mask{0, UINT64_C(1) << line});
+    track(line, 0);
     return gpiod_line_set_value(lines[line], 0);
 }
 
 void rasp_gpio_release(const int line) {
-    return gpiod_line_release(lines[line]);
+    GpioGuard guard;
+    if (inGroup(line))
+        return;     // released with the group
+    gpiod_line_release(lines[line]);
+    lines[line] = NULL;
 }
 
 int rasp_gpio_read(const int line) {
+    GpioGuard guard;
     return gpiod_line_get_value(lines[line]);
 }
 
@@ -69,4 +126,97 @@ int rasp_gpio_reqInt(const int line_offset, void* data, int(*callback)(int, unsi
         data);
 
     return ret;
-}
\ No newline at end of file
+}
+
+/*
+ * Lines of a failed group request back to one request per line (the ones requested alone before), at their value
+ */
+static void restoreSingle(const uint64_t requested) {
+    for (int line = 0; line < GROUP_LINES; ++line) {
+        if ((requested >> line & 1) && gpiod_line_request_output(lines[line], "rasp_gpio", outputs >> line & 1) < 0)
+            lines[line] = NULL;
+    }
+}
+
+/*
+ * Once: a line request can't be extended, and re-requesting would release lines a commit may be driving
+ * Every line is retrieved before any is released: a failure leaves the lines as they were, and may be retried
+ */
+int rasp_gpio_group_output(const uint64_t target) {
+    GpioGuard guard;
+    if (groupRequested)
+        return -4;
+    if (!chip) chip = gpiod_chip_open_by_name(DEFAULT_CHIP);
+    if (!chip) return -1;
+
+    struct gpiod_line* resolved[GROUP_LINES] = {0};
+    for (int line = 0; line < GROUP_LINES; ++line) {
+        if (!(target >> line & 1))
+            continue;
+        resolved[line] = lines[line] ? lines[line] : gpiod_chip_get_line(chip, line);
+        if (!resolved[line]) return -2;
+    }
+
+    // Lines requested alone: released and requested again in the group, with every line at its current value
+    uint64_t requested = 0;
+    for (int line = 0; line < GROUP_LINES; ++line) {
+        if ((target >> line & 1) && lines[line] && gpiod_line_is_requested(lines[line])) {
+            gpiod_line_release(lines[line]);
+            requested |= UINT64_C(1) << line;
+        }
+    }
+
+    int values[GROUP_LINES];
+    gpiod_line_bulk_init(&groupBulk);
+    for (int line = 0; line < GROUP_LINES; ++line) {
+        if (!(target >> line & 1))
+            continue;
+        values[gpiod_line_bulk_num_lines(&groupBulk)] = outputs >> line & 1;
+        gpiod_line_bulk_add(&groupBulk, resolved[line]);
+    }
+
+    if (target && gpiod_line_request_bulk_output(&groupBulk, "rasp_gpio", values) < 0) {
+        restoreSingle(requested);
+        return -3;
+    }
+
+    for (int line = 0; line < GROUP_LINES; ++line) {
+        if (target >> line & 1)
+            lines[line] = resolved[line];
+    }
+    group = target;
+    groupRequested = 1;
+    return 0;
+}
+
+int rasp_gpio_commit(const rasp_gpio_mask mask) {
+    GpioGuard guard;
+    outputs = (outputs & ~mask.clear) | mask.set;
+
+    int ret = 0;
+    if (group & (mask.set | mask.clear)) {
+        int values[GROUP_LINES];
+        int i = 0;
+        for (int line = 0; line < GROUP_LINES; ++line) {
+            if (group >> line & 1)
+                values[i++] = outputs >> line & 1;
+        }
+        ret = gpiod_line_set_value_bulk(&groupBulk, values);
+    }
+
+    // Lines outside the group
+    const uint64_t single = (mask.set | mask.clear) & ~group;
+    for (int line = 0; line < GROUP_LINES; ++line) {
+        if ((single >> line & 1) && lines[line] && gpiod_line_set_value(lines[line], outputs >> line & 1) < 0)
+            ret = -1;
+    }
+    return ret;
+}
+
+int rasp_gpio_try_commit(const rasp_gpio_mask mask) {
+    if (pthread_mutex_trylock(&gpioMutex) != 0)
+        return -EBUSY;
+    const int ret = rasp_gpio_commit(mask);
+    pthread_mutex_unlock(&gpioMutex);
+    return ret;
+}
@@ -2,6 +2,16 @@
 #ifndef TESTPIN_OUT_RASP_GPIO_HPP
 #define TESTPIN_OUT_RASP_GPIO_HPP
 
+#include <stdint.h>
+
+/**
+ * @brief Lines driven in a single light switching step (bit n = GPIO line n).
+ */
+typedef struct
+{
+    uint64_t set;       // lines driven high
+    uint64_t clear;     // lines driven low
+} rasp_gpio_mask;
 
 /**
  * @brief Ensures that a GPIO line is initialized and ready for output.
@@ -67,4 +77,54 @@ int rasp_gpio_read(int line);
 
 int rasp_gpio_reqInt(int line_offset, void* data,  int(*callback)(int, unsigned int, const struct timespec*, void*));
 
+/**
+ * @brief Requests output lines together (one line request), so that rasp_gpio_commit() drives them in a single call.
+ *
+ * Called once, on set up, before any commit: the group never changes afterwards. Lines requested alone
+ * (set_output_mode) are released and requested again in the group, keeping their current value.
+ *
+ * @param lines Output lines of the group (bit n = GPIO line n).
+ * @return 0 on success,
+ *        -1 if the chip couldn't be opened,
+ *        -2 if a line couldn't be retrieved,
+ *        -3 if the lines couldn't be requested for output (the group is left empty: lines driven one by one),
+ *        -4 if the group was already requested.
+ *        On -1, -2 and -3 the lines are left as they were (requested alone), and the call may be retried.
+ */
+int rasp_gpio_group_output(uint64_t lines);
+
+/**
+ * @brief Applies every set/clear of a light switching step at once (set wins over clear on the same line).
+ *
+ * Lines in the output group change in a single bulk call (one ioctl); lines outside it are driven one by one.
+ *
+ * @param mask Lines driven high and low.
+ * @return 0 on success, negative value on failure.
+ */
+int rasp_gpio_commit(rasp_gpio_mask mask);
+
+/**
+ * @brief rasp_gpio_commit() that never waits for the GPIO lock.
+ *
+ * For a caller that must not block on another thread's commit (the failure flash, on the TimerService thread):
+ * nothing is driven while another thread holds the lock.
+ *
+ * @param mask Lines driven high and low.
+ * @return 0 on success, -EBUSY if another thread holds the GPIO lock, other negative value on failure.
+ */
+int rasp_gpio_try_commit(rasp_gpio_mask mask);
+
+/**
+ * @brief Holds the GPIO lock: no other thread drives a line until rasp_gpio_unlock().
+ *
+ * Every function above takes it on its own; a caller takes it to keep a check and the commits that depend on it
+ * together (e.g. the phase machine commits a step only while the failure flash has not started). Recursive.
+ */
+void rasp_gpio_lock(void);
+
+/**
+ * @brief Releases the GPIO lock taken by rasp_gpio_lock().
+ */
+void rasp_gpio_unlock(void);
+
 #endif //TESTPIN_OUT_RASP_GPIO_HPP
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include "GreenTime.hpp"
+
+#include <algorithm>
+
+/*--- Fixed timing ---------------------------------------------------------------------------------------------------*/
+double FixedGreenTime::phaseStart(const PhaseDemand& demand, const double start)
+{
+    greenStart = start;
+    greenEnd = start + demand.configuredTime;
+    return demand.configuredTime;
+}
+
+// A button pressed on a waiting crosswalk shortens the green, if there is still a long time left
+double FixedGreenTime::call(const PhaseCall call, const bool served, const double now)
+{
+    if (call != PhaseCall::BUTTON || served || !isGreen(now))
+        return -1;
+
+    const double left = greenEnd - now;
+    if (left <= FIXED_CALL_MIN)
+        return -1;
+
+    greenEnd -= FIXED_CALL_REDUCE;
+    return left - FIXED_CALL_REDUCE;
+}
+
+PhaseEnd FixedGreenTime::phaseEnd() const
+{
+    return PhaseEnd::FIXED;
+}
+
+/*--- Actuated timing ------------------------------------------------------------------------------------------------*/
+ActuatedGreenTime::ActuatedGreenTime(const double minGreen, const double maxGreen, const double passage):
+    minGreen(minGreen), maxGreen(std::max(minGreen, maxGreen)), passage(passage) {}
+
+/*  Initial green: enough for the queued vehicles and for the requested crossings
+ *      (a phase without demand gets the min green)
+ */
+double ActuatedGreenTime::phaseStart(const PhaseDemand& demand, const double start)
+{
+    double green = minGreen + demand.vehicles * GREEN_PER_VEHICLE;
+    if (demand.buttons > 0)
+        green = std::max(green, GREEN_WALK);
+    if (demand.cards > 0)
+        green = std::max(green, GREEN_CARD_WALK);
+    green = std::clamp(green, minGreen, maxGreen);
+
+    greenStart = start;
+    greenEnd = start + green;
+    return green;
+}
+
+/*  Served calls extend the green up to the max green:
+ *      vehicle: by the passage time (gap-out if no other vehicle comes in the meantime)
+ *      card: until the slower crossing is over
+ *  Other calls wait for their phase (see PhaseDemand)
+ */
+double ActuatedGreenTime::call(const PhaseCall call, const bool served, const double now)
+{
+    if (!served || !isGreen(now))
+        return -1;
+
+    double end;
+    switch (call)
+    {
+        case PhaseCall::VEHICLE: end = now + passage; break;
+        case PhaseCall::CARD: end = now + GREEN_CARD_WALK; break;
+        default: return -1;     // the crosswalk is already green
+    }
+
+    end = std::min(end, greenStart + maxGreen);
+    if (end <= greenEnd)
+        return -1;
+
+    greenEnd = end;
+    return greenEnd - now;
+}
+
+PhaseEnd ActuatedGreenTime::phaseEnd() const
+{
+    return greenEnd >= greenStart + maxGreen ? PhaseEnd::MAX_OUT : PhaseEnd::GAP_OUT;
+}
@@ -0,0 +1,94 @@
+#ifndef TRAFFICCONTROLSYSTEM_GREENTIME_HPP
+#define TRAFFICCONTROLSYSTEM_GREENTIME_HPP
+
+/*
+ *  Green time of the phases run in Normal operation: computed when a phase is organized (between
+ *  organizeNextConfiguration() and switchLightQueue) and moved by the calls received while it is green
+ *   *  FixedGreenTime: the Configuration's time (DEFAULT_SWITCHING_TIME, extended by RFID cards); a button
+ *      on a waiting crosswalk shortens a long green once
+ *   *  ActuatedGreenTime: initial green from the demand waiting for the phase, within [min, max] green;
+ *      each vehicle detected on a served approach extends it by the passage time (gap-out: no vehicle within
+ *      the passage time ends it), never beyond the max green (max-out)
+ *
+ *   Times in seconds; instants on the monotonic clock. Only used by the TCS thread (not thread-safe)
+ */
+
+/*--- Actuated timing ------------------------------------------------------------------------------------------------*/
+#define GREEN_MIN 5.0           // s
+#define GREEN_MAX 30.0          // s
+#define GREEN_PASSAGE 2.5       // s, extension per vehicle detected on a served approach
+#define GREEN_PER_VEHICLE 2.0   // s, per vehicle queued before the phase starts (headway)
+#define GREEN_WALK 8.0          // s, pedestrian crossing requested by button
+#define GREEN_CARD_WALK 15.0    // s, pedestrian crossing requested by an RFID card (slower pedestrians)
+
+/*--- Fixed timing ---------------------------------------------------------------------------------------------------*/
+#define FIXED_CALL_MIN 10.0     // s, only greens with more time left are shortened
+#define FIXED_CALL_REDUCE 5.0   // s
+
+// Demand waiting for a phase when it is organized
+struct PhaseDemand
+{
+    int buttons = 0;            // button presses at its crosswalks since they last got green
+    int cards = 0;              // validated RFID cards at its crosswalks
+    int vehicles = 0;           // vehicles detected at its TSEMs
+    double configuredTime = 0;  // Configuration's time
+};
+
+enum class PhaseCall
+{
+    BUTTON,
+    CARD,
+    VEHICLE
+};
+
+enum class PhaseEnd
+{
+    FIXED,
+    GAP_OUT,
+    MAX_OUT
+};
+
+/*--- STRATEGY PATTERN INTERFACE -------------------------------------------------------------------------------------*/
+class I_GreenTime
+{
+protected:
+    double greenStart = 0;
+    double greenEnd = 0;
+
+    [[nodiscard]] bool isGreen(const double now) const { return now >= greenStart && now < greenEnd; }
+
+public:
+    virtual ~I_GreenTime() = default;
+
+    // Phase organized, its green starts at 'start': returns its green time
+    virtual double phaseStart(const PhaseDemand& demand, double start) = 0;
+    // Call at 'now' (served: at a Location of the phase): returns the green time left if the phase end moved,
+    // < 0 otherwise
+    virtual double call(PhaseCall call, bool served, double now) = 0;
+    [[nodiscard]] virtual PhaseEnd phaseEnd() const = 0;
+};
+
+/*--- STRATEGY PATTERN IMPLEMENTATIONS -------------------------------------------------------------------------------*/
+class FixedGreenTime : public I_GreenTime
+{
+public:
+    double phaseStart(const PhaseDemand& demand, double start) override;
+    double call(PhaseCall call, bool served, double now) override;
+    [[nodiscard]] PhaseEnd phaseEnd() const override;
+};
+
+class ActuatedGreenTime : public I_GreenTime
+{
+    double minGreen;
+    double maxGreen;
+    double passage;
+
+public:
+    explicit ActuatedGreenTime(double minGreen = GREEN_MIN, double maxGreen = GREEN_MAX, double passage = GREEN_PASSAGE);
+
+    double phaseStart(const PhaseDemand& demand, double start) override;
+    double call(PhaseCall call, bool served, double now) override;
+    [[nodiscard]] PhaseEnd phaseEnd() const override;
+};
+
+#endif //TRAFFICCONTROLSYSTEM_GREENTIME_HPP
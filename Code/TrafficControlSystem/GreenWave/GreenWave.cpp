@@ -0,0 +1,55 @@
+#include "GreenWave.hpp"
+
+#include <cmath>
+#include <utility>
+
+void GreenWave::coordinate(const int corridor, std::string upstreamName, const double upstreamOffset)
+{
+    location = corridor;
+    upstream = std::move(upstreamName);
+    offset = upstreamOffset;
+    upstreamStart = -1;
+    upstreamCycle = 0;
+    heard = -1;
+}
+
+bool GreenWave::following(const double now) const
+{
+    return coordinated() && !upstream.empty() && upstreamCycle > 0 &&
+           now - heard <= GREEN_WAVE_STALE_CYCLES * upstreamCycle;
+}
+
+GreenWaveEvent GreenWave::organized(const std::string& self, const int phase, const double start, const double now)
+{
+    if (phase == 0)
+    {
+        if (cycleStart >= 0)
+            cycle = start - cycleStart;
+        cycleStart = start;
+    }
+    if (cycleStart < 0)
+        return {self, -1};      // no reference yet
+    return {self, phase, cycle, now - cycleStart};
+}
+
+void GreenWave::received(const GreenWaveEvent& report, const double now)
+{
+    if (upstream.empty() || report.sender != upstream || report.phase < 0)
+        return;
+
+    upstreamStart = now - report.offset;
+    if (report.cycle > 0)
+        upstreamCycle = report.cycle;
+    heard = now;
+}
+
+double GreenWave::hold(const double green, const double next, const double minGreen, const double now) const
+{
+    if (!following(now))
+        return green;
+
+    // > 0: late on the nearest upstream start + offset
+    const double error = std::remainder(next - (upstreamStart + offset), upstreamCycle);
+    const double held = green - error;
+    return held >= minGreen ? held : held + upstreamCycle;
+}
@@ -0,0 +1,64 @@
+#ifndef TRAFFICCONTROLSYSTEM_GREENWAVE_HPP
+#define TRAFFICCONTROLSYSTEM_GREENWAVE_HPP
+
+#include <string>
+
+#include "../Messages/Components/GreenWaveEvent.hpp"
+
+/*
+ *  Green wave along a corridor of Intersections: each coordinated box publishes its cycle (GreenWaveEvent)
+ *  every time it organizes a phase; a follower holds its coordinated green 'offset' seconds after the one of
+ *  its upstream neighbour
+ *   *  Coordinated phase: the first phase of the cycle serving the corridor Location. The cycle chosen by the
+ *      PhaseSequencer is rotated to start with it: a cycle starts with the coordinated green
+ *   *  Reference: the upstream cycle start is taken on the local clock when a report is received (now - offset
+ *      into its cycle) - the boxes share no clock, the DDS latency is the error
+ *   *  Hold: the green of the last phase of the cycle is moved so that the next coordinated green starts at the
+ *      nearest upstream start + offset (modulo the upstream cycle); when that cuts it below the min green, it
+ *      dwells until the following upstream cycle instead
+ *   *  No report for GREEN_WAVE_STALE_CYCLES upstream cycles: isolated operation (the leader only publishes)
+ *
+ *   Times in seconds; instants on the TCS clock. Only used by the TCS thread (not thread-safe)
+ */
+
+#define GREEN_WAVE_TOPIC "GreenWave"
+#define GREEN_WAVE_STALE_CYCLES 3
+
+// Transport of the cycle reports: DDS between boxes (DDSGreenWave), in process in host tests
+class I_GreenWaveLink
+{
+public:
+    virtual ~I_GreenWaveLink() = default;
+    virtual void publish(const GreenWaveEvent& report) = 0;
+};
+
+class GreenWave
+{
+    int location = -1;          // corridor Location: served by the coordinated phase (-1: not coordinated)
+    std::string upstream;       // Intersection followed (empty: leader)
+    double offset = 0;          // s, from its coordinated green to ours
+
+    double cycleStart = -1;     // our last coordinated green (organized)
+    double cycle = 0;
+
+    double upstreamStart = -1;  // its last coordinated green, on our clock
+    double upstreamCycle = 0;
+    double heard = -1;          // last report from upstream
+
+public:
+    void coordinate(int corridor, std::string upstreamName, double upstreamOffset);
+
+    [[nodiscard]] bool coordinated() const { return location >= 0; }
+    [[nodiscard]] int corridor() const { return location; }
+    [[nodiscard]] bool following(double now) const;     // upstream reference still valid
+
+    // Phase 'phase' of our cycle organized at 'now', its green starting at 'start': the report to publish
+    GreenWaveEvent organized(const std::string& self, int phase, double start, double now);
+    // Report received at 'now' (the ones not from upstream are ignored)
+    void received(const GreenWaveEvent& report, double now);
+
+    // Green of the last phase of the cycle, the next coordinated green starting at 'next' if not held
+    [[nodiscard]] double hold(double green, double next, double minGreen, double now) const;
+};
+
+#endif //TRAFFICCONTROLSYSTEM_GREENWAVE_HPP
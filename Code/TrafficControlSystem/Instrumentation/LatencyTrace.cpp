@@ -0,0 +1,252 @@
+#include "LatencyTrace.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define DUMP_WAKE_REPORT 'r'
+#define DUMP_WAKE_STOP 'q'
+
+static const char* stageNames[] = {
+    "event queue", "strategy", "switch queue", "GPIO commit",
+    "timeout -> yellow", "emergency -> yellow", "emergency -> green"
+};
+
+/*--- Histogram ------------------------------------------------------------------------------------------------------*/
+size_t LatencyHistogram::bucketOf(uint64_t ns)
+{
+    constexpr uint64_t limit = (uint64_t{1} << LATENCY_MAX_BITS) - 1;
+    ns = std::min(ns, limit);
+    if (ns < 2 * HALF)
+        return ns;
+
+    const int msb = std::bit_width(ns) - 1;
+    const int shift = msb - LATENCY_PRECISION_BITS + 1;
+    return (shift + 1) * HALF + ((ns >> shift) - HALF);
+}
+
+uint64_t LatencyHistogram::upperBound(const size_t bucket)
+{
+    if (bucket < 2 * HALF)
+        return bucket;
+
+    const size_t q = bucket / HALF;
+    const uint64_t r = bucket % HALF;
+    const size_t shift = q - 1;
+    return ((HALF + r + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(const uint64_t ns)
+{
+    counts[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(ns, std::memory_order_relaxed);
+
+    uint64_t current = max.load(std::memory_order_relaxed);
+    while (ns > current && !max.compare_exchange_weak(current, ns, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto& c : counts)
+        c.store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::count() const
+{
+    return total.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::maximum() const
+{
+    return max.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const
+{
+    const uint64_t n = count();
+    return n ? static_cast<double>(sum.load(std::memory_order_relaxed)) / static_cast<double>(n) : 0.0;
+}
+
+// Read while recording goes on: the buckets may hold a few more samples than 'total'
+uint64_t LatencyHistogram::percentile(const double p) const
+{
+    const uint64_t n = count();
+    if (!n)
+        return 0;
+
+    const auto rank = static_cast<uint64_t>(p * static_cast<double>(n - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKETS; ++bucket)
+    {
+        seen += counts[bucket].load(std::memory_order_relaxed);
+        if (seen >= rank)
+            return std::min(upperBound(bucket), maximum());
+    }
+    return maximum();
+}
+
+/*--- Trace ----------------------------------------------------------------------------------------------------------*/
+int LatencyTrace::wakeFd[2] = {-1, -1};
+
+LatencyTrace::LatencyTrace(): dumpThread(t_dump, CppWrapper::ThreadRole::BACKGROUND, "latency-dump"), listenFd(-1) {}
+
+LatencyTrace::~LatencyTrace()
+{
+    stop();
+}
+
+uint64_t LatencyTrace::now()
+{
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+void LatencyTrace::record(const LatencyStage stage, const uint64_t start, const uint64_t end)
+{
+    histograms[static_cast<size_t>(stage)].record(end > start ? end - start : 0);
+}
+
+const LatencyHistogram& LatencyTrace::histogram(const LatencyStage stage) const
+{
+    return histograms[static_cast<size_t>(stage)];
+}
+
+void LatencyTrace::reset()
+{
+    for (auto& histogram : histograms)
+        histogram.reset();
+}
+
+void LatencyTrace::dump(std::ostream& out) const
+{
+    out << std::left << std::setw(22) << "stage [us]" << std::right << std::setw(12) << "count"
+        << std::setw(12) << "p50" << std::setw(12) << "p99" << std::setw(12) << "p99.9" << std::setw(12) << "max"
+        << "\n" << std::fixed << std::setprecision(1);
+
+    for (size_t i = 0; i < histograms.size(); ++i)
+    {
+        const auto& h = histograms[i];
+        out << std::left << std::setw(22) << stageNames[i] << std::right << std::setw(12) << h.count()
+            << std::setw(12) << h.percentile(0.5) / 1e3 << std::setw(12) << h.percentile(0.99) / 1e3
+            << std::setw(12) << h.percentile(0.999) / 1e3 << std::setw(12) << h.maximum() / 1e3 << "\n";
+    }
+}
+
+// Only async-signal-safe calls: the dump runs on the dump thread
+void LatencyTrace::signalHandler(int)
+{
+    const char wake = DUMP_WAKE_REPORT;
+    if (wakeFd[1] != -1)
+        (void)!write(wakeFd[1], &wake, 1);     // pipe full: a report is already pending
+}
+
+int LatencyTrace::start()
+{
+    if (dumpThread.isRunning)
+        return -EPERM;
+
+    if (pipe2(wakeFd, O_CLOEXEC | O_NONBLOCK) == -1)
+        return -errno;
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd != -1)
+    {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, LATENCY_SOCKET_PATH, sizeof(addr.sun_path) - 1);
+        unlink(LATENCY_SOCKET_PATH);
+        if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1 || listen(listenFd, 4) == -1)
+        {
+            std::cerr << "LatencyTrace: socket " << LATENCY_SOCKET_PATH << " " << strerror(errno) << "\n";
+            close(listenFd);
+            listenFd = -1;      // signal only
+        }
+    }
+
+    if (signal(LATENCY_DUMP_SIGNAL, signalHandler) == SIG_ERR)
+        std::cerr << "LatencyTrace: signal handler not installed\n";
+
+    return dumpThread.run(this);
+}
+
+void LatencyTrace::stop()
+{
+    if (!dumpThread.isRunning)
+        return;
+
+    const char wake = DUMP_WAKE_STOP;
+    if (write(wakeFd[1], &wake, 1) == 1)
+        dumpThread.join();
+
+    signal(LATENCY_DUMP_SIGNAL, SIG_DFL);
+    if (listenFd != -1)
+    {
+        close(listenFd);
+        unlink(LATENCY_SOCKET_PATH);
+        listenFd = -1;
+    }
+    close(wakeFd[0]);
+    close(wakeFd[1]);
+    wakeFd[0] = wakeFd[1] = -1;
+}
+
+void* LatencyTrace::t_dump(void* arg)
+{
+    const auto self = static_cast<LatencyTrace*>(arg);
+    pollfd fds[2] = {{wakeFd[0], POLLIN, 0}, {self->listenFd, POLLIN, 0}};
+    const nfds_t nfds = self->listenFd != -1 ? 2 : 1;
+
+    while (true)
+    {
+        if (poll(fds, nfds, -1) == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            return nullptr;
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            char wake = 0;
+            while (read(wakeFd[0], &wake, 1) == 1)
+            {
+                if (wake == DUMP_WAKE_STOP)
+                    return nullptr;
+                self->dump(std::cerr);
+            }
+        }
+
+        if (nfds > 1 && (fds[1].revents & POLLIN))
+        {
+            const int client = accept4(self->listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client == -1)
+                continue;
+
+            std::ostringstream report;
+            self->dump(report);
+            const std::string text = report.str();
+            for (size_t sent = 0; sent < text.size();)
+            {
+                const ssize_t n = send(client, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0)
+                    break;
+                sent += n;
+            }
+            close(client);
+        }
+    }
+}
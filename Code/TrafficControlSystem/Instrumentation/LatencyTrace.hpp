@@ -0,0 +1,100 @@
+#ifndef TRAFFICCONTROLSYSTEM_LATENCYTRACE_HPP
+#define TRAFFICCONTROLSYSTEM_LATENCYTRACE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+#include "../CppWrapper/CppWrapper.hpp"
+
+/*
+ *  Latency of the event path, stage by stage:
+ *      notify -> eventQueue -> strategy -> switchLightQueue -> t_switchLight -> GPIO commit
+ *   *  Each stage records monotonic timestamps (ns) into its own histogram: lock-free, wait-free recording
+ *      from any thread (one relaxed fetch_add per bucket/count, a CAS loop for the max)
+ *   *  HDR-style buckets: exact up to 2^LATENCY_PRECISION_BITS ns, then 2^(LATENCY_PRECISION_BITS - 1)
+ *      buckets per power of two (relative error < 1.6%); percentiles report the bucket's upper bound
+ *   *  End to end: from the LIGHTS_TIMEOUT / DDS EMERGENCY_START notification until the lights of the new
+ *      phase are driven (yellow step; the green step too, for emergencies)
+ *   *  Report dumped on SIGUSR1 (stderr) or to any client of the local socket LATENCY_SOCKET_PATH:
+ *          socat - UNIX-CONNECT:/tmp/tcs-latency.sock
+ */
+
+#define LATENCY_PRECISION_BITS 7
+#define LATENCY_MAX_BITS 40             // 2^40 ns ~ 18 min: longer latencies are recorded as the maximum bucket
+#define LATENCY_SOCKET_PATH "/tmp/tcs-latency.sock"
+#define LATENCY_DUMP_SIGNAL SIGUSR1
+
+class LatencyHistogram
+{
+    static constexpr uint64_t HALF = uint64_t{1} << (LATENCY_PRECISION_BITS - 1);
+    static constexpr size_t BUCKETS = (LATENCY_MAX_BITS - LATENCY_PRECISION_BITS + 2) * HALF;
+
+    std::array<std::atomic<uint64_t>, BUCKETS> counts{};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> max{0};
+
+public:
+    static size_t bucketOf(uint64_t ns);
+    static uint64_t upperBound(size_t bucket);     // highest value recorded in 'bucket'
+
+    void record(uint64_t ns);
+    void reset();
+
+    [[nodiscard]] uint64_t count() const;
+    [[nodiscard]] uint64_t maximum() const;
+    [[nodiscard]] double mean() const;
+    [[nodiscard]] uint64_t percentile(double p) const;    // p in [0, 1]; 0 if empty
+};
+
+enum class LatencyStage
+{
+    EVENT_QUEUE,            // notify -> consumer
+    STRATEGY,               // strategy handler (StrategyTable)
+    SWITCH_QUEUE,           // queueTransition -> t_switchLight
+    GPIO_COMMIT,            // lights of a phase step driven
+    TIMEOUT_TO_YELLOW,      // LIGHTS_TIMEOUT notified -> yellow step driven
+    EMERGENCY_TO_YELLOW,    // EMERGENCY_START notified -> yellow step driven
+    EMERGENCY_TO_GREEN,     // EMERGENCY_START notified -> green step driven
+    COUNT
+};
+
+// Event a phase switch comes from (end to end stages)
+enum class LatencyCause
+{
+    NONE,
+    TIMEOUT,
+    EMERGENCY
+};
+
+class LatencyTrace
+{
+    std::array<LatencyHistogram, static_cast<size_t>(LatencyStage::COUNT)> histograms;
+
+    CppWrapper::Thread dumpThread;
+    int listenFd;
+    static int wakeFd[2];       // self-pipe: signal handler / stop -> dump thread
+
+    static void* t_dump(void* arg);
+    static void signalHandler(int signum);
+
+public:
+    LatencyTrace();
+    LatencyTrace(const LatencyTrace&) = delete;
+    LatencyTrace& operator=(const LatencyTrace&) = delete;
+    ~LatencyTrace();
+
+    static uint64_t now();      // CLOCK_MONOTONIC, ns
+
+    void record(LatencyStage stage, uint64_t start, uint64_t end);
+    [[nodiscard]] const LatencyHistogram& histogram(LatencyStage stage) const;
+    void reset();
+    void dump(std::ostream& out) const;
+
+    int start();                // dump thread: socket + signal
+    void stop();
+};
+
+#endif //TRAFFICCONTROLSYSTEM_LATENCYTRACE_HPP
@@ -23,7 +23,7 @@ class Mediator
 {
 public:
     virtual ~Mediator() = default;
-    virtual void notify (Component* sender, Event command)=0;
+    virtual int notify (Component* sender, Event command)=0;     // never waits: -EAGAIN if the event was dropped
     //virtual void consume (queue)=0;
     virtual int createComponents (const std::shared_ptr<json>& data_file)=0;
 };
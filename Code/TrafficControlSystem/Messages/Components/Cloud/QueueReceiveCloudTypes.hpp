@@ -12,14 +12,15 @@ using json = nlohmann::json;
  **********************************************************************************************************************/
 namespace rx_cloud
 {
+    // Configuration files: handles in EventPayloads (taken once, by the TCS thread)
     struct TSEM_data
     {
-        std::shared_ptr<json> file;
+        int file;
     };
 
     struct PSEM_data
     {
-        std::shared_ptr<json> file;
+        int file;
     };
 
     struct RFID_Validation
@@ -27,9 +28,25 @@ namespace rx_cloud
         bool isIDvalid = false;
         int location;
     };
+
+    // Live reconfiguration of one Intersection Element (applied by the TCS thread, swapped in at a phase boundary)
+    struct Component_update
+    {
+        enum class Operation
+        {
+            ADD,        // file: a TSEM (object) or a Crosswalk (array with its two PSEMs)
+            MODIFY,     // file: {"location": L, "destinations": [...]}
+            REMOVE      // location: the TSEM, or one of the Crosswalk's PSEMs
+        };
+
+        Operation operation;
+        int location = -1;
+        int file = -1;      // handle in EventPayloads; -1: none (REMOVE)
+    };
 }
 
 // Receive from Cloud Messages Type
-using CloudReceiveType = std::variant<rx_cloud::TSEM_data, rx_cloud::PSEM_data, rx_cloud::RFID_Validation>;
+using CloudReceiveType = std::variant<rx_cloud::TSEM_data, rx_cloud::PSEM_data, rx_cloud::RFID_Validation,
+    rx_cloud::Component_update>;
 
 #endif //TRAFFICCONTROLSYSTEM_QUEUERECEIVECLOUDTYPES_HPP
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define TRAFFICCONTROLSYSTEM_DDSEVENT_HPP
 
 //#include <utility>
+#include "EventText.hpp"
 
 enum class DDS_Event_Qualifier
 {
@@ -12,8 +13,8 @@ enum class DDS_Event_Qualifier
 struct DDSEvent
 {
   DDS_Event_Qualifier qualifier;
-  // The following arguments aren't necessary when qualifier is EMERGENCY_END
-  std::string license_plate = "";
+  // EMERGENCY_FINISH: only license_plate (sender_id of the EV gone; empty: every EV)
+  EventText license_plate;
   int location = -1;
   int direction = -1;
   int priority = -1;
@@ -0,0 +1,10 @@
+#ifndef TRAFFICCONTROLSYSTEM_DETECTOREVENT_HPP
+#define TRAFFICCONTROLSYSTEM_DETECTOREVENT_HPP
+
+// Vehicle detected (loop/presence detector) on the approach of the TSEM at 'location'
+typedef struct
+{
+    int location;
+}VehicleDetectorEvent;
+
+#endif //TRAFFICCONTROLSYSTEM_DETECTOREVENT_HPP
@@ -0,0 +1,44 @@
+#ifndef TRAFFICCONTROLSYSTEM_EVENTTEXT_HPP
+#define TRAFFICCONTROLSYSTEM_EVENTTEXT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#define EVENT_TEXT_SIZE 24      // bytes, terminating NUL included
+
+/*
+ *  Identifier carried by an Event (EV license plate, Intersection name): stored inline, so the Event stays
+ *  trivially copyable - no allocation when it is built, queued or copied
+ *   Converts to std::string where one is needed (Cloud messages, the EV registry)
+ *   A longer identifier is truncated, and two of them sharing a prefix would compare equal: they are
+ *   rejected where they enter the system (fits(): DDS samples, green wave configuration)
+ */
+struct EventText
+{
+    char text[EVENT_TEXT_SIZE] = {};
+
+    EventText() = default;
+    EventText(const std::string_view s)
+    {
+        std::memcpy(text, s.data(), std::min(s.size(), sizeof(text) - 1));
+    }
+    EventText(const std::string& s): EventText(std::string_view(s)) {}
+    EventText(const char* s): EventText(std::string_view(s)) {}
+
+    // true if stored whole: no truncation, no NUL cutting it short
+    [[nodiscard]] static bool fits(const std::string_view s)
+    {
+        return s.size() < EVENT_TEXT_SIZE && s.find('\0') == std::string_view::npos;
+    }
+
+    [[nodiscard]] std::string_view view() const { return {text, strnlen(text, sizeof(text))}; }
+    [[nodiscard]] bool empty() const { return text[0] == '\0'; }
+    operator std::string() const { return std::string(view()); }
+
+    friend bool operator==(const EventText& a, const std::string_view b) { return a.view() == b; }
+};
+
+#endif //TRAFFICCONTROLSYSTEM_EVENTTEXT_HPP
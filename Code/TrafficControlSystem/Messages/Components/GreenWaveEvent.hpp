@@ -0,0 +1,15 @@
+#ifndef TRAFFICCONTROLSYSTEM_GREENWAVEEVENT_HPP
+#define TRAFFICCONTROLSYSTEM_GREENWAVEEVENT_HPP
+
+#include "EventText.hpp"
+
+// Cycle of a coordinated Intersection (DDS GreenWave topic): published each time it organizes a phase
+struct GreenWaveEvent
+{
+  EventText sender;     // Intersection publishing it
+  int phase = -1;       // position of the phase organized in its cycle (0: coordinated phase)
+  double cycle = 0;     // s, length of its last cycle (0: not known yet)
+  double offset = 0;    // s, into its cycle: since its coordinated green started (< 0: it starts in -offset)
+};
+
+#endif //TRAFFICCONTROLSYSTEM_GREENWAVEEVENT_HPP
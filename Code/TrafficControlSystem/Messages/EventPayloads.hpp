@@ -0,0 +1,68 @@
+#ifndef TRAFFICCONTROLSYSTEM_EVENTPAYLOADS_HPP
+#define TRAFFICCONTROLSYSTEM_EVENTPAYLOADS_HPP
+
+#include <array>
+#include <cerrno>
+#include <memory>
+#include <nlohmann/json.hpp>
+
+#include "../CppWrapper/CppWrapper.hpp"
+
+using json = nlohmann::json;
+
+#define EVENT_PAYLOADS 8        // bulky payloads in flight (configuration files: 2 per set up, 1 per component update)
+
+/*
+ *  Side buffer of the bulky Event payloads (Cloud configuration files): the Event only carries a handle, so it
+ *  stays trivially copyable and small on the hot path
+ *   *  put(): any thread (the sender); take(): the thread handling the Event - the slot is freed
+ *   *  release(): the Event was not posted, or not handled in this state - every handle is taken or released
+ *   *  Fixed slots, under a Mutex: payloads are rare (set up), never on the per-event path
+ */
+class EventPayloads
+{
+    CppWrapper::Mutex mutexPayloads;
+    std::array<std::shared_ptr<json>, EVENT_PAYLOADS> slots;
+
+    EventPayloads() = default;
+public:
+    EventPayloads(const EventPayloads&) = delete;
+    EventPayloads& operator=(const EventPayloads&) = delete;
+
+    static EventPayloads& instance()
+    {
+        static EventPayloads payloads;
+        return payloads;
+    }
+
+    // Handle (>= 0), or -EAGAIN if every slot is in flight
+    int put(std::shared_ptr<json> payload)
+    {
+        CppWrapper::LockGuard lock(mutexPayloads);
+        for (size_t i = 0; i < slots.size(); ++i)
+            if (!slots[i])
+            {
+                slots[i] = payload ? std::move(payload) : std::make_shared<json>();
+                return static_cast<int>(i);
+            }
+        return -EAGAIN;
+    }
+
+    // nullptr if 'handle' holds nothing (already taken, or invalid)
+    std::shared_ptr<json> take(const int handle)
+    {
+        if (handle < 0 || handle >= static_cast<int>(slots.size()))
+            return nullptr;
+
+        CppWrapper::LockGuard lock(mutexPayloads);
+        return std::move(slots[handle]);
+    }
+
+    // Frees the slot, unused
+    void release(const int handle)
+    {
+        take(handle);
+    }
+};
+
+#endif //TRAFFICCONTROLSYSTEM_EVENTPAYLOADS_HPP
@@ -1,16 +1,23 @@
 #ifndef TRAFFICCONTROLSYSTEM_EVENTSTYPE_HPP
 #define TRAFFICCONTROLSYSTEM_EVENTSTYPE_HPP
 
+#include <type_traits>
 #include <variant>
 
 #include "Components/PedestrianEvent.hpp"
+#include "Components/DetectorEvent.hpp"
 #include "Components/DDSEvent.hpp"
+#include "Components/GreenWaveEvent.hpp"
 #include "Components/Cloud/QueueReceiveCloudTypes.hpp"
 #include "InternalEvent.hpp"
 
 
 using Event = std::variant<PedestrianButtonEvent, PedestrianRFIDEvent,
-                           DDSEvent, InternalEvent, CloudReceiveType>;
+                           DDSEvent, InternalEvent, CloudReceiveType, VehicleDetectorEvent, GreenWaveEvent>;
        // rx_cloud::TSEM_data, rx_cloud::PSEM_data, rx_cloud::RFID_ID_data>;//
 
+// Hot path: built, queued and copied without allocating (bulky payloads: EventPayloads)
+static_assert(std::is_trivially_copyable_v<Event>, "Event: alternatives must be trivially copyable");
+static_assert(sizeof(Event) <= 64, "Event: must fit in a cache line");
+
 #endif //TRAFFICCONTROLSYSTEM_EVENTSTYPE_HPP
\ No newline at end of file
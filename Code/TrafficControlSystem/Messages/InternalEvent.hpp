@@ -6,7 +6,8 @@ enum class InternalEvent
 {
     NEW_STATE_ENTERED,      /* "on State Change" Generated Event */
     YELLOW_TIMEOUT,
-    LIGHTS_TIMEOUT
+    LIGHTS_TIMEOUT,
+    FAILURE_DETECTED        /* Watchdog tripped: the lights are already flashing */
 };
 
 #endif //TRAFFICCONTROLSYSTEM_INTERNALEVENT_HPP
\ No newline at end of file
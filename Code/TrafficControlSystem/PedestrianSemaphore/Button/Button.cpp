@@ -12,7 +12,7 @@ Button::Button(const int pin, const int threshold, std::atomic<bool>& shutdownRe
     gpio_pin(pin), current_state(false),
     last_state(false), pressCount(0),
     threshold(threshold),
-    threadButton(t_Button),
+    threadButton(t_Button, CppWrapper::ThreadRole::DEVICE, "button"),
     onThreshold(std::move(thresholdCallback)),
     _shutdown_requested(shutdownRequested)
 {
@@ -87,6 +87,10 @@ void  PedestrianSemaphore::switch_nextLight(const TrafficColour colour, const bo
     // Turn on new light
     rasp_gpio_set(lights[colour].gpio_pin);
 
+    commit_nextLight(colour, emergency);
+}
+
+void PedestrianSemaphore::commit_nextLight(const TrafficColour colour, const bool emergency) {
     currentState = colour;
 
     // Set Buzzer function based on state
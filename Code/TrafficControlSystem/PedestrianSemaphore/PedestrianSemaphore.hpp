@@ -59,6 +59,7 @@ class PedestrianSemaphore : public Semaphore, public Component
     void start() const;
     void stop();
     void switch_nextLight (TrafficColour colour,  bool emergency) override;
+    void commit_nextLight (TrafficColour colour,  bool emergency) override;
 /* Helper Methods */
     [[nodiscard]]int getButtonEventCounter() const;
     void resetButtonEventCounter();
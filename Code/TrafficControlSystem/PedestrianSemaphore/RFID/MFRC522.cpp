@@ -13,7 +13,7 @@
  * @brief Constructor with default SPI parameters
  */
 MFRC522::MFRC522(MFRC522callback cardCallback, std::atomic<bool>& shutdownRequested) :
-            mfrc522Thread(t_readRFID), _shutdown_requested(shutdownRequested)
+            mfrc522Thread(t_readRFID, CppWrapper::ThreadRole::DEVICE, "rfid"), _shutdown_requested(shutdownRequested)
 {
     spi_driver = std::make_unique<SPI_DeviceDriver>(SPI_PATH, SPI_MODE, SPI_BITS, SPI_SPEED);
     mfrc522Callback = std::move(cardCallback);
@@ -31,7 +31,7 @@ MFRC522::MFRC522(MFRC522callback cardCallback, std::atomic<bool>& shutdownReques
  */
 MFRC522::MFRC522( MFRC522callback cardCallback, std::atomic<bool>& shutdownRequested,const char* devpath,const int mode,
         const int bits,const int speed) :
-    mfrc522Thread(t_readRFID), _shutdown_requested(shutdownRequested)
+    mfrc522Thread(t_readRFID, CppWrapper::ThreadRole::DEVICE, "rfid"), _shutdown_requested(shutdownRequested)
 {
     spi_driver = std::make_unique<SPI_DeviceDriver>(SPI_PATH, SPI_MODE, SPI_BITS, SPI_SPEED);
     mfrc522Callback = std::move(cardCallback);
@@ -0,0 +1,134 @@
+#ifndef TRAFFICCONTROLSYSTEM_LOOKAHEAD_HPP
+#define TRAFFICCONTROLSYSTEM_LOOKAHEAD_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+#include "../CppWrapper/CppWrapper.hpp"
+
+/*
+ *  Look-ahead pipeline: the next phase transitions, planned (staged) by one thread ahead of time and started by
+ *  another one without waiting for it
+ *   *  Producer (TCS thread): stages entries in order - a chain; invalidates the whole chain when its plan changes
+ *   *  Consumer (t_switchLight): takes the next entry of the chain, if any, when a green ends
+ *   *  Entries are numbered; 'next' is the only number the consumer may start (CAS). Invalidating swaps it out
+ *      (exchange): an entry is either started or dropped, never both - the producer learns which from 'next'
+ *   *  Stale entries stay in the ring until the consumer drains them on its next take()
+ *
+ *   Cost of invalidating: one atomic exchange; the producer restages from its own state
+ *   No allocation: the producer's entries not committed yet (in the ring, or started) fit in 2 * Capacity
+ */
+
+template <typename T, size_t Capacity>
+class LookAhead
+{
+    static constexpr uint64_t NONE = std::numeric_limits<uint64_t>::max();
+
+    struct Entry
+    {
+        T data;
+        uint64_t seq;
+    };
+
+    CppWrapper::SpscRing<Entry, Capacity> ring;
+    std::atomic<uint64_t> next{NONE};   // seq the consumer may start (NONE: chain invalidated)
+
+    // Producer side
+    std::array<Entry, 2 * Capacity> pending;    // staged, not committed yet (started or still valid): FIFO
+    size_t pendingHead = 0;
+    size_t pendingCount = 0;
+    uint64_t nextSeq = 0;           // seq of the next entry staged
+    uint64_t startedUpTo = 0;       // entries below it were started by the consumer
+    bool chainOpen = false;         // 'next' is in the current chain
+
+    void refresh()
+    {
+        if (chainOpen)
+            startedUpTo = next.load(std::memory_order_acquire);
+    }
+
+public:
+    LookAhead() = default;
+    LookAhead(const LookAhead&) = delete;
+    LookAhead& operator=(const LookAhead&) = delete;
+
+    /*--- Producer -----------------------------------------------------------------------------------------------*/
+
+    // Appends to the chain: false if the ring is full (stale entries not drained yet)
+    bool stage(const T& data)
+    {
+        if (ring.space() == 0 || pendingCount == pending.size())
+            return false;
+
+        const Entry entry{data, nextSeq++};
+        if (!chainOpen)         // before the entry is visible: never dropped as stale
+        {
+            next.store(entry.seq, std::memory_order_release);
+            chainOpen = true;
+        }
+        ring.tryPush(entry);
+        pending[(pendingHead + pendingCount++) % pending.size()] = entry;
+        return true;
+    }
+
+    // Staged entries not started yet
+    [[nodiscard]] size_t depth()
+    {
+        refresh();
+        size_t valid = 0;
+        for (size_t i = 0; i < pendingCount; ++i)
+            valid += pending[(pendingHead + i) % pending.size()].seq >= startedUpTo;
+        return valid;
+    }
+
+    // Last entry of the chain (nullptr: empty - the chain starts from the producer's committed state)
+    [[nodiscard]] const T* back() const
+    {
+        return pendingCount ? &pending[(pendingHead + pendingCount - 1) % pending.size()].data : nullptr;
+    }
+
+    // Next entry started by the consumer, in order (the producer commits it)
+    std::optional<T> started()
+    {
+        refresh();
+        if (!pendingCount || pending[pendingHead].seq >= startedUpTo)
+            return std::nullopt;
+
+        T data = pending[pendingHead].data;
+        pendingHead = (pendingHead + 1) % pending.size();
+        --pendingCount;
+        return data;
+    }
+
+    // Drops every entry not started yet: the ones already started are still returned by started()
+    void invalidate()
+    {
+        if (!chainOpen)
+            return;
+        chainOpen = false;
+
+        startedUpTo = next.exchange(NONE, std::memory_order_acq_rel);
+        while (pendingCount && pending[(pendingHead + pendingCount - 1) % pending.size()].seq >= startedUpTo)
+            --pendingCount;
+    }
+
+    /*--- Consumer -----------------------------------------------------------------------------------------------*/
+
+    // Next entry of the chain, started by the caller; stale entries are drained
+    std::optional<T> take()
+    {
+        Entry entry;
+        while (ring.tryPop(entry))
+        {
+            uint64_t expected = entry.seq;
+            if (next.compare_exchange_strong(expected, entry.seq + 1, std::memory_order_acq_rel))
+                return entry.data;
+        }
+        return std::nullopt;
+    }
+};
+
+#endif //TRAFFICCONTROLSYSTEM_LOOKAHEAD_HPP
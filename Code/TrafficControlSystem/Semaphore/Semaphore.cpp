@@ -61,6 +61,11 @@ int  Semaphore::getDuration(const TrafficColour colour) const{
     return lights.at(colour).duration_s;
 }
 
+void Semaphore::commit_nextLight(const TrafficColour colour, bool)
+{
+    currentState = colour;
+}
+
 Semaphore::TrafficColour Semaphore::getCurrentState() const
 {
     return currentState;
@@ -68,4 +73,18 @@ Semaphore::TrafficColour Semaphore::getCurrentState() const
 
 int  Semaphore::getLocation() const{
     return location;
+}
+
+std::vector<int> Semaphore::getPins() const
+{
+    std::vector<int> pins;
+    for (const auto& [SemaphoreColour, LightConfiguration] : lights)
+        pins.push_back(LightConfiguration.gpio_pin);
+    return pins;
+}
+
+int Semaphore::getPin(const TrafficColour colour) const
+{
+    const auto it = lights.find(colour);
+    return it != lights.end() ? it->second.gpio_pin : 0;
 }
\ No newline at end of file
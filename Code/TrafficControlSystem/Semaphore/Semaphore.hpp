@@ -2,6 +2,7 @@
 #define SEMAPHORE_SEMAPHORE_HPP
 
 #include <map>
+#include <vector>
 
 using namespace std;
 
@@ -23,6 +24,8 @@ public:
     void configureLight(TrafficColour colour, int pin/*, int duration_s*/);
     // Switch to a specific color
     virtual void switch_nextLight(TrafficColour colour, bool emergency) = 0;
+    // Lights already driven by a phase commit (rasp_gpio_commit): updates the state only
+    virtual void commit_nextLight(TrafficColour colour, bool emergency);
     // Set duration for a specific color (in seconds)
     int setDuration(TrafficColour colour, int duration_s);
     // Get duration for a specific color
@@ -31,6 +34,10 @@ public:
     [[nodiscard]]TrafficColour getCurrentState() const;
     // Get semaphore Location
     [[nodiscard]]int getLocation() const;
+    // Get the GPIO pins of the configured lights
+    [[nodiscard]]std::vector<int> getPins() const;
+    // Get the GPIO pin of a light (0 if not configured)
+    [[nodiscard]]int getPin(TrafficColour colour) const;
 
 protected:
     int location;
@@ -0,0 +1,178 @@
+#include "DDSGreenWave.hpp"
+#include "GreenWaveMSGPubSubTypes.hpp"
+
+#include <cmath>
+#include <utility>
+
+#include <fastdds/dds/domain/DomainParticipantFactory.hpp>
+#include <fastdds/dds/publisher/DataWriter.hpp>
+#include <fastdds/dds/publisher/Publisher.hpp>
+#include <fastdds/dds/subscriber/DataReader.hpp>
+#include <fastdds/dds/subscriber/SampleInfo.hpp>
+#include <fastdds/dds/subscriber/Subscriber.hpp>
+
+#define GREEN_WAVE_HISTORY 8    // reports kept per reader (one per phase organized by each box)
+
+namespace eprosima::fastdds::examples::greenWaveMSG {
+
+/*---Constructor/Destructor---------------------------------------------------------------------------------------*/
+
+DDSGreenWave::DDSGreenWave(
+        std::atomic<bool>& shutdownRequested,
+        const std::string& topic_name,
+        std::string sender_id,
+        Mediator* mediator)
+    : Component(mediator)
+    , participant_(nullptr)
+    , publisher_(nullptr)
+    , subscriber_(nullptr)
+    , topic_(nullptr)
+    , writer_(nullptr)
+    , reader_(nullptr)
+    , type_(new GreenWaveMSGPubSubType())
+    , _shutdown_requested(shutdownRequested)
+    , sender_id_(std::move(sender_id))
+{
+    auto factory = dds::DomainParticipantFactory::get_instance();
+    participant_ = factory->create_participant_with_default_profile(nullptr, dds::StatusMask::none());
+    if (participant_ == nullptr)
+        throw std::runtime_error("GreenWave: Participant initialization failed");
+
+    type_.register_type(participant_);
+
+    dds::TopicQos topic_qos = dds::TOPIC_QOS_DEFAULT;
+    participant_->get_default_topic_qos(topic_qos);
+    topic_ = participant_->create_topic(topic_name, type_.get_type_name(), topic_qos);
+    if (topic_ == nullptr)
+        throw std::runtime_error("GreenWave: Topic initialization failed");
+
+    // Only the latest reports matter: a late joiner waits for the next phase instead of replaying old cycles
+    publisher_ = participant_->create_publisher(dds::PUBLISHER_QOS_DEFAULT, nullptr, dds::StatusMask::none());
+    if (publisher_ == nullptr)
+        throw std::runtime_error("GreenWave: Publisher initialization failed");
+
+    dds::DataWriterQos writer_qos = dds::DATAWRITER_QOS_DEFAULT;
+    publisher_->get_default_datawriter_qos(writer_qos);
+    writer_qos.reliability().kind = dds::RELIABLE_RELIABILITY_QOS;
+    writer_qos.durability().kind = dds::VOLATILE_DURABILITY_QOS;
+    writer_qos.history().kind = dds::KEEP_LAST_HISTORY_QOS;
+    writer_qos.history().depth = GREEN_WAVE_HISTORY;
+
+    writer_ = publisher_->create_datawriter(topic_, writer_qos, nullptr, dds::StatusMask::none());
+    if (writer_ == nullptr)
+        throw std::runtime_error("GreenWave: DataWriter initialization failed");
+
+    subscriber_ = participant_->create_subscriber(dds::SUBSCRIBER_QOS_DEFAULT, nullptr, dds::StatusMask::none());
+    if (subscriber_ == nullptr)
+        throw std::runtime_error("GreenWave: Subscriber initialization failed");
+
+    dds::DataReaderQos reader_qos = dds::DATAREADER_QOS_DEFAULT;
+    subscriber_->get_default_datareader_qos(reader_qos);
+    reader_qos.reliability().kind = dds::RELIABLE_RELIABILITY_QOS;
+    reader_qos.durability().kind = dds::VOLATILE_DURABILITY_QOS;
+    reader_qos.history().kind = dds::KEEP_LAST_HISTORY_QOS;
+    reader_qos.history().depth = GREEN_WAVE_HISTORY;
+
+    reader_ = subscriber_->create_datareader(topic_, reader_qos, nullptr, dds::StatusMask::all());
+    if (reader_ == nullptr)
+        throw std::runtime_error("GreenWave: DataReader initialization failed");
+
+    wait_set_.attach_condition(reader_->get_statuscondition());
+    wait_set_.attach_condition(terminate_condition_);
+
+    std::cout << "GreenWave Created" << std::endl;
+}
+
+DDSGreenWave::~DDSGreenWave()
+{
+    if (nullptr != participant_)
+    {
+        participant_->delete_contained_entities();
+        dds::DomainParticipantFactory::get_instance()->delete_participant(participant_);
+    }
+}
+
+/*---System Handling----------------------------------------------------------------------------------------------*/
+
+void DDSGreenWave::start()
+{
+    ddsThread = std::make_unique<CppWrapper::Thread>(t_ddsCommunication, CppWrapper::ThreadRole::NETWORK,
+        "dds-greenwave");
+    ddsThread->run(this);
+}
+
+void DDSGreenWave::stop()
+{
+    terminate_condition_.set_trigger_value(true);
+    if (ddsThread)
+        ddsThread->join();
+}
+
+void DDSGreenWave::publish(const GreenWaveEvent& report)
+{
+    GreenWaveMSG msg;
+    msg.sender_id(std::string(report.sender.view()));
+    msg.phase(static_cast<uint8_t>(report.phase));
+    msg.cycle_ms(static_cast<uint32_t>(std::lround(report.cycle * 1e3)));
+    msg.offset_ms(static_cast<int32_t>(std::lround(report.offset * 1e3)));
+
+    if (dds::RETCODE_OK != writer_->write(&msg))
+        EPROSIMA_LOG_ERROR(GREEN_WAVE, "Cycle report not published");
+}
+
+/*---Helper methods-----------------------------------------------------------------------------------------------*/
+
+bool DDSGreenWave::is_stopped() const
+{
+    return _shutdown_requested.load();
+}
+
+void DDSGreenWave::run()
+{
+    while (!is_stopped())
+    {
+        dds::ConditionSeq triggered_conditions;
+        dds::Duration_t timeout {0, 100000000};
+        dds::ReturnCode_t ret_code = wait_set_.wait(triggered_conditions, timeout);
+        if (dds::RETCODE_TIMEOUT == ret_code)
+            continue;
+        if (dds::RETCODE_OK != ret_code)
+        {
+            EPROSIMA_LOG_ERROR(GREEN_WAVE_WAITSET, "Error waiting for conditions");
+            continue;
+        }
+        if (terminate_condition_.get_trigger_value())
+            return;
+
+        if (!reader_->get_status_changes().is_active(dds::StatusMask::data_available()))
+            continue;
+
+        dds::SampleInfo info;
+        while (!is_stopped() && dds::RETCODE_OK == reader_->take_next_sample(&green_wave_msg_, &info))
+        {
+            if (info.instance_state != dds::ALIVE_INSTANCE_STATE || !info.valid_data ||
+                green_wave_msg_.sender_id() == sender_id_ || !EventText::fits(green_wave_msg_.sender_id()))
+                continue;
+
+            GreenWaveEvent event
+            {
+                .sender = green_wave_msg_.sender_id(),
+                .phase = green_wave_msg_.phase(),
+                .cycle = green_wave_msg_.cycle_ms() / 1e3,
+                .offset = green_wave_msg_.offset_ms() / 1e3
+            };
+
+            mediator->notify(this, event);
+        }
+    }
+}
+
+/*---Threading & Synchronization Resources------------------------------------------------------------------------*/
+
+void* DDSGreenWave::t_ddsCommunication(void* arg)
+{
+    static_cast<DDSGreenWave*>(arg)->run();
+    return nullptr;
+}
+
+} // namespace eprosima::fastdds::examples::greenWaveMSG
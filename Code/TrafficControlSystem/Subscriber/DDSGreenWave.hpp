@@ -0,0 +1,62 @@
+#ifndef FASTDDS_DDSGREENWAVE_HPP
+#define FASTDDS_DDSGREENWAVE_HPP
+
+#include <fastdds/dds/core/condition/GuardCondition.hpp>
+#include <fastdds/dds/core/condition/WaitSet.hpp>
+#include <fastdds/dds/domain/DomainParticipant.hpp>
+#include <fastdds/dds/topic/TypeSupport.hpp>
+
+#include "GreenWaveMSG.hpp"
+#include "../Mediator.hpp"
+#include "../CppWrapper/CppWrapper.hpp"
+#include "../GreenWave/GreenWave.hpp"
+
+namespace eprosima::fastdds::examples::greenWaveMSG {
+
+/*  Cycle reports of the coordinated Intersections (GREEN_WAVE_TOPIC), next to the EmergencyAlert topic
+ *      publish(): from the TCS thread; the reports of the other boxes are notified as GreenWaveEvent
+ */
+class DDSGreenWave: public I_GreenWaveLink, public Component
+{
+private:
+    /*---DDS Attributes---------------------------------------------------------------------------------------------------*/
+    GreenWaveMSG green_wave_msg_;
+    dds::DomainParticipant* participant_;
+    dds::Publisher* publisher_;
+    dds::Subscriber* subscriber_;
+    dds::Topic* topic_;
+    dds::DataWriter* writer_;
+    dds::DataReader* reader_;
+    dds::TypeSupport type_;
+    dds::WaitSet wait_set_;
+    std::atomic<bool>& _shutdown_requested;
+    dds::GuardCondition terminate_condition_;
+    std::string sender_id_;     // this Intersection: its own samples are not notified
+
+    /*---Helper methods-----------------------------------------------------------------------------------------------*/
+    [[nodiscard]] bool is_stopped() const;
+    void run();
+
+    /*---Threading & Synchronization Resources------------------------------------------------------------------------*/
+    std::unique_ptr<CppWrapper::Thread> ddsThread;
+    static void* t_ddsCommunication(void* arg);
+
+public:
+    /*---Constructor/Destructor---------------------------------------------------------------------------------------*/
+    DDSGreenWave(std::atomic<bool>& shutdownRequested, const std::string& topic_name, std::string sender_id,
+        Mediator* mediator);
+    ~DDSGreenWave() override;
+
+    /*---Disable Copying (unique ownership)---------------------------------------------------------------------------*/
+    DDSGreenWave(const DDSGreenWave&) = delete;
+    DDSGreenWave& operator=(const DDSGreenWave&) = delete;
+
+    /*---System Handling----------------------------------------------------------------------------------------------*/
+    void start();
+    void stop();
+    void publish(const GreenWaveEvent& report) override;
+};
+
+} // namespace eprosima::fastdds::examples::greenWaveMSG
+
+#endif // FASTDDS_DDSGREENWAVE_HPP
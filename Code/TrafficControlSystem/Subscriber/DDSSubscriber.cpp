@@ -83,7 +83,8 @@ DDSSubscriber::~DDSSubscriber()
 
 void DDSSubscriber::start()
 {
-    ddsThread = std::make_unique<CppWrapper::Thread>(t_ddsCommunication);
+    ddsThread = std::make_unique<CppWrapper::Thread>(t_ddsCommunication, CppWrapper::ThreadRole::NETWORK,
+        "dds-emergency");
     ddsThread->run(this);
 }
 
@@ -130,12 +131,19 @@ void DDSSubscriber::run()
                     else if (status_.current_count_change == -1)
                     {
                         std::cout << "Subscriber unmatched." << std::endl;
-                        DDSEvent event_EM_Stop
+
+                        // Only the EV of that publication is gone (others may still be publishing)
+                        if (const auto sender = senders_.find(status_.last_publication_handle); sender != senders_.end())
                         {
-                           .qualifier = DDS_Event_Qualifier::EMERGENCY_FINISH
-                        };
+                            DDSEvent event_EM_Stop
+                            {
+                               .qualifier = DDS_Event_Qualifier::EMERGENCY_FINISH,
+                               .license_plate = sender->second
+                            };
+                            senders_.erase(sender);
 
-                        mediator->notify(this, event_EM_Stop);
+                            mediator->notify(this, event_EM_Stop);
+                        }
 
                     }
                     else
@@ -153,7 +161,15 @@ void DDSSubscriber::run()
                     {
                         if ((info.instance_state == dds::ALIVE_INSTANCE_STATE) && info.valid_data)
                         {
+                            // sender_id is the EV key: a truncated one could merge (or finish) another EV
+                            if (!EventText::fits(emergency_msg_.sender_id()))
+                            {
+                                std::cerr << "EV sample dropped: sender_id longer than "
+                                          << EVENT_TEXT_SIZE - 1 << " bytes" << std::endl;
+                                continue;
+                            }
                             received_samples_++;
+                            senders_[info.publication_handle] = emergency_msg_.sender_id();
 
                             std::cout << "Warning message received: " << emergency_msg_.sender_id()
                               << " Origin= " << static_cast<int>(emergency_msg_.origin())
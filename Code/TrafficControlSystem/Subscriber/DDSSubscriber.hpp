@@ -2,6 +2,9 @@
 #ifndef FASTDDS_DDSSUBSCRIBER_HPP
 #define FASTDDS_DDSSUBSCRIBER_HPP
 
+#include <map>
+
+#include <fastdds/dds/common/InstanceHandle.hpp>
 #include <fastdds/dds/core/condition/GuardCondition.hpp>
 #include <fastdds/dds/core/condition/WaitSet.hpp>
 #include <fastdds/dds/domain/DomainParticipant.hpp>
@@ -29,6 +32,7 @@ private:
     uint16_t received_samples_;
     std::atomic<bool>& _shutdown_requested;
     dds::GuardCondition terminate_condition_;
+    std::map<dds::InstanceHandle_t, std::string> senders_;  // publication (DataWriter) -> sender_id of its EV
 
     /*---Helper methods-----------------------------------------------------------------------------------------------*/
     [[nodiscard]] bool is_stopped() const;
@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../../ConflictGraph/ConflictGraph.hpp"
+#include "../../ConflictGraph/ConfigurationEngine.hpp"
+
+/* BENCHMARK
+ *  - Configuration search (backtracking) over synthetic intersections with 16 to 256 locations
+ *  - Legacy: std::vector<std::vector<bool>> matrix, bit-by-bit candidate filtering and maximality checks
+ *  - Packed: ConflictGraph 64-bit word rows, AND/ANDN/popcount candidate filtering and maximality checks
+ *  - Bron-Kerbosch: ConfigurationEngine w/ pivoting on the packed rows, visits maximal sets only
+ *  - Parallel: Bron-Kerbosch over 2 and 4 workers, on two adjacent junctions planned as one Conflict Graph
+ *
+ *  Runs on the host (no GPIO/Cloud/DDS required):
+ *      g++ -std=c++20 -O2 Test/Benchmark/ConflictGraphBenchmark.cpp ConflictGraph/ConflictGraph.cpp \
+ *          ConflictGraph/ConfigurationEngine.cpp CppWrapper/Thread_CppWrapper.cpp CppWrapper/Executor_CppWrapper.cpp \
+ *          CppWrapper/Mutex_CppWrapper.cpp -lpthread
+ */
+
+#define BENCH_REPETITIONS 5
+#define BENCH_SEED 2024
+
+using Clock = std::chrono::steady_clock;
+
+struct SyntheticIntersection
+{
+    size_t locations;
+    std::vector<std::pair<int, int>> conflicts;
+    std::vector<int> vertices;
+};
+
+/*  Synthetic intersection with N locations
+ *   *  Pairs of consecutive locations (every 8th) form a crosswalk: both sides share the same conflicts
+ *   *  Every other movement crosses most of the remaining movements, as in a saturated junction:
+ *      each pair conflicts with probability 1 - COMPATIBLE_MOVEMENTS/N
+ *      (keeps the number of compatible sets - and the legacy run time - bounded as N grows)
+ *   *  Sparse intersections (conflict probability 0.5) show the cost of exploring non-maximal sets
+ */
+#define COMPATIBLE_MOVEMENTS 6.0
+
+static SyntheticIntersection makeIntersection(const int n, const double conflictProbability, std::mt19937& rng)
+{
+    SyntheticIntersection in{static_cast<size_t>(n), {}, {}};
+    std::bernoulli_distribution conflict(conflictProbability);
+
+    // Crosswalk side B mirrors side A, so only side A draws its conflicts
+    auto mirror = [](const int loc) { return (loc % 8 == 7) ? loc - 1 : loc; };
+
+    for (int a = 0; a < n; ++a)
+    {
+        in.vertices.push_back(a);
+        if (mirror(a) != a)
+            continue;
+        for (int b = a + 1; b < n; ++b)
+        {
+            if (mirror(b) != b)
+                continue;
+            if (conflict(rng))
+            {
+                in.conflicts.emplace_back(a, b);
+                if (a % 8 == 6 && a + 1 < n) in.conflicts.emplace_back(a + 1, b);
+                if (b % 8 == 6 && b + 1 < n) in.conflicts.emplace_back(a, b + 1);
+                if (a % 8 == 6 && a + 1 < n && b % 8 == 6 && b + 1 < n) in.conflicts.emplace_back(a + 1, b + 1);
+            }
+        }
+    }
+    return in;
+}
+
+/*--- Legacy implementation ------------------------------------------------------------------------------------------*/
+struct LegacySearch
+{
+    std::vector<std::vector<bool>> conflictGraph;
+    std::vector<int> vertices;
+    size_t found = 0;
+
+    void backtrack(std::vector<int>& current, std::vector<int>& candidates)
+    {
+        if (candidates.empty()) {
+            if (!current.empty()) {
+                bool maximal = true;
+                for (int v : vertices) {
+                    if (std::find(current.begin(), current.end(), v) == current.end()) {
+                        bool ok = true;
+                        for (int u : current)
+                            if (conflictGraph[v][u]) {
+                                ok = false;
+                                break;
+                            }
+                        if (ok) {
+                            maximal = false;
+                            break;
+                        }
+                    }
+                }
+                if (maximal)
+                    ++found;
+            }
+            return;
+        }
+
+        while (!candidates.empty()) {
+            int v = candidates.back();
+            candidates.pop_back();
+
+            std::vector<int> newCandidates;
+            for (int u : candidates) {
+                if (!conflictGraph[v][u])
+                    newCandidates.push_back(u);
+            }
+
+            current.push_back(v);
+            backtrack(current, newCandidates);
+            current.pop_back();
+        }
+    }
+
+    size_t run(const SyntheticIntersection& in)
+    {
+        conflictGraph.assign(in.locations, std::vector<bool>(in.locations, false));
+        for (const auto& [a, b] : in.conflicts)
+            conflictGraph[a][b] = conflictGraph[b][a] = true;
+        vertices = in.vertices;
+
+        found = 0;
+        std::vector<int> current;
+        std::vector<int> candidates = vertices;
+        backtrack(current, candidates);
+        return found;
+    }
+};
+
+/*--- Packed implementation ------------------------------------------------------------------------------------------*/
+struct PackedSearch
+{
+    ConfigurationEngine::Algorithm algorithm;
+    unsigned workers;
+    ConflictGraph conflictGraph;
+    LocationSet vertices;
+
+    explicit PackedSearch(const ConfigurationEngine::Algorithm algorithm, const unsigned workers = 1)
+        : algorithm(algorithm), workers(workers) {}
+
+    size_t run(const SyntheticIntersection& in)
+    {
+        conflictGraph.resize(in.locations);
+        for (const auto& [a, b] : in.conflicts)
+            conflictGraph.addConflict(a, b);
+        vertices = conflictGraph.emptySet();
+        for (const int v : in.vertices)
+            vertices.set(v);
+
+        return ConfigurationEngine(conflictGraph).enumerate(vertices, algorithm, workers).size();
+    }
+};
+
+template <typename Search>
+static double timeSearch(Search& search, const SyntheticIntersection& in, size_t& found)
+{
+    double best = 1e30;
+    for (int r = 0; r < BENCH_REPETITIONS; ++r)
+    {
+        const auto start = Clock::now();
+        found = search.run(in);
+        const std::chrono::duration<double, std::micro> elapsed = Clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+static int runTable(const char* title, const std::initializer_list<int> sizes, const bool saturated, std::mt19937& rng)
+{
+    int ret = 0;
+    std::cout << title << "\n";
+    std::cout << "locations  conflicts  configs   legacy[us]   packed[us]   bron-kerbosch[us]\n";
+    for (const int n : sizes)
+    {
+        const double conflictProbability = saturated ? std::max(0.5, 1.0 - COMPATIBLE_MOVEMENTS / n) : 0.5;
+        const SyntheticIntersection in = makeIntersection(n, conflictProbability, rng);
+
+        LegacySearch legacy;
+        PackedSearch packed{ConfigurationEngine::Algorithm::BACKTRACK};
+        PackedSearch bronKerbosch{ConfigurationEngine::Algorithm::BRON_KERBOSCH};
+        size_t legacyFound = 0, packedFound = 0, bkFound = 0;
+
+        const double legacyTime = timeSearch(legacy, in, legacyFound);
+        const double packedTime = timeSearch(packed, in, packedFound);
+        const double bkTime = timeSearch(bronKerbosch, in, bkFound);
+
+        if (legacyFound != packedFound || legacyFound != bkFound)
+        {
+            std::cerr << "MISMATCH at " << n << " locations: " << legacyFound << " / " << packedFound
+                      << " / " << bkFound << "\n";
+            ret = 1;
+        }
+
+        std::cout << n << "\t   " << in.conflicts.size() << "\t      " << packedFound << "\t"
+                  << legacyTime << "\t" << packedTime << " (" << legacyTime / packedTime << "x)\t"
+                  << bkTime << " (" << legacyTime / bkTime << "x)" << std::endl;
+    }
+    return ret;
+}
+
+/*  Two adjacent junctions driven by the same control box, planned as one Conflict Graph: the movements of one
+ *  junction are compatible with most movements of the other (only the link road between them conflicts),
+ *  so the Configurations of the combined plan are roughly the product of both junctions' Configurations
+ */
+#define LINK_CONFLICT_PROBABILITY 0.05
+
+static SyntheticIntersection makeAdjacentJunctions(const int n, std::mt19937& rng)
+{
+    const int half = n / 2;
+    const double conflictProbability = std::max(0.5, 1.0 - COMPATIBLE_MOVEMENTS / half);
+    const SyntheticIntersection first = makeIntersection(half, conflictProbability, rng);
+    const SyntheticIntersection second = makeIntersection(half, conflictProbability, rng);
+
+    SyntheticIntersection in{static_cast<size_t>(2 * half), first.conflicts, first.vertices};
+    for (const auto& [a, b] : second.conflicts)
+        in.conflicts.emplace_back(a + half, b + half);
+    for (const int v : second.vertices)
+        in.vertices.push_back(v + half);
+
+    std::bernoulli_distribution link(LINK_CONFLICT_PROBABILITY);
+    for (int a = 0; a < half; ++a)
+        for (int b = half; b < 2 * half; ++b)
+            if (link(rng))
+                in.conflicts.emplace_back(a, b);
+    return in;
+}
+
+static int runParallelTable(const std::initializer_list<int> sizes, std::mt19937& rng)
+{
+    int ret = 0;
+    std::cout << "\nAdjacent junctions (one Conflict Graph)\n";
+    std::cout << "locations  conflicts  configs   bron-kerbosch[us]   2 workers[us]   4 workers[us]\n";
+    for (const int n : sizes)
+    {
+        const SyntheticIntersection in = makeAdjacentJunctions(n, rng);
+
+        PackedSearch serial{ConfigurationEngine::Algorithm::BRON_KERBOSCH, 1};
+        PackedSearch two{ConfigurationEngine::Algorithm::BRON_KERBOSCH, 2};
+        PackedSearch four{ConfigurationEngine::Algorithm::BRON_KERBOSCH, 4};
+        size_t serialFound = 0, twoFound = 0, fourFound = 0;
+
+        const double serialTime = timeSearch(serial, in, serialFound);
+        const double twoTime = timeSearch(two, in, twoFound);
+        const double fourTime = timeSearch(four, in, fourFound);
+
+        if (serialFound != twoFound || serialFound != fourFound)
+        {
+            std::cerr << "MISMATCH at " << n << " locations: " << serialFound << " / " << twoFound
+                      << " / " << fourFound << "\n";
+            ret = 1;
+        }
+
+        std::cout << n << "\t   " << in.conflicts.size() << "\t      " << serialFound << "\t"
+                  << serialTime << "\t\t" << twoTime << " (" << serialTime / twoTime << "x)\t"
+                  << fourTime << " (" << serialTime / fourTime << "x)" << std::endl;
+    }
+    return ret;
+}
+
+int main()
+{
+    std::mt19937 rng(BENCH_SEED);
+    int ret = runTable("Saturated intersections", {16, 32, 64, 128, 192, 256}, true, rng);
+    ret |= runTable("\nSparse intersections", {16, 24, 32, 40}, false, rng);
+    ret |= runParallelTable({32, 64, 128, 192}, rng);
+    return ret;
+}
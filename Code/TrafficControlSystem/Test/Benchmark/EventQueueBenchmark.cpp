@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+#include "../../CppWrapper/CppWrapper.hpp"
+
+/* BENCHMARK
+ *  - Event queue of the TCS thread: Queue<T> (mutex + condition variable) vs MpscQueue<T> (lock-free ring,
+ *    eventfd wake-up), with 1, 2, 4 and 8 producer threads and one consumer blocked in receive()
+ *  - Burst: every producer sends as fast as it can - throughput (messages/s)
+ *  - Paced: every producer sends one message every BENCH_PACE (the event rate of an Intersection is low) -
+ *    enqueue to dequeue latency, including the consumer's wake-up
+ *  - Checked: every message received once, in order per producer
+ *
+ *  Runs on the host (no GPIO/Cloud/DDS required):
+ *      g++ -std=c++20 -O2 Test/Benchmark/EventQueueBenchmark.cpp CppWrapper/EventFd_CppWrapper.cpp \
+ *          CppWrapper/Thread_CppWrapper.cpp CppWrapper/Executor_CppWrapper.cpp CppWrapper/Mutex_CppWrapper.cpp \
+ *          CppWrapper/CondVar_CppWrapper.cpp -lpthread
+ */
+
+#define BENCH_BURST 200000      // messages per run, burst
+#define BENCH_PACED 2000        // messages per producer, paced
+#define BENCH_PACE 100000       // ns between two messages of a producer, paced
+#define BENCH_CAPACITY 1024     // MpscQueue slots (as EVENT_QUEUE_CAPACITY)
+
+struct Message
+{
+    uint64_t sent;      // ns, CLOCK_MONOTONIC
+    uint32_t producer;
+    uint32_t seq;
+};
+
+static uint64_t now()
+{
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+/*--- Measurement ----------------------------------------------------------------------------------------------------*/
+template <typename Q>
+struct Run
+{
+    Q queue;
+    unsigned producers = 0;
+    uint32_t perProducer = 0;
+    uint64_t pace = 0;                  // ns (0: burst)
+    std::atomic<unsigned> ready{0};
+    std::atomic<bool> go{false};
+
+    std::vector<double> latencies;      // us
+    bool ordered = true;
+
+    struct Producer
+    {
+        Run* run;
+        uint32_t id;
+    };
+
+    static void* t_produce(void* arg)
+    {
+        const auto [run, id] = *static_cast<Producer*>(arg);
+        ++run->ready;
+        while (!run->go.load())
+            sched_yield();
+
+        uint64_t next = now();
+        for (uint32_t seq = 0; seq < run->perProducer; ++seq)
+        {
+            if (run->pace)
+            {
+                next += run->pace;
+                const timespec at{static_cast<time_t>(next / 1000000000ull), static_cast<long>(next % 1000000000ull)};
+                clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &at, nullptr);
+            }
+            run->queue.send(Message{now(), id, seq});
+        }
+        return nullptr;
+    }
+
+    // Throughput (messages/s)
+    double measure()
+    {
+        const uint64_t total = static_cast<uint64_t>(producers) * perProducer;
+        latencies.reserve(total);
+        std::vector<uint32_t> expected(producers, 0);
+
+        std::vector<Producer> args(producers);
+        std::vector<std::unique_ptr<CppWrapper::Thread>> threads;
+        for (unsigned i = 0; i < producers; ++i)
+        {
+            args[i] = {this, i};
+            threads.push_back(std::make_unique<CppWrapper::Thread>(t_produce));
+            threads.back()->run(&args[i]);
+        }
+        while (ready.load() < producers)
+            sched_yield();
+
+        const uint64_t start = now();
+        go = true;
+        for (uint64_t i = 0; i < total; ++i)
+        {
+            const Message message = queue.receive();
+            latencies.push_back(static_cast<double>(now() - message.sent) * 1e-3);
+            ordered = ordered && message.seq == expected[message.producer]++;
+        }
+        const double elapsed = static_cast<double>(now() - start) * 1e-9;
+
+        for (const auto& thread : threads)
+            thread->join();
+        std::ranges::sort(latencies);
+        return static_cast<double>(total) / elapsed;
+    }
+};
+
+static double percentile(const std::vector<double>& sorted, const double p)
+{
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * static_cast<double>(sorted.size())))];
+}
+
+static bool failed = false;
+
+template <typename Q>
+static void row(std::ostream& report, const char* name, const unsigned producers)
+{
+    Run<Q> burst;
+    burst.producers = producers;
+    burst.perProducer = BENCH_BURST / producers;
+    const double throughput = burst.measure();
+
+    Run<Q> paced;
+    paced.producers = producers;
+    paced.perProducer = BENCH_PACED;
+    paced.pace = BENCH_PACE;
+    paced.measure();
+
+    if (!burst.ordered || !paced.ordered)
+    {
+        report << "FAILED: " << name << " lost or reordered messages\n";
+        failed = true;
+    }
+
+    report << "  " << std::left << std::setw(8) << name << std::right << std::setw(4) << producers
+           << std::fixed << std::setprecision(2) << std::setw(12) << throughput * 1e-6
+           << std::setprecision(1) << std::setw(12) << percentile(burst.latencies, 0.5)
+           << std::setw(12) << percentile(paced.latencies, 0.5) << std::setw(12) << percentile(paced.latencies, 0.99)
+           << std::setw(12) << paced.latencies.back() << "\n";
+}
+
+int main()
+{
+    std::ostream report(std::cout.rdbuf());
+    std::cerr.rdbuf(nullptr);       // silences Queue's own logging (one line per send)
+
+    using Legacy = CppWrapper::Queue<Message>;
+    using Ring = CppWrapper::MpscQueue<Message, BENCH_CAPACITY>;
+
+    try
+    {
+        report << "burst: " << BENCH_BURST << " messages; paced: " << BENCH_PACED << " per producer, one every "
+               << BENCH_PACE / 1000 << " us; " << std::max(1u, std::thread::hardware_concurrency()) << " CPUs\n";
+        report << "  " << std::left << std::setw(8) << "queue" << std::right << std::setw(4) << "P"
+               << std::setw(12) << "burst[M/s]" << std::setw(12) << "burst p50" << std::setw(12) << "paced p50"
+               << std::setw(12) << "paced p99" << std::setw(12) << "paced max" << "   [us]\n";
+        for (const unsigned producers : {1u, 2u, 4u, 8u})
+        {
+            row<Legacy>(report, "Queue", producers);
+            row<Ring>(report, "Mpsc", producers);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        report << "Benchmark failed: " << e.what() << "\n";
+        return 1;
+    }
+    return failed ? 1 : 0;
+}
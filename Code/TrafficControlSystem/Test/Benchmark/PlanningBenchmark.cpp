@@ -0,0 +1,260 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "../../TrafficControlSystem.hpp"
+#include "../Common/TrafficControlSystemTestAccess.hpp"
+
+/* BENCHMARK
+ *  - Intersection planning pipeline of the Traffic Control System, on synthetic intersections:
+ *      conflictTrajectory, setUpGraphMatrix, findConfigurations (cold and with the plan cached)
+ *      and organizeNextConfiguration
+ *  - Reports ns/op and heap allocations/op (global operator new, counted on the benchmark thread only)
+ *
+ *  Host build (target PlanningBenchmark): GPIO is stubbed by Test/Benchmark/Stubs/rasp_gpio_stub.cpp,
+ *  the Cloud and DDS objects are created but never started
+ */
+
+#ifndef PLAN_CACHE_PATH
+#error "PLAN_CACHE_PATH must point to a scratch file (set by the PlanningBenchmark target)"
+#endif
+
+#define BENCH_SEED 2024
+#define BENCH_MIN_TIME 0.2      // s, per measurement
+#define BENCH_PINS 128          // stubbed GPIO lines
+#define BENCH_FAN_OUT 3         // maximum destinations per approach
+
+using Clock = std::chrono::steady_clock;
+
+/*--- Allocation counter ---------------------------------------------------------------------------------------------*/
+static thread_local size_t allocations = 0;
+
+void* operator new(const size_t size)
+{
+    ++allocations;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+/*--- Synthetic intersection -----------------------------------------------------------------------------------------*/
+struct SyntheticIntersection
+{
+    int arms;
+    int crosswalks;
+    std::shared_ptr<json> tsem;
+    std::shared_ptr<json> psem;
+};
+
+/*  N arms around the junction, 4 Locations each (clockwise):
+ *      4k: crosswalk side A | 4k+1: approach (TSEM) | 4k+2: exit | 4k+3: crosswalk side B
+ *   *  Each approach heads to 1..BENCH_FAN_OUT random exits of the other arms
+ *   *  The first M arms have a crosswalk, spanning their approach and exit
+ */
+static SyntheticIntersection makeIntersection(const int arms, const int crosswalks, std::mt19937& rng)
+{
+    SyntheticIntersection in{arms, crosswalks, std::make_shared<json>(json::array()),
+        std::make_shared<json>(json::array())};
+    std::uniform_int_distribution<int> fanOut(1, std::min(BENCH_FAN_OUT, arms - 1));
+    std::uniform_int_distribution<int> otherArm(1, arms - 1);
+    int pin = 1;
+
+    for (int k = 0; k < arms; ++k)
+    {
+        std::vector<int> destinations;
+        const int n = fanOut(rng);
+        while (static_cast<int>(destinations.size()) < n)
+        {
+            const int exit = 4 * ((k + otherArm(rng)) % arms) + 2;
+            if (std::ranges::find(destinations, exit) == destinations.end())
+                destinations.push_back(exit);
+        }
+
+        in.tsem->push_back({
+            {"name", "TS" + std::to_string(k)}, {"location", 4 * k + 1}, {"destinations", destinations},
+            {"gpio_red", pin}, {"gpio_green", pin + 1}, {"gpio_yellow", pin + 2}});
+        pin += 3;
+
+        if (k >= crosswalks)
+            continue;
+        for (const int loc : {4 * k, 4 * k + 3})
+        {
+            in.psem->push_back({
+                {"name", "PS" + std::to_string(loc)}, {"location", loc}, {"gpio_red", pin}, {"gpio_green", pin + 1},
+                {"hasButton", 0}, {"hasCardReader", 0}, {"hasBuzzer", 0}});
+            pin += 2;
+        }
+    }
+    return in;
+}
+
+/*--- Measurement ----------------------------------------------------------------------------------------------------*/
+struct Result
+{
+    double ns;
+    double allocs;
+};
+
+// Runs 'op' for, at least, BENCH_MIN_TIME; each call performs 'opsPerCall' operations
+template <typename F>
+static Result measure(F&& op, const size_t opsPerCall = 1)
+{
+    op();   // warm up
+
+    size_t calls = 0;
+    const size_t startAllocations = allocations;
+    const auto start = Clock::now();
+    std::chrono::duration<double> elapsed{};
+    do
+    {
+        op();
+        ++calls;
+        elapsed = Clock::now() - start;
+    } while (elapsed.count() < BENCH_MIN_TIME);
+
+    const double ops = static_cast<double>(calls * opsPerCall);
+    return {elapsed.count() * 1e9 / ops, static_cast<double>(allocations - startAllocations) / ops};
+}
+
+/*--- Access to the Traffic Control System ---------------------------------------------------------------------------*/
+struct Planning;
+
+template <>
+struct TrafficControlSystemTestAccess<Planning>
+{
+    TrafficControlSystem& tcs;
+    std::ostream& report;
+
+    void clearPlan() const
+    {
+        tcs.configurations.clear();
+        tcs.planSets.clear();
+        tcs.phaseSequence.clear();
+        tcs.sequencePos = -1;
+        tcs.current_config_idx = 0;
+        tcs.planPending = false;
+    }
+
+    void load(const SyntheticIntersection& in) const
+    {
+        clearPlan();
+        tcs.crosswalks.clear();
+        tcs.TrafficSemVector.clear();
+        tcs.PedestrianSemVector.clear();
+        tcs.elementByLocation.clear();
+        tcs.usedGPIOs.clear();
+        tcs.availableGPIOs.clear();
+        for (int pin = 1; pin < BENCH_PINS; ++pin)
+            tcs.availableGPIOs.push_back(pin);
+        tcs.maxLocation = 0;
+        tcs.configHash = 0;
+
+        tcs.createComponents(in.tsem);
+        if (in.crosswalks)
+            tcs.createComponents(in.psem);
+    }
+
+    void row(const char* name, const Result& result) const
+    {
+        report << "  " << std::left << std::setw(34) << name << std::right << std::fixed
+               << std::setprecision(1) << std::setw(14) << result.ns
+               << std::setprecision(2) << std::setw(12) << result.allocs << "\n";
+    }
+
+    void run(const SyntheticIntersection& in) const
+    {
+        load(in);
+        const size_t locations = tcs.maxLocation + 1;
+        const auto& tsems = tcs.TrafficSemVector;
+
+        // conflictTrajectory: every TSEM pair
+        const Result trajectory = measure([&]
+        {
+            int conflicts = 0;
+            for (size_t i = 0; i < tsems.size(); ++i)
+                for (size_t j = i + 1; j < tsems.size(); ++j)
+                    conflicts += TrafficControlSystem::conflictTrajectory(*tsems[i], *tsems[j]);
+            asm volatile("" : : "r"(conflicts));
+        }, tsems.size() * (tsems.size() - 1) / 2);
+
+        const Result graph = measure([&]
+        {
+            tcs.conflictGraph.resize(locations);
+            tcs.setUpGraphMatrix();
+        });
+
+        const Result cold = measure([&]
+        {
+            clearPlan();
+            std::remove(PLAN_CACHE_PATH);
+            tcs.findConfigurations();
+        });
+
+        const Result cached = measure([&]
+        {
+            clearPlan();
+            tcs.findConfigurations();
+        });
+
+        tcs.state = TrafficControlSystem::SystemState::NORMAL;
+        const Result next = measure([&]
+        {
+            const auto switchingData = tcs.organizeNextConfiguration();
+            asm volatile("" : : "r"(switchingData.transition));
+        });
+        tcs.state = TrafficControlSystem::SystemState::SET_UP;
+
+        report << in.arms << " arms, " << in.crosswalks << " crosswalks: " << locations << " locations, "
+               << tcs.configurations.size() << " configurations, " << tcs.phaseSequence.size() << " phases\n";
+        report << "  " << std::left << std::setw(34) << "operation" << std::right << std::setw(14) << "ns/op"
+               << std::setw(12) << "allocs/op" << "\n";
+        row("conflictTrajectory (TSEM pair)", trajectory);
+        row("setUpGraphMatrix", graph);
+        row("findConfigurations (cold)", cold);
+        row("findConfigurations (plan cached)", cached);
+        row("organizeNextConfiguration", next);
+        report << std::endl;
+    }
+};
+using PlanningBenchmark = TrafficControlSystemTestAccess<Planning>;
+
+int main()
+{
+    std::ostream report(std::cout.rdbuf());
+    std::cout.rdbuf(nullptr);       // silences the system's own logging
+
+    std::mt19937 rng(BENCH_SEED);
+    PlanningBenchmark bench{TrafficControlSystem::getInstance(), report};
+
+    try
+    {
+        for (const int arms : {4, 6, 8, 12, 16})
+        {
+            bench.run(makeIntersection(arms, arms / 2, rng));
+            bench.run(makeIntersection(arms, arms, rng));
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Benchmark failed: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::remove(PLAN_CACHE_PATH);
+    return 0;
+}
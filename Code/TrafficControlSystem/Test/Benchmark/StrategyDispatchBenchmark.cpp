@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <time.h>
+#include <unordered_map>
+#include <vector>
+
+#include "../../TrafficStrategy/StateMachine.hpp"
+
+/* BENCHMARK
+ *  - Dispatch of an event to the handler of the current state, the innermost step of t_tcs
+ *  - Legacy: std::unordered_map<state, std::unique_ptr<strategy>> lookup, virtual controlOperation, std::visit
+ *    with an if constexpr chain per strategy - as the TCS used to dispatch
+ *  - Table: StateMachine (state x event type) table of handlers, one indirect call
+ *  - Same handlers (one counter per state and event type, out of line) and the same event stream (the hot
+ *    events of Normal operation, a state change every BENCH_STATE_RUN events); checked: same counters
+ *
+ *  Runs on the host (no GPIO/Cloud/DDS required):
+ *      g++ -std=c++20 -O2 Test/Benchmark/StrategyDispatchBenchmark.cpp
+ */
+
+#define BENCH_EVENTS 4096           // event stream, replayed
+#define BENCH_ROUNDS 2000           // replays per measurement
+#define BENCH_STATE_RUN 64          // events between two state changes
+#define BENCH_STATES 4
+
+enum class State { SET_UP, NORMAL, EMERGENCY, FAILURE };
+
+struct Context
+{
+    State state = State::NORMAL;
+    std::array<std::array<uint64_t, StateMachine::EVENT_KINDS>, BENCH_STATES> handled{};
+};
+
+// Out of line: the cost measured is the dispatch, not an inlined counter
+template <State S, typename T>
+[[gnu::noinline]] void handle(Context* context, const T&)
+{
+    ++context->handled[static_cast<size_t>(S)][StateMachine::kindOf<T>()];
+}
+
+/*--- Legacy dispatch ------------------------------------------------------------------------------------------------*/
+struct I_Strategy
+{
+    virtual ~I_Strategy() = default;
+    virtual void controlOperation(Context* context, Event& event) = 0;
+};
+
+struct LegacySetUp : I_Strategy
+{
+    void controlOperation(Context* context, Event& event) override
+    {
+        std::visit([context](auto&& receive)
+        {
+            using T = std::decay_t<decltype(receive)>;
+            if constexpr (std::is_same_v<T, InternalEvent>)
+                handle<State::SET_UP>(context, receive);
+            else if constexpr (std::is_same_v<T, CloudReceiveType>)
+                handle<State::SET_UP>(context, receive);
+        }, event);
+    }
+};
+
+struct LegacyNormal : I_Strategy
+{
+    void controlOperation(Context* context, Event& event) override
+    {
+        std::visit([context](auto&& receive)
+        {
+            using T = std::decay_t<decltype(receive)>;
+            if constexpr (std::is_same_v<T, InternalEvent>)
+                handle<State::NORMAL>(context, receive);
+            else if constexpr (std::is_same_v<T, DDSEvent>)
+                handle<State::NORMAL>(context, receive);
+            else if constexpr (std::is_same_v<T, PedestrianButtonEvent>)
+                handle<State::NORMAL>(context, receive);
+            else if constexpr (std::is_same_v<T, PedestrianRFIDEvent>)
+                handle<State::NORMAL>(context, receive);
+            else if constexpr (std::is_same_v<T, CloudReceiveType>)
+                handle<State::NORMAL>(context, receive);
+            else if constexpr (std::is_same_v<T, VehicleDetectorEvent>)
+                handle<State::NORMAL>(context, receive);
+            else if constexpr (std::is_same_v<T, GreenWaveEvent>)
+                handle<State::NORMAL>(context, receive);
+        }, event);
+    }
+};
+
+struct LegacyEmergency : I_Strategy
+{
+    void controlOperation(Context* context, Event& event) override
+    {
+        std::visit([context](auto&& receive)
+        {
+            using T = std::decay_t<decltype(receive)>;
+            if constexpr (std::is_same_v<T, InternalEvent>)
+                handle<State::EMERGENCY>(context, receive);
+            else if constexpr (std::is_same_v<T, DDSEvent>)
+                handle<State::EMERGENCY>(context, receive);
+            else if constexpr (std::is_same_v<T, GreenWaveEvent>)
+                handle<State::EMERGENCY>(context, receive);
+        }, event);
+    }
+};
+
+struct LegacyFailure : I_Strategy
+{
+    void controlOperation(Context* context, Event& event) override
+    {
+        if (const auto receive = std::get_if<InternalEvent>(&event))
+            handle<State::FAILURE>(context, *receive);
+    }
+};
+
+struct Legacy
+{
+    std::unordered_map<State, std::unique_ptr<I_Strategy>> strategies;
+
+    Legacy()
+    {
+        strategies[State::SET_UP] = std::make_unique<LegacySetUp>();
+        strategies[State::NORMAL] = std::make_unique<LegacyNormal>();
+        strategies[State::EMERGENCY] = std::make_unique<LegacyEmergency>();
+        strategies[State::FAILURE] = std::make_unique<LegacyFailure>();
+    }
+
+    void dispatch(Context* context, Event& event) { strategies[context->state]->controlOperation(context, event); }
+};
+
+/*--- Table dispatch -------------------------------------------------------------------------------------------------*/
+using StateMachine::On;
+using StateMachine::Ignore;
+
+constexpr StateMachine::Table<Context, BENCH_STATES> table = StateMachine::table<Context, BENCH_STATES>(
+    StateMachine::row<Context, State::SET_UP,
+        On<&handle<State::SET_UP, InternalEvent>>, On<&handle<State::SET_UP, CloudReceiveType>>,
+        Ignore<PedestrianButtonEvent>, Ignore<PedestrianRFIDEvent>, Ignore<DDSEvent>, Ignore<VehicleDetectorEvent>,
+        Ignore<GreenWaveEvent>>(),
+    StateMachine::row<Context, State::NORMAL,
+        On<&handle<State::NORMAL, InternalEvent>>, On<&handle<State::NORMAL, DDSEvent>>,
+        On<&handle<State::NORMAL, PedestrianButtonEvent>>, On<&handle<State::NORMAL, PedestrianRFIDEvent>>,
+        On<&handle<State::NORMAL, CloudReceiveType>>, On<&handle<State::NORMAL, VehicleDetectorEvent>>,
+        On<&handle<State::NORMAL, GreenWaveEvent>>>(),
+    StateMachine::row<Context, State::EMERGENCY,
+        On<&handle<State::EMERGENCY, InternalEvent>>, On<&handle<State::EMERGENCY, DDSEvent>>,
+        On<&handle<State::EMERGENCY, GreenWaveEvent>>, Ignore<PedestrianButtonEvent>, Ignore<PedestrianRFIDEvent>,
+        Ignore<CloudReceiveType>, Ignore<VehicleDetectorEvent>>(),
+    StateMachine::row<Context, State::FAILURE,
+        On<&handle<State::FAILURE, InternalEvent>>, Ignore<PedestrianButtonEvent>, Ignore<PedestrianRFIDEvent>,
+        Ignore<DDSEvent>, Ignore<CloudReceiveType>, Ignore<VehicleDetectorEvent>, Ignore<GreenWaveEvent>>());
+
+struct Table
+{
+    static void dispatch(Context* context, Event& event)
+    {
+        StateMachine::dispatch(table, context->state, context, event);
+    }
+};
+
+/*--- Measurement ----------------------------------------------------------------------------------------------------*/
+static uint64_t now()
+{
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// Hot events of Normal operation: vehicle calls, buttons, cards, phase timeouts, green wave reports, EVs
+static std::vector<Event> makeStream(std::mt19937& rng)
+{
+    std::uniform_int_distribution<int> kind(0, 9);
+    std::uniform_int_distribution<int> location(0, 15);
+    std::vector<Event> stream;
+    for (int i = 0; i < BENCH_EVENTS; ++i)
+    {
+        switch (kind(rng))
+        {
+        case 0: case 1: case 2: case 3: stream.emplace_back(VehicleDetectorEvent{location(rng)}); break;
+        case 4: case 5:  stream.emplace_back(InternalEvent::LIGHTS_TIMEOUT); break;
+        case 6:  stream.emplace_back(PedestrianButtonEvent{location(rng)}); break;
+        case 7:  stream.emplace_back(PedestrianRFIDEvent{location(rng), 0xCAFE}); break;
+        case 8:  stream.emplace_back(GreenWaveEvent{"upstream", 0, 90, 0}); break;
+        default: stream.emplace_back(DDSEvent{DDS_Event_Qualifier::EMERGENCY_START, "AMB-1", 1, 6, 2}); break;
+        }
+    }
+    return stream;
+}
+
+static std::vector<State> makeStates(std::mt19937& rng)
+{
+    // Mostly Normal operation, as an Intersection spends its day
+    std::discrete_distribution<int> pick({1, 85, 10, 4});
+    std::vector<State> states;
+    for (int i = 0; i < BENCH_EVENTS / BENCH_STATE_RUN; ++i)
+        states.push_back(static_cast<State>(pick(rng)));
+    return states;
+}
+
+// ns per event
+template <typename Dispatcher>
+static double measure(Dispatcher& dispatcher, std::vector<Event>& stream, const std::vector<State>& states,
+    Context& context)
+{
+    const uint64_t start = now();
+    for (int round = 0; round < BENCH_ROUNDS; ++round)
+        for (size_t i = 0; i < stream.size(); ++i)
+        {
+            if (i % BENCH_STATE_RUN == 0)
+                context.state = states[i / BENCH_STATE_RUN];
+            dispatcher.dispatch(&context, stream[i]);
+        }
+    return static_cast<double>(now() - start) / (static_cast<double>(BENCH_ROUNDS) * stream.size());
+}
+
+int main()
+{
+    std::mt19937 rng(24);
+    auto stream = makeStream(rng);
+    const auto states = makeStates(rng);
+
+    Legacy legacy;
+    Table direct;
+    Context legacyContext, tableContext;
+
+    // Warm-up, then the best of three (the host may be busy)
+    measure(legacy, stream, states, legacyContext);
+    measure(direct, stream, states, tableContext);
+    double legacyNs = 1e9, tableNs = 1e9;
+    for (int run = 0; run < 3; ++run)
+    {
+        legacyNs = std::min(legacyNs, measure(legacy, stream, states, legacyContext));
+        tableNs = std::min(tableNs, measure(direct, stream, states, tableContext));
+    }
+
+    std::cout << BENCH_EVENTS << " events x " << BENCH_ROUNDS << " rounds, a state change every "
+              << BENCH_STATE_RUN << " events\n" << std::fixed << std::setprecision(2)
+              << "  legacy (map + virtual + visit)  " << std::setw(8) << legacyNs << " ns/event\n"
+              << "  table (StateMachine)            " << std::setw(8) << tableNs << " ns/event\n"
+              << "  speed-up                        " << std::setw(8) << legacyNs / tableNs << "x\n";
+
+    if (legacyContext.handled != tableContext.handled)
+    {
+        std::cout << "FAILED: the dispatchers handled different events\n";
+        return 1;
+    }
+    return 0;
+}
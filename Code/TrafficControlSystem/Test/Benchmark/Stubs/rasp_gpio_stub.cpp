@@ -0,0 +1,97 @@
+#include "../../../GPIOHandling/rasp_gpio.hpp"
+#include "rasp_gpio_stub.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <mutex>
+
+/*
+ *  Host replacement of GPIOHandling/rasp_gpio.cpp (no libgpiod, no GPIO chip)
+ *   Every line is accepted and every operation succeeds; reads return low, interrupts never fire
+ *   Output lines 0..63 are tracked (rasp_gpio_stub_lines)
+ */
+
+static std::atomic<uint64_t> lines{0};
+static std::atomic<uint64_t> commits{0};
+static std::recursive_mutex gpioMutex;     // commits and rasp_gpio_lock(): the lines themselves are atomics
+
+static uint64_t lineBit(const int line)
+{
+    return line >= 0 && line < 64 ? uint64_t{1} << line : 0;
+}
+
+uint64_t rasp_gpio_stub_lines()
+{
+    return lines.load();
+}
+
+uint64_t rasp_gpio_stub_commits()
+{
+    return commits.load();
+}
+
+int set_output_mode(int line_offset)
+{
+    return 0;
+}
+
+int set_input_mode(int line_offset)
+{
+    return 0;
+}
+
+int rasp_gpio_set(int line)
+{
+    lines.fetch_or(lineBit(line));
+    return 0;
+}
+
+int rasp_gpio_clear(int line)
+{
+    lines.fetch_and(~lineBit(line));
+    return 0;
+}
+
+void rasp_gpio_release(int line) {}
+
+int rasp_gpio_read(int line)
+{
+    return 0;
+}
+
+int rasp_gpio_reqInt(int line_offset, void* data, int(*callback)(int, unsigned int, const struct timespec*, void*))
+{
+    return 0;
+}
+
+int rasp_gpio_group_output(uint64_t lines)
+{
+    return 0;
+}
+
+void rasp_gpio_lock()
+{
+    gpioMutex.lock();
+}
+
+void rasp_gpio_unlock()
+{
+    gpioMutex.unlock();
+}
+
+int rasp_gpio_commit(rasp_gpio_mask mask)
+{
+    std::lock_guard lock(gpioMutex);
+    uint64_t current = lines.load();
+    while (!lines.compare_exchange_weak(current, (current & ~mask.clear) | mask.set)) {}
+    commits.fetch_add(1);
+    return 0;
+}
+
+int rasp_gpio_try_commit(rasp_gpio_mask mask)
+{
+    std::unique_lock lock(gpioMutex, std::try_to_lock);
+    if (!lock.owns_lock())
+        return -EBUSY;
+    return rasp_gpio_commit(mask);
+}
@@ -0,0 +1,13 @@
+#ifndef TRAFFICCONTROLSYSTEM_RASP_GPIO_STUB_HPP
+#define TRAFFICCONTROLSYSTEM_RASP_GPIO_STUB_HPP
+
+#include <cstdint>
+
+/*
+ *  Host tests only: output lines as last driven through the stub (bit n = GPIO line n, lines 0..63)
+ */
+
+uint64_t rasp_gpio_stub_lines();
+uint64_t rasp_gpio_stub_commits();      // rasp_gpio_commit calls
+
+#endif //TRAFFICCONTROLSYSTEM_RASP_GPIO_STUB_HPP
@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <malloc.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+#include "../../CppWrapper/CppWrapper.hpp"
+
+/* BENCHMARK
+ *  - Memory: BENCH_THREADS parked threads (the TCS' count), each touching BENCH_STACK_USE of its stack
+ *      legacy: 20 MB stacks, the creator's scheduling - as every Thread used to be created
+ *      roles:  the stacks of the roles the TCS runs (Executor profiles)
+ *    VmSize (address space reserved) and VmRSS (resident) grown, from /proc/self/status
+ *  - Jitter: lateness of a periodic wake-up (BENCH_PERIOD_NS, absolute clock_nanosleep), as t_switchLight and
+ *    the TimerService wake, with every CPU busy spinning (SCHED_OTHER)
+ *      generic: the creator's scheduling (SCHED_OTHER)
+ *      phase:   the PHASE role (SCHED_FIFO, explicit) - "real time denied" if not permitted
+ *
+ *  Runs on the host (no GPIO/Cloud/DDS required), real time needs CAP_SYS_NICE:
+ *      g++ -std=c++20 -O2 Test/Benchmark/ThreadRoleBenchmark.cpp CppWrapper/Thread_CppWrapper.cpp \
+ *          CppWrapper/Executor_CppWrapper.cpp CppWrapper/Mutex_CppWrapper.cpp -lpthread
+ */
+
+#define BENCH_THREADS 10                    // TCS: tcs, switch-light, timers, cloud, 2 DDS, 2 devices, 2 more
+#define BENCH_STACK_USE (64 * 1024)         // bytes of stack each thread touches
+#define BENCH_LEGACY_STACK (20 * 1024 * 1024)
+#define BENCH_SAMPLES 2000                  // wake-ups per run
+#define BENCH_PERIOD_NS 1000000             // 1 ms
+
+/*--- Memory ---------------------------------------------------------------------------------------------------------*/
+static std::atomic<bool> release{false};
+
+static void* t_parked(void*)
+{
+    volatile char frame[BENCH_STACK_USE];
+    for (size_t i = 0; i < sizeof(frame); i += 4096)
+        frame[i] = 1;
+    release.wait(false);
+    return nullptr;
+}
+
+// kB of a /proc/self/status field
+static long status(const std::string& field)
+{
+    std::ifstream file("/proc/self/status");
+    std::string line;
+    while (std::getline(file, line))
+        if (line.rfind(field + ":", 0) == 0)
+            return std::stol(line.substr(field.size() + 1));
+    return 0;
+}
+
+struct Footprint
+{
+    long size;      // kB
+    long rss;       // kB
+};
+
+static Footprint footprint(const std::vector<CppWrapper::ThreadRole>& roles)
+{
+    release = false;
+    const Footprint before{status("VmSize"), status("VmRSS")};
+
+    std::vector<std::unique_ptr<CppWrapper::Thread>> threads;
+    for (const auto role : roles)
+    {
+        threads.push_back(std::make_unique<CppWrapper::Thread>(t_parked, role));
+        threads.back()->run();
+    }
+    const Footprint after{status("VmSize"), status("VmRSS")};
+
+    release = true;
+    release.notify_all();
+    for (const auto& thread : threads)
+        thread->join();
+    return {after.size - before.size, after.rss - before.rss};
+}
+
+/*--- Jitter ---------------------------------------------------------------------------------------------------------*/
+static std::atomic<bool> stopLoad{false};
+
+static void* t_spin(void*)
+{
+    volatile unsigned long x = 0;
+    while (!stopLoad.load(std::memory_order_relaxed))
+        x = x + 1;
+    return nullptr;
+}
+
+static uint64_t now()
+{
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static void* t_periodic(void* arg)
+{
+    auto latencies = static_cast<std::vector<double>*>(arg);
+    uint64_t deadline = now();
+    for (int i = 0; i < BENCH_SAMPLES; ++i)
+    {
+        deadline += BENCH_PERIOD_NS;
+        const timespec ts = {static_cast<time_t>(deadline / 1000000000ull),
+            static_cast<long>(deadline % 1000000000ull)};
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+        latencies->push_back(static_cast<double>(now() - deadline) / 1e3);
+    }
+    return nullptr;
+}
+
+static std::vector<double> jitter(const CppWrapper::ThreadRole role, const unsigned busyThreads)
+{
+    stopLoad = false;
+    std::vector<std::unique_ptr<CppWrapper::Thread>> load;
+    for (unsigned i = 0; i < busyThreads; ++i)
+    {
+        load.push_back(std::make_unique<CppWrapper::Thread>(t_spin, CppWrapper::ThreadRole::GENERIC, "spin"));
+        load.back()->run();
+    }
+
+    std::vector<double> latencies;
+    latencies.reserve(BENCH_SAMPLES);
+    CppWrapper::Thread periodic(t_periodic, role);
+    periodic.run(&latencies);
+    if (role != CppWrapper::ThreadRole::GENERIC)
+        CppWrapper::Executor::report(std::cout);
+    periodic.join();
+
+    stopLoad = true;
+    for (const auto& thread : load)
+        thread->join();
+
+    std::ranges::sort(latencies);
+    return latencies;
+}
+
+static double percentile(const std::vector<double>& sorted, const double p)
+{
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * static_cast<double>(sorted.size())))];
+}
+
+static void row(const char* name, const std::vector<double>& sorted)
+{
+    std::cout << "  " << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << percentile(sorted, 0.5) << std::setw(12) << percentile(sorted, 0.99)
+              << std::setw(12) << percentile(sorted, 0.999) << std::setw(12) << sorted.back() << "\n";
+}
+
+int main()
+{
+    using CppWrapper::ThreadRole;
+    const unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+    mallopt(M_ARENA_MAX, 1);        // no per thread malloc arena (64 MB reserved each): the stacks are measured
+
+    try
+    {
+        // Roles of the TCS' threads
+        const std::vector<ThreadRole> roles = {ThreadRole::CONTROL, ThreadRole::PHASE, ThreadRole::TIMER,
+            ThreadRole::NETWORK, ThreadRole::NETWORK, ThreadRole::NETWORK, ThreadRole::DEVICE, ThreadRole::DEVICE,
+            ThreadRole::WORKER, ThreadRole::BACKGROUND};
+        static_assert(BENCH_THREADS == 10, "ThreadRoleBenchmark: one role per thread");
+
+        // Roles first: the stacks glibc caches once the threads are joined are too small for the legacy ones
+        const Footprint withRoles = footprint(roles);
+
+        CppWrapper::RoleProfile legacy = CppWrapper::Executor::profile(ThreadRole::GENERIC);
+        legacy.stackSize = BENCH_LEGACY_STACK;
+        CppWrapper::Executor::setProfile(ThreadRole::GENERIC, legacy);
+        const Footprint withLegacy = footprint(std::vector<ThreadRole>(BENCH_THREADS, ThreadRole::GENERIC));
+
+        std::cout << BENCH_THREADS << " parked threads, " << BENCH_STACK_USE / 1024 << " KB of stack used each\n"
+                  << "  " << std::left << std::setw(10) << "stacks" << std::right << std::setw(14) << "VmSize[KB]"
+                  << std::setw(14) << "VmRSS[KB]" << "\n"
+                  << "  " << std::left << std::setw(10) << "legacy" << std::right << std::setw(14) << withLegacy.size
+                  << std::setw(14) << withLegacy.rss << "\n"
+                  << "  " << std::left << std::setw(10) << "roles" << std::right << std::setw(14) << withRoles.size
+                  << std::setw(14) << withRoles.rss << "\n\n";
+
+        std::cout << BENCH_SAMPLES << " wake-ups every " << BENCH_PERIOD_NS / 1000 << " us, " << cpus
+                  << " busy threads on " << cpus << " CPUs\n";
+        const auto generic = jitter(ThreadRole::GENERIC, cpus);
+        const auto phase = jitter(ThreadRole::PHASE, cpus);
+
+        std::cout << "  " << std::left << std::setw(10) << "role" << std::right << std::setw(12) << "p50[us]"
+                  << std::setw(12) << "p99[us]" << std::setw(12) << "p99.9[us]" << std::setw(12) << "max[us]"
+                  << "\n";
+        row("generic", generic);
+        row("phase", phase);
+    }
+    catch (const std::exception& e)
+    {
+        std::cout << "Benchmark failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
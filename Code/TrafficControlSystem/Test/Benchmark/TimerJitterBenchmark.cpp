@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../../CppWrapper/CppWrapper.hpp"
+
+/* BENCHMARK
+ *  - Wake-up jitter of one-shot timers: time from the requested expiration until the waiting thread runs
+ *  - Legacy: POSIX interval timer w/ SIGEV_THREAD (a new thread per expiration), as Timer used to be
+ *  - Service: CppWrapper::Timer on the TimerService (timerfd + epoll, one thread)
+ *  - BENCH_TIMERS threads re-arm their own timer concurrently, with 0, 1x and 4x the CPUs busy spinning
+ *
+ *  Runs on the host (no GPIO/Cloud/DDS required):
+ *      g++ -std=c++20 -O2 Test/Benchmark/TimerJitterBenchmark.cpp CppWrapper/Timer_CppWrapper.cpp \
+ *          CppWrapper/TimerService_CppWrapper.cpp CppWrapper/Clock_CppWrapper.cpp CppWrapper/Thread_CppWrapper.cpp \
+ *          CppWrapper/Executor_CppWrapper.cpp CppWrapper/Mutex_CppWrapper.cpp CppWrapper/CondVar_CppWrapper.cpp \
+ *          -lrt -lpthread
+ */
+
+#define BENCH_TIMERS 4          // concurrent timers (one waiting thread each)
+#define BENCH_SAMPLES 250       // expirations per timer
+#define BENCH_PERIOD 0.002      // s, between arming and the expiration
+
+/*--- Legacy timer (SIGEV_THREAD) ------------------------------------------------------------------------------------*/
+class LegacyTimer
+{
+    timer_t timerid{};
+    CppWrapper::Mutex mutexTimer;
+    CppWrapper::CondVar condTimer;
+    int fired;
+
+    static void timerCallback(const union sigval sv)
+    {
+        const auto self = static_cast<LegacyTimer*>(sv.sival_ptr);
+        CppWrapper::LockGuard lock (self->mutexTimer);
+        self->fired = 1;
+        self->condTimer.condBroadcast();
+    }
+
+public:
+    LegacyTimer(): condTimer(mutexTimer), fired(0)
+    {
+        sigevent sev{};
+        sev.sigev_notify = SIGEV_THREAD;
+        sev.sigev_notify_function = timerCallback;
+        sev.sigev_value.sival_ptr = this;
+        if (timer_create(CLOCK_MONOTONIC, &sev, &timerid) != 0)
+            throw std::runtime_error("LegacyTimer: timer_create()");
+    }
+
+    ~LegacyTimer()
+    {
+        timer_delete(timerid);
+    }
+
+    void timerRun(const double value)
+    {
+        CppWrapper::LockGuard lock (mutexTimer);
+        fired = 0;
+        itimerspec its{};
+        its.it_value.tv_sec = static_cast<long>(value);
+        its.it_value.tv_nsec = static_cast<long>((value - its.it_value.tv_sec) * 1e9);
+        timer_settime(timerid, 0, &its, nullptr);
+    }
+
+    void timerWait()
+    {
+        CppWrapper::LockGuard lock (mutexTimer);
+        while (!fired)
+            condTimer.condWait();
+    }
+};
+
+/*--- Load -----------------------------------------------------------------------------------------------------------*/
+static std::atomic<bool> stopLoad{false};
+
+static void* t_spin(void*)
+{
+    volatile unsigned long x = 0;
+    while (!stopLoad.load(std::memory_order_relaxed))
+        x = x + 1;
+    return nullptr;
+}
+
+/*--- Measurement ----------------------------------------------------------------------------------------------------*/
+template <typename T>
+struct Waiter
+{
+    T timer;
+    std::vector<double> latencies;      // us
+
+    static void* t_wait(void* arg)
+    {
+        const auto self = static_cast<Waiter*>(arg);
+        const auto& clock = CppWrapper::MonotonicClock::instance();
+        for (int i = 0; i < BENCH_SAMPLES; ++i)
+        {
+            const double expiration = clock.now() + BENCH_PERIOD;
+            self->timer.timerRun(BENCH_PERIOD);
+            self->timer.timerWait();
+            self->latencies.push_back((clock.now() - expiration) * 1e6);
+        }
+        return nullptr;
+    }
+};
+
+template <typename T>
+static std::vector<double> measure(const unsigned busyThreads)
+{
+    stopLoad = false;
+    std::vector<std::unique_ptr<CppWrapper::Thread>> load;
+    for (unsigned i = 0; i < busyThreads; ++i)
+    {
+        load.push_back(std::make_unique<CppWrapper::Thread>(t_spin));
+        load.back()->run();
+    }
+
+    std::vector<std::unique_ptr<Waiter<T>>> waiters;
+    std::vector<std::unique_ptr<CppWrapper::Thread>> threads;
+    for (int i = 0; i < BENCH_TIMERS; ++i)
+    {
+        waiters.push_back(std::make_unique<Waiter<T>>());
+        threads.push_back(std::make_unique<CppWrapper::Thread>(Waiter<T>::t_wait));
+        threads.back()->run(waiters.back().get());
+    }
+    for (const auto& thread : threads)
+        thread->join();
+
+    stopLoad = true;
+    for (const auto& thread : load)
+        thread->join();
+
+    std::vector<double> latencies;
+    for (const auto& waiter : waiters)
+        latencies.insert(latencies.end(), waiter->latencies.begin(), waiter->latencies.end());
+    std::ranges::sort(latencies);
+    return latencies;
+}
+
+static double percentile(const std::vector<double>& sorted, const double p)
+{
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * static_cast<double>(sorted.size())))];
+}
+
+static void row(std::ostream& report, const char* name, const std::vector<double>& sorted)
+{
+    report << "  " << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(1)
+           << std::setw(12) << percentile(sorted, 0.5) << std::setw(12) << percentile(sorted, 0.99)
+           << std::setw(12) << percentile(sorted, 0.999) << std::setw(12) << sorted.back() << "\n";
+}
+
+int main()
+{
+    std::ostream report(std::cout.rdbuf());
+    std::cerr.rdbuf(nullptr);       // silences the Timer's own logging
+
+    const unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+
+    try
+    {
+        for (const unsigned busy : {0u, cpus, 4 * cpus})
+        {
+            report << std::defaultfloat << BENCH_TIMERS << " timers x " << BENCH_SAMPLES << " expirations ("
+                   << BENCH_PERIOD * 1e3 << " ms), " << busy << " busy threads on " << cpus << " CPUs\n";
+            report << "  " << std::left << std::setw(10) << "timer" << std::right << std::setw(12) << "p50[us]"
+                   << std::setw(12) << "p99[us]" << std::setw(12) << "p99.9[us]" << std::setw(12) << "max[us]"
+                   << "\n";
+            row(report, "legacy", measure<LegacyTimer>(busy));
+            row(report, "service", measure<CppWrapper::Timer>(busy));
+            report << std::endl;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        report << "Benchmark failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
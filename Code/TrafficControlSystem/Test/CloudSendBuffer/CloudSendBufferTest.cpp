@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "../../CloudInterface/CloudSendBuffer.hpp"
+
+/* TEST SET
+ *  - Coalescing: updates of the same (table, location) merge, the latest status wins and keeps the place of the
+ *    first; the TSEM and PSEM tables never merge
+ *  - Order: requests and status updates received in the order they were queued
+ *  - Bounds: status updates of more keys than CLOUD_STATUS_SLOTS, requests beyond CLOUD_REQUEST_SLOTS - dropped
+ *    as the policy says, counted per kind
+ *  - Outage: every head changing colour many times while nothing is received - the buffer stays at one
+ *    update per head, holding the last colours
+ *  - Interrupt: receive() drains, then returns false
+ *
+ *  Runs on the host (no GPIO/Cloud/DDS required); returns 0 if every check passes
+ */
+
+#define TEST_HEADS 16
+#define TEST_CHANGES 10000      // colour changes per head, outage
+
+static int failures = 0;
+
+static void check(const bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << what << "\n";
+        ++failures;
+    }
+}
+
+static tx_cloud::TrafficSemaphoreUpdate tsem(const int location, const int status)
+{
+    return {.location = location, .status = status};
+}
+
+static tx_cloud::PedestrianSemaphoreUpdate psem(const int location, const int status)
+{
+    return {.location = location, .status = status};
+}
+
+static std::vector<CloudSendType> drain(CloudSendBuffer& buffer)
+{
+    std::vector<CloudSendType> received;
+    CloudSendType message;
+    while (buffer.tryReceive(message))
+        received.push_back(message);
+    return received;
+}
+
+static void checkCoalescing()
+{
+    CloudSendBuffer buffer;
+    buffer.send(tsem(1, 1));
+    buffer.send(tsem(5, 1));
+    buffer.send(tsem(1, 2));        // yellow, then red: the Cloud only sees the red
+    buffer.send(tsem(1, 0));
+    buffer.send(psem(1, 1));        // same location, other table
+
+    const auto received = drain(buffer);
+    check(received.size() == 3, "updates of one key merged");
+    check(std::holds_alternative<tx_cloud::TrafficSemaphoreUpdate>(received[0]) &&
+        std::get<tx_cloud::TrafficSemaphoreUpdate>(received[0]).location == 1 &&
+        std::get<tx_cloud::TrafficSemaphoreUpdate>(received[0]).status == 0, "latest status, first place");
+    check(std::holds_alternative<tx_cloud::PedestrianSemaphoreUpdate>(received[2]), "tables kept apart");
+
+    const auto stats = buffer.counters();
+    check(stats.queued == 5 && stats.merged == 2, "merges counted");
+
+    buffer.send(tsem(1, 1));        // sent already: a new update
+    check(buffer.pending() == 1 && buffer.counters().merged == 2, "sent updates not merged");
+}
+
+static void checkOrder()
+{
+    CloudSendBuffer buffer;
+    buffer.send(tx_cloud::Configure{});
+    buffer.send(tsem(1, 1));
+    buffer.send(tx_cloud::ValidateRFID{3, 0xCAFE});
+    buffer.send(tsem(5, 1));
+    buffer.send(tx_cloud::EmergencyContext{"AMB-1", 1, 6, 2});
+
+    const auto received = drain(buffer);
+    const std::vector<size_t> expected = {0, 3, 2, 3, 1};
+    bool ordered = received.size() == expected.size();
+    for (size_t i = 0; ordered && i < received.size(); ++i)
+        ordered = received[i].index() == expected[i];
+    check(ordered, "received in queueing order");
+}
+
+static void checkBounds()
+{
+    CloudSendBuffer oldest;
+    for (int loc = 0; loc < 2 * CLOUD_STATUS_SLOTS; ++loc)
+        oldest.send(tsem(loc, 1));
+    auto received = drain(oldest);
+    check(received.size() == CLOUD_STATUS_SLOTS, "status updates bounded");
+    check(std::get<tx_cloud::TrafficSemaphoreUpdate>(received.front()).location == CLOUD_STATUS_SLOTS,
+        "DROP_OLDEST: newest updates kept");
+    check(oldest.counters().dropped[3] == CLOUD_STATUS_SLOTS, "status drops counted");
+
+    CloudSendBuffer newest;
+    newest.setDropPolicy(CloudSendBuffer::DropPolicy::DROP_NEWEST, CloudSendBuffer::DropPolicy::DROP_NEWEST);
+    for (int i = 0; i < 2 * CLOUD_REQUEST_SLOTS; ++i)
+        newest.send(tx_cloud::ValidateRFID{i, 0xCAFE});
+    received = drain(newest);
+    check(received.size() == CLOUD_REQUEST_SLOTS, "requests bounded");
+    check(std::get<tx_cloud::ValidateRFID>(received.back()).location == CLOUD_REQUEST_SLOTS - 1,
+        "DROP_NEWEST: oldest requests kept");
+
+    const auto stats = newest.counters();
+    check(stats.dropped[2] == CLOUD_REQUEST_SLOTS && stats.dropped[3] == 0, "request drops counted per kind");
+}
+
+static void checkOutage()
+{
+    CloudSendBuffer buffer;
+    size_t peak = 0;
+    for (int change = 0; change < TEST_CHANGES; ++change)
+    {
+        for (int head = 0; head < TEST_HEADS; ++head)
+            buffer.send(tsem(head, change % 3));
+        peak = std::max(peak, buffer.pending());
+    }
+
+    const auto received = drain(buffer);
+    bool latest = received.size() == TEST_HEADS;
+    for (const auto& message : received)
+        latest = latest && std::get<tx_cloud::TrafficSemaphoreUpdate>(message).status == (TEST_CHANGES - 1) % 3;
+
+    check(peak == TEST_HEADS, "outage: one update per head pending");
+    check(latest, "outage: last colours sent");
+    const auto stats = buffer.counters();
+    check(stats.merged == static_cast<uint64_t>(TEST_HEADS) * (TEST_CHANGES - 1) && stats.dropped[3] == 0,
+        "outage: merged, none dropped");
+}
+
+static void checkInterrupt()
+{
+    CloudSendBuffer buffer;
+    buffer.send(tsem(1, 1));
+    buffer.interrupt();
+
+    CloudSendType message;
+    check(buffer.receive(message), "interrupted: pending messages still received");
+    check(!buffer.receive(message), "interrupted and drained: receive returns false");
+}
+
+int main()
+{
+    try
+    {
+        checkCoalescing();
+        checkOrder();
+        checkBounds();
+        checkOutage();
+        checkInterrupt();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Cloud send buffer test failed: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::cout << (failures ? "FAILED" : "All cloud send buffer checks passed") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,60 @@
+#ifndef TRAFFICCONTROLSYSTEM_TESTINTERSECTION_HPP
+#define TRAFFICCONTROLSYSTEM_TESTINTERSECTION_HPP
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "../../TrafficControlSystem.hpp"
+
+/*
+ *  Shared by the host tests of the Traffic Control System (Preemption, GreenWave, Failure, EventPath)
+ *   *  check(): counts and reports a failed condition; the tests return failures ? 1 : 0
+ *   *  The Intersection they load: 4 arms, as in the simulation - 4k+1 approach, 4k+2 exit, crosswalks on arms
+ *      0 and 2; approaches only go straight (2 phases, each with a pair of opposite approaches)
+ */
+
+inline int failures = 0;
+inline std::ostream failed(std::cerr.rdbuf());     // the system's own logging (cerr) is silenced
+
+inline void check(const bool condition, const char* what)
+{
+    if (!condition)
+    {
+        failed << "FAILED: " << what << "\n";
+        ++failures;
+    }
+}
+
+// TSEMs on pins 1..12
+inline std::shared_ptr<json> makeTsem()
+{
+    auto tsem = std::make_shared<json>(json::array());
+    int pin = 1;
+    for (int k = 0; k < 4; ++k)
+    {
+        tsem->push_back({
+            {"name", "TS" + std::to_string(k)}, {"location", 4 * k + 1},
+            {"destinations", {4 * ((k + 2) % 4) + 2}},
+            {"gpio_red", pin}, {"gpio_green", pin + 1}, {"gpio_yellow", pin + 2}});
+        pin += 3;
+    }
+    return tsem;
+}
+
+// PSEMs on pins 20..27, no button, card reader nor buzzer
+inline std::shared_ptr<json> makePsem()
+{
+    auto psem = std::make_shared<json>(json::array());
+    int pin = 20;
+    for (const int loc : {0, 3, 8, 11})
+    {
+        psem->push_back({
+            {"name", "PS" + std::to_string(loc)}, {"location", loc}, {"gpio_red", pin}, {"gpio_green", pin + 1},
+            {"hasButton", 0}, {"hasCardReader", 0}, {"hasBuzzer", 0}});
+        pin += 2;
+    }
+    return psem;
+}
+
+#endif //TRAFFICCONTROLSYSTEM_TESTINTERSECTION_HPP
@@ -0,0 +1,19 @@
+#ifndef TRAFFICCONTROLSYSTEM_TRAFFICCONTROLSYSTEMTESTACCESS_HPP
+#define TRAFFICCONTROLSYSTEM_TRAFFICCONTROLSYSTEMTESTACCESS_HPP
+
+#include "../../TrafficControlSystem.hpp"
+
+/*
+ *  The host tests' only seam into the Traffic Control System: TrafficControlSystem befriends this template and
+ *  nothing else, so it never names a test. Each test (or benchmark) specializes it on a tag of its own:
+ *
+ *      struct FailureMode;
+ *      template <> struct TrafficControlSystemTestAccess<FailureMode> { ... };
+ *      using FailureModeTest = TrafficControlSystemTestAccess<FailureMode>;
+ *
+ *  Included by test translation units only
+ */
+template <typename Test>
+struct TrafficControlSystemTestAccess;
+
+#endif //TRAFFICCONTROLSYSTEM_TRAFFICCONTROLSYSTEMTESTACCESS_HPP
@@ -0,0 +1,185 @@
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../../ConflictGraph/ConflictGraph.hpp"
+#include "../../ConflictGraph/ConfigurationEngine.hpp"
+#include "../../ConflictGraph/ConfigurationIndex.hpp"
+
+/* TEST SET
+ *  - Bron-Kerbosch enumeration returns exactly the Configurations of the backtracking search (same order)
+ *  - Every Configuration is an independent and maximal set, reported only once
+ *  - Parallel enumeration (2 to 4 workers) returns exactly the serial output, for both algorithms
+ *  - Incremental maintenance (removing a Location, then adding it back) matches a full enumeration
+ *  - The Location index reports exactly the Configurations holding each Location
+ *
+ *  Runs on the host (no GPIO/Cloud/DDS required); returns 0 if every check passes
+ */
+
+#define TEST_SEED 7
+#define GRAPHS_PER_SIZE 20
+
+static bool checkIncremental(const ConflictGraph& graph, const LocationSet& vertices,
+    const std::vector<LocationSet>& configurations);
+
+static bool checkIndex(const ConflictGraph& graph, const std::vector<LocationSet>& configurations);
+
+static bool checkParallel(const ConflictGraph& graph, const LocationSet& vertices,
+    const std::vector<LocationSet>& configurations);
+
+static bool checkGraph(const ConflictGraph& graph, const LocationSet& vertices)
+{
+    const ConfigurationEngine engine(graph);
+    const auto reference = engine.enumerate(vertices, ConfigurationEngine::Algorithm::BACKTRACK);
+    const auto candidate = engine.enumerate(vertices, ConfigurationEngine::Algorithm::BRON_KERBOSCH);
+
+    if (reference != candidate)
+    {
+        std::cerr << "Different output: backtrack " << reference.size()
+                  << " sets, bron-kerbosch " << candidate.size() << " sets\n";
+        return false;
+    }
+
+    for (size_t i = 0; i < candidate.size(); ++i)
+    {
+        if (!graph.isIndependent(candidate[i]) || !graph.isMaximal(candidate[i], vertices))
+        {
+            std::cerr << "Configuration " << i << " is not a maximal independent set\n";
+            return false;
+        }
+        if (i > 0 && !ConfigurationEngine::canonicalOrder(candidate[i - 1], candidate[i]))
+        {
+            std::cerr << "Configuration " << i << " is repeated or out of order\n";
+            return false;
+        }
+    }
+    return checkParallel(graph, vertices, reference) && checkIndex(graph, candidate)
+        && checkIncremental(graph, vertices, reference);
+}
+
+static bool checkParallel(const ConflictGraph& graph, const LocationSet& vertices,
+    const std::vector<LocationSet>& configurations)
+{
+    const ConfigurationEngine engine(graph);
+
+    for (const auto algorithm : {ConfigurationEngine::Algorithm::BACKTRACK, ConfigurationEngine::Algorithm::BRON_KERBOSCH})
+    {
+        for (const unsigned workers : {2u, 3u, 4u})
+        {
+            if (engine.enumerate(vertices, algorithm, workers) != configurations)
+            {
+                std::cerr << "Parallel enumeration (" << workers << " workers, "
+                          << (algorithm == ConfigurationEngine::Algorithm::BACKTRACK ? "backtrack" : "bron-kerbosch")
+                          << ") differs from the serial one\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool checkIndex(const ConflictGraph& graph, const std::vector<LocationSet>& configurations)
+{
+    ConfigurationIndex index;
+    index.build(configurations, graph.size());
+
+    for (int loc = 0; loc < static_cast<int>(graph.size()); ++loc)
+    {
+        std::vector<int> serving;
+        index.forEachServing(loc, [&serving](const int config) { serving.push_back(config); });
+
+        std::vector<int> expected;
+        for (int c = 0; c < static_cast<int>(configurations.size()); ++c)
+            if (configurations[c].test(loc))
+                expected.push_back(c);
+
+        if (serving != expected)
+        {
+            std::cerr << "Location index of " << loc << " is wrong\n";
+            return false;
+        }
+        for (const int c : expected)
+            if (!index.serves(loc, c))
+                return false;
+    }
+    return true;
+}
+
+static bool checkIncremental(const ConflictGraph& graph, const LocationSet& vertices,
+    const std::vector<LocationSet>& configurations)
+{
+    if (vertices.none())
+        return true;
+
+    // Location in the middle of the vertices
+    int loc = -1;
+    int remaining = static_cast<int>(vertices.count()) / 2;
+    vertices.forEach([&](const int v) { if (remaining-- == 0) loc = v; });
+
+    // Remove
+    ConflictGraph reduced = graph;
+    reduced.clearVertex(loc);
+    LocationSet reducedVertices = vertices;
+    reducedVertices.reset(loc);
+
+    const ConfigurationEngine reducedEngine(reduced);
+    const auto removed = reducedEngine.removeVertex(configurations, reducedVertices, loc);
+    if (removed != reducedEngine.enumerate(reducedVertices, ConfigurationEngine::Algorithm::BRON_KERBOSCH))
+    {
+        std::cerr << "Incremental removal of Location " << loc << " differs from a full enumeration\n";
+        return false;
+    }
+
+    // Add it back (on the original graph)
+    const ConfigurationEngine engine(graph);
+    if (engine.addVertex(removed, vertices, loc) != configurations)
+    {
+        std::cerr << "Incremental addition of Location " << loc << " differs from a full enumeration\n";
+        return false;
+    }
+    return true;
+}
+
+int main()
+{
+    std::mt19937 rng(TEST_SEED);
+    int failures = 0;
+    int checked = 0;
+
+    for (const int n : {1, 4, 8, 16, 24, 40, 64, 70})
+    {
+        for (const double density : {0.2, 0.5, 0.8})
+        {
+            for (int g = 0; g < GRAPHS_PER_SIZE; ++g)
+            {
+                std::bernoulli_distribution conflict(density);
+                std::bernoulli_distribution used(0.9);  // some Locations are unused (not vertices)
+
+                ConflictGraph graph(n);
+                LocationSet vertices = graph.emptySet();
+                for (int a = 0; a < n; ++a)
+                {
+                    if (used(rng))
+                        vertices.set(a);
+                    for (int b = a + 1; b < n; ++b)
+                        if (conflict(rng))
+                            graph.addConflict(a, b);
+                }
+
+                // Sparse big graphs have too many compatible sets for the backtracking search
+                if (n > 24 && density < 0.5)
+                    continue;
+
+                ++checked;
+                if (!checkGraph(graph, vertices))
+                {
+                    std::cerr << "FAILED: " << n << " locations, density " << density << "\n";
+                    ++failures;
+                }
+            }
+        }
+    }
+
+    std::cout << checked - failures << "/" << checked << " graphs passed\n";
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,116 @@
+#include <iostream>
+#include <vector>
+
+#include "../../Emergency/EmergencyArbiter.hpp"
+
+/* TEST SET
+ *  - Arrivals: an EV is keyed by its sender_id; its periodic samples only refresh it
+ *  - Ranking: higher priority first, then arrival order (kept when refreshed)
+ *  - Preemption: EVs whose origins one Configuration serves are merged; the others wait (by rank); the current
+ *    Configuration is kept if it serves them; the precomputed emergency Configuration is preferred
+ *
+ *  Runs on the host (no GPIO/Cloud/DDS required); returns 0 if every check passes
+ */
+
+#define TEST_LOCATIONS 8
+
+static int failures = 0;
+
+static void check(const bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << what << "\n";
+        ++failures;
+    }
+}
+
+/*  Configurations (Locations ON):
+ *      0: {1, 3}   1: {1, 5}   2: {3}   3: {5, 2}   4: {1}
+ *  Origins 1 and 3 are compatible (0), 1 and 5 too (1); 3 and 5 conflict
+ */
+static ConfigurationIndex makeIndex()
+{
+    const std::vector<std::vector<int>> on = {{1, 3}, {1, 5}, {3}, {5, 2}, {1}};
+    std::vector<LocationSet> sets;
+    for (const auto& locations : on)
+    {
+        sets.emplace_back(TEST_LOCATIONS);
+        for (const int loc : locations)
+            sets.back().set(loc);
+    }
+
+    ConfigurationIndex index;
+    index.build(sets, TEST_LOCATIONS);
+    index.setEmergency(1, 6, 4);
+    index.setEmergency(5, 6, 3);
+    return index;
+}
+
+static void checkArrivals()
+{
+    EmergencyArbiter arbiter;
+    check(arbiter.arrive("AMB-1", 1, 6, 2), "new EV");
+    check(!arbiter.arrive("AMB-1", 1, 6, 2), "same sample: no change");
+    check(arbiter.arrive("AMB-1", 1, 6, 3), "priority changed");
+    check(arbiter.size() == 1 && arbiter.find("AMB-1")->priority == 3, "refreshed, not duplicated");
+
+    check(!arbiter.leave("FIRE-9"), "unknown EV leaving");
+    check(arbiter.leave("AMB-1") && arbiter.empty(), "EV left");
+}
+
+static void checkRanking()
+{
+    EmergencyArbiter arbiter;
+    arbiter.arrive("A", 1, 6, 1);
+    arbiter.arrive("B", 3, 6, 2);
+    arbiter.arrive("C", 5, 6, 2);
+    arbiter.arrive("A", 1, 6, 1);       // refreshed: still the first to arrive
+
+    const auto order = arbiter.ranked();
+    check(order.size() == 3, "ranked: every EV");
+    check(order[0]->id == "B" && order[1]->id == "C" && order[2]->id == "A", "ranked: priority, then arrival");
+}
+
+static void checkPreemption()
+{
+    const ConfigurationIndex index = makeIndex();
+    std::vector<const EmergencyVehicle*> merged;
+
+    EmergencyArbiter arbiter;
+    check(arbiter.preempt(index, 2, &merged) == -1 && merged.empty(), "no EV: no preemption");
+
+    arbiter.arrive("A", 1, 6, 1);
+    check(arbiter.preempt(index, 2, &merged) == 4, "one EV: its emergency Configuration");
+    check(arbiter.preempt(index, 0, &merged) == 0, "one EV: current Configuration kept if it serves it");
+
+    arbiter.arrive("B", 3, 6, 1);
+    check(arbiter.preempt(index, 2, &merged) == 0 && merged.size() == 2, "compatible EVs merged");
+
+    arbiter.arrive("C", 5, 6, 1);       // conflicts with B: waits
+    check(arbiter.preempt(index, 2, &merged) == 0 && merged.size() == 2 && merged[1]->id == "B",
+        "conflicting EV waits for the ones ahead");
+
+    arbiter.arrive("C", 5, 6, 3);       // now the highest priority: B waits instead
+    check(arbiter.preempt(index, 2, &merged) == 1 && merged.size() == 2 && merged[0]->id == "C" &&
+          merged[1]->id == "A", "higher priority takes the preemption over");
+
+    arbiter.leave("C");
+    check(arbiter.preempt(index, 1, &merged) == 0, "EVs waiting get the preemption when it leaves");
+
+    arbiter.clear();
+    arbiter.arrive("D", 7, 6, 5);       // not a TSEM Location: served by no Configuration
+    arbiter.arrive("E", 3, 6, 1);
+    check(arbiter.preempt(index, 4, &merged) == 0 && merged.size() == 1 && merged[0]->id == "E",
+        "EV without a Configuration skipped");
+}
+
+int main()
+{
+    checkArrivals();
+    checkRanking();
+    checkPreemption();
+
+    std::cout << (failures ? "FAILED" : "All emergency arbiter checks passed") << std::endl;
+    return failures ? 1 : 0;
+}
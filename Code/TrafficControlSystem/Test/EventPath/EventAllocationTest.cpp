@@ -0,0 +1,341 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+
+#include "../../TrafficControlSystem.hpp"
+#include "../Common/TestIntersection.hpp"
+#include "../Common/TrafficControlSystemTestAccess.hpp"
+#include "../../Messages/EventPayloads.hpp"
+
+/* TEST SET
+ *  - Event: trivially copyable, one cache line; hot events (internal, button, RFID, vehicle, EV, green wave)
+ *    built, queued (MpscQueue) and received without a heap allocation
+ *  - Identifiers (EV sender_id, Intersection names): one that would be truncated is rejected, so two of them
+ *    sharing the stored prefix never compare equal (DDS samples, green wave configuration)
+ *  - Bulky payloads (configuration files) by handle: taken once, slots reused, exhausted -> -EAGAIN; a
+ *    configuration file after set up (Normal, Failure) frees its slot
+ *  - Steady state: a TCS in Normal operation on virtual time (phase switches, vehicle, button and card calls,
+ *    cycle reports) - after a warm-up, zero heap allocations per event handled
+ *  - Full event queue: notify() never waits - another thread's event is dropped and counted (-EAGAIN), the
+ *    TCS thread's own (NEW_STATE_ENTERED) is still handled. Calls flooding it leave EVENT_QUEUE_RESERVE slots
+ *    to the EV and phase timing events; a full phase queue drops a transition instead of waiting
+ *
+ *  Host build (target EventAllocationTest): global operator new counts the allocations; GPIO is stubbed by
+ *  Test/Benchmark/Stubs/rasp_gpio_stub.cpp, the Cloud and DDS objects are created but never started;
+ *  returns 0 if every check passes
+ */
+
+#ifndef PLAN_CACHE_PATH
+#error "PLAN_CACHE_PATH must point to a scratch file (set by the EventAllocationTest target)"
+#endif
+
+#define TEST_SEED 22
+#define TEST_PINS 128
+#define TEST_EVENTS 1000        // hot events queued and received
+#define WARM_UP 900.0           // s of Normal operation before counting
+#define STEADY_RUN 1800.0       // s of Normal operation counted
+#define CALL_GAP_MAX 3.0        // s between two calls
+
+/*--- Allocation counter ---------------------------------------------------------------------------------------------*/
+static std::atomic<uint64_t> allocations{0};
+
+void* operator new(const std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](const std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    const auto align = static_cast<std::size_t>(alignment);
+    if (void* p = std::aligned_alloc(align, (size + align - 1) / align * align))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](const std::size_t size, const std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+/*--- Checks ---------------------------------------------------------------------------------------------------------*/
+static Event hotEvent(const int i)
+{
+    switch (i % 6)
+    {
+    case 0:  return InternalEvent::LIGHTS_TIMEOUT;
+    case 1:  return PedestrianButtonEvent{i % 16};
+    case 2:  return PedestrianRFIDEvent{i % 16, 0xCAFE0000u + static_cast<uint32_t>(i)};
+    case 3:  return VehicleDetectorEvent{i % 16};
+    case 4:  return DDSEvent{DDS_Event_Qualifier::EMERGENCY_START, "AMB-1234-XY", 1, 10, 2};
+    default: return GreenWaveEvent{"intersection-7", i % 4, 90, 12.5};
+    }
+}
+
+static void checkHotEvents()
+{
+    CppWrapper::MpscQueue<Event, 64> queue;
+    const uint64_t before = allocations.load();
+
+    int received = 0;
+    for (int i = 0; i < TEST_EVENTS; ++i)
+    {
+        queue.send(hotEvent(i));
+        Event event;
+        received += queue.tryReceive(event) && event.index() == hotEvent(i).index();
+    }
+    const Event plate = DDSEvent{DDS_Event_Qualifier::EMERGENCY_FINISH, "AMB-1234-XY"};
+    const bool same = std::get<DDSEvent>(plate).license_plate == "AMB-1234-XY";
+
+    check(allocations.load() == before, "hot events built, queued and received without allocating");
+    check(received == TEST_EVENTS && same, "hot events received intact");
+
+    const std::string longest(EVENT_TEXT_SIZE - 1, 'x');
+    check(EventText::fits(longest) && EventText(longest) == longest, "longest identifier stored whole");
+    check(EventText(longest + "1") == EventText(longest + "2").view() &&
+        !EventText::fits(longest + "1") && !EventText::fits(longest + "2"),
+        "identifiers sharing the stored prefix rejected");
+    check(!EventText::fits(std::string("AMB\0-1", 6)), "identifier cut short by a NUL rejected");
+}
+
+static void checkPayloads()
+{
+    auto& payloads = EventPayloads::instance();
+    const int file = payloads.put(std::make_shared<json>(json::array({1, 2})));
+    const Event event = CloudReceiveType{rx_cloud::TSEM_data{file}};
+
+    const auto taken = payloads.take(std::get<rx_cloud::TSEM_data>(std::get<CloudReceiveType>(event)).file);
+    check(file >= 0 && taken && taken->size() == 2, "payload taken by handle");
+    check(!payloads.take(file), "payload taken once");
+
+    int handles[EVENT_PAYLOADS];
+    for (int& handle : handles)
+        handle = payloads.put(nullptr);
+    check(handles[0] == file && payloads.put(nullptr) == -EAGAIN, "slots reused, exhausted: -EAGAIN");
+    for (const int handle : handles)
+        payloads.take(handle);
+}
+
+struct EventAllocation;
+
+template <>
+struct TrafficControlSystemTestAccess<EventAllocation>
+{
+    TrafficControlSystem& tcs;
+    CppWrapper::VirtualClock& clock;
+    uint64_t handled = 0;
+
+    void start() const
+    {
+        tcs.useClock(clock);
+        for (int pin = 1; pin < TEST_PINS; ++pin)
+            tcs.availableGPIOs.push_back(pin);
+        tcs.createComponents(makeTsem());
+        tcs.createComponents(makePsem());
+        tcs.findConfigurations();
+
+        tcs.greenTime = std::make_unique<ActuatedGreenTime>();
+        tcs.switchLightQueue.send(tcs.systemWarning());
+        tcs.switch_state(TrafficControlSystem::SystemState::NORMAL);
+    }
+
+    void runControlLoop()
+    {
+        bool progress = true;
+        while (progress)
+        {
+            progress = false;
+
+            TrafficControlSystem::QueuedEvent queued;
+            while (tcs.eventQueue.tryReceive(queued))
+            {
+                tcs.handleEvent(queued);
+                ++handled;
+                progress = true;
+            }
+
+            TrafficControlSystem::PhaseCommand command;
+            while (tcs.switchLightQueue.tryReceive(command))
+            {
+                tcs.runPhase(command);
+                progress = true;
+            }
+        }
+
+        CloudSendType message;      // the Cloud is not running
+        while (tcs.cloud.cloudSendQueue.tryReceive(message)) {}
+    }
+
+    void runUntil(const double time)
+    {
+        runControlLoop();
+        while (clock.nextDeadline() <= time)
+        {
+            clock.advanceTo(clock.nextDeadline());
+            runControlLoop();
+        }
+        clock.advanceTo(time);
+        runControlLoop();
+    }
+
+    // Calls of every kind at random instants
+    void operate(std::mt19937& rng, const double duration)
+    {
+        std::uniform_real_distribution<double> gap(0, CALL_GAP_MAX);
+        std::uniform_int_distribution<size_t> tsem(0, tcs.TrafficSemVector.size() - 1);
+        std::uniform_int_distribution<size_t> psem(0, tcs.PedestrianSemVector.size() - 1);
+        std::uniform_int_distribution<int> kind(0, 4);
+
+        const double end = clock.now() + duration;
+        while (clock.now() < end)
+        {
+            runUntil(clock.now() + gap(rng));
+            const int crosswalk = tcs.PedestrianSemVector[psem(rng)]->getLocation();
+            switch (kind(rng))
+            {
+            case 0:  tcs.notify(nullptr, PedestrianButtonEvent{crosswalk}); break;
+            case 1:  tcs.notify(nullptr, PedestrianRFIDEvent{crosswalk, 0xCAFE}); break;
+            case 2:  tcs.notify(nullptr, CloudReceiveType{rx_cloud::RFID_Validation{true, crosswalk}}); break;
+            case 3:  tcs.notify(nullptr, GreenWaveEvent{"upstream", 0, 90, 0}); break;
+            default: tcs.notify(nullptr, VehicleDetectorEvent{tcs.TrafficSemVector[tsem(rng)]->getLocation()}); break;
+            }
+        }
+    }
+
+    // Heap allocations while operating, after a warm-up (and the events handled meanwhile)
+    std::pair<uint64_t, uint64_t> steadyState(std::mt19937& rng)
+    {
+        start();
+        operate(rng, WARM_UP);
+
+        const uint64_t before = allocations.load();
+        const uint64_t handledBefore = handled;
+        operate(rng, STEADY_RUN);
+        return {allocations.load() - before, handled - handledBefore};
+    }
+
+    // Configuration file in the current state (not SET_UP): dropped, its payload slot freed
+    void checkDroppedFile(const char* what) const
+    {
+        auto& payloads = EventPayloads::instance();
+        const int file = payloads.put(nullptr);
+        TrafficControlSystem::QueuedEvent queued = tcs.stamp(CloudReceiveType{rx_cloud::PSEM_data{file}});
+        tcs.handleEvent(queued);
+        check(file >= 0 && !payloads.take(file), what);
+    }
+
+    // Cycle reports are told apart by Intersection name: a name that would be truncated is not configured
+    void checkLongName() const
+    {
+        bool rejected = false;
+        try
+        {
+            tcs.componentFactory[TrafficControlSystem::Components::GREEN_WAVE](json{{"location", 0},
+                {"upstream", std::string(EVENT_TEXT_SIZE, 'x')}, {"offset", 0}});
+        }
+        catch (const std::runtime_error&)
+        {
+            rejected = true;
+        }
+        check(rejected && !tcs.greenWaveLink, "green wave: upstream name longer than an identifier rejected");
+    }
+
+    // Last: leaves the system in FAILURE
+    void fullQueue()
+    {
+        runControlLoop();       // from an empty queue
+        int calls = 0;
+        while (tcs.notify(nullptr, PedestrianButtonEvent{0}) == 0)
+            ++calls;
+        check(calls == EVENT_QUEUE_CAPACITY - EVENT_QUEUE_RESERVE, "call flood: the reserved slots left free");
+        check(tcs.notify(nullptr, DDSEvent{DDS_Event_Qualifier::EMERGENCY_FINISH, "AMB-1234-XY"}) == 0 &&
+            tcs.notify(nullptr, InternalEvent::LIGHTS_TIMEOUT) == 0, "call flood: EV and phase timing events queued");
+
+        int reserved = 2;
+        while (tcs.notify(nullptr, InternalEvent::YELLOW_TIMEOUT) == 0)     // ignored in NORMAL
+            ++reserved;
+        check(reserved == EVENT_QUEUE_RESERVE, "reserved slots: taken by phase timing events only");
+        const uint64_t dropped = tcs.eventsDropped();
+        check(tcs.notify(nullptr, PedestrianButtonEvent{0}) == -EAGAIN, "full queue: notify() returns -EAGAIN");
+        check(tcs.eventsDropped() == dropped + 1, "full queue: dropped event counted");
+
+        TrafficControlSystem::PhaseCommand command;
+        while (tcs.switchLightQueue.trySend(TrafficControlSystem::PhaseTimeout{})) {}
+        check(!tcs.queueTransition(tcs.systemWarning()), "full phase queue: transition dropped, not waited for");
+        while (tcs.switchLightQueue.tryReceive(command)) {}
+
+        TrafficControlSystem::QueuedEvent failure = tcs.stamp(InternalEvent::FAILURE_DETECTED);
+        tcs.handleEvent(failure);       // NORMAL -> FAILURE: NEW_STATE_ENTERED, to itself
+        check(tcs.failed, "full queue: own NEW_STATE_ENTERED handled");
+        check(tcs.eventsDropped() == dropped + 1, "full queue: own event not dropped");
+
+        TrafficControlSystem::QueuedEvent queued;
+        while (tcs.eventQueue.tryReceive(queued)) {}
+    }
+
+    static size_t queuedSize() { return sizeof(TrafficControlSystem::QueuedEvent); }
+};
+using EventAllocationTest = TrafficControlSystemTestAccess<EventAllocation>;
+
+int main()
+{
+    std::ostream report(std::cout.rdbuf());
+    std::cout.rdbuf(nullptr);       // silences the system's own logging
+    std::cerr.rdbuf(nullptr);
+
+    report << "sizeof(Event) " << sizeof(Event) << " B, sizeof(QueuedEvent) "
+           << EventAllocationTest::queuedSize() << " B\n";
+
+    checkHotEvents();
+    checkPayloads();
+
+    CppWrapper::VirtualClock clock;
+    EventAllocationTest test{TrafficControlSystem::getInstance(), clock};
+    std::mt19937 rng(TEST_SEED);
+    try
+    {
+        const auto [allocated, events] = test.steadyState(rng);
+        check(events > 0, "steady state: events handled");
+        check(allocated == 0, "steady state: no heap allocation per event");
+        report << events << " events handled in " << STEADY_RUN << " s of Normal operation: " << allocated
+               << " heap allocations\n";
+
+        test.checkDroppedFile("NORMAL: configuration file payload freed");
+        test.checkLongName();
+        test.fullQueue();
+        test.checkDroppedFile("FAILURE: configuration file payload freed");
+    }
+    catch (const std::exception& e)
+    {
+        report << "Event allocation test failed: " << e.what() << "\n";
+        failures = 1;
+    }
+
+    report << (failures ? "FAILED" : "All event allocation checks passed") << std::endl;
+
+    std::remove(PLAN_CACHE_PATH);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,360 @@
+#include <cstdio>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "../../TrafficControlSystem.hpp"
+#include "../Common/TestIntersection.hpp"
+#include "../Common/TrafficControlSystemTestAccess.hpp"
+#include "../Benchmark/Stubs/rasp_gpio_stub.hpp"
+#include "../../GPIOHandling/rasp_gpio.hpp"
+
+/* TEST SET
+ *  - Periodic Timer on virtual time: one expiration per period, none once cancelled
+ *  - Normal operation (vehicle calls) for several minutes: the Watchdog never trips
+ *  - Event consumer wedged (TCS thread stops handling events, t_switchLight keeps running): EVENT_STALL within
+ *    WATCHDOG_STALL + WATCHDOG_PERIOD. The lights flash at once, without the TCS thread: every TSEM yellow in
+ *    lockstep (one commit per half period), red, green and crosswalks dark; phase commands are ignored. Once the
+ *    TCS thread runs again, the system is in FAILURE and still flashing
+ *  - Phase machine wedged (t_switchLight stops, no event waiting): PHASE_DEADLINE within the green's deadline +
+ *    WATCHDOG_GRACE + WATCHDOG_PERIOD
+ *  - Phase step wedged inside the GPIO lock (its commit never returns): detected in the same bound; the flash
+ *    never waits for the lock - the timers keep expiring, nothing is committed until it is free, then the lights
+ *    flash (the phase machine, running again, commits nothing)
+ *
+ *  Host build (target FailureModeTest): GPIO is stubbed by Test/Benchmark/Stubs/rasp_gpio_stub.cpp (its lines
+ *  are read back), the Cloud and DDS objects are created but never started; returns 0 if every check passes
+ */
+
+#ifndef PLAN_CACHE_PATH
+#error "PLAN_CACHE_PATH must point to a scratch file (set by the FailureModeTest target)"
+#endif
+
+#define TEST_SEED 20
+#define TEST_PINS 128
+#define NORMAL_RUN 600.0        // s of Normal operation, watched
+#define VEHICLE_GAP_MAX 4.0     // s between two vehicle calls
+#define FLASH_CHECKS 12         // half periods observed
+#define WEDGE_LIMIT 60.0        // s: not detected by then - failed
+
+static constexpr double epsilon = 1e-6;
+
+static void tick(void* arg)
+{
+    ++*static_cast<int*>(arg);
+}
+
+static void checkPeriodicTimer()
+{
+    CppWrapper::VirtualClock clock;
+    CppWrapper::Timer timer;
+    int expirations = 0;
+    timer.useClock(clock);
+    timer.onExpire(tick, &expirations);
+
+    timer.timerRunPeriodic(0.5);
+    clock.advanceTo(2.0);
+    check(expirations == 4 && timer.hasFired(), "periodic Timer: one expiration per period");
+    check(clock.nextDeadline() == 2.5, "periodic Timer: still armed");
+
+    timer.cancel();
+    clock.advanceTo(10.0);
+    check(expirations == 4, "periodic Timer: none once cancelled");
+
+    bool thrown = false;
+    try
+    {
+        timer.timerRunPeriodic(0);
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    check(thrown, "periodic Timer: a period is required");
+}
+
+struct FailureMode;
+
+template <>
+struct TrafficControlSystemTestAccess<FailureMode>
+{
+    using Colour = Semaphore::TrafficColour;
+    using Fault = Watchdog::Fault;
+
+    TrafficControlSystem& tcs;
+    CppWrapper::VirtualClock& clock;
+
+    bool handleEvents = true;       // false: TCS thread wedged
+    bool runPhases = true;          // false: t_switchLight wedged
+
+    void start() const
+    {
+        tcs.useClock(clock);
+        for (int pin = 1; pin < TEST_PINS; ++pin)
+            tcs.availableGPIOs.push_back(pin);
+        tcs.createComponents(makeTsem());
+        tcs.createComponents(makePsem());
+        tcs.findConfigurations();
+
+        tcs.greenTime = std::make_unique<FixedGreenTime>();
+        tcs.switchLightQueue.send(tcs.systemWarning());
+        tcs.switch_state(TrafficControlSystem::SystemState::NORMAL);
+        tcs.startWatchdog();
+    }
+
+    // What the threads not wedged have ready at the current (virtual) instant
+    void runControlLoop() const
+    {
+        bool progress = true;
+        while (progress)
+        {
+            progress = false;
+
+            TrafficControlSystem::QueuedEvent queued;
+            while (handleEvents && tcs.eventQueue.tryReceive(queued))
+            {
+                tcs.handleEvent(queued);
+                progress = true;
+            }
+
+            TrafficControlSystem::PhaseCommand command;
+            while (runPhases && tcs.switchLightQueue.tryReceive(command))
+            {
+                tcs.runPhase(command);
+                progress = true;
+            }
+        }
+
+        CloudSendType message;      // the Cloud is not running
+        while (tcs.cloud.cloudSendQueue.tryReceive(message)) {}
+    }
+
+    // Runs until 'time', or until 'until' holds: the instant it holds (infinity if it never does)
+    template <typename Predicate>
+    double runUntil(const double time, Predicate until) const
+    {
+        runControlLoop();
+        while (!until())
+        {
+            const double next = clock.nextDeadline();
+            if (next > time)
+            {
+                clock.advanceTo(time);
+                runControlLoop();
+                return until() ? clock.now() : std::numeric_limits<double>::infinity();
+            }
+            clock.advanceTo(next);
+            runControlLoop();
+        }
+        return clock.now();
+    }
+
+    [[nodiscard]] uint64_t pins(const Colour colour) const
+    {
+        uint64_t lines = 0;
+        for (const auto& tsem : tcs.TrafficSemVector)
+            lines |= uint64_t{1} << tsem->getPin(colour);
+        return lines;
+    }
+
+    [[nodiscard]] uint64_t crosswalkPins() const
+    {
+        uint64_t lines = 0;
+        for (const auto& psem : tcs.PedestrianSemVector)
+            for (const int pin : psem->getPins())
+                lines |= uint64_t{1} << pin;
+        return lines;
+    }
+
+    void normalOperation(std::mt19937& rng) const
+    {
+        std::uniform_real_distribution<double> gap(0, VEHICLE_GAP_MAX);
+        std::uniform_int_distribution<size_t> approach(0, tcs.TrafficSemVector.size() - 1);
+
+        const double end = clock.now() + NORMAL_RUN;
+        while (clock.now() < end)
+        {
+            runUntil(clock.now() + gap(rng), [] { return false; });
+            tcs.notify(nullptr, VehicleDetectorEvent{tcs.TrafficSemVector[approach(rng)]->getLocation()});
+        }
+        runUntil(clock.now() + 1, [] { return false; });
+
+        check(tcs.watchdog.isRunning() && tcs.watchdog.tripped() == Fault::NONE, "Normal operation: no trip");
+        check(!tcs.failed && !tcs.flashing, "Normal operation: the phase machine drives the lights");
+        check(tcs.state == TrafficControlSystem::SystemState::NORMAL, "Normal operation: still Normal");
+    }
+
+    // Event consumer wedged at the start of a green; returns the detection time
+    double wedgeEventConsumer()
+    {
+        runUntil(clock.now() + WEDGE_LIMIT, [this] { return tcs.phaseState == TrafficControlSystem::PhaseState::GREEN; });
+
+        handleEvents = false;
+        const double wedged = clock.now();
+        tcs.notify(nullptr, VehicleDetectorEvent{tcs.TrafficSemVector[0]->getLocation()});
+
+        const double detected = runUntil(wedged + WEDGE_LIMIT, [this] { return tcs.flashing.load(); });
+        check(tcs.watchdog.tripped() == Fault::EVENT_STALL, "wedged TCS thread: event stall detected");
+        check(detected - wedged <= WATCHDOG_STALL + WATCHDOG_PERIOD + epsilon, "event stall detected in bound");
+        return detected - wedged;
+    }
+
+    // Every TSEM yellow together, or every light dark - one commit per half period
+    void checkFlashing(const char* what)
+    {
+        const uint64_t yellow = pins(Colour::YELLOW);
+        const uint64_t others = pins(Colour::RED) | pins(Colour::GREEN) | crosswalkPins();
+
+        bool lockstep = true;
+        bool toggling = true;
+        bool dark = true;
+        bool oneCommit = true;
+        bool lit = (rasp_gpio_stub_lines() & yellow) == yellow;
+        for (int i = 0; i < FLASH_CHECKS; ++i)
+        {
+            tcs.switchLightQueue.send(tcs.systemWarning());     // ignored: the phase machine is stopped
+            const uint64_t commits = rasp_gpio_stub_commits();
+            runUntil(clock.now() + FLASH_HALF_PERIOD, [] { return false; });
+
+            const uint64_t lines = rasp_gpio_stub_lines();
+            lockstep = lockstep && ((lines & yellow) == yellow || (lines & yellow) == 0);
+            toggling = toggling && ((lines & yellow) == yellow) != lit;
+            dark = dark && (lines & others) == 0;
+            oneCommit = oneCommit && rasp_gpio_stub_commits() == commits + 1;
+            lit = (lines & yellow) == yellow;
+        }
+        const std::string prefix = std::string(what) + ": ";
+        check(lockstep, (prefix + "every TSEM yellow in lockstep").c_str());
+        check(toggling, (prefix + "yellow toggles every half period").c_str());
+        check(dark, (prefix + "red, green and crosswalks dark").c_str());
+        check(oneCommit, (prefix + "one bulk commit per half period").c_str());
+    }
+
+    // Back from the wedge: FAILURE, flashing until restarted; returns the detection time
+    double failEventConsumer()
+    {
+        const double stall = wedgeEventConsumer();
+        checkFlashing("TCS thread wedged");
+
+        handleEvents = true;
+        runControlLoop();
+        check(tcs.state == TrafficControlSystem::SystemState::FAILURE, "FAILURE once the TCS thread runs");
+        tcs.notify(nullptr, VehicleDetectorEvent{tcs.TrafficSemVector[0]->getLocation()});
+        checkFlashing("FAILURE");
+        check(tcs.state == TrafficControlSystem::SystemState::FAILURE, "FAILURE until restarted");
+
+        tcs.flashTimer.cancel();       // the lines are shared with the next instance
+        return stall;
+    }
+
+    static std::unique_ptr<TrafficControlSystem> instance()
+    {
+        return std::unique_ptr<TrafficControlSystem>(new TrafficControlSystem);
+    }
+
+    // t_switchLight wedged in a green, no event waiting; returns the detection time past the green's deadline
+    double wedgePhaseMachine()
+    {
+        runUntil(clock.now() + WEDGE_LIMIT, [this] { return tcs.phaseState == TrafficControlSystem::PhaseState::GREEN; });
+        runPhases = false;
+
+        const double deadline = runUntil(clock.now() + WEDGE_LIMIT, [this] { return tcs.timerSwitchLight.hasFired(); });
+        const double detected = runUntil(deadline + WEDGE_LIMIT, [this] { return tcs.flashing.load(); });
+        check(tcs.watchdog.tripped() == Fault::PHASE_DEADLINE, "wedged phase machine: missed deadline detected");
+        check(detected - deadline <= WATCHDOG_GRACE + WATCHDOG_PERIOD + epsilon, "missed deadline detected in bound");
+        check(tcs.flashing, "wedged phase machine: flashing yellow");
+        return detected - deadline;
+    }
+
+    // t_switchLight wedged in a green, inside the GPIO lock (held by another thread: the lock is recursive)
+    void wedgeInsideGpioLock()
+    {
+        runUntil(clock.now() + WEDGE_LIMIT, [this] { return tcs.phaseState == TrafficControlSystem::PhaseState::GREEN; });
+        runPhases = false;
+
+        std::promise<void> held;
+        std::promise<void> release;
+        std::thread step([&held, done = release.get_future()]
+        {
+            rasp_gpio_lock();
+            held.set_value();
+            done.wait();
+            rasp_gpio_unlock();
+        });
+        held.get_future().wait();
+
+        const uint64_t commits = rasp_gpio_stub_commits();
+        const double deadline = runUntil(clock.now() + WEDGE_LIMIT, [this] { return tcs.timerSwitchLight.hasFired(); });
+        const double detected = runUntil(deadline + WEDGE_LIMIT, [this] { return tcs.flashing.load(); });
+        check(tcs.watchdog.tripped() == Fault::PHASE_DEADLINE &&
+            detected - deadline <= WATCHDOG_GRACE + WATCHDOG_PERIOD + epsilon,
+            "step wedged inside the GPIO lock: missed deadline detected in bound");
+
+        // Returns: the flash did not wait for the lock, the timers keep expiring
+        const double flashed = clock.now();
+        runUntil(flashed + FLASH_CHECKS * FLASH_HALF_PERIOD, [] { return false; });
+        check(clock.now() >= flashed + FLASH_CHECKS * FLASH_HALF_PERIOD &&
+            clock.nextDeadline() <= clock.now() + FLASH_HALF_PERIOD + epsilon,
+            "GPIO lock held: the flash ticks keep expiring");
+        check(rasp_gpio_stub_commits() == commits, "GPIO lock held: nothing committed");
+
+        release.set_value();
+        step.join();
+        runPhases = true;
+        checkFlashing("GPIO lock released");
+    }
+};
+using FailureModeTest = TrafficControlSystemTestAccess<FailureMode>;
+
+int main()
+{
+    std::ostream report(std::cout.rdbuf());
+    std::cout.rdbuf(nullptr);       // silences the system's own logging
+    std::cerr.rdbuf(nullptr);
+
+    checkPeriodicTimer();
+
+    CppWrapper::VirtualClock clock;
+    FailureModeTest test{TrafficControlSystem::getInstance(), clock};
+    std::mt19937 rng(TEST_SEED);
+
+    CppWrapper::VirtualClock phaseClock;
+    const auto other = FailureModeTest::instance();
+    FailureModeTest phaseTest{*other, phaseClock};
+
+    try
+    {
+        test.start();
+        test.normalOperation(rng);
+        const double stall = test.failEventConsumer();
+
+        phaseTest.start();
+        phaseTest.normalOperation(rng);
+        const double late = phaseTest.wedgePhaseMachine();
+
+        CppWrapper::VirtualClock lockClock;
+        const auto locked = FailureModeTest::instance();
+        FailureModeTest lockTest{*locked, lockClock};
+        lockTest.start();
+        lockTest.normalOperation(rng);
+        lockTest.wedgeInsideGpioLock();
+
+        report << "event stall detected after " << stall << " s (bound " << WATCHDOG_STALL + WATCHDOG_PERIOD
+               << " s), missed phase deadline " << late << " s late (bound " << WATCHDOG_GRACE + WATCHDOG_PERIOD
+               << " s)\n";
+    }
+    catch (const std::exception& e)
+    {
+        report << "Failure mode test failed: " << e.what() << "\n";
+        failures = 1;
+    }
+
+    report << (failures ? "FAILED" : "All failure mode checks passed") << std::endl;
+
+    std::remove(PLAN_CACHE_PATH);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,121 @@
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include "../../GreenTime/GreenTime.hpp"
+
+/* TEST SET
+ *  - Actuated: the initial green covers the waiting demand, within [min, max] green
+ *  - Actuated: vehicles on a served approach extend the green by the passage time (gap-out otherwise),
+ *    never beyond the max green (max-out); calls outside the green or not served are ignored
+ *  - Fixed: the Configuration's time; a waiting button shortens a long green
+ *
+ *  Runs on the host (no GPIO/Cloud/DDS required); returns 0 if every check passes
+ */
+
+#define TEST_SEED 5
+#define RANDOM_PHASES 1000
+#define EPSILON 1e-9
+
+static int failures = 0;
+
+static void check(const bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << what << "\n";
+        ++failures;
+    }
+}
+
+static bool equal(const double a, const double b)
+{
+    return std::fabs(a - b) < EPSILON;
+}
+
+static void checkActuatedStart()
+{
+    ActuatedGreenTime actuated;
+
+    check(equal(actuated.phaseStart({}, 100), GREEN_MIN), "no demand: min green");
+    check(equal(actuated.phaseStart({.vehicles = 2}, 100), GREEN_MIN + 2 * GREEN_PER_VEHICLE),
+        "queued vehicles: headway each");
+    check(equal(actuated.phaseStart({.vehicles = 1000}, 100), GREEN_MAX), "long queue: max green");
+    check(equal(actuated.phaseStart({.buttons = 3}, 100), GREEN_WALK), "button: walk time");
+    check(equal(actuated.phaseStart({.buttons = 1, .cards = 1}, 100), GREEN_CARD_WALK), "card: longer walk time");
+    check(equal(actuated.phaseStart({.configuredTime = 60}, 100), GREEN_MIN), "configured time is not used");
+}
+
+static void checkActuatedCalls()
+{
+    ActuatedGreenTime actuated;
+    const double start = 100;
+    actuated.phaseStart({}, start);     // ends at start + GREEN_MIN
+
+    check(actuated.call(PhaseCall::VEHICLE, true, start - 1) < 0, "call during the yellow is ignored");
+    check(actuated.call(PhaseCall::VEHICLE, false, start + 4) < 0, "call not served is ignored");
+    check(actuated.call(PhaseCall::VEHICLE, true, start + 1) < 0, "vehicle within the min green: no extension");
+    check(equal(actuated.call(PhaseCall::VEHICLE, true, start + 4), GREEN_PASSAGE), "vehicle: passage time left");
+    check(actuated.call(PhaseCall::BUTTON, true, start + 5) < 0, "button on a green crosswalk is ignored");
+    check(actuated.phaseEnd() == PhaseEnd::GAP_OUT, "gap-out");
+    check(actuated.call(PhaseCall::VEHICLE, true, start + 4 + GREEN_PASSAGE + 0.1) < 0, "call after the gap-out");
+
+    // Vehicles every second: the green lasts up to the max green
+    actuated.phaseStart({}, start);
+    double end = start + GREEN_MIN;
+    for (double now = start + 1; now < end; now += 1)
+        if (const double left = actuated.call(PhaseCall::VEHICLE, true, now); left >= 0)
+            end = now + left;
+    check(equal(end, start + GREEN_MAX), "continuous traffic: max green");
+    check(actuated.phaseEnd() == PhaseEnd::MAX_OUT, "max-out");
+}
+
+// Random calls: the green never ends before the min green nor after the max green
+static void checkActuatedBounds()
+{
+    std::mt19937 rng(TEST_SEED);
+    std::uniform_int_distribution<int> vehicles(0, 20);
+    std::uniform_real_distribution<double> gap(0.0, 2 * GREEN_PASSAGE);
+    std::bernoulli_distribution served(0.8);
+
+    ActuatedGreenTime actuated;
+    for (int phase = 0; phase < RANDOM_PHASES; ++phase)
+    {
+        const double start = phase * 1000.0;
+        double end = start + actuated.phaseStart({.vehicles = vehicles(rng)}, start);
+
+        for (double now = start + gap(rng); now < end; now += gap(rng))
+            if (const double left = actuated.call(PhaseCall::VEHICLE, served(rng), now); left >= 0)
+                end = now + left;
+
+        if (end < start + GREEN_MIN - EPSILON || end > start + GREEN_MAX + EPSILON)
+        {
+            std::cerr << "FAILED: green of " << end - start << " s\n";
+            ++failures;
+        }
+    }
+}
+
+static void checkFixed()
+{
+    FixedGreenTime fixed;
+    const double start = 100;
+
+    check(equal(fixed.phaseStart({.vehicles = 10, .configuredTime = 20}, start), 20), "configured time");
+    check(fixed.call(PhaseCall::BUTTON, true, start + 1) < 0, "served button is ignored");
+    check(fixed.call(PhaseCall::VEHICLE, false, start + 1) < 0, "vehicles are ignored");
+    check(equal(fixed.call(PhaseCall::BUTTON, false, start + 1), 19 - FIXED_CALL_REDUCE), "waiting button");
+    check(fixed.call(PhaseCall::BUTTON, false, start + 20 - FIXED_CALL_REDUCE - 1) < 0, "short green is kept");
+    check(fixed.phaseEnd() == PhaseEnd::FIXED, "fixed end");
+}
+
+int main()
+{
+    checkActuatedStart();
+    checkActuatedCalls();
+    checkActuatedBounds();
+    checkFixed();
+
+    std::cout << (failures ? "FAILED" : "passed") << " (" << failures << " failures)\n";
+    return failures ? 1 : 0;
+}
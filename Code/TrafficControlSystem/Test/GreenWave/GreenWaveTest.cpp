@@ -0,0 +1,349 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../TrafficControlSystem.hpp"
+#include "../Common/TestIntersection.hpp"
+#include "../Common/TrafficControlSystemTestAccess.hpp"
+
+/* TEST SET
+ *  - GreenWave: reference taken from the upstream reports only; the last phase is held to start the next
+ *    coordinated green at upstream start + offset (dwelling one more upstream cycle rather than cutting the min
+ *    green); isolated operation once the upstream reports stop
+ *  - Corridor on virtual time: 3 TrafficControlSystem instances in this process, A -> B -> C, the cycle reports
+ *    delivered in process (instead of the DDS GreenWave topic). A runs a fixed cycle; B and C are actuated, with
+ *    random vehicle calls, started out of step. Coordinated: B and C hold their offsets, platoons leaving A/B
+ *    on their coordinated green arrive on a green; isolated (no upstream): they do not
+ *
+ *  Host build (target GreenWaveTest): GPIO is stubbed by Test/Benchmark/Stubs/rasp_gpio_stub.cpp,
+ *  the Cloud and DDS objects are created but never started; returns 0 if every check passes
+ */
+
+#ifndef PLAN_CACHE_PATH
+#error "PLAN_CACHE_PATH must point to a scratch file (set by the GreenWaveTest target)"
+#endif
+
+#define TEST_SEED 18
+#define TEST_PINS 128
+#define CORRIDOR 1              // Location of the corridor approach (arm 0), same on every box
+#define LEADER_GREEN 20.0       // s, A: every green (fixed cycle)
+#define OFFSET_B 12.0           // s, A -> B travel time
+#define OFFSET_C 9.0            // s, B -> C travel time
+#define WARM_UP 300.0           // s, before measuring: B and C locked on their upstream
+#define RUN_TIME 3600.0         // s, measured
+#define CALL_GAP_MAX 8.0        // s, between two vehicle calls on a follower (uniform)
+#define PLATOON 4.0             // s, a platoon passes a stop line in that time
+#define PLATOON_SAMPLE 0.5      // s
+
+static constexpr double epsilon = 1e-6;
+
+/*--- GreenWave ------------------------------------------------------------------------------------------------------*/
+static void checkGreenWave()
+{
+    GreenWave wave;
+    wave.coordinate(CORRIDOR, "A", 10);
+    check(!wave.following(0) && wave.hold(12, 50, GREEN_MIN, 0) == 12, "no upstream report: not held");
+
+    wave.received({"X", 0, 40, 3}, 100);
+    check(!wave.following(100), "reports from others ignored");
+
+    wave.received({"A", 0, 40, 3}, 100);        // its coordinated green started at 97: ours at 107 + k * 40
+    check(wave.following(100), "upstream report: following");
+    check(std::abs(wave.hold(20, 100, GREEN_MIN, 100) - 27) < epsilon, "early: green stretched");
+    check(std::abs(wave.hold(20, 110, GREEN_MIN, 100) - 17) < epsilon, "late: green shortened");
+    check(std::abs(wave.hold(10, 120, GREEN_MIN, 100) - 37) < epsilon, "min green: dwells one upstream cycle");
+    check(std::abs(wave.hold(20, 187, GREEN_MIN, 100) - 20) < epsilon, "on time, cycles later: unchanged");
+
+    check(wave.following(100 + GREEN_WAVE_STALE_CYCLES * 40), "upstream stale only after its cycles");
+    check(!wave.following(101 + GREEN_WAVE_STALE_CYCLES * 40), "stale upstream: isolated");
+
+    GreenWave leader;
+    leader.coordinate(CORRIDOR, "", 0);
+    check(leader.organized("A", 1, 10, 7).phase < 0, "no coordinated green yet: no reference published");
+    leader.organized("A", 0, 50, 47);
+    leader.organized("A", 0, 96, 93);
+    const GreenWaveEvent report = leader.organized("A", 1, 122, 119);
+    check(report.phase == 1 && std::abs(report.cycle - 46) < epsilon && std::abs(report.offset - 23) < epsilon,
+        "report: phase, last cycle, offset into the cycle");
+}
+
+/*--- Corridor -------------------------------------------------------------------------------------------------------*/
+// Cycle reports between the boxes of this process (the DDS GreenWave topic on the boxes)
+struct Corridor : I_GreenWaveLink
+{
+    std::vector<TrafficControlSystem*> boxes;
+    bool connected = true;
+
+    void publish(const GreenWaveEvent& report) override
+    {
+        if (connected)
+            for (const auto box : boxes)
+                box->notify(nullptr, report);
+    }
+};
+
+struct GreenWaveCorridor;
+
+template <>
+struct TrafficControlSystemTestAccess<GreenWaveCorridor>
+{
+    using PhaseState = TrafficControlSystem::PhaseState;
+    using Colour = Semaphore::TrafficColour;
+
+    struct Box
+    {
+        std::unique_ptr<TrafficControlSystem> tcs;
+        std::vector<double> coordinated;    // coordinated green starts
+        double nextCall = std::numeric_limits<double>::infinity();
+        int onGreen = 0;                    // platoon samples (from upstream) on a green corridor approach
+        int samples = 0;
+        bool started = false;
+    };
+
+    CppWrapper::VirtualClock clock;
+    Corridor corridor;
+    std::vector<Box> boxes;     // A, B, C
+    std::mt19937& rng;
+
+    TrafficControlSystemTestAccess(std::mt19937& rng, const bool coordinate): rng(rng)
+    {
+        const char* names[] = {"A", "B", "C"};
+        const double offsets[] = {0, OFFSET_B, OFFSET_C};
+        for (int i = 0; i < 3; ++i)
+        {
+            Box box;
+            box.tcs.reset(new TrafficControlSystem);     // one per Intersection
+            TrafficControlSystem& tcs = *box.tcs;
+            tcs.username = names[i];
+            tcs.useClock(clock);
+            tcs.useGreenWaveLink(corridor);
+
+            for (int pin = 1; pin < TEST_PINS; ++pin)
+                tcs.availableGPIOs.push_back(pin);
+            tcs.createComponents(makeTsem());
+            tcs.createComponents(makePsem());
+
+            json wave = {{"name", "GW0"}, {"location", CORRIDOR}};
+            if (i > 0 && coordinate)
+                wave.update({{"upstream", names[i - 1]}, {"offset", offsets[i]}});
+            tcs.createComponents(std::make_shared<json>(json::array({wave})));
+            tcs.findConfigurations();
+
+            if (i == 0)
+                tcs.greenTime = std::make_unique<ActuatedGreenTime>(LEADER_GREEN, LEADER_GREEN);
+            corridor.boxes.push_back(&tcs);
+            boxes.push_back(std::move(box));
+        }
+    }
+
+    void start(Box& box) const
+    {
+        box.started = true;
+        box.tcs->switchLightQueue.send(box.tcs->systemWarning());
+        box.tcs->switch_state(TrafficControlSystem::SystemState::NORMAL);
+        if (&box != &boxes.front())
+            box.nextCall = clock.now();
+    }
+
+    // What every box has ready at the current (virtual) instant - reports go from one box to the others
+    void runControlLoop()
+    {
+        bool progress = true;
+        while (progress)
+        {
+            progress = false;
+            for (auto& box : boxes)
+            {
+                if (!box.started)       // its reports wait in its queue
+                    continue;
+                TrafficControlSystem& tcs = *box.tcs;
+
+                TrafficControlSystem::QueuedEvent queued;
+                while (tcs.eventQueue.tryReceive(queued))
+                {
+                    tcs.handleEvent(queued);
+                    progress = true;
+                }
+
+                TrafficControlSystem::PhaseCommand command;
+                while (tcs.switchLightQueue.tryReceive(command))
+                {
+                    const PhaseState before = tcs.phaseState;
+                    tcs.runPhase(command);
+                    if (before != PhaseState::GREEN && tcs.phaseState == PhaseState::GREEN && tcs.sequencePos == 0)
+                        box.coordinated.push_back(clock.now());
+                    progress = true;
+                }
+
+                CloudSendType message;      // the Cloud is not running
+                while (tcs.cloud.cloudSendQueue.tryReceive(message)) {}
+            }
+        }
+    }
+
+    [[nodiscard]] static bool corridorGreen(const Box& box)
+    {
+        const auto& tsem = box.tcs->TrafficSemVector;
+        const auto approach = std::ranges::find_if(tsem, [](const auto& t) { return t->getLocation() == CORRIDOR; });
+        return approach != tsem.end() && (*approach)->getCurrentState() == Colour::GREEN;
+    }
+
+    // Platoons: leave each upstream coordinated green start, reach the box 'offset' later, pass in PLATOON seconds
+    [[nodiscard]] double nextSample(const size_t i, const double after) const
+    {
+        const double offset = i == 1 ? OFFSET_B : OFFSET_C;
+        for (const double start : boxes[i - 1].coordinated)
+            for (double t = start + offset + PLATOON_SAMPLE / 2; t < start + offset + PLATOON; t += PLATOON_SAMPLE)
+                if (t > after + epsilon)
+                    return t;
+        return std::numeric_limits<double>::infinity();
+    }
+
+    void runUntil(const double time, const bool measure)
+    {
+        runControlLoop();
+        std::uniform_real_distribution<double> gap(0, CALL_GAP_MAX);
+        std::uniform_int_distribution<int> arm(0, 3);
+
+        while (true)
+        {
+            double next = std::min(clock.nextDeadline(), time);
+            for (const auto& box : boxes)
+                next = std::min(next, box.nextCall);
+            if (measure)
+                for (size_t i = 1; i < boxes.size(); ++i)
+                    next = std::min(next, nextSample(i, clock.now()));
+
+            clock.advanceTo(next);
+            runControlLoop();
+            if (next >= time)
+                return;
+
+            for (auto& box : boxes)
+                if (box.nextCall <= next)
+                {
+                    box.tcs->notify(nullptr, VehicleDetectorEvent{4 * arm(rng) + 1});
+                    box.nextCall = next + gap(rng);
+                }
+            runControlLoop();
+
+            if (measure)
+                for (size_t i = 1; i < boxes.size(); ++i)
+                    if (std::abs(nextSample(i, next - 2 * epsilon) - next) < epsilon)
+                    {
+                        ++boxes[i].samples;
+                        boxes[i].onGreen += corridorGreen(boxes[i]);
+                    }
+        }
+    }
+
+    // Coordinated green starts (after 'from') at an upstream start + offset
+    [[nodiscard]] double held(const size_t i, const double from) const
+    {
+        const double offset = i == 1 ? OFFSET_B : OFFSET_C;
+        int total = 0;
+        int on = 0;
+        for (const double start : boxes[i].coordinated)
+        {
+            if (start < from)
+                continue;
+            ++total;
+            on += std::ranges::any_of(boxes[i - 1].coordinated,
+                [&](const double up) { return std::abs(start - (up + offset)) < 1e-3; });
+        }
+        return total ? static_cast<double>(on) / total : 0;
+    }
+
+    void run()
+    {
+        start(boxes[0]);
+        runUntil(7, false);
+        start(boxes[1]);
+        runUntil(20, false);
+        start(boxes[2]);
+
+        runUntil(WARM_UP, false);
+        for (auto& box : boxes)
+            box.onGreen = box.samples = 0;
+        runUntil(WARM_UP + RUN_TIME, true);
+    }
+
+    void report(const char* mode, std::ostream& out) const
+    {
+        for (size_t i = 1; i < boxes.size(); ++i)
+        {
+            const auto& box = boxes[i];
+            const auto& cycles = box.coordinated;
+            const double cycle = cycles.size() > 1 ? (cycles.back() - cycles.front()) / (cycles.size() - 1) : 0;
+            out << "  " << mode << " " << box.tcs->username << ": mean cycle " << cycle << " s, offset held "
+                << 100 * held(i, WARM_UP) << " %, platoons on green "
+                << (box.samples ? 100.0 * box.onGreen / box.samples : 0) << " %\n";
+        }
+    }
+
+    // Upstream gone: the followers run isolated after GREEN_WAVE_STALE_CYCLES of its cycles
+    void disconnect()
+    {
+        corridor.connected = false;
+        runUntil(clock.now() + (GREEN_WAVE_STALE_CYCLES + 1) * 2 * (LEADER_GREEN + YELLOW_DURATION + ALL_RED_DURATION),
+            false);
+        for (size_t i = 1; i < boxes.size(); ++i)
+            check(!boxes[i].tcs->greenWave.following(clock.now()), "no reports: isolated");
+    }
+};
+using GreenWaveTest = TrafficControlSystemTestAccess<GreenWaveCorridor>;
+
+int main()
+{
+    std::ostream out(std::cout.rdbuf());
+    std::cout.rdbuf(nullptr);       // silences the system's own logging
+    std::cerr.rdbuf(nullptr);
+
+    try
+    {
+        checkGreenWave();
+
+        std::mt19937 rng(TEST_SEED);
+        GreenWaveTest coordinated(rng, true);
+        coordinated.run();
+        coordinated.report("coordinated", out);
+
+        for (size_t i = 1; i < coordinated.boxes.size(); ++i)
+        {
+            check(coordinated.held(i, WARM_UP) > 0.95, "coordinated: offset to the upstream box held");
+            const auto& box = coordinated.boxes[i];
+            check(box.samples > 0 && box.onGreen >= 0.95 * box.samples, "coordinated: platoons arrive on green");
+        }
+
+        coordinated.disconnect();
+
+        std::mt19937 rngIsolated(TEST_SEED);
+        GreenWaveTest isolated(rngIsolated, false);
+        isolated.run();
+        isolated.report("isolated", out);
+
+        for (size_t i = 1; i < isolated.boxes.size(); ++i)
+        {
+            const auto& box = coordinated.boxes[i];
+            const auto& alone = isolated.boxes[i];
+            check(alone.samples > 0 && static_cast<double>(alone.onGreen) / alone.samples <
+                  static_cast<double>(box.onGreen) / box.samples - 0.2, "isolated: fewer platoons on green");
+        }
+    }
+    catch (const std::exception& e)
+    {
+        out << "Green wave test failed: " << e.what() << "\n";
+        failures = 1;
+    }
+
+    out << (failures ? "FAILED" : "All green wave checks passed") << std::endl;
+
+    std::remove(PLAN_CACHE_PATH);
+    return failures ? 1 : 0;
+}
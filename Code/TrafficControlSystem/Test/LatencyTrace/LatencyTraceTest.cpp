@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+#include "../../Instrumentation/LatencyTrace.hpp"
+
+/* TEST SET
+ *  - Buckets: every value lies in its bucket, with a relative error below 2^-(LATENCY_PRECISION_BITS - 1)
+ *  - Percentiles: match the exact percentiles of the recorded samples, within the bucket error
+ *  - Concurrent recording (several threads): no sample lost, exact maximum
+ *  - Report: served to a client of the local socket
+ *
+ *  Runs on the host (no GPIO/Cloud/DDS required); returns 0 if every check passes
+ */
+
+#define TEST_SEED 15
+#define RANDOM_VALUES 200000
+#define CONCURRENT_THREADS 4
+#define SAMPLES_PER_THREAD 100000
+
+static int failures = 0;
+
+static void check(const bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << what << "\n";
+        ++failures;
+    }
+}
+
+static constexpr double relativeError = 1.0 / (1 << (LATENCY_PRECISION_BITS - 1));
+
+static void checkBuckets(std::mt19937_64& rng)
+{
+    std::uniform_int_distribution<int> bits(0, LATENCY_MAX_BITS - 1);
+    size_t previousBucket = 0;
+    for (uint64_t v = 0; v < 100000; ++v)
+    {
+        const size_t bucket = LatencyHistogram::bucketOf(v);
+        check(bucket >= previousBucket, "buckets grow with the value");
+        previousBucket = bucket;
+    }
+
+    for (int i = 0; i < RANDOM_VALUES; ++i)
+    {
+        const uint64_t v = rng() >> (64 - 1 - bits(rng));
+        const size_t bucket = LatencyHistogram::bucketOf(v);
+        const uint64_t upper = LatencyHistogram::upperBound(bucket);
+        const uint64_t lower = bucket ? LatencyHistogram::upperBound(bucket - 1) + 1 : 0;
+        check(lower <= v && v <= upper, "value inside its bucket");
+        check(static_cast<double>(upper - v) <= relativeError * static_cast<double>(v), "bucket error bound");
+    }
+}
+
+static void checkPercentiles(std::mt19937_64& rng)
+{
+    std::lognormal_distribution<double> latency(10.0, 1.5);     // ns: ~22 us median, long tail
+    LatencyHistogram histogram;
+    std::vector<uint64_t> values;
+    for (int i = 0; i < RANDOM_VALUES; ++i)
+    {
+        const auto v = static_cast<uint64_t>(latency(rng));
+        values.push_back(v);
+        histogram.record(v);
+    }
+    std::ranges::sort(values);
+
+    check(histogram.count() == values.size(), "count");
+    check(histogram.maximum() == values.back(), "maximum");
+    for (const double p : {0.0, 0.5, 0.9, 0.99, 0.999, 1.0})
+    {
+        const uint64_t exact = values[static_cast<size_t>(p * static_cast<double>(values.size() - 1))];
+        const uint64_t reported = histogram.percentile(p);
+        check(reported >= exact, "percentile: not below the exact value");
+        check(static_cast<double>(reported - exact) <= relativeError * static_cast<double>(exact) + 1,
+            "percentile: within the bucket error");
+    }
+
+    histogram.reset();
+    check(histogram.count() == 0 && histogram.percentile(0.99) == 0, "reset");
+}
+
+static LatencyHistogram shared;
+
+static void* t_record(void* arg)
+{
+    const auto base = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(arg));
+    for (uint64_t i = 0; i < SAMPLES_PER_THREAD; ++i)
+        shared.record(base + i);
+    return nullptr;
+}
+
+static void checkConcurrent()
+{
+    std::vector<std::unique_ptr<CppWrapper::Thread>> threads;
+    for (uintptr_t t = 0; t < CONCURRENT_THREADS; ++t)
+    {
+        threads.push_back(std::make_unique<CppWrapper::Thread>(t_record));
+        threads.back()->run(reinterpret_cast<void*>(t * 1000));
+    }
+    for (const auto& thread : threads)
+        thread->join();
+
+    check(shared.count() == CONCURRENT_THREADS * SAMPLES_PER_THREAD, "concurrent: no sample lost");
+    check(shared.maximum() == (CONCURRENT_THREADS - 1) * 1000 + SAMPLES_PER_THREAD - 1, "concurrent: maximum");
+}
+
+static void checkSocketReport()
+{
+    LatencyTrace trace;
+    trace.record(LatencyStage::EMERGENCY_TO_GREEN, 0, 3000000000ull);
+    if (trace.start() < 0)
+    {
+        check(false, "report: dump thread started");
+        return;
+    }
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, LATENCY_SOCKET_PATH, sizeof(addr.sun_path) - 1);
+    check(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0, "report: socket connection");
+
+    std::string report;
+    char buffer[512];
+    for (ssize_t n; (n = read(fd, buffer, sizeof(buffer))) > 0;)
+        report.append(buffer, n);
+    close(fd);
+    trace.stop();
+
+    check(report.find("emergency -> green") != std::string::npos, "report: every stage listed");
+    check(report.find("3000000.0") != std::string::npos, "report: maximum in us");
+}
+
+int main()
+{
+    std::mt19937_64 rng(TEST_SEED);
+    checkBuckets(rng);
+    checkPercentiles(rng);
+    checkConcurrent();
+    checkSocketReport();
+
+    std::cout << (failures ? "FAILED" : "All latency trace checks passed") << std::endl;
+    return failures ? 1 : 0;
+}
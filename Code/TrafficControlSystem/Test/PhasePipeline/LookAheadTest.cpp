@@ -0,0 +1,213 @@
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <sched.h>
+#include <vector>
+
+#include "../../CppWrapper/CppWrapper.hpp"
+#include "../../PhasePipeline/LookAhead.hpp"
+
+/* TEST SET
+ *  - SpscRing: FIFO, bounded; one producer and one consumer thread, every item received once and in order
+ *  - LookAhead: a chain is taken in order; invalidating drops the entries not started, stale entries are
+ *    drained by the consumer; the producer learns every entry started (started())
+ *  - Race: the consumer takes while the producer stages and invalidates - every entry taken is committed by
+ *    the producer exactly once, in order, and none dropped is ever taken
+ *
+ *  Runs on the host; returns 0 if every check passes
+ */
+
+#define RING_ITEMS 1000000
+#define RACE_ENTRIES 20000
+#define RACE_DEPTH 2
+#define TEST_SEED 19
+
+static int failures = 0;
+
+static void check(const bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << what << "\n";
+        ++failures;
+    }
+}
+
+static void checkRing()
+{
+    CppWrapper::SpscRing<int, 4> ring;
+    int value = 0;
+    check(!ring.tryPop(value), "empty ring");
+    for (int i = 0; i < 4; ++i)
+        check(ring.tryPush(i), "push until full");
+    check(!ring.tryPush(4) && ring.space() == 0, "full ring");
+    check(ring.tryPop(value) && value == 0 && ring.space() == 1, "FIFO");
+    check(ring.tryPush(4), "slot freed by the pop");
+    for (int i = 1; i <= 4; ++i)
+        check(ring.tryPop(value) && value == i, "FIFO across the wrap-around");
+    check(!ring.tryPop(value), "drained");
+}
+
+struct RingTest
+{
+    CppWrapper::SpscRing<uint64_t, 64> ring;
+    bool ordered = true;
+
+    static void* t_consumer(void* arg)
+    {
+        const auto self = static_cast<RingTest*>(arg);
+        uint64_t expected = 0;
+        uint64_t value;
+        while (expected < RING_ITEMS)
+        {
+            if (self->ring.tryPop(value))
+                self->ordered = self->ordered && value == expected++;
+            else
+                sched_yield();
+        }
+        return nullptr;
+    }
+};
+
+static void checkRingThreads()
+{
+    RingTest test;
+    CppWrapper::Thread consumer(RingTest::t_consumer);
+    consumer.run(&test);
+
+    for (uint64_t i = 0; i < RING_ITEMS; )
+    {
+        if (test.ring.tryPush(i))
+            ++i;
+        else
+            sched_yield();
+    }
+    consumer.join();
+    check(test.ordered, "every item received once, in order");
+}
+
+static void checkChain()
+{
+    LookAhead<int, 8> lookAhead;
+    check(!lookAhead.take() && !lookAhead.started() && !lookAhead.back(), "nothing staged");
+
+    lookAhead.stage(1);
+    lookAhead.stage(2);
+    check(lookAhead.depth() == 2 && *lookAhead.back() == 2, "chain staged");
+
+    const auto taken = lookAhead.take();
+    check(taken && *taken == 1 && lookAhead.depth() == 1, "first entry taken");
+    const auto started = lookAhead.started();
+    check(started && *started == 1 && !lookAhead.started(), "started entry committed once");
+
+    lookAhead.invalidate();
+    check(lookAhead.depth() == 0 && !lookAhead.back(), "entries not started dropped");
+    check(!lookAhead.take(), "dropped entry not taken (drained)");
+
+    lookAhead.stage(3);
+    lookAhead.invalidate();
+    lookAhead.stage(4);
+    const auto restaged = lookAhead.take();
+    check(restaged && *restaged == 4, "stale entry skipped, new chain taken");
+    check(lookAhead.started() == 4, "new chain committed");
+
+    // Taken, then invalidated before the producer saw it: still committed
+    lookAhead.stage(5);
+    lookAhead.stage(6);
+    check(lookAhead.take() == 5, "taken before the invalidation");
+    lookAhead.invalidate();
+    check(lookAhead.started() == 5 && !lookAhead.started(), "started entry survives the invalidation");
+    check(!lookAhead.take(), "the rest of the chain dropped");
+
+    // Full of stale entries: staging fails until the consumer drains them
+    LookAhead<int, 2> small;
+    small.stage(1);
+    small.stage(2);
+    small.invalidate();
+    check(!small.stage(3), "ring full of stale entries");
+    check(!small.take() && small.stage(3) && small.take() == 3, "stale entries drained");
+}
+
+struct RaceTest
+{
+    LookAhead<uint64_t, 8> lookAhead;
+    std::atomic<bool> done{false};
+    std::vector<uint64_t> taken;
+
+    static void* t_consumer(void* arg)
+    {
+        const auto self = static_cast<RaceTest*>(arg);
+        while (!self->done.load())
+        {
+            if (const auto entry = self->lookAhead.take())
+                self->taken.push_back(*entry);
+            else
+                sched_yield();      // single core hosts: let the producer stage
+        }
+        return nullptr;
+    }
+};
+
+static void checkRace()
+{
+    RaceTest test;
+    CppWrapper::Thread consumer(RaceTest::t_consumer);
+    consumer.run(&test);
+
+    std::mt19937 rng(TEST_SEED);
+    std::bernoulli_distribution invalidate(0.2);
+    std::vector<uint64_t> committed;
+    std::vector<bool> dropped(RACE_ENTRIES, false);
+    std::vector<uint64_t> chain;        // staged, not known started
+
+    for (uint64_t id = 0; id < RACE_ENTRIES; )
+    {
+        while (const auto started = test.lookAhead.started())
+        {
+            committed.push_back(*started);
+            std::erase(chain, *started);
+        }
+        if (invalidate(rng))
+        {
+            test.lookAhead.invalidate();
+            while (const auto started = test.lookAhead.started())
+            {
+                committed.push_back(*started);
+                std::erase(chain, *started);
+            }
+            for (const uint64_t left : chain)
+                dropped[left] = true;
+            chain.clear();
+        }
+        if (test.lookAhead.depth() < RACE_DEPTH && test.lookAhead.stage(id))
+            chain.push_back(id++);
+        else
+            sched_yield();
+    }
+
+    test.lookAhead.invalidate();
+    test.done = true;
+    consumer.join();
+    while (const auto started = test.lookAhead.started())
+        committed.push_back(*started);
+
+    check(committed == test.taken, "every entry taken committed once, in order");
+    bool droppedTaken = false;
+    for (const uint64_t id : test.taken)
+        droppedTaken = droppedTaken || dropped[id];
+    check(!droppedTaken, "no dropped entry taken");
+    check(!test.taken.empty(), "entries taken while racing");
+    std::cout << "race: " << test.taken.size() << " of " << RACE_ENTRIES << " entries taken\n";
+}
+
+int main()
+{
+    checkRing();
+    checkRingThreads();
+    checkChain();
+    checkRace();
+
+    std::cout << (failures ? "FAILED" : "All look-ahead checks passed") << std::endl;
+    return failures ? 1 : 0;
+}
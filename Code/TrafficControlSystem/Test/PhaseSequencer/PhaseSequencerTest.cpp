@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../../ConflictGraph/ConflictGraph.hpp"
+#include "../../ConflictGraph/ConfigurationEngine.hpp"
+#include "../../ConflictGraph/PhaseSequencer.hpp"
+
+/* TEST SET
+ *  - The phase cycle serves every Location, without repeated nor redundant phases
+ *  - Short cycles are ordered with the minimum transition cost (compared against every permutation)
+ *  - A Crosswalk (two Locations with the same conflicts, switched together) costs one head, not two
+ *
+ *  Runs on the host (no GPIO/Cloud/DDS required); returns 0 if every check passes
+ */
+
+#define TEST_SEED 11
+#define GRAPHS_PER_SIZE 30
+
+#define CROSSWALK_EVERY 4      // Locations 4i+2 and 4i+3 make a Crosswalk
+
+static int bruteForceCost(const std::vector<LocationSet>& configurations, std::vector<int> cycle,
+    const LocationSet& heads)
+{
+    int best = PhaseSequencer::cycleCost(configurations, cycle, heads);
+    while (std::next_permutation(cycle.begin() + 1, cycle.end()))
+        best = std::min(best, PhaseSequencer::cycleCost(configurations, cycle, heads));
+    return best;
+}
+
+static bool checkCycle(const std::vector<LocationSet>& configurations, const LocationSet& vertices,
+    const LocationSet& heads, const std::vector<int>& cycle)
+{
+    LocationSet served = vertices;
+    for (const int phase : cycle)
+        served.andNot(configurations[phase].data());
+    if (!served.none())
+    {
+        std::cerr << "Cycle does not serve every Location\n";
+        return false;
+    }
+
+    for (const int phase : cycle)
+    {
+        if (std::ranges::count(cycle, phase) > 1)
+        {
+            std::cerr << "Phase " << phase << " repeated\n";
+            return false;
+        }
+        LocationSet own = vertices;
+        own.andWith(configurations[phase].data());
+        for (const int other : cycle)
+            if (other != phase)
+                own.andNot(configurations[other].data());
+        if (own.none())
+        {
+            std::cerr << "Phase " << phase << " is redundant\n";
+            return false;
+        }
+    }
+
+    std::vector<int> sorted = cycle;
+    std::sort(sorted.begin() + 1, sorted.end());
+    if (cycle.size() <= 8 &&
+        PhaseSequencer::cycleCost(configurations, cycle, heads) != bruteForceCost(configurations, sorted, heads))
+    {
+        std::cerr << "Cycle order is not the cheapest\n";
+        return false;
+    }
+    return true;
+}
+
+// Switching a Crosswalk off costs one head: both its Locations are in (or out of) a Configuration together
+static bool checkCrosswalkCost(const std::vector<LocationSet>& configurations, const LocationSet& vertices,
+    const LocationSet& heads)
+{
+    for (const auto& from : configurations)
+        for (const auto& to : configurations)
+        {
+            int expected = 0;
+            vertices.forEach([&](const int loc)
+            {
+                if (heads.test(loc) && from.test(loc) && !to.test(loc))
+                    ++expected;
+            });
+            if (PhaseSequencer::transitionCost(from, to, heads) != expected ||
+                PhaseSequencer::transitionCost(from, to, vertices) < expected)
+            {
+                std::cerr << "Crosswalk counted twice in the transition cost\n";
+                return false;
+            }
+        }
+    return true;
+}
+
+int main()
+{
+    std::mt19937 rng(TEST_SEED);
+    std::uniform_real_distribution<double> demandDist(0.0, 20.0);
+    int failures = 0;
+    int checked = 0;
+    size_t totalConfigurations = 0;
+    size_t totalPhases = 0;
+
+    for (const int n : {4, 8, 12, 16, 24})
+    {
+        for (const double density : {0.3, 0.5, 0.7})
+        {
+            for (int g = 0; g < GRAPHS_PER_SIZE; ++g)
+            {
+                std::bernoulli_distribution conflict(density);
+
+                ConflictGraph graph(n);
+                LocationSet vertices = graph.emptySet();
+                LocationSet heads = graph.emptySet();
+                std::vector<double> demand(n);
+                for (int a = 0; a < n; ++a)
+                {
+                    vertices.set(a);
+                    demand[a] = demandDist(rng);
+                    for (int b = a + 1; b < n; ++b)
+                        if (conflict(rng))
+                            graph.addConflict(a, b);
+                }
+
+                // The second PSEM of a Crosswalk has the conflicts of the first one, and is not a head
+                for (int a = 2; a + 1 < n; a += CROSSWALK_EVERY)
+                {
+                    graph.clearVertex(a + 1);
+                    for (int b = 0; b < n; ++b)
+                        if (b != a && graph.conflicts(a, b))
+                            graph.addConflict(a + 1, b);
+                }
+                heads = vertices;
+                for (int a = 3; a < n; a += CROSSWALK_EVERY)
+                    heads.reset(a);
+
+                const ConfigurationEngine engine(graph);
+                const auto configurations = engine.enumerate(vertices, ConfigurationEngine::Algorithm::BRON_KERBOSCH);
+                const auto cycle = PhaseSequencer::optimize(configurations, vertices, heads, demand);
+
+                ++checked;
+                totalConfigurations += configurations.size();
+                totalPhases += cycle.size();
+                if (!checkCycle(configurations, vertices, heads, cycle) ||
+                    !checkCrosswalkCost(configurations, vertices, heads))
+                {
+                    std::cerr << "FAILED: " << n << " locations, density " << density << "\n";
+                    ++failures;
+                }
+            }
+        }
+    }
+
+    std::cout << checked - failures << "/" << checked << " graphs passed ("
+              << totalPhases << " phases instead of " << totalConfigurations << " configurations)\n";
+    return failures ? 1 : 0;
+}
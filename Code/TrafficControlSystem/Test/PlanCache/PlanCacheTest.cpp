@@ -0,0 +1,201 @@
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+
+#include "../../ConflictGraph/ConflictGraph.hpp"
+#include "../../ConflictGraph/ConfigurationEngine.hpp"
+#include "../../ConflictGraph/PlanCache.hpp"
+
+/* TEST SET
+ *  - Round trip: a saved plan loads back the Conflict Graph, the element map and exactly the Configurations of a
+ *    fresh enumeration (several row words)
+ *  - Rejected: another configuration hash (-ESTALE); another magic or version, a size that does not match the
+ *    header (extra bytes, another Location count) and a truncated file (-EINVAL); no file (-ENOENT)
+ *  - Failed save: reported with its own errno (file size limit: -EFBIG), the previous plan left untouched
+ *
+ *  Runs on the host; returns 0 if every check passes
+ */
+
+#ifndef PLAN_CACHE_PATH
+#error "PLAN_CACHE_PATH must point to a scratch file (set by the PlanCacheTest target)"
+#endif
+
+#define TEST_SEED 3
+#define TEST_LOCATIONS 70       // two words per row
+#define TEST_DENSITY 0.6
+#define TEST_HASH 0x5eedull
+
+// PlanHeader fields (file layout, PlanCache.hpp)
+#define OFFSET_MAGIC 0
+#define OFFSET_VERSION 4
+#define OFFSET_LOCATIONS 16
+
+static int failures = 0;
+
+static void check(const bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << what << "\n";
+        ++failures;
+    }
+}
+
+static std::vector<char> readFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+static void writeFile(const std::string& path, const std::vector<char>& bytes)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+static void patch(std::vector<char>& bytes, const size_t offset, const uint32_t value)
+{
+    std::memcpy(bytes.data() + offset, &value, sizeof(value));
+}
+
+struct Plan
+{
+    ConflictGraph graph;
+    LocationSet vertices;
+    std::vector<PlanCache::Element> elements;
+    std::vector<LocationSet> configurations;
+};
+
+static Plan makePlan()
+{
+    std::mt19937 rng(TEST_SEED);
+    std::bernoulli_distribution conflict(TEST_DENSITY);
+    std::uniform_int_distribution<int> element(0, 2);
+
+    Plan plan{ConflictGraph(TEST_LOCATIONS), LocationSet(TEST_LOCATIONS), {}, {}};
+    for (int a = 0; a < TEST_LOCATIONS; ++a)
+    {
+        plan.elements.push_back(static_cast<PlanCache::Element>(element(rng)));
+        if (plan.elements.back() != PlanCache::Element::NONE)
+            plan.vertices.set(a);
+        for (int b = a + 1; b < TEST_LOCATIONS; ++b)
+            if (conflict(rng))
+                plan.graph.addConflict(a, b);
+    }
+    plan.configurations = ConfigurationEngine(plan.graph).enumerate(plan.vertices,
+        ConfigurationEngine::Algorithm::BRON_KERBOSCH);
+    return plan;
+}
+
+static void checkRoundTrip(const Plan& plan)
+{
+    check(PlanCache::save(PLAN_CACHE_PATH, TEST_HASH, plan.graph, plan.elements, plan.configurations) == 0,
+        "round trip: saved");
+
+    PlanCache cache;
+    check(cache.load(PLAN_CACHE_PATH, TEST_HASH) == 0 && cache.isLoaded(), "round trip: loaded");
+    check(cache.locations() == TEST_LOCATIONS, "round trip: Location count");
+
+    bool elements = true;
+    for (int loc = 0; loc < TEST_LOCATIONS; ++loc)
+        elements = elements && cache.element(loc) == plan.elements[loc];
+    check(elements, "round trip: element map");
+
+    ConflictGraph graph;
+    cache.conflictGraph(graph);
+    check(graph.size() == plan.graph.size() && graph.numWords() == plan.graph.numWords() &&
+        std::memcmp(graph.data(), plan.graph.data(), graph.size() * graph.numWords() * sizeof(uint64_t)) == 0,
+        "round trip: Conflict Graph rows");
+
+    const auto fresh = ConfigurationEngine(graph).enumerate(plan.vertices, ConfigurationEngine::Algorithm::BACKTRACK);
+    check(!plan.configurations.empty() && cache.configurations() == plan.configurations &&
+        cache.configurations() == fresh, "round trip: Configurations of a fresh enumeration");
+}
+
+static void checkRejected()
+{
+    const std::vector<char> saved = readFile(PLAN_CACHE_PATH);
+    PlanCache cache;
+
+    check(cache.load(PLAN_CACHE_PATH, TEST_HASH + 1) == -ESTALE && !cache.isLoaded(), "another hash: -ESTALE");
+
+    const auto rejects = [&cache](const std::vector<char>& bytes, const char* what)
+    {
+        writeFile(PLAN_CACHE_PATH, bytes);
+        check(cache.load(PLAN_CACHE_PATH, TEST_HASH) == -EINVAL && !cache.isLoaded(), what);
+    };
+
+    std::vector<char> bytes = saved;
+    patch(bytes, OFFSET_MAGIC, PLAN_CACHE_MAGIC + 1);
+    rejects(bytes, "another magic: -EINVAL");
+
+    bytes = saved;
+    patch(bytes, OFFSET_VERSION, PLAN_CACHE_VERSION + 1);
+    rejects(bytes, "another version: -EINVAL");
+
+    bytes = saved;
+    patch(bytes, OFFSET_LOCATIONS, TEST_LOCATIONS - 1);
+    rejects(bytes, "another Location count: -EINVAL");
+
+    bytes = saved;
+    bytes.insert(bytes.end(), sizeof(uint64_t), 0);
+    rejects(bytes, "extra bytes: -EINVAL");
+
+    bytes.assign(saved.begin(), saved.end() - sizeof(uint64_t));
+    rejects(bytes, "truncated by a word: -EINVAL");
+
+    bytes.assign(saved.begin(), saved.begin() + 8);
+    rejects(bytes, "truncated header: -EINVAL");
+
+    std::remove(PLAN_CACHE_PATH);
+    check(cache.load(PLAN_CACHE_PATH, TEST_HASH) == -ENOENT, "no file: -ENOENT");
+}
+
+// Writes beyond the file size limit fail with EFBIG (SIGXFSZ ignored): set by the failing call, never stale
+static void checkFailedSave(const Plan& plan)
+{
+    check(PlanCache::save(PLAN_CACHE_PATH, TEST_HASH, plan.graph, plan.elements, plan.configurations) == 0,
+        "failed save: previous plan saved");
+    const std::vector<char> previous = readFile(PLAN_CACHE_PATH);
+
+    rlimit limit{};
+    getrlimit(RLIMIT_FSIZE, &limit);
+    const rlimit restore = limit;
+    limit.rlim_cur = 64;
+    signal(SIGXFSZ, SIG_IGN);
+    setrlimit(RLIMIT_FSIZE, &limit);
+
+    errno = ENOTTY;     // left by an earlier call
+    const int ret = PlanCache::save(PLAN_CACHE_PATH, TEST_HASH + 1, plan.graph, plan.elements, plan.configurations);
+    setrlimit(RLIMIT_FSIZE, &restore);
+
+    check(ret == -EFBIG, "failed save: -EFBIG, not a stale errno");
+    check(readFile(PLAN_CACHE_PATH) == previous, "failed save: previous plan untouched");
+    check(readFile(std::string(PLAN_CACHE_PATH) + ".tmp").empty(), "failed save: temporary file removed");
+
+    check(PlanCache::save(PLAN_CACHE_PATH, TEST_HASH, plan.graph, {}, plan.configurations) == -EINVAL,
+        "element map of another size: -EINVAL");
+}
+
+int main()
+{
+    const Plan plan = makePlan();
+
+    checkRoundTrip(plan);
+    checkRejected();
+    checkFailedSave(plan);
+
+    std::remove(PLAN_CACHE_PATH);
+    std::cout << plan.configurations.size() << " configurations of " << TEST_LOCATIONS << " Locations\n"
+              << (failures ? "FAILED" : "All plan cache checks passed") << std::endl;
+    return failures ? 1 : 0;
+}
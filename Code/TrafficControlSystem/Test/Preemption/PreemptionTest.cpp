@@ -0,0 +1,309 @@
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../TrafficControlSystem.hpp"
+#include "../Common/TestIntersection.hpp"
+#include "../Common/TrafficControlSystemTestAccess.hpp"
+
+/* TEST SET
+ *  - Emergency preemption on virtual time: Emergency Vehicles arrive at every point of the Normal cycle (green,
+ *    yellow, all red) and leave after a while
+ *  - Bound: from the EMERGENCY_START to a green on the EV origin, at most YELLOW_DURATION + ALL_RED_DURATION
+ *  - Minimum yellow: no yellow is cut short, a yellow always ends in red
+ *  - Safety: the heads green at any instant belong to one Configuration
+ *  - Several EVs (keyed by sender_id): compatible origins share one preemption (a single switch); a higher
+ *    priority EV takes the preemption over, the one waiting gets it when it leaves
+ *
+ *  Host build (target PreemptionTest): GPIO is stubbed by Test/Benchmark/Stubs/rasp_gpio_stub.cpp,
+ *  the Cloud and DDS objects are created but never started; returns 0 if every check passes
+ */
+
+#ifndef PLAN_CACHE_PATH
+#error "PLAN_CACHE_PATH must point to a scratch file (set by the PreemptionTest target)"
+#endif
+
+#define TEST_SEED 16
+#define TEST_EMERGENCIES 400
+#define TEST_PINS 128
+#define WARM_UP 60.0            // s of Normal operation before the first EV
+#define EV_PASSAGE 12.0         // s, from the EV arrival to its EMERGENCY_FINISH
+#define EV_GAP_MIN 5.0          // s, Normal operation between two EVs
+#define EV_GAP_MAX 40.0
+
+static constexpr double bound = YELLOW_DURATION + ALL_RED_DURATION;
+static constexpr double epsilon = 1e-6;
+
+struct Preemption;
+
+template <>
+struct TrafficControlSystemTestAccess<Preemption>
+{
+    using PhaseState = TrafficControlSystem::PhaseState;
+    using Colour = Semaphore::TrafficColour;
+
+    TrafficControlSystem& tcs;
+    CppWrapper::VirtualClock& clock;
+
+    std::map<const TrafficSemaphore*, std::pair<Colour, double>> lastChange{};  // colour, since
+    std::array<int, 4> arrivals{};      // per PhaseState at the EV arrival
+    double worst = 0;
+    int greens = 0;                     // phases started (ALL_RED -> GREEN)
+
+    void load() const
+    {
+        for (int pin = 1; pin < TEST_PINS; ++pin)
+            tcs.availableGPIOs.push_back(pin);
+        tcs.createComponents(makeTsem());
+        tcs.createComponents(makePsem());
+        tcs.findConfigurations();
+    }
+
+    // What t_switchLight and the TCS thread have ready at the current (virtual) instant
+    void runControlLoop()
+    {
+        bool progress = true;
+        while (progress)
+        {
+            progress = false;
+
+            TrafficControlSystem::QueuedEvent queued;
+            while (tcs.eventQueue.tryReceive(queued))
+            {
+                tcs.handleEvent(queued);
+                progress = true;
+            }
+
+            TrafficControlSystem::PhaseCommand command;
+            while (tcs.switchLightQueue.tryReceive(command))
+            {
+                const PhaseState before = tcs.phaseState;
+                tcs.runPhase(command);
+                if (before != PhaseState::GREEN && tcs.phaseState == PhaseState::GREEN)
+                    ++greens;
+                progress = true;
+            }
+        }
+
+        CloudSendType message;      // the Cloud is not running
+        while (tcs.cloud.cloudSendQueue.tryReceive(message)) {}
+
+        observe();
+    }
+
+    void observe()
+    {
+        const double now = clock.now();
+        for (const auto& tsem : tcs.TrafficSemVector)
+        {
+            auto& [colour, since] = lastChange[tsem.get()];
+            const Colour current = tsem->getCurrentState();
+            if (current == colour)
+                continue;
+
+            if (colour == Colour::YELLOW)
+            {
+                check(now - since >= YELLOW_DURATION - epsilon, "minimum yellow");
+                check(current == Colour::RED, "a yellow ends in red");
+            }
+            colour = current;
+            since = now;
+        }
+
+        const bool safe = std::ranges::any_of(tcs.configurations, [this](const auto& configuration)
+        {
+            for (const auto& tsem : tcs.TrafficSemVector)
+                if (tsem->getCurrentState() == Colour::GREEN &&
+                    std::ranges::find(configuration.activeTsem, tsem.get()) == configuration.activeTsem.end())
+                    return false;
+            for (const auto& cw : tcs.crosswalks)
+                if (cw->psem1->getCurrentState() == Colour::GREEN &&
+                    std::ranges::find(configuration.crosswalk, cw.get()) == configuration.crosswalk.end())
+                    return false;
+            return true;
+        });
+        check(safe, "green heads of a single Configuration");
+    }
+
+    // Runs the control loop until 'time'; returns the instant 'until' holds (infinity if it never does)
+    template <typename Predicate>
+    double runUntil(const double time, Predicate until)
+    {
+        runControlLoop();
+        while (!until())
+        {
+            const double next = clock.nextDeadline();
+            if (next > time)
+            {
+                clock.advanceTo(time);
+                runControlLoop();
+                return until() ? clock.now() : std::numeric_limits<double>::infinity();
+            }
+            clock.advanceTo(next);
+            runControlLoop();
+        }
+        return clock.now();
+    }
+
+    void run(std::mt19937& rng)
+    {
+        load();
+        tcs.greenTime = std::make_unique<FixedGreenTime>();
+        tcs.switchLightQueue.send(tcs.systemWarning());
+        tcs.switch_state(TrafficControlSystem::SystemState::NORMAL);
+
+        runUntil(clock.now() + WARM_UP, [] { return false; });
+
+        std::uniform_real_distribution<double> gap(EV_GAP_MIN, EV_GAP_MAX);
+        for (int i = 0; i < TEST_EMERGENCIES; ++i)
+        {
+            const auto& origin = tcs.TrafficSemVector[i % tcs.TrafficSemVector.size()];
+            const int k = origin->getLocation() / 4;
+
+            const double arrival = clock.now();
+            ++arrivals[static_cast<size_t>(tcs.phaseState.load())];
+            const std::string id = "EV-" + std::to_string(i);
+            tcs.notify(nullptr, DDSEvent{DDS_Event_Qualifier::EMERGENCY_START, id, origin->getLocation(),
+                4 * ((k + 2) % 4) + 2, 1});
+
+            const double green = runUntil(arrival + EV_PASSAGE,
+                [&origin] { return origin->getCurrentState() == Colour::GREEN; });
+            check(green - arrival <= bound + epsilon, "EV origin green within yellow + all red");
+            worst = std::max(worst, green - arrival);
+
+            runUntil(arrival + EV_PASSAGE, [] { return false; });
+            check(origin->getCurrentState() == Colour::GREEN, "EV origin green until the emergency is over");
+
+            tcs.notify(nullptr, DDSEvent{DDS_Event_Qualifier::EMERGENCY_FINISH, id});
+            runUntil(clock.now() + gap(rng), [] { return false; });
+        }
+        check(tcs.state == TrafficControlSystem::SystemState::NORMAL, "back to Normal operation");
+
+        check(arrivals[static_cast<size_t>(PhaseState::GREEN)] > 0, "EVs arrived on a green");
+        check(arrivals[static_cast<size_t>(PhaseState::YELLOW)] > 0, "EVs arrived on a yellow");
+        check(arrivals[static_cast<size_t>(PhaseState::ALL_RED)] > 0, "EVs arrived on an all red");
+
+        checkSeveralEmergencies();
+    }
+
+    void arrive(const std::string& id, const TrafficSemaphore* origin, const int priority)
+    {
+        const int k = origin->getLocation() / 4;
+        tcs.notify(nullptr, DDSEvent{DDS_Event_Qualifier::EMERGENCY_START, id, origin->getLocation(),
+            4 * ((k + 2) % 4) + 2, priority});
+    }
+
+    void leave(const std::string& id)
+    {
+        tcs.notify(nullptr, DDSEvent{DDS_Event_Qualifier::EMERGENCY_FINISH, id});
+    }
+
+    static bool green(const TrafficSemaphore* tsem)
+    {
+        return tsem->getCurrentState() == Colour::GREEN;
+    }
+
+    // Two origins served together by some Configuration, and two never
+    void checkSeveralEmergencies()
+    {
+        const TrafficSemaphore* compatible[2] = {};
+        const TrafficSemaphore* conflicting[2] = {};
+        for (const auto& a : tcs.TrafficSemVector)
+            for (const auto& b : tcs.TrafficSemVector)
+            {
+                if (a == b)
+                    continue;
+                bool together = false;
+                tcs.configurationIndex.forEachServing(a->getLocation(), [&](const int c)
+                    { together |= tcs.configurationIndex.serves(b->getLocation(), c); });
+                if (together && !compatible[0] && !green(a.get()) && !green(b.get()))
+                    compatible[0] = a.get(), compatible[1] = b.get();     // both need the switch
+                if (!together && !conflicting[0])
+                    conflicting[0] = a.get(), conflicting[1] = b.get();
+            }
+        check(compatible[0] && conflicting[0], "several EVs: compatible and conflicting origins found");
+        if (!compatible[0] || !conflicting[0])
+            return;
+
+        // Compatible: one preemption, a single switch for both
+        double arrival = clock.now();
+        const int greensBefore = greens;
+        arrive("AMB-1", compatible[0], 1);
+        arrive("AMB-2", compatible[1], 1);
+        const double both = runUntil(arrival + EV_PASSAGE, [&] { return green(compatible[0]) && green(compatible[1]); });
+        check(both - arrival <= bound + epsilon, "merged EVs: both origins green within yellow + all red");
+        check(greens - greensBefore == 1, "merged EVs: a single switch");
+
+        leave("AMB-1");
+        runUntil(clock.now() + EV_PASSAGE, [] { return false; });
+        check(green(compatible[1]) && greens - greensBefore == 1, "merged EVs: the one left keeps its green");
+        leave("AMB-2");
+        runUntil(clock.now() + EV_GAP_MAX, [] { return false; });
+
+        // Conflicting: the higher priority takes over, the other waits for it to leave
+        arrive("AMB-3", conflicting[0], 1);
+        runUntil(clock.now() + EV_PASSAGE, [] { return false; });
+        check(green(conflicting[0]), "priority: first EV served");
+
+        arrival = clock.now();
+        arrive("FIRE-1", conflicting[1], 3);
+        const double over = runUntil(arrival + EV_PASSAGE, [&] { return green(conflicting[1]); });
+        check(over - arrival <= bound + epsilon, "priority: higher priority EV green within yellow + all red");
+        check(!green(conflicting[0]), "priority: lower priority EV waits");
+
+        arrive("AMB-3", conflicting[0], 1);     // periodic sample: no change
+        runUntil(clock.now() + EV_PASSAGE, [] { return false; });
+        check(green(conflicting[1]) && !green(conflicting[0]), "priority: refreshed EV keeps waiting");
+
+        arrival = clock.now();
+        leave("FIRE-1");
+        const double back = runUntil(arrival + EV_PASSAGE, [&] { return green(conflicting[0]); });
+        check(back - arrival <= bound + epsilon, "priority: waiting EV green once the other leaves");
+        check(tcs.state == TrafficControlSystem::SystemState::EMERGENCY, "priority: still an emergency");
+
+        leave("AMB-3");
+        runUntil(clock.now() + EV_PASSAGE, [] { return false; });
+        check(tcs.state == TrafficControlSystem::SystemState::NORMAL, "several EVs: back to Normal operation");
+    }
+};
+using PreemptionTest = TrafficControlSystemTestAccess<Preemption>;
+
+int main()
+{
+    std::ostream report(std::cout.rdbuf());
+    std::cout.rdbuf(nullptr);       // silences the system's own logging
+    std::cerr.rdbuf(nullptr);
+
+    CppWrapper::VirtualClock clock;
+    TrafficControlSystem& tcs = TrafficControlSystem::getInstance();
+    tcs.useClock(clock);
+    PreemptionTest test{tcs, clock};
+    std::mt19937 rng(TEST_SEED);
+
+    try
+    {
+        test.run(rng);
+    }
+    catch (const std::exception& e)
+    {
+        report << "Preemption test failed: " << e.what() << "\n";
+        failures = 1;
+    }
+
+    using PhaseState = TrafficControlSystem::PhaseState;
+    report << TEST_EMERGENCIES << " EVs arriving on green " << test.arrivals[static_cast<size_t>(PhaseState::GREEN)]
+           << ", yellow " << test.arrivals[static_cast<size_t>(PhaseState::YELLOW)]
+           << ", all red " << test.arrivals[static_cast<size_t>(PhaseState::ALL_RED)]
+           << ": worst arrival -> origin green " << test.worst
+           << " s (bound " << bound << " s)\n";
+    report << (failures ? "FAILED" : "All preemption checks passed") << std::endl;
+
+    std::remove(PLAN_CACHE_PATH);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,336 @@
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <tuple>
+
+#include "../../TrafficControlSystem.hpp"
+#include "../../Messages/EventPayloads.hpp"
+#include "../Common/TestIntersection.hpp"
+#include "../Common/TrafficControlSystemTestAccess.hpp"
+
+/* TEST SET
+ *  - Live reconfiguration requests (Component_update) go through the event queue, and are applied by the TCS
+ *    thread (Normal strategy): a TSEM and a Crosswalk are added, the TSEM modified, then a TSEM and a Crosswalk
+ *    (by its second PSEM) removed
+ *  - The element vectors t_switchLight reads are not touched until the phase boundary: the pending plan is only
+ *    swapped in there (organizeNextConfiguration), the lights never leave Normal operation
+ *  - After each swap: the Configurations and the Transition Table (elements switched, GPIO masks) equal those of
+ *    a Traffic Control System built from scratch (findConfigurations) with the same Intersection Elements
+ *  - An element added and removed before the swap never joins the element vectors; invalid requests change nothing
+ *
+ *  Host build (target ReconfigurationTest): GPIO is stubbed by Test/Benchmark/Stubs/rasp_gpio_stub.cpp, the Cloud
+ *  and DDS objects are created but never started; returns 0 if every check passes
+ */
+
+#ifndef PLAN_CACHE_PATH
+#error "PLAN_CACHE_PATH must point to a scratch file (set by the ReconfigurationTest target)"
+#endif
+
+#define TEST_PINS 128
+#define SWAP_LIMIT 120.0        // s: plan not swapped in by then - failed
+
+using Operation = rx_cloud::Component_update::Operation;
+using Locations = std::set<int>;
+// From, to, then OFF/ON TSEMs and Crosswalks (first PSEM) - the masks of its three steps, bulk
+using TransitionKey = std::tuple<Locations, Locations, Locations, Locations, Locations, Locations>;
+using TransitionMasks = std::tuple<uint64_t, uint64_t, uint64_t, uint64_t, uint64_t, uint64_t, bool>;
+
+// Intersection Elements of the test: the configuration JSON of each one, by Location
+struct Intersection
+{
+    std::map<int, json> tsem;
+    std::map<int, json> psem;
+
+    [[nodiscard]] std::shared_ptr<json> tsemFile() const
+    {
+        auto file = std::make_shared<json>(json::array());
+        for (const auto& [loc, data] : tsem)
+            file->push_back(data);
+        return file;
+    }
+
+    [[nodiscard]] std::shared_ptr<json> psemFile() const
+    {
+        auto file = std::make_shared<json>(json::array());
+        for (const auto& [loc, data] : psem)
+            file->push_back(data);
+        return file;
+    }
+};
+
+static json tsemData(const int loc, const std::initializer_list<int> destinations, const int pin)
+{
+    return {{"name", "TS" + std::to_string(loc)}, {"location", loc}, {"destinations", destinations},
+        {"gpio_red", pin}, {"gpio_green", pin + 1}, {"gpio_yellow", pin + 2}};
+}
+
+static json psemData(const int loc, const int pin)
+{
+    return {{"name", "PS" + std::to_string(loc)}, {"location", loc}, {"gpio_red", pin}, {"gpio_green", pin + 1},
+        {"hasButton", 0}, {"hasCardReader", 0}, {"hasBuzzer", 0}};
+}
+
+struct Reconfiguration;
+
+template <>
+struct TrafficControlSystemTestAccess<Reconfiguration>
+{
+    using Configuration = TrafficControlSystem::Configuration;
+
+    TrafficControlSystem& tcs;
+    CppWrapper::VirtualClock& clock;
+
+    static void setUp(TrafficControlSystem& system, const Intersection& intersection)
+    {
+        for (int pin = 1; pin < TEST_PINS; ++pin)
+            system.availableGPIOs.push_back(pin);
+        system.createComponents(intersection.tsemFile());
+        system.createComponents(intersection.psemFile());
+        std::remove(PLAN_CACHE_PATH);      // enumerated, not loaded from a previous instance
+        system.findConfigurations();
+    }
+
+    void start(const Intersection& intersection) const
+    {
+        tcs.useClock(clock);
+        setUp(tcs, intersection);
+
+        tcs.greenTime = std::make_unique<FixedGreenTime>();
+        tcs.switchLightQueue.send(tcs.systemWarning());
+        tcs.switch_state(TrafficControlSystem::SystemState::NORMAL);
+    }
+
+    void runControlLoop() const
+    {
+        bool progress = true;
+        while (progress)
+        {
+            progress = false;
+
+            TrafficControlSystem::QueuedEvent queued;
+            while (tcs.eventQueue.tryReceive(queued))
+            {
+                tcs.handleEvent(queued);
+                progress = true;
+            }
+
+            TrafficControlSystem::PhaseCommand command;
+            while (tcs.switchLightQueue.tryReceive(command))
+            {
+                tcs.runPhase(command);
+                progress = true;
+            }
+        }
+
+        CloudSendType message;      // the Cloud is not running
+        while (tcs.cloud.cloudSendQueue.tryReceive(message)) {}
+    }
+
+    // Runs until 'time', or until 'until' holds: the instant it holds (infinity if it never does)
+    template <typename Predicate>
+    double runUntil(const double time, Predicate until) const
+    {
+        runControlLoop();
+        while (!until())
+        {
+            const double next = clock.nextDeadline();
+            if (next > time)
+            {
+                clock.advanceTo(time);
+                runControlLoop();
+                return until() ? clock.now() : std::numeric_limits<double>::infinity();
+            }
+            clock.advanceTo(next);
+            runControlLoop();
+        }
+        return clock.now();
+    }
+
+    // As the Cloud posts it (CloudInterface::notifyComponentUpdate)
+    void post(const Operation operation, const int location, json data = {}) const
+    {
+        rx_cloud::Component_update update{operation, location};
+        if (operation != Operation::REMOVE)
+            update.file = EventPayloads::instance().put(std::make_shared<json>(std::move(data)));
+        check(tcs.notify(nullptr, Event{CloudReceiveType{update}}) == 0, "update posted");
+    }
+
+    [[nodiscard]] size_t elements() const
+    {
+        return tcs.TrafficSemVector.size() + tcs.PedestrianSemVector.size() + tcs.crosswalks.size();
+    }
+
+    // The update is applied on the TCS thread, the element vectors only change at the phase boundary
+    void apply(const Operation operation, const int location, json data, const char* what) const
+    {
+        const size_t before = elements();
+        post(operation, location, std::move(data));
+        runControlLoop();
+
+        const std::string prefix = std::string(what) + ": ";
+        check(tcs.planPending, (prefix + "handled by the TCS thread, plan pending").c_str());
+        check(elements() == before, (prefix + "element vectors untouched until the phase boundary").c_str());
+
+        const double swapped = runUntil(clock.now() + SWAP_LIMIT, [this] { return !tcs.planPending; });
+        check(swapped < std::numeric_limits<double>::infinity(), (prefix + "plan swapped in").c_str());
+        check(tcs.addedTsem.empty() && tcs.addedPedestrianSem.empty() && tcs.addedCrosswalks.empty() &&
+            tcs.removedTsem.empty() && tcs.removedCrosswalks.empty(), (prefix + "nothing left pending").c_str());
+        check(tcs.state == TrafficControlSystem::SystemState::NORMAL, (prefix + "still Normal").c_str());
+    }
+
+    static Locations locations(const Configuration& configuration)
+    {
+        Locations set;
+        for (const TrafficSemaphore* tsem : configuration.activeTsem)
+            set.insert(tsem->getLocation());
+        for (const TrafficControlSystem::Crosswalk* cw : configuration.crosswalk)
+        {
+            set.insert(cw->psem1->getLocation());
+            set.insert(cw->psem2->getLocation());
+        }
+        return set;
+    }
+
+    static std::map<TransitionKey, TransitionMasks> transitions(const TrafficControlSystem& system)
+    {
+        const auto tsemSet = [](const auto& span)
+        {
+            Locations set;
+            for (const TrafficSemaphore* tsem : span)
+                set.insert(tsem->getLocation());
+            return set;
+        };
+        const auto crosswalkSet = [](const auto& span)
+        {
+            Locations set;
+            for (const TrafficControlSystem::Crosswalk* cw : span)
+                set.insert(cw->psem1->getLocation());
+            return set;
+        };
+
+        std::map<TransitionKey, TransitionMasks> table;
+        const size_t n = system.configurations.size();
+        for (size_t from = 0; from < n; ++from)
+            for (size_t to = 0; to < n; ++to)
+            {
+                const auto& t = system.transitionTable.transitions[from * n + to];
+                table[{locations(system.configurations[from]), locations(system.configurations[to]),
+                    tsemSet(t.OFF_Tsem), tsemSet(t.ON_Tsem), crosswalkSet(t.OFF_Crosswalk),
+                    crosswalkSet(t.ON_Crosswalk)}] = {t.yellowStep.set, t.yellowStep.clear, t.redStep.set,
+                    t.redStep.clear, t.greenStep.set, t.greenStep.clear, t.bulk};
+            }
+        return table;
+    }
+
+    // Same Configurations and Transition Table as a system built from scratch
+    void checkRebuild(const Intersection& intersection, const char* what) const
+    {
+        const auto rebuilt = std::unique_ptr<TrafficControlSystem>(new TrafficControlSystem);
+        setUp(*rebuilt, intersection);
+
+        std::set<Locations> live;
+        for (const auto& configuration : tcs.configurations)
+            live.insert(locations(configuration));
+        std::set<Locations> scratch;
+        for (const auto& configuration : rebuilt->configurations)
+            scratch.insert(locations(configuration));
+
+        const std::string prefix = std::string(what) + ": ";
+        check(tcs.configurations.size() == rebuilt->configurations.size() && live == scratch,
+            (prefix + "Configurations equal a full rebuild").c_str());
+        check(transitions(tcs) == transitions(*rebuilt), (prefix + "Transition Table equals a full rebuild").c_str());
+        check(tcs.TrafficSemVector.size() == intersection.tsem.size() &&
+            tcs.PedestrianSemVector.size() == intersection.psem.size() &&
+            tcs.crosswalks.size() == intersection.psem.size() / 2, (prefix + "element vectors").c_str());
+    }
+
+    // Added, then removed in the same plan: retired at once, never in the element vectors
+    void checkAddedAndRemoved(const int loc, const int pin) const
+    {
+        const size_t before = elements();
+        post(Operation::ADD, -1, tsemData(loc, {2}, pin));
+        post(Operation::REMOVE, loc);
+        runControlLoop();
+        check(tcs.addedTsem.empty() && tcs.retiredTsem.size() == 1, "added and removed: retired at once");
+
+        runUntil(clock.now() + SWAP_LIMIT, [this] { return !tcs.planPending; });
+        check(elements() == before, "added and removed: never in the element vectors");
+    }
+
+    // Rejected requests leave the plan as it is
+    void checkInvalid(const Intersection& intersection) const
+    {
+        post(Operation::REMOVE, 63);                                    // nothing there
+        post(Operation::MODIFY, -1, {{"location", 3}, {"destinations", {2}}});     // a PSEM
+        post(Operation::ADD, -1, tsemData(intersection.tsem.begin()->first, {2}, 60));     // Location taken
+        runControlLoop();
+        check(!tcs.planPending, "invalid requests: no plan pending");
+        checkRebuild(intersection, "invalid requests");
+    }
+};
+using ReconfigurationTest = TrafficControlSystemTestAccess<Reconfiguration>;
+
+int main()
+{
+    std::ostream report(std::cout.rdbuf());
+    std::cout.rdbuf(nullptr);       // silences the system's own logging
+    std::cerr.rdbuf(nullptr);
+
+    // The shared test Intersection, by Location
+    Intersection intersection;
+    const auto tsem = makeTsem();
+    for (const auto& data : *tsem)
+        intersection.tsem[data["location"]] = data;
+    const auto psem = makePsem();
+    for (const auto& data : *psem)
+        intersection.psem[data["location"]] = data;
+
+    CppWrapper::VirtualClock clock;
+    ReconfigurationTest test{TrafficControlSystem::getInstance(), clock};
+
+    try
+    {
+        test.start(intersection);
+        test.runUntil(clock.now() + SWAP_LIMIT / 2, [] { return false; });
+
+        // Arm 1 gets a Crosswalk, a new approach (Location 16) joins
+        intersection.tsem[16] = tsemData(16, {2}, 30);
+        test.apply(Operation::ADD, -1, intersection.tsem[16], "TSEM added");
+        test.checkRebuild(intersection, "TSEM added");
+
+        intersection.psem[4] = psemData(4, 40);
+        intersection.psem[7] = psemData(7, 42);
+        test.apply(Operation::ADD, -1, json::array({intersection.psem[7], intersection.psem[4]}), "Crosswalk added");
+        test.checkRebuild(intersection, "Crosswalk added");
+
+        intersection.tsem[16]["destinations"] = {6, 10};
+        test.apply(Operation::MODIFY, -1, {{"location", 16}, {"destinations", {6, 10}}}, "TSEM modified");
+        test.checkRebuild(intersection, "TSEM modified");
+
+        intersection.tsem.erase(13);
+        test.apply(Operation::REMOVE, 13, {}, "TSEM removed");
+        test.checkRebuild(intersection, "TSEM removed");
+
+        intersection.psem.erase(8);
+        intersection.psem.erase(11);
+        test.apply(Operation::REMOVE, 11, {}, "Crosswalk removed");
+        test.checkRebuild(intersection, "Crosswalk removed");
+
+        test.checkAddedAndRemoved(17, 50);
+        test.checkInvalid(intersection);
+    }
+    catch (const std::exception& e)
+    {
+        report << "Reconfiguration test failed: " << e.what() << "\n";
+        failures = 1;
+    }
+
+    report << (failures ? "FAILED" : "All reconfiguration checks passed") << std::endl;
+
+    std::remove(PLAN_CACHE_PATH);
+    return failures ? 1 : 0;
+}
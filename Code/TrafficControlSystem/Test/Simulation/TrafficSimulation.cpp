@@ -0,0 +1,329 @@
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "../../TrafficControlSystem.hpp"
+#include "../Common/TrafficControlSystemTestAccess.hpp"
+
+/* SIMULATION
+ *  - The Traffic Control System's control loop (event queue, strategies, phase switching) on virtual time,
+ *    on a single thread: days of traffic run in seconds, with the same results on every run
+ *  - Vehicles arrive at each approach (Poisson), are detected (VehicleDetectorEvent) and leave while their
+ *    TSEM is green, one per saturation headway; pedestrians press the crosswalk buttons
+ *  - Compares the green time policies (fixed, actuated): throughput, delay and queues
+ *
+ *  Host build (target TrafficSimulation): GPIO is stubbed by Test/Benchmark/Stubs/rasp_gpio_stub.cpp,
+ *  the Cloud and DDS objects are created but never started
+ */
+
+#ifndef PLAN_CACHE_PATH
+#error "PLAN_CACHE_PATH must point to a scratch file (set by the TrafficSimulation target)"
+#endif
+
+#define SIM_SEED 42
+#define SIM_HOURS 24
+#define SIM_PINS 128
+#define SATURATION_HEADWAY 2.0     // s, between vehicles leaving a queue
+#define STARTUP_LOST_TIME 2.0      // s, before the first vehicle of a queue leaves
+#define PEDESTRIAN_RATE (30.0 / 3600)   // button presses per second, per crosswalk side
+
+using WallClock = std::chrono::steady_clock;
+
+/*--- Scenario -------------------------------------------------------------------------------------------------------*/
+struct Scenario
+{
+    const char* name;
+    double armRate[4];      // vehicles per second, per approach
+};
+
+/*  4 arms, 4 Locations each (clockwise), as in the planning benchmark:
+ *      4k: crosswalk side A | 4k+1: approach (TSEM) | 4k+2: exit | 4k+3: crosswalk side B
+ *   *  Each approach goes straight and turns right
+ *   *  Arms 0 and 2 have a crosswalk
+ */
+static std::shared_ptr<json> makeTsem()
+{
+    auto tsem = std::make_shared<json>(json::array());
+    int pin = 1;
+    for (int k = 0; k < 4; ++k)
+    {
+        tsem->push_back({
+            {"name", "TS" + std::to_string(k)}, {"location", 4 * k + 1},
+            {"destinations", {4 * ((k + 2) % 4) + 2, 4 * ((k + 1) % 4) + 2}},
+            {"gpio_red", pin}, {"gpio_green", pin + 1}, {"gpio_yellow", pin + 2}});
+        pin += 3;
+    }
+    return tsem;
+}
+
+static std::shared_ptr<json> makePsem()
+{
+    auto psem = std::make_shared<json>(json::array());
+    int pin = 20;
+    for (const int loc : {0, 3, 8, 11})
+    {
+        psem->push_back({
+            {"name", "PS" + std::to_string(loc)}, {"location", loc}, {"gpio_red", pin}, {"gpio_green", pin + 1},
+            {"hasButton", 0}, {"hasCardReader", 0}, {"hasBuzzer", 0}});
+        pin += 2;
+    }
+    return psem;
+}
+
+/*--- Traffic --------------------------------------------------------------------------------------------------------*/
+struct Approach
+{
+    TrafficSemaphore* tsem;
+    std::exponential_distribution<double> interArrival;
+    double nextArrival;
+    double nextDeparture;       // earliest time the next vehicle can leave (while green)
+    bool green;
+    std::deque<double> queue;   // arrival times
+};
+
+struct Result
+{
+    size_t served = 0;
+    double totalDelay = 0;
+    size_t maxQueue = 0;
+    size_t phases = 0;
+    double wallSeconds = 0;
+};
+
+/*--- Control loop on virtual time -----------------------------------------------------------------------------------*/
+struct Simulation;
+
+template <>
+struct TrafficControlSystemTestAccess<Simulation>
+{
+    using PhaseState = TrafficControlSystem::PhaseState;
+
+    TrafficControlSystem& tcs;
+    CppWrapper::VirtualClock& clock;
+
+    void load() const
+    {
+        tcs.configurations.clear();
+        tcs.planSets.clear();
+        tcs.phaseSequence.clear();
+        tcs.sequencePos = -1;
+        tcs.current_config_idx = 0;
+        tcs.planPending = false;
+        tcs.crosswalks.clear();
+        tcs.TrafficSemVector.clear();
+        tcs.PedestrianSemVector.clear();
+        tcs.elementByLocation.clear();
+        tcs.usedGPIOs.clear();
+        tcs.availableGPIOs.clear();
+        for (int pin = 1; pin < SIM_PINS; ++pin)
+            tcs.availableGPIOs.push_back(pin);
+        tcs.maxLocation = 0;
+        tcs.configHash = 0;
+
+        tcs.createComponents(makeTsem());
+        tcs.createComponents(makePsem());
+        tcs.findConfigurations();
+    }
+
+    // Runs whatever the control loop has ready at the current (virtual) instant; returns the phases started
+    size_t runControlLoop()
+    {
+        size_t phases = 0;
+        bool progress = true;
+        while (progress)
+        {
+            progress = false;
+
+            TrafficControlSystem::QueuedEvent queued;
+            while (tcs.eventQueue.tryReceive(queued))
+            {
+                tcs.handleEvent(queued);
+                progress = true;
+            }
+
+            // Targets and timer expirations (queued by the Timer on virtual time), as t_switchLight
+            TrafficControlSystem::PhaseCommand command;
+            while (tcs.switchLightQueue.tryReceive(command))
+            {
+                const PhaseState before = tcs.phaseState;
+                tcs.runPhase(command);
+                if (before != PhaseState::GREEN && tcs.phaseState == PhaseState::GREEN)
+                    ++phases;
+                progress = true;
+            }
+        }
+
+        CloudSendType message;      // the Cloud is not running
+        while (tcs.cloud.cloudSendQueue.tryReceive(message)) {}
+        return phases;
+    }
+
+    Result run(const Scenario& scenario, std::unique_ptr<I_GreenTime> policy, std::mt19937& rng)
+    {
+        constexpr double never = std::numeric_limits<double>::infinity();
+        Result result;
+        const auto wallStart = WallClock::now();
+
+        load();
+        tcs.greenTime = std::move(policy);
+        tcs.switchLightQueue.send(tcs.systemWarning());
+        tcs.switch_state(TrafficControlSystem::SystemState::NORMAL);
+
+        const double start = clock.now();
+        const double end = start + SIM_HOURS * 3600.0;
+
+        std::vector<Approach> approaches;
+        for (const auto& tsem : tcs.TrafficSemVector)
+        {
+            const double rate = scenario.armRate[tsem->getLocation() / 4];
+            approaches.push_back({tsem.get(), std::exponential_distribution<double>(rate), 0, never, false, {}});
+            approaches.back().nextArrival = start + approaches.back().interArrival(rng);
+        }
+
+        std::exponential_distribution<double> pedestrianGap(PEDESTRIAN_RATE);
+        std::vector<std::pair<int, double>> buttons;
+        for (const auto& psem : tcs.PedestrianSemVector)
+            buttons.emplace_back(psem->getLocation(), start + pedestrianGap(rng));
+
+        while (true)
+        {
+            result.phases += runControlLoop();
+            const double now = clock.now();
+
+            // Queues start leaving at the start of the green, and stop at its end
+            double next = clock.nextDeadline();
+            for (auto& a : approaches)
+            {
+                const bool green = a.tsem->getCurrentState() == Semaphore::TrafficColour::GREEN;
+                if (green && !a.green)
+                    a.nextDeparture = now + STARTUP_LOST_TIME;
+                else if (!green)
+                    a.nextDeparture = never;
+                a.green = green;
+
+                next = std::min(next, a.nextArrival);
+                if (!a.queue.empty())
+                    next = std::min(next, a.nextDeparture);
+            }
+            for (const auto& [loc, press] : buttons)
+                next = std::min(next, press);
+
+            if (next > end)
+                break;
+            clock.advanceTo(next);
+
+            for (auto& a : approaches)
+            {
+                if (!a.queue.empty() && a.nextDeparture <= next)
+                {
+                    result.totalDelay += next - a.queue.front();
+                    ++result.served;
+                    a.queue.pop_front();
+                    a.nextDeparture = next + SATURATION_HEADWAY;
+                }
+                if (a.nextArrival <= next)
+                {
+                    if (a.queue.empty() && a.nextDeparture <= next)     // green, no queue: does not stop
+                    {
+                        ++result.served;
+                        a.nextDeparture = next + SATURATION_HEADWAY;
+                    }
+                    else
+                    {
+                        a.queue.push_back(next);
+                        result.maxQueue = std::max(result.maxQueue, a.queue.size());
+                    }
+                    tcs.notify(nullptr, VehicleDetectorEvent{a.tsem->getLocation()});
+                    a.nextArrival = next + a.interArrival(rng);
+                }
+            }
+            for (auto& [loc, press] : buttons)
+            {
+                if (press <= next)
+                {
+                    tcs.notify(nullptr, PedestrianButtonEvent{loc});
+                    press = next + pedestrianGap(rng);
+                }
+            }
+        }
+
+        // Leftovers of this run
+        TrafficControlSystem::QueuedEvent queued;
+        while (tcs.eventQueue.tryReceive(queued)) {}
+        TrafficControlSystem::PhaseCommand command;
+        while (tcs.switchLightQueue.tryReceive(command)) {}
+        tcs.timerSwitchLight.cancel();
+        tcs.invalidatePhases();         // staged into this plan
+        tcs.startedPhase.reset();
+        tcs.phaseState = PhaseState::IDLE;
+        tcs.clearingTsem.clear();       // heads destroyed by the next load()
+        tcs.clearingStep = {};
+        tcs.clearingBulk = true;
+        tcs.state = TrafficControlSystem::SystemState::SET_UP;
+
+        result.wallSeconds = std::chrono::duration<double>(WallClock::now() - wallStart).count();
+        return result;
+    }
+};
+using TrafficSimulation = TrafficControlSystemTestAccess<Simulation>;
+
+static void row(std::ostream& report, const char* policy, const Result& r)
+{
+    const double hours = SIM_HOURS;
+    report << "  " << std::left << std::setw(10) << policy << std::right << std::fixed
+           << std::setprecision(0) << std::setw(12) << r.served / hours
+           << std::setprecision(1) << std::setw(12) << (r.served ? r.totalDelay / r.served : 0.0)
+           << std::setw(10) << r.maxQueue
+           << std::setprecision(0) << std::setw(10) << r.phases / hours
+           << std::setprecision(2) << std::setw(10) << r.wallSeconds
+           << std::setprecision(0) << std::setw(12) << SIM_HOURS * 3600.0 / r.wallSeconds << "x\n";
+}
+
+int main()
+{
+    std::ostream report(std::cout.rdbuf());
+    std::cout.rdbuf(nullptr);       // silences the system's own logging
+    std::cerr.rdbuf(nullptr);
+
+    CppWrapper::VirtualClock clock;
+    TrafficControlSystem& tcs = TrafficControlSystem::getInstance();
+    tcs.useClock(clock);
+    TrafficSimulation simulation{tcs, clock};
+
+    const Scenario scenarios[] = {
+        {"Off-peak", {0.02, 0.02, 0.02, 0.02}},
+        {"Peak", {0.10, 0.10, 0.10, 0.10}},
+        {"Main road (arms 0 and 2)", {0.15, 0.02, 0.15, 0.02}},
+    };
+
+    try
+    {
+        for (const auto& scenario : scenarios)
+        {
+            report << scenario.name << ", " << SIM_HOURS << " h\n";
+            report << "  " << std::left << std::setw(10) << "policy" << std::right << std::setw(12) << "veh/h"
+                   << std::setw(12) << "delay[s]" << std::setw(10) << "max queue" << std::setw(10) << "phases/h"
+                   << std::setw(10) << "wall[s]" << std::setw(13) << "speed-up" << "\n";
+
+            // Same arrivals for both policies
+            std::mt19937 fixedRng(SIM_SEED);
+            row(report, "fixed", simulation.run(scenario, std::make_unique<FixedGreenTime>(), fixedRng));
+            std::mt19937 actuatedRng(SIM_SEED);
+            row(report, "actuated", simulation.run(scenario, std::make_unique<ActuatedGreenTime>(), actuatedRng));
+            report << std::endl;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        report << "Simulation failed: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::remove(PLAN_CACHE_PATH);
+    return 0;
+}
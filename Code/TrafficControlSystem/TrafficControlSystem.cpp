@@ -1,4 +1,6 @@
 #include "TrafficControlSystem.hpp"
+#include "TrafficStrategy/StrategyTable.hpp"
+#include "Messages/EventPayloads.hpp"
 
 #include <cerrno>       // Error codes in: asm-generic/errno.h AND errno-base.h
 #include <iostream>
@@ -8,17 +10,28 @@
 #include <csignal>
 #include <variant>
 #include <type_traits>
+#include <cstring>
+#include <limits>
 
-#define YELLOW_DURATION 2 // seconds
 #define START_UP_CONFIG_DURATION 10 // seconds
-#define FIRE_TIMER_IMMEDIATELY 1e-9
+#define PHASE_HOLD 0    // green time of an emergency Configuration: held until the next target
+#define PHASE_UNTIMED (-1)  // green time of a staged phase, until the TCS thread times it
 
 #define USE_CLOUD
+#define USE_ACTUATED_GREEN  // demand-driven green time; otherwise, fixed Configuration time
 
-int TrafficControlSystem::maxLocation = 0;
+#define CONFIGURATION_ALGORITHM ConfigurationEngine::Algorithm::BRON_KERBOSCH
+#define CONFIGURATION_WORKERS 4     // Raspberry Pi 4 cores
+#ifndef PLAN_CACHE_PATH
+#define PLAN_CACHE_PATH "/root/intersection.plan"
+#endif
+
+#define DEMAND_DECAY 0.5    // demand kept from one cycle to the next
 
 std::atomic<bool> TrafficControlSystem::_shutdown_requested{false};
 CppWrapper::Mutex TrafficControlSystem::mutexShutdown;
+thread_local const TrafficControlSystem::QueuedEvent* TrafficControlSystem::handledEvent = nullptr;
+thread_local const TrafficControlSystem* TrafficControlSystem::handlingSystem = nullptr;
 CppWrapper::CondVar TrafficControlSystem::condShutdown(mutexShutdown);
 
 TrafficControlSystem& TrafficControlSystem::getInstance()
@@ -30,22 +43,50 @@ TrafficControlSystem& TrafficControlSystem::getInstance()
 TrafficControlSystem::TrafficControlSystem():
     username("raspMari.local"),
     cloud("http://192.168.1.185:3000", username, "tmc1", this, _shutdown_requested),
-    tcsThread(t_tcs),
-    switchLightThread(t_switchLight),
+    tcsThread(t_tcs, CppWrapper::ThreadRole::CONTROL, "tcs"),
+    switchLightThread(t_switchLight, CppWrapper::ThreadRole::PHASE, "switch-light"),
     ddsSubscriber(_shutdown_requested, 0, "EmergencyAlert", this)
 {
     state = SystemState::SET_UP;
+    setUpFiles = 0;
+    maxLocation = 0;
     current_config_idx = 0;
+    sequencePos = -1;
+    configurationAlgorithm = CONFIGURATION_ALGORITHM;
+    configHash = 0;
+    planPending = false;
+    clock = &CppWrapper::MonotonicClock::instance();
+    phaseState = PhaseState::IDLE;
+    clearingStep = {};
+    clearingBulk = true;
+    greenExpired = true;
+    greenWaveLink = nullptr;
+    greenHeld = false;
+    cycleCount = 0;
+    stagedCycleDirty = false;
+    flashOn = {};
+    flashOff = {};
+    failed = false;
+    flashing = false;
+    flashTicks = 0;
+    droppedEvents = 0;
+    timerSwitchLight.onExpire(phaseTimerExpired, this);
+#ifdef USE_ACTUATED_GREEN
+    greenTime = std::make_unique<ActuatedGreenTime>();
+#else
+    greenTime = std::make_unique<FixedGreenTime>();
+#endif
     availableGPIOs = {1, 2, 3, 4, 5, 6, 7, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27};//22 total
 
     initComponentFactory();
-    initTrafficStrategies();
     initSystemSignals();
 }
 
 TrafficControlSystem::~TrafficControlSystem()
 {
     std::cerr<<"TCS destroyed\n";
+    watchdog.stop();
+    flashTimer.cancel();
 }
 
 /* Initialize some system requirements
@@ -56,6 +97,8 @@ void TrafficControlSystem::start()
     // Start threads
     tcsThread.run(this);
     switchLightThread.run(this);
+    if (const int ret = latencyTrace.start(); ret < 0)
+        std::cerr << "Latency report not available: " << strerror(-ret) << "\n";
 
     cloud.cloudStart();
     ddsSubscriber.start();
@@ -67,21 +110,35 @@ void TrafficControlSystem::startComponents() const
 {
     for (auto& psem: PedestrianSemVector)
         psem->start();
+
+    // Every thread of the set up is running: their effective scheduling, once
+    CppWrapper::Executor::report(std::cout);
 }
 
 void TrafficControlSystem::waitStop()
 {
+    watchdog.stop();            // the threads it watches are stopping
+    flashTimer.cancel();
     switchLightQueue.interrupt();
     eventQueue.interrupt();
 
     ddsSubscriber.stop();
+    if (ddsGreenWave)
+        ddsGreenWave->stop();
     cloud.stop();
 
     for (auto& psem: PedestrianSemVector)
         psem->stop();
+    for (auto& psem: addedPedestrianSem)
+        psem->stop();
+    for (auto& psem: retiredPedestrianSem)
+        psem->stop();
 
     switchLightThread.join();
     tcsThread.join();
+
+    latencyTrace.dump(std::cerr);
+    latencyTrace.stop();
 }
 
 void TrafficControlSystem::initComponentFactory()
@@ -92,123 +149,157 @@ void TrafficControlSystem::initComponentFactory()
      *   since lambdas are not member functions: they are objects which behave like functions
      */
     componentFactory[Components::PEDESTRIAN_SEMAPHORE] =
-     [this](const json& data) -> int
-     {
-         const std::string validationData [] = {"location", "gpio_red", "gpio_green", "hasButton",
-             "hasCardReader", "hasBuzzer"};
-
-         for (const auto &i : validationData)
-         {
-             // Data is expected to come as an integer
-             if (!data.contains(i) || !data[i].is_number_integer())
-                 throw::std::runtime_error("PSEM: " + i + " field not configured\n");
-         }
-
-         int loc = data["location"];
-         if (checkLocation(Components::PEDESTRIAN_SEMAPHORE, loc) < 0)
-             throw::std::runtime_error("PSEM: location invalid\n");
-
-         int gpio_red = data["gpio_red"];
-         int gpio_green = data["gpio_green"];
-         if (processPin(gpio_red) < 0 || processPin(gpio_green) < 0)
-             throw::std::runtime_error("PSEM: GPIO red/green exist\n");
-
-         PedestrianFeatures feature = {};
-         int threshold = 0;
-         int gpio_button = 0;
-
-         if (data["hasButton"]==1)
-         {
-             if (!data.contains("buttonThreshold") || !data.contains("gpio_button"))
-                 throw::std::runtime_error("PSEM: GPIO button config not exist\n");
-
-             threshold = data["buttonThreshold"];
-             gpio_button = data["gpio_button"];
-             if (processPin(gpio_button) < 0)
-                 throw::std::runtime_error("PSEM: GPIO button exist\n");
-
-             feature |= PedestrianFeatures::Button;
-         }
-
-         if (data["hasCardReader"]==1)
-             feature |= PedestrianFeatures::CardReader;
-
-         if (data["hasBuzzer"]==1)
-             feature |= PedestrianFeatures::Buzzer;
-
-         PedestrianSemVector.push_back(
-         std::make_unique<PedestrianSemaphore>(
-             this,
-             _shutdown_requested,
-             loc,
-             feature,
-             gpio_red,
-             gpio_green,
-             gpio_button,
-             threshold
-
-         ));
-
-         return 0;
-     };
-
-    componentFactory[Components::TRAFFIC_SEMAPHORE]=
-        [this](const json& data)
+        [this](const json& data) -> int
+        {
+            PedestrianSemVector.push_back(makePedestrianSemaphore(data));
+            return 0;
+        };
+
+    componentFactory[Components::TRAFFIC_SEMAPHORE] =
+        [this](const json& data) -> int
+        {
+            TrafficSemVector.push_back(makeTrafficSemaphore(data));
+            return 0;
+        };
+
+    // Corridor coordination: 'location' (TSEM on the corridor) and, for a follower, 'upstream' and 'offset' (s)
+    componentFactory[Components::GREEN_WAVE] =
+        [this](const json& data) -> int
         {
-            const std::string validationData [] = {"location", "destinations", "gpio_red", "gpio_green", "gpio_yellow"};
+            if (!data.contains("location") || !data["location"].is_number_integer())
+                throw::std::runtime_error("GW: location field not configured\n");
 
-            for (const auto &i : validationData)
+            std::string upstream;
+            double offset = 0;
+            if (data.contains("upstream"))
             {
-                // Data is expected to come as an integer
-                if (!data.contains(i) /*|| !data[i].is_number_integer(i)*/)
-                    throw::std::runtime_error("TSEM: " + i + " field not configured\n");
+                if (!data["upstream"].is_string() || !data.contains("offset") || !data["offset"].is_number())
+                    throw::std::runtime_error("GW: upstream/offset fields not configured\n");
+                upstream = data["upstream"];
+                offset = data["offset"];
             }
+            // Intersections are told apart by name in the cycle reports: a truncated one could match another
+            if (!EventText::fits(username) || !EventText::fits(upstream))
+                throw::std::runtime_error("GW: Intersection name longer than " +
+                    std::to_string(EVENT_TEXT_SIZE - 1) + " bytes\n");
+
+            greenWave.coordinate(data["location"], upstream, offset);
 
-            int loc = data["location"];
-            if (checkLocation(Components::TRAFFIC_SEMAPHORE, loc) < 0)
-                throw::std::runtime_error("TSEM: location invalid\n");
-            if (loc > maxLocation) maxLocation = loc;
-
-            const int gpio_red = data["gpio_red"];
-            const int gpio_green = data["gpio_green"];
-            const int gpio_yellow = data["gpio_yellow"];
-
-        /*    if (processPin(gpio_red) < 0 || processPin(gpio_green) < 0 || processPin(gpio_yellow) < 0)
-                throw::std::runtime_error("TSEM: GPIO red/green/yellow exist\n");*/
-            if (processPin(gpio_yellow) < 0)
-                throw::std::runtime_error("TSEM: GPIO yellow\n"+std::to_string(loc));
-            if (processPin(gpio_green) < 0)
-                throw::std::runtime_error("TSEM: GPIO green\n"+std::to_string(loc));
-
-            if (processPin(gpio_red) < 0)
-                throw::std::runtime_error("TSEM: GPIO red\n"+std::to_string(loc));
-
-
-            auto vec = data["destinations"].get<std::vector<int>>();
-            std::unordered_set<int> destinations(vec.begin(), vec.end());
-
-            for (const auto destination : destinations)
-                if (destination > maxLocation) maxLocation = destination;
-
-            TrafficSemVector.push_back(
-                std::make_unique<TrafficSemaphore>(
-                this,
-                loc,
-                destinations,
-                gpio_red,
-                gpio_green,
-                gpio_yellow
-                ));
+            if (!greenWaveLink)
+            {
+                ddsGreenWave = std::make_unique<DDS_GreenWave>(_shutdown_requested, GREEN_WAVE_TOPIC, username, this);
+                ddsGreenWave->start();
+                greenWaveLink = ddsGreenWave.get();
+            }
             return 0;
         };
 }
 
-void TrafficControlSystem::initTrafficStrategies()
+/*  Intersection Elements of the Registry Factory: the owner (the element vectors, or a pending plan) keeps them
+ *  Throws std::runtime_error on invalid data
+ */
+std::unique_ptr<PedestrianSemaphore> TrafficControlSystem::makePedestrianSemaphore(const json& data)
+{
+    const std::string validationData [] = {"location", "gpio_red", "gpio_green", "hasButton",
+        "hasCardReader", "hasBuzzer"};
+
+    for (const auto &i : validationData)
+    {
+        // Data is expected to come as an integer
+        if (!data.contains(i) || !data[i].is_number_integer())
+            throw::std::runtime_error("PSEM: " + i + " field not configured\n");
+    }
+
+    int loc = data["location"];
+    if (checkLocation(Components::PEDESTRIAN_SEMAPHORE, loc) < 0)
+        throw::std::runtime_error("PSEM: location invalid\n");
+    if (loc > maxLocation) maxLocation = loc;
+
+    int gpio_red = data["gpio_red"];
+    int gpio_green = data["gpio_green"];
+    if (processPin(gpio_red) < 0 || processPin(gpio_green) < 0)
+        throw::std::runtime_error("PSEM: GPIO red/green exist\n");
+
+    PedestrianFeatures feature = {};
+    int threshold = 0;
+    int gpio_button = 0;
+
+    if (data["hasButton"]==1)
+    {
+        if (!data.contains("buttonThreshold") || !data.contains("gpio_button"))
+            throw::std::runtime_error("PSEM: GPIO button config not exist\n");
+
+        threshold = data["buttonThreshold"];
+        gpio_button = data["gpio_button"];
+        if (processPin(gpio_button) < 0)
+            throw::std::runtime_error("PSEM: GPIO button exist\n");
+
+        feature |= PedestrianFeatures::Button;
+    }
+
+    if (data["hasCardReader"]==1)
+        feature |= PedestrianFeatures::CardReader;
+
+    if (data["hasBuzzer"]==1)
+        feature |= PedestrianFeatures::Buzzer;
+
+    return std::make_unique<PedestrianSemaphore>(
+        this,
+        _shutdown_requested,
+        loc,
+        feature,
+        gpio_red,
+        gpio_green,
+        gpio_button,
+        threshold
+    );
+}
+
+std::unique_ptr<TrafficSemaphore> TrafficControlSystem::makeTrafficSemaphore(const json& data)
 {
-    TrafficStrategies[SystemState::SET_UP] = std::make_unique<StrategySetUp>();
-    TrafficStrategies[SystemState::NORMAL] = std::make_unique<StrategyNormal>();
-    TrafficStrategies[SystemState::EMERGENCY] = std::make_unique<StrategyEmergency>();
-    TrafficStrategies[SystemState::FAILURE] = std::make_unique<StrategyFailure>();
+    const std::string validationData [] = {"location", "destinations", "gpio_red", "gpio_green", "gpio_yellow"};
+
+    for (const auto &i : validationData)
+    {
+        // Data is expected to come as an integer
+        if (!data.contains(i) /*|| !data[i].is_number_integer(i)*/)
+            throw::std::runtime_error("TSEM: " + i + " field not configured\n");
+    }
+
+    int loc = data["location"];
+    if (loc < 0 || loc >= TSEM_MAX_LOCATIONS || checkLocation(Components::TRAFFIC_SEMAPHORE, loc) < 0)
+        throw::std::runtime_error("TSEM: location invalid\n");
+    if (loc > maxLocation) maxLocation = loc;
+
+    const int gpio_red = data["gpio_red"];
+    const int gpio_green = data["gpio_green"];
+    const int gpio_yellow = data["gpio_yellow"];
+
+/*    if (processPin(gpio_red) < 0 || processPin(gpio_green) < 0 || processPin(gpio_yellow) < 0)
+        throw::std::runtime_error("TSEM: GPIO red/green/yellow exist\n");*/
+    if (processPin(gpio_yellow) < 0)
+        throw::std::runtime_error("TSEM: GPIO yellow\n"+std::to_string(loc));
+    if (processPin(gpio_green) < 0)
+        throw::std::runtime_error("TSEM: GPIO green\n"+std::to_string(loc));
+
+    if (processPin(gpio_red) < 0)
+        throw::std::runtime_error("TSEM: GPIO red\n"+std::to_string(loc));
+
+
+    auto vec = data["destinations"].get<std::vector<int>>();
+    std::unordered_set<int> destinations(vec.begin(), vec.end());
+
+    for (const auto destination : destinations)
+        if (destination > maxLocation) maxLocation = destination;
+
+    return std::make_unique<TrafficSemaphore>(
+        this,
+        loc,
+        destinations,
+        gpio_red,
+        gpio_green,
+        gpio_yellow
+    );
 }
 
 // Inits system signals to stop the system execution
@@ -218,7 +309,7 @@ void TrafficControlSystem::initSystemSignals()
 
     if (signal(SIGINT, SystemSignalsHandler) == SIG_ERR ||
         signal(SIGTERM, SystemSignalsHandler) == SIG_ERR ||
-        signal(SIGHUP, SystemSignalsHandler))
+        signal(SIGHUP, SystemSignalsHandler) == SIG_ERR)
         throw::std::runtime_error("TCS: initSystemSignals");
 }
 
@@ -230,15 +321,49 @@ void TrafficControlSystem::SystemSignalsHandler(const int signum)
     condShutdown.condBroadcast();
 }
 
-void TrafficControlSystem::setStrategy()
+/*  Events notified while handling another one (TCS thread) inherit its origin: the latency of a phase switch is
+ *  measured from the LIGHTS_TIMEOUT / EMERGENCY_START that started it
+ *  Never waits for room: the TCS thread would wait on its own queue, and a producer yielding under SCHED_FIFO never
+ *  lets a lower priority thread run
+ *   *  TCS thread: handled right after the event that notified them (ownEvents) - not behind eventQueue
+ *   *  Other threads: dropped (and counted) while eventQueue is full. Only emergency and phase timing events
+ *      (reservedEvent) take its last EVENT_QUEUE_RESERVE slots: a flood of calls never drops them
+ */
+int TrafficControlSystem::notify (Component* sender, Event event)
+{
+    const bool own = handlingSystem == this;
+    const size_t reserve = reservedEvent(event) ? 0 : EVENT_QUEUE_RESERVE;
+    if (own ? !ownEvents.tryPush(stamp(std::move(event))) : !eventQueue.trySend(stamp(std::move(event)), reserve))
+    {
+        const uint64_t dropped = ++droppedEvents;
+        std::cerr << (own ? "Own" : "Event") << " queue full: event dropped (" << dropped << " so far)\n";
+        return -EAGAIN;
+    }
+    watchdog.eventQueued();
+    return 0;
+}
+
+// EV arrivals and departures, phase timing and failures: what the lights depend on
+bool TrafficControlSystem::reservedEvent(const Event& event)
 {
-    TrafficStrategy = TrafficStrategies[state].get();
+    return std::holds_alternative<DDSEvent>(event) || std::holds_alternative<InternalEvent>(event);
 }
 
-void TrafficControlSystem::notify (Component* sender, Event event)
+TrafficControlSystem::QueuedEvent TrafficControlSystem::stamp(Event event) const
 {
-    std::cout << "TrafficSystem this: " << this << std::endl;
-    eventQueue.send(std::move(event));
+    const uint64_t now = LatencyTrace::now();
+    QueuedEvent queued{std::move(event), now, now, LatencyCause::NONE};
+
+    if (const auto internal = std::get_if<InternalEvent>(&queued.event); internal && *internal == InternalEvent::LIGHTS_TIMEOUT)
+        queued.cause = LatencyCause::TIMEOUT;
+    else if (const auto dds = std::get_if<DDSEvent>(&queued.event); dds && dds->qualifier == DDS_Event_Qualifier::EMERGENCY_START)
+        queued.cause = LatencyCause::EMERGENCY;
+    else if (handledEvent)
+    {
+        queued.origin = handledEvent->origin;
+        queued.cause = handledEvent->cause;
+    }
+    return queued;
 }
 
 /*
@@ -254,6 +379,8 @@ TrafficControlSystem::Components TrafficControlSystem::isValidName (const std::s
             result = Components::PEDESTRIAN_SEMAPHORE;
         else if (!s.rfind("TS", 0))
             result = Components::TRAFFIC_SEMAPHORE;
+        else if (!s.rfind("GW", 0))
+            result = Components::GREEN_WAVE;
 
         // Validate if the rest of the Semaphore is a valid input
         for (size_t i = 2; i < s.size(); ++i) {
@@ -268,25 +395,20 @@ TrafficControlSystem::Components TrafficControlSystem::isValidName (const std::s
 }
 
 // Check if Location was already attributed; Location must not be the same between (TSEMs), (PSEMs) and (TSEMs and PSEMs)
+// Elements of either plan count (live reconfiguration): a removed one keeps its Location until the plan swap
 int TrafficControlSystem:: checkLocation (const Components cp, const int loc) const
 {
+    const auto used = [loc](const auto& vec)
+    {
+        return std::ranges::any_of(vec, [loc](const auto& p) { return p->getLocation() == loc; });
+    };
+
     switch (cp)
     {
         case Components::PEDESTRIAN_SEMAPHORE:
-            for (const auto& p : PedestrianSemVector) {
-                if (p->getLocation() == loc)
-                    return -EEXIST;             // If yes, return
-            }
-        break;
         case Components::TRAFFIC_SEMAPHORE:
-            for (const auto& p : TrafficSemVector) {
-                if (p->getLocation() == loc)
-                    return -EEXIST;             // If yes, return
-            }
-            for (const auto& p : PedestrianSemVector) {
-                if (p->getLocation() == loc)
-                    return -EEXIST;             // If yes, return
-            }
+            if (used(TrafficSemVector) || used(addedTsem) || used(PedestrianSemVector) || used(addedPedestrianSem))
+                return -EEXIST;             // If yes, return
         break;
         default: return -EPERM;
     }
@@ -309,9 +431,81 @@ int TrafficControlSystem::processPin (const int pin)
     return -EEXIST;
 }
 
+// Gives back a pin of a removed component (its line stays requested as output, see set_output_mode)
+void TrafficControlSystem::releasePin (const int pin)
+{
+    if (std::erase(usedGPIOs, pin))
+        availableGPIOs.push_back(pin);
+}
+
+/*  Validates a TSEM before it is created at runtime: the factory claims its pins one by one, a rejected
+ *  destination would leave them claimed (and the head could never be added again)
+ */
+int TrafficControlSystem::checkTrafficData (const json& data) const
+{
+    const std::string validationData [] = {"location", "gpio_red", "gpio_green", "gpio_yellow"};
+
+    for (const auto &i : validationData)
+        if (!data.contains(i) || !data[i].is_number_integer())
+            return -EINVAL;
+
+    if (!data.contains("destinations") || !data["destinations"].is_array())
+        return -EINVAL;
+    for (const auto& destination : data["destinations"])
+        if (!destination.is_number_integer() || destination.get<int>() < 0 ||
+            destination.get<int>() >= TSEM_MAX_LOCATIONS)
+            return -EINVAL;
+
+    const int loc = data["location"];
+    if (loc < 0 || loc >= TSEM_MAX_LOCATIONS || checkLocation(Components::TRAFFIC_SEMAPHORE, loc) < 0)
+        return -EEXIST;
+
+    const std::vector<int> pins = {data["gpio_red"], data["gpio_green"], data["gpio_yellow"]};
+    for (const int pin : pins)
+        if (std::ranges::count(availableGPIOs, pin) == 0 || std::ranges::count(pins, pin) > 1)
+            return -EEXIST;
+
+    return 0;
+}
+
+/*  Validates a PSEM before it is created at runtime: the factory claims its pins one by one and
+ *  a half-created crosswalk could not be undone (PSEM threads)
+ */
+int TrafficControlSystem::checkPedestrianData (const json& data) const
+{
+    const std::string validationData [] = {"location", "gpio_red", "gpio_green", "hasButton",
+        "hasCardReader", "hasBuzzer"};
+
+    if (!data.is_object() || !data.contains("name") || !data["name"].is_string() ||
+        isValidName(data["name"]) != Components::PEDESTRIAN_SEMAPHORE)
+        return -EINVAL;
+
+    for (const auto &i : validationData)
+        if (!data.contains(i) || !data[i].is_number_integer())
+            return -EINVAL;
+
+    const int loc = data["location"];
+    if (loc < 0 || checkLocation(Components::TRAFFIC_SEMAPHORE, loc) < 0)    // no TSEM nor PSEM there
+        return -EEXIST;
+
+    std::vector<int> pins = {data["gpio_red"], data["gpio_green"]};
+    if (data["hasButton"] == 1)
+    {
+        if (!data.contains("buttonThreshold") || !data.contains("gpio_button") || data["buttonThreshold"] == 0)
+            return -EINVAL;
+        pins.push_back(data["gpio_button"]);
+    }
+
+    for (const int pin : pins)
+        if (std::ranges::count(availableGPIOs, pin) == 0 || std::ranges::count(pins, pin) > 1)
+            return -EEXIST;
+
+    return 0;
+}
+
 int TrafficControlSystem::createComponents (const std::shared_ptr<json>& data_file)
 {
-    Components current_comp;
+    Components current_comp = Components::INVALID;     // kind of semaphores in the file
 
     for (auto& data: *data_file)
     {
@@ -319,11 +513,13 @@ int TrafficControlSystem::createComponents (const std::shared_ptr<json>& data_fi
             return -EINVAL;
 
         const std::string name = data["name"];
-        current_comp = isValidName(name);
+        const Components component = isValidName(name);
+        if (component != Components::GREEN_WAVE)    // comes along either file
+            current_comp = component;
 
-        if (current_comp != Components::INVALID)
+        if (component != Components::INVALID)
         {
-            if (const int ret = componentFactory[current_comp] (data); ret < 0)
+            if (const int ret = componentFactory[component] (data); ret < 0)
             {
                 std::cout <<("Component '" + name + "' has repeated location\n");
                 return ret;
@@ -335,6 +531,11 @@ int TrafficControlSystem::createComponents (const std::shared_ptr<json>& data_fi
         }
     }
 
+    // Key of the Intersection Plan: each received file contributes once, independently of the arrival order
+    // (green wave entries alone do not change the plan)
+    if (current_comp != Components::INVALID)
+        configHash ^= PlanCache::hash(data_file->dump(), PlanCache::hash(std::to_string(static_cast<int>(current_comp))));
+
     switch (current_comp)
     {
         case Components::PEDESTRIAN_SEMAPHORE:
@@ -352,8 +553,10 @@ int TrafficControlSystem::createComponents (const std::shared_ptr<json>& data_fi
 
 void TrafficControlSystem::switch_state (const SystemState next_state)
 {
+    invalidatePhases();     // the staged phases belong to the state left
+    startedPhase.reset();
+
     state = next_state;
-    setStrategy();
 
     this->notify(nullptr, InternalEvent::NEW_STATE_ENTERED);
 }
@@ -372,14 +575,24 @@ void TrafficControlSystem::sortSemByLocation(std::vector<std::unique_ptr<T>>& ve
     );
 }
 
-void TrafficControlSystem::letPedestriansCross(const std::vector<Crosswalk*>& ChangeCrosswalksVec, const bool emergency)
+// A head switched on its own, or one whose lights a phase commit already drove
+static void switchLight(Semaphore* sem, const Semaphore::TrafficColour colour, const bool emergency, const bool committed)
+{
+    if (committed)
+        sem->commit_nextLight(colour, emergency);
+    else
+        sem->switch_nextLight(colour, emergency);
+}
+
+void TrafficControlSystem::letPedestriansCross(const std::span<Crosswalk* const> ChangeCrosswalksVec, const bool emergency,
+    const bool committed)
 {
     if (!ChangeCrosswalksVec.empty())
     {
         for (const auto& crosswalk: ChangeCrosswalksVec)
         {
-            crosswalk->psem1->switch_nextLight(Semaphore::TrafficColour::GREEN, emergency);
-            crosswalk->psem2->switch_nextLight(Semaphore::TrafficColour::GREEN, emergency);
+            switchLight(crosswalk->psem1, Semaphore::TrafficColour::GREEN, emergency, committed);
+            switchLight(crosswalk->psem2, Semaphore::TrafficColour::GREEN, emergency, committed);
 
 #ifdef USE_CLOUD
             updateSemaphoresCloud(crosswalk, static_cast<int>(Semaphore::TrafficColour::GREEN));
@@ -388,14 +601,15 @@ void TrafficControlSystem::letPedestriansCross(const std::vector<Crosswalk*>& Ch
     }
 }
 
-void TrafficControlSystem::stopPedestriansCross(const std::vector<Crosswalk*>& ChangeCrosswalksVec, const bool emergency)
+void TrafficControlSystem::stopPedestriansCross(const std::span<Crosswalk* const> ChangeCrosswalksVec, const bool emergency,
+    const bool committed)
 {
     if (!ChangeCrosswalksVec.empty())
     {
         for (const auto& crosswalk: ChangeCrosswalksVec)
         {
-            crosswalk->psem1->switch_nextLight(Semaphore::TrafficColour::RED, emergency);
-            crosswalk->psem2->switch_nextLight(Semaphore::TrafficColour::RED, emergency);
+            switchLight(crosswalk->psem1, Semaphore::TrafficColour::RED, emergency, committed);
+            switchLight(crosswalk->psem2, Semaphore::TrafficColour::RED, emergency, committed);
 #ifdef USE_CLOUD
             updateSemaphoresCloud(crosswalk, static_cast<int>(Semaphore::TrafficColour::RED));
 #endif
@@ -403,13 +617,13 @@ void TrafficControlSystem::stopPedestriansCross(const std::vector<Crosswalk*>& C
     }
 }
 
-void TrafficControlSystem::letCarsMove(const std::vector<TrafficSemaphore*>& ChangeSemVec)
+void TrafficControlSystem::letCarsMove(const std::span<TrafficSemaphore* const> ChangeSemVec, const bool committed)
 {
     if (!ChangeSemVec.empty())
     {
         for (const auto& tsem: ChangeSemVec)
         {
-            tsem->switch_nextLight(Semaphore::TrafficColour::GREEN, false);
+            switchLight(tsem, Semaphore::TrafficColour::GREEN, false, committed);
 
 #ifdef USE_CLOUD
             updateSemaphoresCloud(tsem, static_cast<int>(Semaphore::TrafficColour::GREEN));
@@ -418,13 +632,13 @@ void TrafficControlSystem::letCarsMove(const std::vector<TrafficSemaphore*>& Cha
     }
 }
 
-void TrafficControlSystem::prepareToStopCars(const std::vector<TrafficSemaphore*>& ChangeSemVec)
+void TrafficControlSystem::prepareToStopCars(const std::span<TrafficSemaphore* const> ChangeSemVec, const bool committed)
 {
     if (!ChangeSemVec.empty())
     {
         for (const auto& tsem: ChangeSemVec)
         {
-            tsem->switch_nextLight(Semaphore::TrafficColour::YELLOW, false);
+            switchLight(tsem, Semaphore::TrafficColour::YELLOW, false, committed);
 
 #ifdef USE_CLOUD
             updateSemaphoresCloud(tsem, static_cast<int>(Semaphore::TrafficColour::YELLOW));
@@ -438,18 +652,17 @@ void TrafficControlSystem::prepareToStopCars(const std::vector<TrafficSemaphore*
  *  -> Check if there are common semaphores on between the current configuration and the next configuration;
  *  -> Turn off (YELLOW, then, RED) the semaphores which require that.
  */
-void TrafficControlSystem::stopCarsMove(const std::vector<TrafficSemaphore*>& ChangeSemVec)
+void TrafficControlSystem::stopCarsMove(const std::span<TrafficSemaphore* const> ChangeSemVec, const bool committed)
 {
     if (!ChangeSemVec.empty())
     {
         for (auto &tsem: ChangeSemVec)
         {
-            tsem->switch_nextLight(Semaphore::TrafficColour::RED, false);
+            switchLight(tsem, Semaphore::TrafficColour::RED, false, committed);
 #ifdef USE_CLOUD
             updateSemaphoresCloud(tsem, static_cast<int>(Semaphore::TrafficColour::RED));
 #endif
         }
-        std::cerr << "[stopCarsMove] switched cars red \n";
     }
 }
 
@@ -472,30 +685,29 @@ bool TrafficControlSystem::PSEM_Button_HasExtended(const int location) const
 bool TrafficControlSystem::conflictTrajectory(const TrafficSemaphore& semA,
                         const TrafficSemaphore& semB)
 {
-    const int La = semA.getLocation();
-    const int Lb = semB.getLocation();
-
-    for (const int Da : semA.getDirection()) {
-        for (const int Db : semB.getDirection()) {
-
-            // same direction = immediate conflict
-            if (Da == Db)
-                return true;
+    // same direction = immediate conflict
+    if ((semA.getDirection() & semB.getDirection()).any())
+        return true;
 
-            // Check if trajectories cross (circle approach)
-            // For each variable,
-            //      if both are true, means the other trajectory is completely inside the first, so no problem.
-            //      if both are false, means the other trajectory is completely outside the first, so no problem
-            //      When they are different => there is a transition from inside to outside (vice versa) => problem
-            const bool A_cross_B =
-                isBetween(La, Da, Lb) ^ isBetween(La, Da, Db);
+    return crossesTrajectory(semA, semB) || crossesTrajectory(semB, semA);
+}
 
-            const bool B_cross_A =
-                isBetween(Lb, Db, La) ^ isBetween(Lb, Db, Da);
+/*  Checks if a movement of semB crosses the arc of a movement of semA (circle approach)
+ *      For each movement of A, on the arc between its Location and destination:
+ *          if B's Location and destination are both inside, the trajectory of B is completely inside the arc, so no problem
+ *          if both are outside, B's trajectory is completely outside the arc, so no problem
+ *          When they are different => there is a transition from inside to outside (vice versa) => problem
+ *      B's Location is on one side of the arc: any destination of B on the other side crosses it
+ */
+bool TrafficControlSystem::crossesTrajectory(const TrafficSemaphore& semA, const TrafficSemaphore& semB)
+{
+    const int Lb = semB.getLocation();
+    const MovementMask& Db = semB.getDirection();
 
-            if (A_cross_B || B_cross_A)
-                return true;
-        }
+    for (const auto& [Da, arc] : semA.getMovements())
+    {
+        if (arc.test(Lb) ? (Db & ~arc).any() : (Db & arc).any())
+            return true;
     }
     return false;
 }
@@ -510,355 +722,1125 @@ bool TrafficControlSystem::conflictTrajectory (const TrafficSemaphore& semA, con
     if (semA.getLocation() > min && semA.getLocation() < max)
         return true;
 
-    // Conflict from heading direction
-     for (const auto a : semA.getDirection()){
-         if (a > min && a < max)
-            return true;        // The crosswalk contains that direction
-     }
-     return false;
+    // Conflict from heading direction: the crosswalk contains some direction
+    return (semA.getDirection() & TrafficSemaphore::between(min, max)).any();
 }
 
 /*  Matrix indexes are identified by the Location attribute (Location are contiguous)
- *      - Item in conflictGraph[i][j] is
- *          - true: if there is conflict
- *          - false: if there isn't conflict
+ *      - Bit conflictGraph.row(i)[j] is
+ *          - set: if there is conflict
+ *          - clear: if there isn't conflict
  */
 void TrafficControlSystem::setUpGraphMatrix(){ // O(T²) + O(T*P)
     // Traffic Semaphores
     for (size_t i = 0; i < TrafficSemVector.size(); ++i)
     {
         for (size_t j = i + 1; j < TrafficSemVector.size(); ++j) {
-            if (conflictTrajectory(*TrafficSemVector[i], *TrafficSemVector[j])) {
-                conflictGraph[TrafficSemVector[i]->getLocation()][TrafficSemVector[j]->getLocation()]
-                = conflictGraph[TrafficSemVector[j]->getLocation()][TrafficSemVector[i]->getLocation()]
-                            = true; // Undirected Conflict Graph
-            }
+            if (conflictTrajectory(*TrafficSemVector[i], *TrafficSemVector[j]))  // Undirected Conflict Graph
+                conflictGraph.addConflict(TrafficSemVector[i]->getLocation(), TrafficSemVector[j]->getLocation());
         }
-        elementByLocation[TrafficSemVector[i]->getLocation()] = TrafficSemVector[i].get();
     }
     // Crosswalks/ Pedestrian Semaphores
     for (auto & crosswalk : crosswalks)
     {
         for (auto & j : TrafficSemVector)
         {
-            if (conflictTrajectory(*j, *crosswalk))
+            if (conflictTrajectory(*j, *crosswalk))     // Undirected Conflict Graph
             {
-                conflictGraph[j->getLocation()][crosswalk->psem1->getLocation()]
-                = conflictGraph[j->getLocation()][crosswalk->psem2->getLocation()]
-                = conflictGraph[crosswalk->psem1->getLocation()][j->getLocation()]
-                = conflictGraph[crosswalk->psem2->getLocation()][j->getLocation()]
-                = true; // Undirected Conflict Graph
+                conflictGraph.addConflict(j->getLocation(), crosswalk->psem1->getLocation());
+                conflictGraph.addConflict(j->getLocation(), crosswalk->psem2->getLocation());
             }
         }
+    }
+}
+
+// Location -> Intersection Element map and the Graph's vertices
+void TrafficControlSystem::setUpElementMap()
+{
+    vertices = LocationSet(elementByLocation.size());
+    heads = LocationSet(elementByLocation.size());
+
+    for (auto& tsem : TrafficSemVector)
+    {
+        elementByLocation[tsem->getLocation()] = tsem.get();
+        vertices.set(tsem->getLocation());
+        heads.set(tsem->getLocation());
+    }
+
+    for (auto& crosswalk : crosswalks)
+    {
         elementByLocation[crosswalk->psem1->getLocation()] = crosswalk.get();
         elementByLocation[crosswalk->psem2->getLocation()] = crosswalk.get();
+        vertices.set(crosswalk->psem1->getLocation());
+        vertices.set(crosswalk->psem2->getLocation());
+        heads.set(crosswalk->psem1->getLocation());
     }
 }
 
-/* Considers a Circular Approach to return whether trajectories intersect or not
- * Args:
- *  a and b shall be Location and Destination of a single semaphore.
- *  x is the location or destination of the other
- */
-bool TrafficControlSystem::isBetween(const int a, const int b, const int x) {
-    if (a < b)
-        return x > a && x < b;
-    return x > a || x < b;
+// Builds the Configuration holding the Intersection Elements of an accepted (maximal) set of Locations
+TrafficControlSystem::Configuration TrafficControlSystem::makeConfiguration(const LocationSet& locations) const
+{
+    Configuration cfg;
+    locations.forEach([&](const int loc)
+    {
+        const IntersectionElement& c = elementByLocation[loc];
+
+        std::visit([&](auto&& obj) {
+            using T = std::decay_t<decltype(obj)>;
+
+            if constexpr (std::is_same_v<T, TrafficSemaphore*>) {
+                cfg.activeTsem.push_back(obj);
+            }
+            else if constexpr (std::is_same_v<T, Crosswalk*>) {
+                if (std::find(cfg.crosswalk.begin(),
+                              cfg.crosswalk.end(),
+                              obj) == cfg.crosswalk.end())
+                    cfg.crosswalk.push_back(obj);
+            }
+        }, c);
+    });
+    return cfg;
 }
 
-// Apply backtracking w/ pruning Algorithm
-/*      vector current holds the current locations to insert on the same configuration
- *      vector candidates holds all the locations, initially
- */
-void TrafficControlSystem::backtrack(std::vector<int>& current, std::vector<int>& candidates)
+void TrafficControlSystem::findConfigurations()
 {
-    if (candidates.empty()) {       // Last iteration of each configuration
-        if (!current.empty()) {
-            Configuration cfg;
-            for (const int loc : current)
-            {
-                const IntersectionElement& c = elementByLocation[loc];
-
-                std::visit([&](auto&& obj) {
-                    using T = std::decay_t<decltype(obj)>;
-
-                    if constexpr (std::is_same_v<T, TrafficSemaphore*>) {
-                        cfg.activeTsem.push_back(obj);
-                    }
-                    else if constexpr (std::is_same_v<T, Crosswalk*>) {
-                        if (std::find(cfg.crosswalk.begin(),
-                                      cfg.crosswalk.end(),
-                                      obj) == cfg.crosswalk.end())
-                            cfg.crosswalk.push_back(obj);
-                    }
-                }, c);
-            }
+    const size_t totalSize = maxLocation + 1;
+    elementByLocation.resize(totalSize);
 
-            // Check if it is a maximal independent set - local validation:
-            //      if any of the other locations (vertices) are compatible with this config
-            bool maximal = true;
-            for (int v : vertices) {
-                if (std::find(current.begin(), current.end(), v) == current.end()) {
-                    bool ok = true;
-                    for (int u : current)
-                        if (conflictGraph[v][u]) {
-                            ok = false;
-                            break;
-                        }
-                    if (ok) {
-                        maximal = false;
-                        break;
-                    }
-                }
-            }
+    setUpElementMap();
+    requestOutputGroup();
 
-            if (maximal)
-                configurations.push_back(cfg);
-        }
+    // Same Cloud configuration as a previous boot: use its precompiled plan
+    locationDemand.assign(totalSize, 0.0);
+    cardCalls.assign(totalSize, 0);
+    vehicleCalls.assign(totalSize, 0);
+
+    if (const int ret = loadPlan(); ret == 0)
+    {
+        std::cout << "Intersection Plan loaded: " << configurations.size() << " configurations\n";
+        buildTransitionTable();
+        buildLocationIndex();
+        optimizeSequence();
         return;
     }
 
-    while (!candidates.empty()) {
-        int v = candidates.back();
-        candidates.pop_back();
+    conflictGraph.resize(totalSize);
+    setUpGraphMatrix();
 
-        // New subset of compatible candidates - next recursive iteration
-        std::vector<int> newCandidates;
-        for (int u : candidates) {
-            if (!conflictGraph[v][u])           // pruning
-                newCandidates.push_back(u);
-        }
+    // Only accepted (maximal) sets become Configurations
+    const ConfigurationEngine engine(conflictGraph);
+    planSets = engine.enumerate(vertices, configurationAlgorithm, CONFIGURATION_WORKERS);
+    for (const auto& set : planSets)
+        configurations.push_back(makeConfiguration(set));
 
-        current.push_back(v);
-        backtrack(current, newCandidates);
-        current.pop_back();
-    }
+    if (const int ret = savePlan(planSets); ret < 0)
+        std::cerr << "Intersection Plan not saved: " << strerror(-ret) << "\n";
+
+    buildTransitionTable();
+    buildLocationIndex();
+    optimizeSequence();
+    std::cout << "Phase cycle: " << phaseSequence.size() << " of " << configurations.size() << " configurations\n";
 }
 
-void TrafficControlSystem::findConfigurations()
+/*  Location -> Configuration index of the active plan (built with the Configurations)
+ *      Emergency: for each TSEM origin and destination, the Configuration turning the origin ON with the
+ *      fewest Crosswalks crossing the EV path (the first one, on ties)
+ */
+void TrafficControlSystem::buildLocationIndex()
 {
-    size_t totalSize = maxLocation + 1;
-    conflictGraph.resize(totalSize);
-    for (auto &row : conflictGraph)
-        row.resize(totalSize, false);
-
-    elementByLocation.resize(totalSize);
-
-    setUpGraphMatrix();
+    const int locations = static_cast<int>(elementByLocation.size());
 
-    std::vector<int> current;
+    configurationIndex.build(planSets, locations);
+    indexedElements = elementByLocation;
 
-    for (auto& tsem : TrafficSemVector)
-        vertices.push_back(tsem->getLocation());
+    crossingCrosswalks.assign(locations, LocationSet(locations));
+    for (const auto& cw : crosswalks)
+        for (int x = cw->psem1->getLocation() + 1; x < cw->psem2->getLocation() && x < locations; ++x)
+            crossingCrosswalks[x].set(cw->psem1->getLocation());
 
-    for (auto& cross : crosswalks) {
-        vertices.push_back(cross->psem1->getLocation());
-        vertices.push_back(cross->psem2->getLocation());
+    tsemHeadingUpTo.assign(locations, LocationSet(locations));
+    for (const auto& tsem : TrafficSemVector)
+    {
+        const auto movements = tsem->getMovements();
+        if (movements.empty())
+            continue;
+        for (int x = movements.front().destination; x < locations; ++x)
+            tsemHeadingUpTo[x].set(tsem->getLocation());
     }
-    std::vector<int> candidates = vertices;
 
-    std::sort(candidates.begin(), candidates.end());
+    for (const auto& tsem : TrafficSemVector)
+    {
+        const int origin = tsem->getLocation();
+        for (int destination = 0; destination < locations; ++destination)
+        {
+            LocationSet path = crossingCrosswalks[origin];
+            path.orWith(crossingCrosswalks[destination].data());
+            const int pathCrosswalks = path.count();
 
-    backtrack(current, candidates);
+            int best = -1;
+            int bestCrossing = 0;
+            configurationIndex.forEachServing(origin, [&](const int config)
+            {
+                const int crossing = pathCrosswalks - path.countAndNot(configurationIndex.locationsOf(config).data());
+                if (best < 0 || crossing < bestCrossing)
+                {
+                    best = config;
+                    bestCrossing = crossing;
+                }
+            });
+            configurationIndex.setEmergency(origin, destination, best);
+        }
+    }
 }
 
-
-/* Sets crosswalks based on each Pedestrian Semaphore Pair
- *  - Supposes that the Pedestrian Semaphore vector is already ordered,
- *      and that Pedestrian Semaphores were correctly created, so they are an even number
- */
-void TrafficControlSystem::setCrosswalks ()
+// GPIO mask bit of a light (pin 0: light not configured)
+static uint64_t pinBit(const int pin)
 {
-    for (size_t i = 0; i < PedestrianSemVector.size(); i += 2)
-        crosswalks.push_back(std::make_unique<Crosswalk>(Crosswalk{
-            PedestrianSemVector[i].get(),
-            PedestrianSemVector[i+1].get()
-        }));
+    return (pin > 0 && pin < 64) ? uint64_t{1} << pin : 0;
 }
 
-// Used to know if the emergency vehicle is going to cross over any crosswalk
-std::vector<TrafficControlSystem::Crosswalk*> TrafficControlSystem::searchCrosswalk
-    (const int location, const int direction) const
+// 'sem' goes to 'colour' in 'step': its other lights off (as switch_nextLight). False if a light is not in the mask
+static bool switchMask(const Semaphore& sem, const Semaphore::TrafficColour colour, rasp_gpio_mask& step)
 {
-    std::vector<Crosswalk*> return_sem;
-    for (const auto& crosswalk: configurations[current_config_idx].crosswalk)
+    bool masked = true;
+    for (const int pin : sem.getPins())
     {
-        if ((crosswalk->psem1->getLocation() < location && crosswalk->psem2->getLocation() > location) |
-            (crosswalk->psem1->getLocation() < direction && crosswalk->psem2->getLocation() > direction))
-            return_sem.push_back(crosswalk);
+        step.clear |= pinBit(pin);
+        masked &= pinBit(pin) != 0;
     }
-    return return_sem;
+    step.set |= pinBit(sem.getPin(colour));
+    return masked;
 }
 
-// Used to know the semaphore where the emergency vehicle is coming from
-// Used to know the currently activated semaphores whose directions cross/collide with the EV direction
-// Searches TSEMs by location and direction; this is useful for emergency vehicle interaction
-std::vector<TrafficSemaphore*> TrafficControlSystem::searchTSEM(const int location, const int direction) const
+/*  Appends the lights switched going from 'from' to 'to':
+ *      OFF: on in 'from', not in 'to' (TSEMs go YELLOW before RED)
+ *      ON: every element of 'to' (the ones already GREEN are kept GREEN)
+ */
+void TrafficControlSystem::appendTransition(const Configuration& from, const Configuration& to,
+    TransitionTable& table) const
 {
-    std::vector<TrafficSemaphore*> return_sem;
+    std::array<uint32_t, 4> sizes = {};
+    Transition transition = {};
+    transition.bulk = true;
 
-    for (const auto& tsem: configurations[current_config_idx].activeTsem)
+    for (const auto& tsem : from.activeTsem)
+    {
+        if (std::ranges::find(to.activeTsem, tsem) != to.activeTsem.end())
+            continue;
+        table.tsem.push_back(tsem);
+        ++sizes[0];
+        transition.bulk &= switchMask(*tsem, Semaphore::TrafficColour::YELLOW, transition.yellowStep);
+        transition.bulk &= switchMask(*tsem, Semaphore::TrafficColour::RED, transition.redStep);
+    }
+    for (const auto& tsem : to.activeTsem)
     {
-        // Search Location
-        if (tsem->getLocation() == location)
-            return_sem.push_back(tsem);
+        table.tsem.push_back(tsem);
+        ++sizes[1];
+        transition.bulk &= switchMask(*tsem, Semaphore::TrafficColour::GREEN, transition.greenStep);
+    }
 
-        // Search Direction
-        for (const auto& dir: tsem->getDirection())
-            if (dir <= direction) // Direction cross or collide
-                return_sem.push_back(tsem);
+    for (const auto& cw : from.crosswalk)
+    {
+        if (std::ranges::find(to.crosswalk, cw) != to.crosswalk.end())
+            continue;
+        table.crosswalk.push_back(cw);
+        ++sizes[2];
+        for (const PedestrianSemaphore* psem : {cw->psem1, cw->psem2})
+            transition.bulk &= switchMask(*psem, Semaphore::TrafficColour::RED, transition.yellowStep);
     }
-    return return_sem;
+    for (const auto& cw : to.crosswalk)
+    {
+        table.crosswalk.push_back(cw);
+        ++sizes[3];
+        for (const PedestrianSemaphore* psem : {cw->psem1, cw->psem2})
+            transition.bulk &= switchMask(*psem, Semaphore::TrafficColour::GREEN, transition.greenStep);
+    }
+
+    table.sizes.push_back(sizes);
+    table.transitions.push_back(transition);
 }
 
-// Stores Emergency and Sends it to Cloud
-void TrafficControlSystem::pushEmergency (tx_cloud::EmergencyContext info)
+// Points the transitions' spans into the pools (only once the pools stop growing)
+void TrafficControlSystem::linkTransitions(TransitionTable& table)
 {
-    emergencies.push(std::move(info));
+    size_t tsemOffset = 0;
+    size_t crosswalkOffset = 0;
+
+    for (size_t i = 0; i < table.transitions.size(); ++i)
+    {
+        auto& transition = table.transitions[i];
+        const auto& [offTsem, onTsem, offCrosswalk, onCrosswalk] = table.sizes[i];
+
+        transition.OFF_Tsem = {table.tsem.data() + tsemOffset, offTsem};
+        transition.ON_Tsem = {table.tsem.data() + tsemOffset + offTsem, onTsem};
+        transition.OFF_Crosswalk = {table.crosswalk.data() + crosswalkOffset, offCrosswalk};
+        transition.ON_Crosswalk = {table.crosswalk.data() + crosswalkOffset + offCrosswalk, onCrosswalk};
+
+        tsemOffset += offTsem + onTsem;
+        crosswalkOffset += offCrosswalk + onCrosswalk;
+    }
 }
 
-void TrafficControlSystem::popEmergency ()
+void TrafficControlSystem::buildTransitionTable()
 {
-    if (!emergencies.empty())
-        emergencies.pop();
+    transitionTable = {};
+    transitionTable.transitions.reserve(configurations.size() * configurations.size());
+    transitionTable.sizes.reserve(configurations.size() * configurations.size());
+
+    for (const auto& from : configurations)
+        for (const auto& to : configurations)
+            appendTransition(from, to, transitionTable);
+
+    linkTransitions(transitionTable);
+    buildFlashMasks();
 }
 
-tx_cloud::EmergencyContext TrafficControlSystem::getEmergency()
+/*  The group is never requested again: t_switchLight and the flash commit on it from other threads
+ *  Lights added at runtime stay out of it (driven one by one in the same commit)
+ */
+void TrafficControlSystem::requestOutputGroup() const
 {
-    return emergencies.front();
+    uint64_t lights = 0;
+    for (const auto& tsem : TrafficSemVector)
+        for (const int pin : tsem->getPins())
+            lights |= pinBit(pin);
+    for (const auto& psem : PedestrianSemVector)
+        for (const int pin : psem->getPins())
+            lights |= pinBit(pin);
+
+    if (const int ret = rasp_gpio_group_output(lights); ret < 0)
+        std::cerr << "GPIO output group not requested (" << ret << "): lights switched one by one\n";
 }
 
-/*
-void TrafficControlSystem::sendEmergencyToCloud()
+// Failure mode: the whole Intersection in one bulk commit per flash - TSEMs yellow or dark, Crosswalks dark
+void TrafficControlSystem::buildFlashMasks()
 {
-    cloud.cloudSendQueue.send(emergencies.front());
+    rasp_gpio_mask on = {};
+    rasp_gpio_mask off = {};
+    for (const auto& tsem : TrafficSemVector)
+    {
+        switchMask(*tsem, Semaphore::TrafficColour::YELLOW, on);
+        for (const int pin : tsem->getPins())
+            off.clear |= pinBit(pin);
+    }
+    for (const auto& psem : PedestrianSemVector)
+        for (const int pin : psem->getPins())
+        {
+            on.clear |= pinBit(pin);
+            off.clear |= pinBit(pin);
+        }
+
+    CppWrapper::LockGuard lock(mutexFlash);
+    flashOn = on;
+    flashOff = off;
 }
-*/
-int TrafficControlSystem:: numEmergencies() const
+
+/*  Phase cycle for the next round: shortest cycle serving every Location, weighted by the demand observed
+ *  during the previous rounds (see PhaseSequencer)
+ *      planSets must match the active configurations (no plan pending)
+ */
+const std::vector<int>& TrafficControlSystem::nextCycle()
 {
-    return static_cast<int>(emergencies.size());
+    // The workspace buffers are reused: no allocation once warm
+    std::vector<int>& cycle = sequencerWorkspace.cycle;
+    PhaseSequencer::optimize(planSets, vertices, heads, locationDemand, sequencerWorkspace);
+
+    // Green wave: the cycle (cyclic order) starts with the coordinated phase
+    if (greenWave.coordinated())
+    {
+        const auto coordinated = std::ranges::find_if(cycle, [this](const int config)
+            { return configurationIndex.serves(greenWave.corridor(), config); });
+        std::rotate(cycle.begin(), coordinated, cycle.end());
+    }
+    return cycle;
 }
 
-/*
- * Must be called by Strategy when switching timer ends
- */
-TrafficControlSystem::SwitchLightsData TrafficControlSystem::organizeNextConfiguration(int config_idx_em)
+void TrafficControlSystem::optimizeSequence()
 {
-    int next_idx;
-    if (state == SystemState::EMERGENCY)
-        next_idx = config_idx_em;
-    else     // Find next configuration index
-        next_idx = (current_config_idx + 1) % static_cast<int>(configurations.size());
+    phaseSequence = nextCycle();
+    sequencePos = -1;
+    ++cycleCount;
 
-    // Clear switching Data
-    SwitchLightsData switchingData = {};
+    for (auto& demand : locationDemand)
+        demand *= DEMAND_DECAY;
+}
 
-    auto& current = configurations[current_config_idx];
-    const auto& next = configurations[next_idx];
+/*  Requests (button, card, vehicle detected) at a Location
+ *      Phases staged into the next cycle: that cycle is checked again on the next staging (stagePhases)
+ */
+void TrafficControlSystem::recordDemand(const int location)
+{
+    if (location < 0 || location >= static_cast<int>(locationDemand.size()))
+        return;
+    locationDemand[location] += 1.0;
 
-    // ---- TSEMs ----
-    std::unordered_set<int> nextTsemLocations;
-    for (const auto& tsem : next.activeTsem)
-        nextTsemLocations.insert(tsem->getLocation());
+    if (const StagedPhase* last = lookAhead.back(); last && last->cycle != cycleCount)
+        stagedCycleDirty = true;
+}
 
-    for (const auto& tsem : current.activeTsem)
-        if (!nextTsemLocations.contains(tsem->getLocation()))
-            switchingData.OFF_Tsem.push_back(tsem);                 // Before going RED, they go YELLOW
+/*  Green time of the phase just organized (Normal operation), from the demand waiting for it
+ *      Its green starts once the yellow and the all red of the outgoing lights are over
+ *      Green wave: the last phase of the cycle is held to start the next coordinated green on time; every
+ *      phase organized is published to the corridor
+ */
+void TrafficControlSystem::timeGreen(SwitchLightsData& data)
+{
+    const Configuration& phase = configurations[current_config_idx];
+    PhaseDemand demand = {.configuredTime = static_cast<double>(phase.time)};
 
-    // ---- Crosswalks ----
-    for (const auto& cw : current.crosswalk)
+    for (const auto tsem : phase.activeTsem)
+    {
+        demand.vehicles += vehicleCalls[tsem->getLocation()];
+        vehicleCalls[tsem->getLocation()] = 0;
+    }
+    for (const auto cw : phase.crosswalk)
     {
-        bool turn_off = true;
-        for (const auto& next_cw : next.crosswalk)
+        demand.buttons += cw->psem1->getButtonEventCounter() + cw->psem2->getButtonEventCounter();
+        for (const int loc : {cw->psem1->getLocation(), cw->psem2->getLocation()})
         {
-            if (cw == next_cw)
-            {
-                turn_off = false;
-                break;
-            }
+            demand.cards += cardCalls[loc];
+            cardCalls[loc] = 0;
         }
-        if (turn_off)
-            switchingData.OFF_Crosswalk.push_back(cw);
-
-        cw->psem1->resetButtonEventCounter();
-        cw->psem2->resetButtonEventCounter();
     }
 
-    // Define ON states
-    switchingData.ON_Tsem = next.activeTsem;
-    switchingData.ON_Crosswalk = next.crosswalk;
+    const double now = clock->now();
+    const double start = now + YELLOW_DURATION + ALL_RED_DURATION;
+    data.time = greenTime->phaseStart(demand, start);
 
-    if (state == SystemState::NORMAL)
-        switchingData.time = next.time;
-    else // Emergency
+    greenHeld = false;
+    if (!greenWave.coordinated())
+        return;
+
+    if (sequencePos + 1 == static_cast<int>(phaseSequence.size()) && greenWave.following(now))
     {
-        switchingData.time = FIRE_TIMER_IMMEDIATELY;   // provoke firing immediately
+        const double next = start + data.time + YELLOW_DURATION + ALL_RED_DURATION;
+        data.time = greenWave.hold(data.time, next, GREEN_MIN, now);
+        greenHeld = true;
     }
-    // If the time was previously increased, put it back to Normal
-    if (current.time != DEFAULT_SWITCHING_TIME)
-        current.time = DEFAULT_SWITCHING_TIME;
-
-    current_config_idx = next_idx;
 
-    return switchingData;
+    if (const GreenWaveEvent report = greenWave.organized(username, sequencePos, start, now); greenWaveLink && report.phase >= 0)
+        greenWaveLink->publish(report);
 }
 
-/*
- * Evaluates if it needs to change configuration
+/*  Call (button, card, vehicle) at a Location (Normal operation)
+ *      Served by the green phase: may move the end of the green (timer re-armed)
+ *      Otherwise: waits for the Location's phase
  */
-/*
- * if semaphore where it is coming  is ON signal variable to not cahnge on next configurration
- * if not: turn off all the semaphores and turn on a configuraion with that direction
+void TrafficControlSystem::phaseCall(const int location, const PhaseCall call)
+{
+    if (state != SystemState::NORMAL || location < 0 || location >= static_cast<int>(cardCalls.size()))
+        return;
+
+    const bool served = configurationIndex.serves(location, current_config_idx);
+    if (!served)
+    {
+        if (call == PhaseCall::CARD) ++cardCalls[location];
+        if (call == PhaseCall::VEHICLE) ++vehicleCalls[location];
+    }
+
+    /* Only a green is moved: the yellow and the all red keep their durations
+     *  t_switchLight owns the phase state - it applies the extension only if the green has not ended since
+     */
+    if (const double left = greenTime->call(call, served, clock->now());
+        left >= 0 && phaseState == PhaseState::GREEN && !greenHeld &&
+        !switchLightQueue.trySend(PhaseExtension{left}))
+        std::cerr << "Phase queue full: green extension dropped\n";
+}
+
+// Cycle report of another Intersection of the corridor (only the upstream one is followed)
+void TrafficControlSystem::greenWaveReceived(const GreenWaveEvent& report)
+{
+    greenWave.received(report, clock->now());
+}
+
+PlanCache::Element TrafficControlSystem::planElement(const int location) const
+{
+    const IntersectionElement& element = elementByLocation[location];
+
+    if (const auto tsem = std::get_if<TrafficSemaphore*>(&element); tsem && *tsem)
+        return PlanCache::Element::TRAFFIC_SEMAPHORE;
+    if (const auto crosswalk = std::get_if<Crosswalk*>(&element); crosswalk && *crosswalk)
+        return PlanCache::Element::CROSSWALK;
+    return PlanCache::Element::NONE;
+}
+
+/*  Loads the Conflict Graph and Configurations from the precompiled Intersection Plan
+ *      The plan is only used if it was compiled from the same PSEM/TSEM JSON and places the same
+ *      Intersection Elements on the same Locations
  */
-// else does nothing: the Lights timeout does not matter for the  Emergency State
-int TrafficControlSystem::EVneedChangeConfiguration ()
+int TrafficControlSystem::loadPlan()
 {
-    tx_cloud::EmergencyContext info = emergencies.front();
-    const int EVorigin = info.Origin;
+    PlanCache plan;
+    if (const int ret = plan.load(PLAN_CACHE_PATH, configHash); ret < 0)
+        return ret;
+
+    if (plan.locations() != elementByLocation.size())
+        return -EINVAL;
 
-    // Evaluate is that semaphore is already ON
-    for (const auto &tsem: configurations[current_config_idx].activeTsem)
+    for (int loc = 0; loc < static_cast<int>(elementByLocation.size()); ++loc)
+        if (plan.element(loc) != planElement(loc))
+            return -EINVAL;
+
+    plan.conflictGraph(conflictGraph);
+    planSets = plan.configurations();
+    for (const auto& set : planSets)
+        configurations.push_back(makeConfiguration(set));
+
+    return 0;
+}
+
+int TrafficControlSystem::savePlan(const std::vector<LocationSet>& sets) const
+{
+    std::vector<PlanCache::Element> elements(elementByLocation.size());
+    for (int loc = 0; loc < static_cast<int>(elements.size()); ++loc)
+        elements[loc] = planElement(loc);
+
+    return PlanCache::save(PLAN_CACHE_PATH, configHash, conflictGraph, elements, sets);
+}
+
+/*  Live Reconfiguration
+ *      - Only the changed element's rows of the Conflict Graph are (re)computed
+ *      - Only the Configurations which contain the element, or could absorb it, are recomputed (planSets)
+ *      - The new plan replaces the active one at the next phase boundary (organizeNextConfiguration):
+ *          lights keep cycling, no all-RED (systemWarning) transition
+ *      - The element vectors t_switchLight reads only change there too: new and removed elements wait in their
+ *          own lists (addedTsem, removedTsem, ...)
+ *   Requested by the Cloud (Component_update event: updateComponent), runs on the TCS thread. The precompiled
+ *  Intersection Plan is not rewritten: the Cloud configuration did not change, so the next boot rebuilds it from the
+ *  Cloud
+ */
+
+// Adds Locations to every Location indexed structure, keeping their contents
+void TrafficControlSystem::growLocations(const size_t locations)
+{
+    if (locations <= elementByLocation.size())
+        return;
+
+    elementByLocation.resize(locations);
+    locationDemand.resize(locations, 0.0);
+    cardCalls.resize(locations, 0);
+    vehicleCalls.resize(locations, 0);
+    conflictGraph.grow(locations);
+    vertices.resize(locations);
+    heads.resize(locations);
+    for (auto& set : planSets)
+        set.resize(locations);
+
+    maxLocation = std::max(maxLocation, static_cast<int>(locations) - 1);
+}
+
+// Conflict Graph row of a single TSEM, against the elements of the newest plan (elementByLocation)
+void TrafficControlSystem::connectTsem(const TrafficSemaphore& tsem)
+{
+    for (int loc = 0; loc < static_cast<int>(elementByLocation.size()); ++loc)
     {
-        if (EVorigin == tsem->getLocation())
-            return -1; // THAT SEMAPHORE IS ALREADY ON
+        const IntersectionElement& element = elementByLocation[loc];
+        if (const auto other = std::get_if<TrafficSemaphore*>(&element); other && *other && *other != &tsem)
+        {
+            if (conflictTrajectory(tsem, **other))
+                conflictGraph.addConflict(tsem.getLocation(), loc);
+        }
+        else if (const auto crosswalk = std::get_if<Crosswalk*>(&element);
+            crosswalk && *crosswalk && (*crosswalk)->psem1->getLocation() == loc && conflictTrajectory(tsem, **crosswalk))
+        {
+            conflictGraph.addConflict(tsem.getLocation(), (*crosswalk)->psem1->getLocation());
+            conflictGraph.addConflict(tsem.getLocation(), (*crosswalk)->psem2->getLocation());
+        }
     }
+}
 
-    // If the semaphore where it is coming from is NOT ON, search for a configuration where it is ON
-    for (int i = 0; i < configurations.size(); i++)
+// Conflict Graph rows of a single Crosswalk (both Pedestrian Semaphores)
+void TrafficControlSystem::connectCrosswalk(const Crosswalk& crosswalk)
+{
+    for (const auto& element : elementByLocation)
     {
-        for (const auto &tsem : configurations[i].activeTsem)
+        const auto tsem = std::get_if<TrafficSemaphore*>(&element);
+        if (tsem && *tsem && conflictTrajectory(**tsem, crosswalk))
         {
-            if (EVorigin == tsem->getLocation())
-            {
-                return i;     // It is guaranteed that this will exist
-            }
+            conflictGraph.addConflict((*tsem)->getLocation(), crosswalk.psem1->getLocation());
+            conflictGraph.addConflict((*tsem)->getLocation(), crosswalk.psem2->getLocation());
+        }
+    }
+}
+
+// The Location's row must already be in the Conflict Graph
+void TrafficControlSystem::insertVertex(const int location)
+{
+    vertices.set(location);
+
+    const ConfigurationEngine engine(conflictGraph);
+    planSets = engine.addVertex(planSets, vertices, location);
+    planPending = true;
+    invalidatePhases();     // not staged past the swap
+}
+
+void TrafficControlSystem::eraseVertex(const int location)
+{
+    conflictGraph.clearVertex(location);
+    vertices.reset(location);
+
+    const ConfigurationEngine engine(conflictGraph);
+    planSets = engine.removeVertex(planSets, vertices, location);
+    planPending = true;
+    invalidatePhases();
+}
+
+// Moves an element from one owner to another (it must be owned by 'from')
+template <typename T>
+static void moveOwned(std::vector<std::unique_ptr<T>>& from, const T* element, std::vector<std::unique_ptr<T>>& to)
+{
+    const auto it = std::ranges::find_if(from, [element](const auto& owned) { return owned.get() == element; });
+    to.push_back(std::move(*it));
+    from.erase(it);
+}
+
+/*  Phase boundary: the plan becomes active; elements removed from the old plan are switched off by this transition
+ *  The only place the element vectors change after the set up: t_switchLight reads them (litConfiguration) while a
+ *  phase runs, and none is running - the last green ended, the next transition is not queued yet
+ */
+void TrafficControlSystem::swapPlan()
+{
+    for (TrafficSemaphore* tsem : removedTsem)
+        moveOwned(TrafficSemVector, tsem, retiredTsem);
+    removedTsem.clear();
+    for (Crosswalk* crosswalk : removedCrosswalks)
+    {
+        // PSEM threads can only be joined on shutdown: they stay alive, ignored (no element on their Location)
+        moveOwned(PedestrianSemVector, crosswalk->psem1, retiredPedestrianSem);
+        moveOwned(PedestrianSemVector, crosswalk->psem2, retiredPedestrianSem);
+        moveOwned(crosswalks, crosswalk, retiredCrosswalks);
+    }
+    removedCrosswalks.clear();
+
+    for (auto& tsem : addedTsem)
+        TrafficSemVector.push_back(std::move(tsem));
+    addedTsem.clear();
+    for (auto& psem : addedPedestrianSem)
+        PedestrianSemVector.push_back(std::move(psem));
+    addedPedestrianSem.clear();
+    for (auto& crosswalk : addedCrosswalks)
+        crosswalks.push_back(std::move(crosswalk));
+    addedCrosswalks.clear();
+    sortSemByLocation(TrafficSemVector);
+    sortSemByLocation(PedestrianSemVector);
+
+    configurations.clear();
+    for (const auto& set : planSets)
+        configurations.push_back(makeConfiguration(set));
+    buildTransitionTable();
+    buildLocationIndex();
+
+    planPending = false;
+    phaseSequence.clear();      // new cycle from the next phase on
+    sequencePos = -1;
+}
+
+/*  Adds an Intersection Element (same JSON fields as the Cloud configuration)
+ *      - TSEM: json object
+ *      - Crosswalk: json array with its two PSEMs
+ *  New elements start RED, until a Configuration turns them on. They join the element vectors at the plan swap
+ */
+int TrafficControlSystem::addComponent(const json& data)
+{
+    if (data.is_object())
+    {
+        if (!data.contains("name") || !data["name"].is_string() ||
+            isValidName(data["name"]) != Components::TRAFFIC_SEMAPHORE)
+            return -EINVAL;
+        if (const int ret = checkTrafficData(data); ret < 0)
+            return ret;
+
+        std::unique_ptr<TrafficSemaphore> added;
+        try
+        {
+            added = makeTrafficSemaphore(data);
+        }
+        catch (const std::exception& e)
+        {
+            std::string reason = e.what();
+            if (!reason.ends_with('\n'))
+                reason += '\n';
+            std::cout << "Component '" << data["name"].get<std::string>() << "' not added: " << reason;
+            return -EINVAL;
         }
+
+        TrafficSemaphore* tsem = added.get();
+        addedTsem.push_back(std::move(added));
+
+        growLocations(maxLocation + 1);
+        elementByLocation[tsem->getLocation()] = tsem;
+        stopCarsMove({&tsem, 1});
+
+        connectTsem(*tsem);
+        heads.set(tsem->getLocation());
+        insertVertex(tsem->getLocation());
+        return 0;
+    }
+
+    if (!data.is_array() || data.size() != 2)
+        return -EINVAL;
+
+    for (const auto& psemData : data)
+        if (const int ret = checkPedestrianData(psemData); ret < 0)
+            return ret;
+    if (data[0]["location"] == data[1]["location"])
+        return -EEXIST;
+
+    std::unique_ptr<PedestrianSemaphore> addedA;
+    std::unique_ptr<PedestrianSemaphore> addedB;
+    try
+    {
+        addedA = makePedestrianSemaphore(data[0]);
+        addedB = makePedestrianSemaphore(data[1]);
     }
-    return -2; // Code will never reach this point
+    catch (const std::exception& e)
+    {
+        std::string reason = e.what();
+        if (!reason.ends_with('\n'))
+            reason += '\n';
+        std::cout << "Crosswalk not added: " << reason;
+        return -EINVAL;
+    }
+
+    PedestrianSemaphore* psemA = addedA.get();
+    PedestrianSemaphore* psemB = addedB.get();
+    if (psemA->getLocation() > psemB->getLocation())
+        std::swap(psemA, psemB);
+    addedPedestrianSem.push_back(std::move(addedA));
+    addedPedestrianSem.push_back(std::move(addedB));
+
+    addedCrosswalks.push_back(std::make_unique<Crosswalk>(Crosswalk{psemA, psemB}));
+    Crosswalk* crosswalk = addedCrosswalks.back().get();
+
+    growLocations(psemB->getLocation() + 1);
+    elementByLocation[psemA->getLocation()] = crosswalk;
+    elementByLocation[psemB->getLocation()] = crosswalk;
+    stopPedestriansCross({&crosswalk, 1}, false);
+    psemA->start();
+    psemB->start();
+
+    connectCrosswalk(*crosswalk);
+    heads.set(psemA->getLocation());
+    insertVertex(psemA->getLocation());
+    insertVertex(psemB->getLocation());
+    return 0;
+}
+
+/*  Removes the TSEM, or the Crosswalk, on that Location (a Crosswalk can be identified by any of its PSEMs)
+ *  It leaves the element vectors at the plan swap; one added since the last swap (never lit) is retired at once
+ */
+int TrafficControlSystem::removeComponent(const int location)
+{
+    if (location < 0 || location >= static_cast<int>(elementByLocation.size()))
+        return -ENOENT;
+
+    const IntersectionElement element = elementByLocation[location];
+
+    if (const auto tsem = std::get_if<TrafficSemaphore*>(&element); tsem && *tsem)
+    {
+        if (vertices.count() == 1)
+            return -EPERM;      // the Intersection needs, at least, one Configuration
+
+        if (std::ranges::any_of(addedTsem, [tsem](const auto& t) { return t.get() == *tsem; }))
+            moveOwned(addedTsem, *tsem, retiredTsem);
+        else
+            removedTsem.push_back(*tsem);
+
+        elementByLocation[location] = IntersectionElement{};
+        heads.reset(location);
+        eraseVertex(location);
+        return 0;
+    }
+
+    if (const auto p_crosswalk = std::get_if<Crosswalk*>(&element); p_crosswalk && *p_crosswalk)
+    {
+        if (vertices.count() == 2)
+            return -EPERM;
+
+        Crosswalk* crosswalk = *p_crosswalk;
+        for (const PedestrianSemaphore* psem : {crosswalk->psem1, crosswalk->psem2})
+        {
+            elementByLocation[psem->getLocation()] = IntersectionElement{};
+            heads.reset(psem->getLocation());
+            eraseVertex(psem->getLocation());
+        }
+
+        if (std::ranges::any_of(addedCrosswalks, [crosswalk](const auto& c) { return c.get() == crosswalk; }))
+        {
+            moveOwned(addedPedestrianSem, crosswalk->psem1, retiredPedestrianSem);
+            moveOwned(addedPedestrianSem, crosswalk->psem2, retiredPedestrianSem);
+            moveOwned(addedCrosswalks, crosswalk, retiredCrosswalks);
+        }
+        else
+            removedCrosswalks.push_back(crosswalk);
+        return 0;
+    }
+    return -ENOENT;
+}
+
+// Changes the destinations of a TSEM: {"location": L, "destinations": [...]}
+int TrafficControlSystem::modifyComponent(const json& data)
+{
+    if (!data.is_object() || !data.contains("location") || !data["location"].is_number_integer() ||
+        !data.contains("destinations") || !data["destinations"].is_array())
+        return -EINVAL;
+
+    const int location = data["location"];
+    if (location < 0 || location >= static_cast<int>(elementByLocation.size()))
+        return -ENOENT;
+    const auto p_tsem = std::get_if<TrafficSemaphore*>(&elementByLocation[location]);
+    if (!p_tsem || !*p_tsem)
+        return -ENOENT;
+
+    // Nothing changes until the whole list is valid
+    std::unordered_set<int> destinations;
+    int newMaxLocation = maxLocation;
+    for (const auto& destination : data["destinations"])
+    {
+        if (!destination.is_number_integer() || destination.get<int>() < 0 ||
+            destination.get<int>() >= TSEM_MAX_LOCATIONS)
+            return -EINVAL;
+        destinations.insert(destination.get<int>());
+        newMaxLocation = std::max(newMaxLocation, destination.get<int>());
+    }
+    maxLocation = newMaxLocation;
+
+    TrafficSemaphore& tsem = **p_tsem;
+    tsem.setDirection(destinations);
+    growLocations(maxLocation + 1);
+
+    // Same vertex with a new row
+    eraseVertex(location);
+    connectTsem(tsem);
+    insertVertex(location);
+    return 0;
+}
+
+// Cloud request (Normal and Emergency strategies): its file is taken from EventPayloads
+int TrafficControlSystem::updateComponent(const rx_cloud::Component_update& update)
+{
+    using Operation = rx_cloud::Component_update::Operation;
+
+    int ret;
+    if (update.operation == Operation::REMOVE)
+        ret = removeComponent(update.location);
+    else if (const auto file = EventPayloads::instance().take(update.file))
+        ret = update.operation == Operation::ADD ? addComponent(*file) : modifyComponent(*file);
+    else
+        ret = -ENODATA;
+
+    if (ret < 0)
+        std::cerr << "Component update not applied: " << strerror(-ret) << "\n";
+    return ret;
+}
+
+
+/* Sets crosswalks based on each Pedestrian Semaphore Pair
+ *  - Supposes that the Pedestrian Semaphore vector is already ordered,
+ *      and that Pedestrian Semaphores were correctly created, so they are an even number
+ */
+void TrafficControlSystem::setCrosswalks ()
+{
+    for (size_t i = 0; i < PedestrianSemVector.size(); i += 2)
+        crosswalks.push_back(std::make_unique<Crosswalk>(Crosswalk{
+            PedestrianSemVector[i].get(),
+            PedestrianSemVector[i+1].get()
+        }));
+}
+
+// Used to know if the emergency vehicle is going to cross over any crosswalk
+std::vector<TrafficControlSystem::Crosswalk*> TrafficControlSystem::searchCrosswalk
+    (const int location, const int direction) const
+{
+    std::vector<Crosswalk*> return_sem;
+    const int locations = static_cast<int>(crossingCrosswalks.size());
+
+    LocationSet found(locations);
+    if (location >= 0 && location < locations)
+        found.orWith(crossingCrosswalks[location].data());
+    if (direction >= 0 && direction < locations)
+        found.orWith(crossingCrosswalks[direction].data());
+    found.andWith(configurationIndex.locationsOf(current_config_idx).data());
+
+    found.forEach([&](const int loc) { return_sem.push_back(std::get<Crosswalk*>(indexedElements[loc])); });
+    return return_sem;
+}
+
+// Used to know the semaphore where the emergency vehicle is coming from
+// Used to know the currently activated semaphores whose directions cross/collide with the EV direction
+// Searches TSEMs by location and direction; this is useful for emergency vehicle interaction
+std::vector<TrafficSemaphore*> TrafficControlSystem::searchTSEM(const int location, const int direction) const
+{
+    std::vector<TrafficSemaphore*> return_sem;
+    const int locations = static_cast<int>(tsemHeadingUpTo.size());
+
+    // Direction cross or collide: some destination <= direction
+    LocationSet found(locations);
+    if (direction >= 0)
+        found.orWith(tsemHeadingUpTo[std::min(direction, locations - 1)].data());
+    // Search Location
+    if (location >= 0 && location < locations && std::holds_alternative<TrafficSemaphore*>(indexedElements[location]))
+        found.set(location);
+    found.andWith(configurationIndex.locationsOf(current_config_idx).data());
+
+    found.forEach([&](const int loc) { return_sem.push_back(std::get<TrafficSemaphore*>(indexedElements[loc])); });
+    return return_sem;
+}
+
+// Stores Emergency and Sends it to Cloud (once per EV: its periodic samples only refresh it)
+bool TrafficControlSystem::pushEmergency (const tx_cloud::EmergencyContext& info)
+{
+    const bool known = emergencies.find(info.EmVehicleID) != nullptr;
+    const bool changed = emergencies.arrive(info.EmVehicleID, info.Origin, info.Destination, info.priority);
+    if (!known)
+        sendToCloud(info);
+    return changed;
+}
+
+void TrafficControlSystem::popEmergency (const std::string& id)
+{
+    if (id.empty())
+        emergencies.clear();
+    else
+        emergencies.leave(id);
+}
+
+/*
+void TrafficControlSystem::sendEmergencyToCloud()
+{
+    cloud.cloudSendQueue.send(emergencies.front());
+}
+*/
+int TrafficControlSystem:: numEmergencies() const
+{
+    return static_cast<int>(emergencies.size());
+}
+
+/*
+ * Must be called by Strategy when switching timer ends
+ */
+TrafficControlSystem::SwitchLightsData TrafficControlSystem::organizeNextConfiguration(int config_idx_em)
+{
+    // Look-ahead: t_switchLight already started the staged phase (committed by syncStaged) - only its green is left
+    if (startedPhase && state == SystemState::NORMAL)
+    {
+        const SwitchLightsData started = *startedPhase;
+        startedPhase.reset();
+        return started;
+    }
+    invalidatePhases();         // the lights leave the staged chain
+
+    Configuration previous;     // outgoing Configuration, when the plan is swapped
+    Configuration* p_current = &configurations[current_config_idx];
+
+    // Phase boundary (Normal operation): the lights of the retired elements were switched off by the last cycle
+    if (state == SystemState::NORMAL)
+    {
+        releaseRetired();
+
+        if (planPending)
+        {
+            previous = configurations[current_config_idx];
+            p_current = &previous;
+            swapPlan();
+        }
+    }
+
+    int next_idx;
+    if (state == SystemState::EMERGENCY)
+        next_idx = config_idx_em;
+    else     // Find next configuration index: next phase of the cycle, re-optimized at the end of each cycle
+    {
+        if (++sequencePos >= static_cast<int>(phaseSequence.size()))
+        {
+            optimizeSequence();
+            sequencePos = 0;
+        }
+        next_idx = phaseSequence[sequencePos];
+    }
+
+    // Clear switching Data
+    SwitchLightsData switchingData = {};
+
+    auto& current = *p_current;
+    const auto& next = configurations[next_idx];
+
+    // Transition: precomputed, except from the Configuration of a replaced plan
+    if (p_current == &previous)
+    {
+        swapTransition = {};
+        appendTransition(current, next, swapTransition);
+        linkTransitions(swapTransition);
+        switchingData.transition = &swapTransition.transitions.front();
+    }
+    else
+        switchingData.transition =
+            &transitionTable.transitions[current_config_idx * configurations.size() + next_idx];
+
+    leaveConfiguration(current);
+
+    if (state == SystemState::NORMAL)
+        switchingData.time = next.time;
+    else // Emergency: green until the Emergency is over
+    {
+        switchingData.time = PHASE_HOLD;
+    }
+
+    current_config_idx = next_idx;
+
+    return switchingData;
+}
+
+// Lights of the retired elements switched off by the last cycle: their pins are free
+void TrafficControlSystem::releaseRetired()
+{
+    for (const auto& tsem : retiredTsem)
+        for (const int pin : tsem->getPins())
+            releasePin(pin);
+    retiredTsem.clear();
+    retiredCrosswalks.clear();
+}
+
+// Configuration going off: its button presses were served, its time (RFID) back to Normal
+void TrafficControlSystem::leaveConfiguration(Configuration& current)
+{
+    for (const auto& cw : current.crosswalk)
+    {
+        cw->psem1->resetButtonEventCounter();
+        cw->psem2->resetButtonEventCounter();
+    }
+
+    // If the time was previously increased, put it back to Normal
+    if (current.time != DEFAULT_SWITCHING_TIME)
+        current.time = DEFAULT_SWITCHING_TIME;
+}
+
+/*  Look-ahead: the next LOOKAHEAD_DEPTH phases of the cycle, with their transitions, staged for t_switchLight
+ *  (TCS thread, after each event)
+ *      Chained from the last phase staged, or from the current one; into the next cycle with the demand seen so
+ *      far (stagedCycle) - never two cycles ahead
+ *      Demand recorded since: the next cycle is optimized again once, when a phase was taken (the look-ahead has
+ *      room) - its phases not started are dropped if it changed
+ *      Not staged out of Normal operation, nor past a pending plan swap: those phases go through the TCS thread
+ */
+void TrafficControlSystem::stagePhases()
+{
+    if (state != SystemState::NORMAL || planPending || phaseSequence.empty())
+        return;
+
+    if (stagedCycleDirty && lookAhead.depth() < LOOKAHEAD_DEPTH)
+    {
+        stagedCycleDirty = false;
+        if (const StagedPhase* last = lookAhead.back(); last && last->cycle != cycleCount && nextCycle() != stagedCycle)
+            invalidatePhases();
+    }
+
+    while (lookAhead.depth() < LOOKAHEAD_DEPTH)
+    {
+        const StagedPhase* last = lookAhead.back();
+        const int from = last ? last->config : current_config_idx;
+        int position = (last ? last->position : sequencePos) + 1;
+        uint32_t cycle = last ? last->cycle : cycleCount;
+
+        if (cycle == cycleCount && position >= static_cast<int>(phaseSequence.size()))
+        {
+            stagedCycle = nextCycle();
+            cycle = cycleCount + 1;
+            position = 0;
+        }
+        const auto& sequence = cycle == cycleCount ? phaseSequence : stagedCycle;
+        if (position >= static_cast<int>(sequence.size()))
+            return;
+
+        const int next = sequence[position];
+        const StagedPhase staged = {
+            &transitionTable.transitions[from * configurations.size() + next], next, position, cycle};
+        if (!lookAhead.stage(staged))
+            return;
+    }
+}
+
+void TrafficControlSystem::syncStaged()
+{
+    while (const auto staged = lookAhead.started())
+        commitStaged(*staged);
+}
+
+// Phase started by t_switchLight: the phase boundary of organizeNextConfiguration, its transition already running
+void TrafficControlSystem::commitStaged(const StagedPhase& staged)
+{
+    releaseRetired();
+    leaveConfiguration(configurations[current_config_idx]);
+
+    if (staged.cycle != cycleCount)
+    {
+        phaseSequence = stagedCycle;
+        stagedCycleDirty = false;       // cycle boundary: the next cycle is computed when staged
+        ++cycleCount;
+        for (auto& demand : locationDemand)
+            demand *= DEMAND_DECAY;
+    }
+    sequencePos = staged.position;
+    current_config_idx = staged.config;
+
+    SwitchLightsData started = {};
+    started.transition = staged.transition;
+    started.time = PHASE_UNTIMED;
+    started.started = true;
+    startedPhase = started;
+}
+
+// Staged phases not started yet are dropped (restaged after the event); the ones already started are committed
+void TrafficControlSystem::invalidatePhases()
+{
+    lookAhead.invalidate();
+    syncStaged();
+}
+
+/*
+ * Evaluates if it needs to change configuration
+ */
+/*
+ * if the semaphores where the EVs are coming from are ON (current configuration serves them): no change
+ * if not: turn off all the semaphores and turn on a configuration serving them - the EVs whose origins
+ * fit one configuration are merged (EmergencyArbiter), in priority order; the others wait
+ */
+// else does nothing: the Lights timeout does not matter for the  Emergency State
+int TrafficControlSystem::EVneedChangeConfiguration ()
+{
+    const int config = emergencies.preempt(configurationIndex, current_config_idx);
+
+    if (config == current_config_idx)
+        return -1; // THOSE SEMAPHORES ARE ALREADY ON
+
+    return config >= 0 ? config : -2; // -2: no Origin is a TSEM
 }
 
 TrafficControlSystem::SwitchLightsData TrafficControlSystem::systemWarning()
 {
-    SwitchLightsData switchingData;
+    invalidatePhases();
 
-    switchingData.OFF_Crosswalk.clear();
+    Configuration all;
     for (const auto& cw : crosswalks)
-        switchingData.OFF_Crosswalk.push_back(cw.get());
-
-    switchingData.OFF_Tsem.clear();
+        all.crosswalk.push_back(cw.get());
     for (const auto& tsem : TrafficSemVector)
-        switchingData.OFF_Tsem.push_back(tsem.get());
+        all.activeTsem.push_back(tsem.get());
+
+    warningTransition = {};
+    appendTransition(all, Configuration{}, warningTransition);
+    linkTransitions(warningTransition);
 
+    SwitchLightsData switchingData = {};
+    switchingData.transition = &warningTransition.transitions.front();
     switchingData.time = 5;
-    switchingData.ON_Crosswalk.clear();
-    switchingData.ON_Tsem.clear();
 
     return switchingData;
 }
 
+// TCS thread and t_switchLight: a slow Cloud never holds the lights back
 void TrafficControlSystem::sendToCloud(CloudSendType message)
 {
-    cloud.cloudSendQueue.send (std::move(message));
+    cloud.cloudSendQueue.send(std::move(message));
 }
 
 void TrafficControlSystem::updateSemaphoresCloud(
@@ -868,7 +1850,7 @@ void TrafficControlSystem::updateSemaphoresCloud(
         .location = sem->getLocation(),
         .status = light_state
     };
-    cloud.cloudSendQueue.send(u);
+    sendToCloud(u);
 }
 
 void TrafficControlSystem::updateSemaphoresCloud(
@@ -882,8 +1864,8 @@ void TrafficControlSystem::updateSemaphoresCloud(
         .location = cross->psem2->getLocation(),
         .status = light_state
     };
-    cloud.cloudSendQueue.send(p1);
-    cloud.cloudSendQueue.send(p2);
+    sendToCloud(p1);
+    sendToCloud(p2);
 }
 
 
@@ -943,24 +1925,14 @@ void TrafficControlSystem::updateCloud(SwitchLightsData& data, bool isYellow)
 // Only applicable to the current configuration if the PSEM which is supposed to be on hasn't turned on yet
 void TrafficControlSystem::searchConfigurationForRFID(int location)
 {
-    const int n = configurations.size();
+    const int n = static_cast<int>(phaseSequence.size());
 
     for (int count = 0; count < n; ++count)
     {
-        int i = (current_config_idx + count) % n;
+        int i = phaseSequence[(std::max(sequencePos, 0) + count) % n];
 
-        for (const auto& crosswalk : configurations[i].crosswalk)
-        {
-            if (crosswalk->psem1->getLocation() == location ||
-                crosswalk->psem2->getLocation() == location)
-            {
-                if (configurations[i].time <= DEFAULT_SWITCHING_TIME)
-                {
-                    configurations[i].time += DEFAULT_SWITCHING_TIME;
-                }
-                break;
-            }
-        }
+        if (configurationIndex.serves(location, i) && configurations[i].time <= DEFAULT_SWITCHING_TIME)
+            configurations[i].time += DEFAULT_SWITCHING_TIME;
     }
 }
 
@@ -971,8 +1943,51 @@ void TrafficControlSystem::stopCurrentTime()
 
 void TrafficControlSystem::consumer()
 {
-    Event data = eventQueue.receive();
-    TrafficStrategy->controlOperation(this, data);
+    QueuedEvent queued = eventQueue.receive();
+    if (!eventQueue.interrupted())
+        handleEvent(queued);
+}
+
+void TrafficControlSystem::handleEvent(QueuedEvent& queued)
+{
+    dispatchEvent(queued);
+
+    QueuedEvent own;
+    while (ownEvents.tryPop(own))
+        dispatchEvent(own);
+}
+
+void TrafficControlSystem::dispatchEvent(QueuedEvent& queued)
+{
+    const uint64_t start = LatencyTrace::now();
+    latencyTrace.record(LatencyStage::EVENT_QUEUE, queued.notified, start);
+
+    handledEvent = &queued;
+    handlingSystem = this;
+    syncStaged();
+    StateMachine::dispatch(StrategyTable::table, state, this, queued.event);    // (state x event type) table
+    stagePhases();
+    handledEvent = nullptr;
+    handlingSystem = nullptr;
+
+    latencyTrace.record(LatencyStage::STRATEGY, start, LatencyTrace::now());
+    watchdog.eventHandled();
+}
+
+/*  Never waits: PHASE_QUEUE_CAPACITY commands waiting means t_switchLight is not running them - the target is
+ *  dropped, and the phase machine owes a step now: the Watchdog trips (PHASE_DEADLINE) unless it catches up
+ */
+bool TrafficControlSystem::queueTransition(SwitchLightsData data)
+{
+    data.queued = LatencyTrace::now();
+    data.origin = handledEvent ? handledEvent->origin : data.queued;
+    data.cause = handledEvent ? handledEvent->cause : LatencyCause::NONE;
+    if (switchLightQueue.trySend(std::move(data)))
+        return true;
+
+    std::cerr << "Phase queue full: transition dropped\n";
+    watchdog.expectPhase(clock->now());
+    return false;
 }
 
 void* TrafficControlSystem::t_tcs(void* arg)
@@ -986,41 +2001,311 @@ void* TrafficControlSystem::t_tcs(void* arg)
     return arg;
 }
 
-void* TrafficControlSystem::t_switchLight(void* arg)
+// GPIO lock held for a scope (rasp_gpio_lock)
+struct GpioLock
 {
-    auto self = static_cast<TrafficControlSystem*>(arg);
+    GpioLock() { rasp_gpio_lock(); }
+    ~GpioLock() { rasp_gpio_unlock(); }
+    GpioLock(const GpioLock&) = delete;
+    GpioLock& operator=(const GpioLock&) = delete;
+};
+
+/*  Phase machine: each command is one step (each one ends by arming timerSwitchLight, or by notifying the system)
+ *      t_switchLight runs them as they are queued; a simulation runs them on virtual time
+ *  No trace output in a step (latency critical): its timing goes to the LatencyTrace
+ *  Failure mode: once flashYellow() set 'failed', no step runs, commits a light (commitStep) nor re-arms
+ *  timerSwitchLight (armPhase)
+ */
+void TrafficControlSystem::runPhase(const PhaseCommand& command)
+{
+    if (failed)     // failure mode: the lights flash (flashTick)
+        return;
 
-    SwitchLightsData&  switchingData = self->currentSwitchingData;
-    while (!_shutdown_requested.load())
+    auto visitor = [this](auto&& step)
+    {
+        using T = std::decay_t<decltype(step)>;
+
+        if constexpr (std::is_same_v<T, SwitchLightsData>)
+            step.started ? timeStarted(step) : retarget(step);
+        else if constexpr (std::is_same_v<T, PhaseExtension>)
+        {
+            if (phaseState == PhaseState::GREEN && !greenExpired)     // the yellow is never stretched
+                armPhase(step.seconds);
+        }
+        else if (timerSwitchLight.hasFired())   // otherwise: stale, re-armed since it was queued
+        {
+            switch (phaseState)
+            {
+            case PhaseState::YELLOW:  endYellow();  break;
+            case PhaseState::ALL_RED: endAllRed();  break;
+            case PhaseState::GREEN:   endGreen();   break;
+            case PhaseState::IDLE:    break;
+            }
+        }
+    };
+
+    std::visit(visitor, command);
+}
+
+/*  New target, from any state
+ *      IDLE, GREEN: its transition starts now (the current green is cut short)
+ *      YELLOW, ALL_RED: the lights are half way - the transition is rebuilt from the heads still green.
+ *          Those leaving go yellow (the yellow restarts); otherwise, the yellow or all red in progress ends
+ *          in the new target's greens
+ */
+void TrafficControlSystem::retarget(const SwitchLightsData& data)
+{
+    const uint64_t start = LatencyTrace::now();
+    if (data.queued)
+        latencyTrace.record(LatencyStage::SWITCH_QUEUE, data.queued, start);
+
+    currentSwitchingData = data;
+
+    if (phaseState == PhaseState::YELLOW || phaseState == PhaseState::ALL_RED)
+    {
+        Configuration target;
+        target.activeTsem.assign(data.transition->ON_Tsem.begin(), data.transition->ON_Tsem.end());
+        target.crosswalk.assign(data.transition->ON_Crosswalk.begin(), data.transition->ON_Crosswalk.end());
+
+        retargetTransition = {};
+        appendTransition(litConfiguration(), target, retargetTransition);
+        linkTransitions(retargetTransition);
+        currentSwitchingData.transition = &retargetTransition.transitions.front();
+
+        const Transition& transition = *currentSwitchingData.transition;
+        if (transition.OFF_Tsem.empty() && transition.OFF_Crosswalk.empty())
+            return;
+    }
+
+    beginYellow(start);
+}
+
+// Green time of the staged phase started at the end of the last green (sent once the TCS thread committed it)
+void TrafficControlSystem::timeStarted(const SwitchLightsData& data)
+{
+    if (data.transition != currentSwitchingData.transition)   // retargeted since
+        return;
+
+    currentSwitchingData.time = data.time;
+    if (phaseState == PhaseState::GREEN)    // timed late: its green runs from now
     {
-        // Wait for switching data to be ready
-        switchingData = self->switchLightQueue.receive();
+        greenExpired = data.time <= PHASE_HOLD;
+        if (!greenExpired)
+            armPhase(data.time);
+    }
+}
 
-        // Change Semaphores
-        std::cerr << "PSEM OFF \n";
-        self->stopPedestriansCross(switchingData.OFF_Crosswalk, false);
+void TrafficControlSystem::beginYellow(const uint64_t start)
+{
+    const Transition& transition = *currentSwitchingData.transition;
+
+    // Change Semaphores: every head of the step at once
+    if (!commitStep(transition.bulk, transition.yellowStep))
+        return;
 
-        std::cerr << "YELLOW \n";
-        self->prepareToStopCars(switchingData.OFF_Tsem);
+    stopPedestriansCross(transition.OFF_Crosswalk, false, transition.bulk);
 
-        self->timerSwitchLight.timerRun(YELLOW_DURATION);
-        self->timerSwitchLight.timerWait();
+    prepareToStopCars(transition.OFF_Tsem, transition.bulk);
 
-        self->notify(nullptr, InternalEvent::YELLOW_TIMEOUT);
+    const uint64_t driven = LatencyTrace::now();
+    latencyTrace.record(LatencyStage::GPIO_COMMIT, start, driven);
+    if (currentSwitchingData.cause == LatencyCause::TIMEOUT)
+        latencyTrace.record(LatencyStage::TIMEOUT_TO_YELLOW, currentSwitchingData.origin, driven);
+    else if (currentSwitchingData.cause == LatencyCause::EMERGENCY)
+        latencyTrace.record(LatencyStage::EMERGENCY_TO_YELLOW, currentSwitchingData.origin, driven);
 
-        self->stopCarsMove(switchingData.OFF_Tsem);
+    // Red at the end of the yellow, with the heads already yellow (if retargeted)
+    clearingTsem.insert(clearingTsem.end(), transition.OFF_Tsem.begin(), transition.OFF_Tsem.end());
+    clearingStep.set |= transition.redStep.set;
+    clearingStep.clear |= transition.redStep.clear;
+    clearingBulk = clearingBulk && transition.bulk;
 
-        self->letPedestriansCross(switchingData.ON_Crosswalk, false);
-        self->letCarsMove(switchingData.ON_Tsem);
+    phaseState = PhaseState::YELLOW;
+    armPhase(YELLOW_DURATION);
+}
 
-        std::cerr<<"GREEN: config "<< self->current_config_idx <<"  \n";
+void TrafficControlSystem::endYellow()
+{
+    notify(nullptr, InternalEvent::YELLOW_TIMEOUT);
 
-        self->timerSwitchLight.timerRun(switchingData.time);
-        self->timerSwitchLight.timerWait();
+    const uint64_t start = LatencyTrace::now();
+    if (!commitStep(clearingBulk, clearingStep))
+        return;
+
+    stopCarsMove(clearingTsem, clearingBulk);
+    latencyTrace.record(LatencyStage::GPIO_COMMIT, start, LatencyTrace::now());
+
+    clearingTsem.clear();
+    clearingStep = {};
+    clearingBulk = true;
+
+    phaseState = PhaseState::ALL_RED;
+    armPhase(ALL_RED_DURATION);
+}
+
+void TrafficControlSystem::endAllRed()
+{
+    const Transition& transition = *currentSwitchingData.transition;
+
+    const uint64_t start = LatencyTrace::now();
+    if (!commitStep(transition.bulk, transition.greenStep))
+        return;
+
+    letPedestriansCross(transition.ON_Crosswalk, false, transition.bulk);
+    letCarsMove(transition.ON_Tsem, transition.bulk);
+
+    const uint64_t driven = LatencyTrace::now();
+    latencyTrace.record(LatencyStage::GPIO_COMMIT, start, driven);
+    if (currentSwitchingData.cause == LatencyCause::EMERGENCY)
+        latencyTrace.record(LatencyStage::EMERGENCY_TO_GREEN, currentSwitchingData.origin, driven);
+
+    phaseState = PhaseState::GREEN;
+    greenExpired = currentSwitchingData.time <= PHASE_HOLD;     // or PHASE_UNTIMED: armed by timeStarted
+    if (!greenExpired)
+        armPhase(currentSwitchingData.time);
+    else
+        watchdog.expectPhase(std::numeric_limits<double>::infinity());      // held until the next target
+}
+
+void TrafficControlSystem::endGreen()
+{
+    if (greenExpired)       // held, or already notified
+        return;
+    greenExpired = true;
+
+    // Look-ahead: the next phase is staged - its transition starts now, its green is timed by the TCS thread
+    if (const auto staged = lookAhead.take())
+    {
+        const uint64_t start = LatencyTrace::now();
+        currentSwitchingData = {staged->transition, PHASE_UNTIMED, start, LatencyCause::TIMEOUT, 0, true};
+        beginYellow(start);
+    }
+    else
+        watchdog.expectPhase(clock->now());    // the TCS thread owes the next target
+
+    // Notify the system itself: otherwise, the lights stay green until the next target
+    notify(nullptr, InternalEvent::LIGHTS_TIMEOUT);
+}
+
+/*  A step's lights: the GPIO lock is held for the check and the commit only (never for the rest of the step), so
+ *  the flash either finds it free or skips one half period (rasp_gpio_try_commit) - it never waits for a step
+ *      !bulk: the heads are driven one by one, once 'failed' was checked
+ */
+bool TrafficControlSystem::commitStep(const bool bulk, const rasp_gpio_mask mask)
+{
+    if (!bulk)
+        return !failed;
 
-        // Notify the system itself
-        self->notify(nullptr, InternalEvent::LIGHTS_TIMEOUT);
-        std::cerr<<"RED\n";
+    GpioLock lock;
+    if (failed)
+        return false;
+    rasp_gpio_commit(mask);
+    return true;
+}
+
+TrafficControlSystem::Configuration TrafficControlSystem::litConfiguration() const
+{
+    Configuration lit;
+    for (const auto& tsem : TrafficSemVector)
+        if (tsem->getCurrentState() == Semaphore::TrafficColour::GREEN)
+            lit.activeTsem.push_back(tsem.get());
+    for (const auto& cw : crosswalks)
+        if (cw->psem1->getCurrentState() == Semaphore::TrafficColour::GREEN)
+            lit.crosswalk.push_back(cw.get());
+    return lit;
+}
+
+// TimerService thread (or the one advancing the VirtualClock): the step itself runs on t_switchLight
+void TrafficControlSystem::phaseTimerExpired(void* arg)
+{
+    // Never waits: the flash and the watchdog share this thread (a full queue: t_switchLight is stuck)
+    if (!static_cast<TrafficControlSystem*>(arg)->switchLightQueue.trySend(PhaseTimeout{}))
+        std::cerr << "Phase queue full: timeout dropped\n";
+}
+
+// Control loop on virtual time (before start): the switching timer only expires when the clock is advanced
+void TrafficControlSystem::useClock(CppWrapper::VirtualClock& virtualClock)
+{
+    clock = &virtualClock;
+    timerSwitchLight.useClock(virtualClock);
+    flashTimer.useClock(virtualClock);
+}
+
+void TrafficControlSystem::armPhase(const double seconds)
+{
+    if (failed)     // cancelled by flashYellow(): a step still running does not re-arm it
+        return;
+    timerSwitchLight.timerRun(seconds);
+    watchdog.expectPhase(clock->now() + seconds);
+}
+
+void TrafficControlSystem::startWatchdog()
+{
+    if (const int ret = watchdog.start(*clock, watchdogTripped, this); ret < 0)
+        std::cerr << "Watchdog not started: " << strerror(-ret) << "\n";
+}
+
+/*  Watchdog thread (TimerService): the lights flash at once, whatever the TCS thread is doing; the system moves
+ *  to FAILURE once the TCS thread handles the event
+ */
+void TrafficControlSystem::watchdogTripped(void* arg, const Watchdog::Fault fault)
+{
+    const auto self = static_cast<TrafficControlSystem*>(arg);
+    std::cerr << "FAILURE: " << Watchdog::describe(fault) << " - flashing yellow\n";
+
+    self->flashYellow();
+    // Never waits for the TCS thread: the flash runs on this thread
+    if (!self->eventQueue.trySend(self->stamp(InternalEvent::FAILURE_DETECTED)))
+        std::cerr << "FAILURE_DETECTED dropped: event queue full\n";
+}
+
+/*  Flashing yellow until restarted: a single periodic Timer drives every head (no thread per head)
+ *      Takes no lock a step may hold: 'failed' stops the phase machine at its next check (commitStep, armPhase)
+ */
+void TrafficControlSystem::flashYellow()
+{
+    failed = true;
+    timerSwitchLight.cancel();
+    watchdog.stop();
+
+    if (flashing.exchange(true))
+        return;
+    flashTimer.onExpire(flashTick, this);
+    flashTick(this);
+    flashTimer.timerRunPeriodic(FLASH_HALF_PERIOD);
+}
+
+/*  Every TSEM in lockstep: one bulk commit per half period
+ *      Never waits (TimerService thread: every timer would stop): with the masks being rebuilt, or the GPIO lock
+ *      held by a step's commit, this half period is skipped - the next one commits the same mask
+ */
+void TrafficControlSystem::flashTick(void* arg)
+{
+    const auto self = static_cast<TrafficControlSystem*>(arg);
+
+    if (self->mutexFlash.TryLockMutex() != 0)
+        return;
+    const rasp_gpio_mask mask = self->flashTicks % 2 == 0 ? self->flashOn : self->flashOff;
+    self->mutexFlash.UnlockMutex();
+
+    if (rasp_gpio_try_commit(mask) != -EBUSY)
+        ++self->flashTicks;
+}
+
+void TrafficControlSystem::useGreenWaveLink(I_GreenWaveLink& link)
+{
+    greenWaveLink = &link;
+}
+
+void* TrafficControlSystem::t_switchLight(void* arg)
+{
+    auto self = static_cast<TrafficControlSystem*>(arg);
+
+    while (!_shutdown_requested.load())
+    {
+        const PhaseCommand command = self->switchLightQueue.receive();
+        if (!self->switchLightQueue.interrupted())
+            self->runPhase(command);
     }
     return arg;
 }
\ No newline at end of file
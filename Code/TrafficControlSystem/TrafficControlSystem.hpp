@@ -1,10 +1,15 @@
 #ifndef TRAFFICCONTROLSYSTEM_TRAFFICCONTROLSYSTEM_HPP
 #define TRAFFICCONTROLSYSTEM_TRAFFICCONTROLSYSTEM_HPP
 
+#include <array>
+#include <atomic>
 #include <queue>
+#include <span>
 #include <string>
 #include <vector>
 #include <memory>
+#include <optional>
+#include <variant>
 
 #include "Mediator.hpp"
 #include "TrafficStrategy/TrafficStrategy.hpp"
@@ -14,14 +19,37 @@
 #include "CppWrapper/CppWrapper.hpp"
 #include "CloudInterface/CloudInterface.hpp"
 #include "Subscriber/DDSSubscriber.hpp"
+#include "Subscriber/DDSGreenWave.hpp"
+#include "ConflictGraph/ConflictGraph.hpp"
+#include "ConflictGraph/ConfigurationEngine.hpp"
+#include "ConflictGraph/PlanCache.hpp"
+#include "ConflictGraph/PhaseSequencer.hpp"
+#include "ConflictGraph/ConfigurationIndex.hpp"
+#include "GreenTime/GreenTime.hpp"
+#include "Emergency/EmergencyArbiter.hpp"
+#include "GreenWave/GreenWave.hpp"
+#include "GPIOHandling/rasp_gpio.hpp"
+#include "Instrumentation/LatencyTrace.hpp"
+#include "PhasePipeline/LookAhead.hpp"
+#include "Watchdog/Watchdog.hpp"
 
 #define DEFAULT_SWITCHING_TIME 5   //s
-
-class I_TrafficStrategy;
-
-//  Meyers Singleton, Mediator
+#define YELLOW_DURATION 2           // s, minimum yellow: never cut short, not even by an emergency
+#define ALL_RED_DURATION 1          // s, every outgoing light red before the new greens
+#define LOOKAHEAD_DEPTH 2           // phase transitions kept staged for t_switchLight
+#define LOOKAHEAD_RING 8            // staged + stale entries not drained yet (power of two)
+#define FLASH_HALF_PERIOD 0.5       // s, yellow on / off in failure mode (1 Hz flashing)
+#define EVENT_QUEUE_CAPACITY 1024   // events waiting for the TCS thread (power of two): dropped beyond it
+#define EVENT_QUEUE_RESERVE 64      // of them, free for emergency and phase timing events only
+#define OWN_EVENT_CAPACITY 8        // events the TCS thread notifies itself while handling one (power of two)
+#define PHASE_QUEUE_CAPACITY 64     // commands waiting for t_switchLight (power of two)
+
+//  Meyers Singleton (the box's Intersection), Mediator - host tests build several, one per Intersection
 class TrafficControlSystem: public Mediator
 {
+    template <typename Test>
+    friend struct TrafficControlSystemTestAccess;   // host tests only (Test/Common/TrafficControlSystemTestAccess.hpp)
+
 public:
     /*--- System Types ---------------------------------------------------------------------------------------------- */
     enum class SystemState {
@@ -50,7 +78,8 @@ private:
         INVALID,
         PEDESTRIAN_SEMAPHORE,
         TRAFFIC_SEMAPHORE,
-        DDS_SUBSCRIBER
+        DDS_SUBSCRIBER,
+        GREEN_WAVE
     };
 
     /* --- Attributes ----------------------------------------------------------------------------------------------- */
@@ -66,20 +95,39 @@ private:
     using  DDS_Subscriber = eprosima::fastdds::examples::emergencyMSG::DDSSubscriber;
     DDS_Subscriber ddsSubscriber;
 
-    queue<tx_cloud::EmergencyContext> emergencies; // FIFO: Stores current EV on intersection info
+    EmergencyArbiter emergencies;   // EVs on the Intersection, by sender_id: ranked by priority, then arrival
+
+    // ------------------- Green Wave (corridor coordination) ------------------------
+    using DDS_GreenWave = eprosima::fastdds::examples::greenWaveMSG::DDSGreenWave;
+    std::unique_ptr<DDS_GreenWave> ddsGreenWave;    // created when configured ("GW" entry)
+    I_GreenWaveLink* greenWaveLink;     // cycle reports published through it (nullptr: not coordinated)
+    GreenWave greenWave;
+    bool greenHeld;                     // the green is held for the wave: calls do not move it
 
     std::vector<std::unique_ptr<Crosswalk>> crosswalks; // Stores Intersection's Crosswalks
 
     std::vector<Configuration> configurations; // Stores Intersection's Configurations
     int current_config_idx;
 
+    std::vector<int> phaseSequence;     // Configurations cycled in Normal operation (PhaseSequencer)
+    int sequencePos;                    // position of the current phase in phaseSequence
+    std::vector<double> locationDemand; // observed demand per Location, decays every cycle
+    PhaseSequencer::Workspace sequencerWorkspace;     // nextCycle() scratch (TCS thread)
+
+    CppWrapper::Clock* clock;           // time of the control loop (monotonic, or virtual in simulations)
+    std::unique_ptr<I_GreenTime> greenTime;   // green time of each phase (Normal operation)
+    std::vector<int> cardCalls;         // validated RFID cards per Location, waiting for its green
+    std::vector<int> vehicleCalls;      // vehicles detected per Location, waiting for its green
+
     SystemState state;
 
     //static SwitchLightsData switchingData;
     // ------------------- Undirected Conflict Graph Logic ------------------------
-    std::vector<std::vector<bool>> conflictGraph;  // Modified Graph Adjacency Matrix (O(1) access)
+    ConflictGraph conflictGraph;  // Packed Graph Adjacency Matrix (64-bit word rows, O(1) access)
     // Graph Virtual Structure
-    std::vector<int> vertices;
+    LocationSet vertices;
+    LocationSet heads;      // vertices switched as one head each: TSEMs, a Crosswalk's first PSEM (phase cost)
+    ConfigurationEngine::Algorithm configurationAlgorithm; // Configuration enumeration algorithm
 
     using IntersectionElement = std::variant<       // for extensibility option to other signs
                             TrafficSemaphore*,
@@ -87,7 +135,30 @@ private:
                             >;
 
     std::vector<IntersectionElement> elementByLocation;
-    static int maxLocation; // stores the maximum Location/Destination in the configuration
+    int maxLocation;    // stores the maximum Location/Destination in the configuration
+
+    uint64_t configHash;    // hash of the PSEM/TSEM JSON received - identifies the precompiled Intersection Plan
+
+    // ------------------- Location Index (active plan) ------------------------
+    ConfigurationIndex configurationIndex;          // Location -> Configurations, best EV Configuration
+    std::vector<IntersectionElement> indexedElements;   // elementByLocation of the active plan
+    std::vector<LocationSet> crossingCrosswalks;    // [x]: Crosswalks (first PSEM Location) whose span contains x
+    std::vector<LocationSet> tsemHeadingUpTo;       // [x]: TSEMs with a destination <= x
+
+    // ------------------- Live Reconfiguration ------------------------
+    std::vector<LocationSet> planSets;  // Location sets of the newest plan
+    bool planPending;                   // planSets changed: swapped in at the next phase boundary
+
+    // The element vectors (read by t_switchLight) only change at the plan swap (swapPlan)
+    std::vector<std::unique_ptr<TrafficSemaphore>> addedTsem;     // in the pending plan only
+    std::vector<std::unique_ptr<PedestrianSemaphore>> addedPedestrianSem;
+    std::vector<std::unique_ptr<Crosswalk>> addedCrosswalks;
+    // Removed elements stay alive while a Configuration still drives their lights
+    std::vector<TrafficSemaphore*> removedTsem;                   // still in the active plan
+    std::vector<Crosswalk*> removedCrosswalks;
+    std::vector<std::unique_ptr<TrafficSemaphore>> retiredTsem;   // switched off by the last plan swap
+    std::vector<std::unique_ptr<Crosswalk>> retiredCrosswalks;
+    std::vector<std::unique_ptr<PedestrianSemaphore>> retiredPedestrianSem;   // threads stopped on waitStop
 
     /* --- Private Constructor - Singleton -------------------------------------------------------------------------  */
     TrafficControlSystem();
@@ -95,15 +166,13 @@ private:
     /* --- Registry Factory ----------------------------------------------------------------------------------------- */
     using ComponentCreator = std::function<int(const json&)>;
     std::unordered_map<Components, ComponentCreator> componentFactory;
+    std::unique_ptr<PedestrianSemaphore> makePedestrianSemaphore(const json& data);
+    std::unique_ptr<TrafficSemaphore> makeTrafficSemaphore(const json& data);
 
     void initComponentFactory();
 
     /* --- Handling Strategy ---------------------------------------------------------------------------------------- */
-    I_TrafficStrategy* TrafficStrategy;
-    std::unordered_map<SystemState, std::unique_ptr<I_TrafficStrategy>> TrafficStrategies;
-
-    void setStrategy();
-    void initTrafficStrategies();
+    int setUpFiles;         // configuration files received in SET_UP (per Intersection)
 
     /* --- System Signals - Stop System Execution ------------------------------------------------------------------- */
     static void initSystemSignals();
@@ -113,29 +182,134 @@ private:
     static Components isValidName (const std::string& name);
     int checkLocation (Components cp, int loc) const;
     int processPin (int pin);
+    void releasePin (int pin);
+    int checkTrafficData (const json& data) const;
+    int checkPedestrianData (const json& data) const;
     void setCrosswalks();
 
     static bool conflictTrajectory (const TrafficSemaphore& semA, const TrafficSemaphore& semB);
     static bool conflictTrajectory (const TrafficSemaphore& semA, const Crosswalk& crosswalk);
+    static bool crossesTrajectory (const TrafficSemaphore& semA, const TrafficSemaphore& semB);
 
+    void setUpElementMap();
     void setUpGraphMatrix();
-    static bool isBetween(int a, int b, int x);
-    void backtrack(std::vector<int>& current, std::vector<int>& candidates);
+    Configuration makeConfiguration(const LocationSet& locations) const;
+
+    [[nodiscard]] PlanCache::Element planElement(int location) const;
+    int loadPlan();
+    int savePlan(const std::vector<LocationSet>& sets) const;
+
+    void growLocations(size_t locations);
+    void connectTsem(const TrafficSemaphore& tsem);
+    void connectCrosswalk(const Crosswalk& crosswalk);
+    void insertVertex(int location);
+    void eraseVertex(int location);
+    void swapPlan();
+    void releaseRetired();
+    static void leaveConfiguration(Configuration& current);
+    [[nodiscard]] const std::vector<int>& nextCycle();     // valid until the next call
+    void optimizeSequence();
+    void buildLocationIndex();
 
 public:
 
+    /*  Lights switched from one Configuration to another - immutable once built
+     *      Spans point into the pools of its TransitionTable
+     *      Masks: GPIO lines driven by each step of the phase machine (a head's other lights are cleared)
+     *          yellowStep: OFF crosswalks go RED, OFF TSEMs go YELLOW
+     *          redStep:    OFF TSEMs go RED (all red)
+     *          greenStep:  ON crosswalks and TSEMs go GREEN
+     *      bulk: every light is in the masks (GPIO line < 64) - each step is one rasp_gpio_commit()
+     */
+    typedef struct
+    {
+        std::span<TrafficSemaphore* const> ON_Tsem;
+        std::span<TrafficSemaphore* const> OFF_Tsem;
+        std::span<Crosswalk* const> ON_Crosswalk;
+        std::span<Crosswalk* const> OFF_Crosswalk;
+        rasp_gpio_mask yellowStep;
+        rasp_gpio_mask redStep;
+        rasp_gpio_mask greenStep;
+        bool bulk;
+    } Transition;
+
     /*  This data structure aims to be used only with Queue destined for
      * light switching.
      */
     typedef struct
     {
-        std::vector<TrafficSemaphore*> ON_Tsem;
-        std::vector<TrafficSemaphore*> OFF_Tsem;
-        std::vector<Crosswalk*> ON_Crosswalk;
-        std::vector<Crosswalk*> OFF_Crosswalk;
+        const Transition* transition;
         double time;
+        uint64_t origin;        // LatencyTrace::now() of the event it comes from
+        LatencyCause cause;
+        uint64_t queued;        // sent to switchLightQueue (0: not traced)
+        bool started;           // look-ahead: already started by t_switchLight - only its green time is sent
     }SwitchLightsData;
 
+    /*  Next phase of the cycle, staged ahead by the TCS thread (lookAhead): t_switchLight starts its transition
+     *  as soon as the green ends; the TCS thread commits it (organizeNextConfiguration) and times its green
+     */
+    typedef struct
+    {
+        const Transition* transition;
+        int config;
+        int position;           // in the phase cycle
+        uint32_t cycle;         // cycleCount of its cycle (+1: the next cycle, stagedCycle)
+    } StagedPhase;
+
+    // Event with the time it was notified - 'origin'/'cause': of the event that led to it (see notify)
+    typedef struct
+    {
+        Event event;
+        uint64_t notified;
+        uint64_t origin;
+        LatencyCause cause;
+    } QueuedEvent;
+
+    /*  Phase machine (t_switchLight): IDLE -> YELLOW -> ALL_RED -> GREEN -> (LIGHTS_TIMEOUT) -> YELLOW ...
+     *      Steps on commands: a new target (SwitchLightsData) or the expiration of timerSwitchLight
+     *   *  Retargeted at any point: a GREEN ends at once; in YELLOW or ALL_RED the lights still green switch
+     *      to the new target, and the yellow in progress runs to its end (YELLOW_DURATION)
+     *   *  Worst case from a new target to its greens: YELLOW_DURATION + ALL_RED_DURATION
+     */
+    enum class PhaseState
+    {
+        IDLE,
+        YELLOW,
+        ALL_RED,
+        GREEN
+    };
+
+    struct PhaseTimeout {};     // timerSwitchLight expired
+    struct PhaseExtension       // call served by the green: its end moves (only while still GREEN)
+    {
+        double seconds;
+    };
+    using PhaseCommand = std::variant<SwitchLightsData, PhaseTimeout, PhaseExtension>;
+
+private:
+    // Transitions built on set up (and on plan swaps): a phase switch only looks one up
+    typedef struct
+    {
+        std::vector<TrafficSemaphore*> tsem;          // OFF then ON TSEMs of each transition
+        std::vector<Crosswalk*> crosswalk;            // OFF then ON Crosswalks of each transition
+        std::vector<std::array<uint32_t, 4>> sizes;   // OFF/ON TSEMs, OFF/ON Crosswalks
+        std::vector<Transition> transitions;
+    } TransitionTable;
+
+    TransitionTable transitionTable;    // N x N: [from * N + to]
+    TransitionTable swapTransition;     // old plan -> new plan (live reconfiguration)
+    TransitionTable warningTransition;  // every light RED (systemWarning)
+    TransitionTable retargetTransition; // lights still green -> new target (phase machine retargeted)
+
+    void appendTransition(const Configuration& from, const Configuration& to, TransitionTable& table) const;
+    static void linkTransitions(TransitionTable& table);
+    void buildTransitionTable();
+    void buildFlashMasks();
+    void requestOutputGroup() const;    // once, on set up: every light of the Intersection in one line request
+
+public:
+
     SwitchLightsData currentSwitchingData; // keeps track of the current information required to switch Configuration
 
    static std::atomic<bool> _shutdown_requested;
@@ -153,41 +327,75 @@ public:
     void waitStop();
 
     /* --- Mediator Interface --------------------------------------------------------------------------------------- */
-    void notify (Component* sender, Event event) override;
+    int notify (Component* sender, Event event) override;
     int createComponents (const std::shared_ptr<json>& data_file) override;
+    int configurationFileReceived() { return ++setUpFiles; }     // SET_UP: files received so far
 
     /* --- Consumer Logic ------------------------------------------------------------------------------------------- */
     void consumer();
+    void handleEvent(QueuedEvent& queued);    // and the events it notified to this thread (ownEvents)
+    void dispatchEvent(QueuedEvent& queued);
+    QueuedEvent stamp(Event event) const;     // timestamps and cause, as queued by notify()
+    static bool reservedEvent(const Event& event);    // may take the EVENT_QUEUE_RESERVE slots
+    [[nodiscard]] uint64_t eventsDropped() const { return droppedEvents.load(); }
 
     /* --- System Handling ------------------------------------------------------------------------------------------ */
     void switch_state (SystemState next_state);
 
-    void letPedestriansCross(const std::vector<Crosswalk*>& ChangeCrosswalksVec, bool emergency);
-    void stopPedestriansCross(const std::vector<Crosswalk*>& ChangeCrosswalksVec, bool emergency);
+    // committed: lights already driven by rasp_gpio_commit() (Transition masks) - only the heads' state changes
+    void letPedestriansCross(std::span<Crosswalk* const> ChangeCrosswalksVec, bool emergency, bool committed = false);
+    void stopPedestriansCross(std::span<Crosswalk* const> ChangeCrosswalksVec, bool emergency, bool committed = false);
 
-    void letCarsMove(const std::vector<TrafficSemaphore*>& ChangeSemVec);
-    void prepareToStopCars(const std::vector<TrafficSemaphore*>& ChangeSemVec);
-    void stopCarsMove(const std::vector<TrafficSemaphore*>& ChangeSemVec);
+    void letCarsMove(std::span<TrafficSemaphore* const> ChangeSemVec, bool committed = false);
+    void prepareToStopCars(std::span<TrafficSemaphore* const> ChangeSemVec, bool committed = false);
+    void stopCarsMove(std::span<TrafficSemaphore* const> ChangeSemVec, bool committed = false);
 
    // void updateCloud (SwitchLightsData& data, bool isYellow);
 
+    /* --- Phase Switching (t_switchLight) -------------------------------------------------------------------------- */
+    bool queueTransition(SwitchLightsData data);          // to t_switchLight, traced from the event being handled
+    void runPhase(const PhaseCommand& command);           // one step of the phase machine
+    void retarget(const SwitchLightsData& data);          // new target, from any state
+    void timeStarted(const SwitchLightsData& data);       // green time of a staged phase already started
+    void beginYellow(uint64_t start);                     // PSEM off, yellow: yellow timer armed
+    void endYellow();                                     // yellow heads red: all red timer armed
+    void endAllRed();                                     // new greens: green timer armed (unless held)
+    void endGreen();                                      // LIGHTS_TIMEOUT
+    bool commitStep(bool bulk, rasp_gpio_mask mask);      // false: failure mode, the step stops there
+    void armPhase(double seconds);                        // next step of the phase machine, watched
+    Configuration litConfiguration() const;               // heads green right now
+    static void phaseTimerExpired(void* arg);
+    void useClock(CppWrapper::VirtualClock& virtualClock);
+    void useGreenWaveLink(I_GreenWaveLink& link);         // instead of DDS (before the "GW" entry)
+
+    /* --- Failure Mode (Watchdog, flashing yellow) ----------------------------------------------------------------- */
+    void startWatchdog();                                 // once in Normal operation
+    static void watchdogTripped(void* arg, Watchdog::Fault fault);
+    void flashYellow();                                   // any thread: the phase machine stops driving the lights
+    static void flashTick(void* arg);
+
     void updateSemaphoresCloud(TrafficSemaphore* sem, int light_state);
     void updateSemaphoresCloud(Crosswalk* cross, int light_state);
-    void sendToCloud(CloudSendType message);
+    void sendToCloud(CloudSendType message);              // never waits (CloudSendBuffer)
 
     /* --- System Evaluation ---------------------------------------------------------------------------------------- */
     void findConfigurations ();
     bool PSEM_Button_HasExtended(int location) const;
 
+    /* --- Live Reconfiguration (TCS thread) ------------------------------------------------------------------------ */
+    int addComponent (const json& data);
+    int removeComponent (int location);
+    int modifyComponent (const json& data);
+    int updateComponent (const rx_cloud::Component_update& update);     // Cloud request (CloudReceiveType)
+
     /* --- Search/Organize Methods ---------------------------------------------------------------------------------- */
     template <typename T>
     void sortSemByLocation(std::vector<std::unique_ptr<T>>& vec);
     std::vector<Crosswalk*> searchCrosswalk(int location, int direction) const;
     std::vector<TrafficSemaphore*> searchTSEM(int location, int direction) const;
 
-    void pushEmergency (tx_cloud::EmergencyContext info);
-    void popEmergency ();
-    tx_cloud::EmergencyContext getEmergency();
+    bool pushEmergency (const tx_cloud::EmergencyContext& info);     // true: new or changed EV
+    void popEmergency (const std::string& id);                      // empty id: every EV
     //void sendEmergencyToCloud ();
     [[nodiscard]] int numEmergencies() const;
 
@@ -197,21 +405,58 @@ public:
     SwitchLightsData systemWarning();
 
     void searchConfigurationForRFID(int location);
+    void recordDemand(int location);
+    void timeGreen(SwitchLightsData& data);
+    void phaseCall(int location, PhaseCall call);
+    void greenWaveReceived(const GreenWaveEvent& report);
     /*--- Helper -----------------------------------------------------------------------------------------------------*/
     void stopCurrentTime();
     /*---Threading & Synchronization Resources------------------------------------------------------------------------*/
-    CppWrapper::Queue<Event> eventQueue;
+    CppWrapper::MpscQueue<QueuedEvent, EVENT_QUEUE_CAPACITY> eventQueue;
+    static thread_local const QueuedEvent* handledEvent;    // being handled by this thread (TCS thread only)
+    static thread_local const TrafficControlSystem* handlingSystem;     // the system handling it
+    CppWrapper::SpscRing<QueuedEvent, OWN_EVENT_CAPACITY> ownEvents;    // notified by the TCS thread to itself
+    std::atomic<uint64_t> droppedEvents;            // notify(): queue full
+    LatencyTrace latencyTrace;
 
     CppWrapper::Thread tcsThread;
     static void* t_tcs(void* arg);
 
-    CppWrapper::Queue<SwitchLightsData> switchLightQueue;
+    CppWrapper::MpscQueue<PhaseCommand, PHASE_QUEUE_CAPACITY> switchLightQueue;
+
+    std::atomic<PhaseState> phaseState;
+    std::vector<TrafficSemaphore*> clearingTsem;    // yellow: red at the end of the yellow
+    rasp_gpio_mask clearingStep;                    // their red lights
+    bool clearingBulk;
+    bool greenExpired;                              // no LIGHTS_TIMEOUT (left) for the current green
+
+    // ------------------- Look-ahead (TCS thread stages, t_switchLight takes) ------------------------
+    LookAhead<StagedPhase, LOOKAHEAD_RING> lookAhead;
+    std::vector<int> stagedCycle;                   // next phase cycle, when staged phases reach it
+    bool stagedCycleDirty;                          // demand recorded since stagedCycle was computed
+    uint32_t cycleCount;                            // phase cycles started
+    std::optional<SwitchLightsData> startedPhase;   // committed, its green not timed yet
+
+    void stagePhases();                             // tops the look-ahead up to LOOKAHEAD_DEPTH (Normal)
+    void syncStaged();                              // commits the phases t_switchLight started
+    void commitStaged(const StagedPhase& staged);
+    void invalidatePhases();                        // the plan changed: staged phases dropped
 
     CppWrapper::Thread switchLightThread;
     static void* t_switchLight(void* arg);
 
     CppWrapper::Timer timerSwitchLight;
 
+    // Failure mode: driven from the TimerService thread only - never waits for the TCS thread or t_switchLight
+    CppWrapper::Mutex mutexFlash;                   // flash masks, rebuilt with the transition table (try-locked)
+    rasp_gpio_mask flashOn;                         // every TSEM yellow, everything else dark
+    rasp_gpio_mask flashOff;                        // every light dark
+    std::atomic<bool> failed;                       // t_switchLight no longer drives the lights
+    std::atomic<bool> flashing;
+    uint64_t flashTicks;                            // flashTick only: half periods committed
+    CppWrapper::Timer flashTimer;                   // destroyed first: waits for a flashTick in progress
+    Watchdog watchdog;
+
     static CppWrapper::Mutex mutexShutdown;
     static CppWrapper::CondVar condShutdown;
 
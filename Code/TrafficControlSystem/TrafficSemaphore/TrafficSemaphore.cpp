@@ -1,5 +1,6 @@
 #include "TrafficSemaphore.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 #include "../GPIOHandling/rasp_gpio.hpp"
@@ -8,7 +9,11 @@
 
 TrafficSemaphore::TrafficSemaphore( Mediator* mediator, const int loc, const std::unordered_set<int> &dir,
     const int gpio_red, const int gpio_green, const int gpio_yellow)
-    : Semaphore(loc), direction(dir){
+    : Semaphore(loc){
+
+    if (loc < 0 || loc >= TSEM_MAX_LOCATIONS)
+        throw runtime_error("TSEM: location out of range");
+    setDirection(dir);
 
     configureLight(TrafficColour::RED, gpio_red/*, 0*/);
     configureLight(TrafficColour::GREEN, gpio_green/*, 0*/);
@@ -28,9 +33,53 @@ void TrafficSemaphore::switch_nextLight(TrafficColour colour, bool emergency) {
     // Turn on new light
     rasp_gpio_set(lights[colour].gpio_pin);
 
-    currentState = colour;
+    commit_nextLight(colour, emergency);
 }
 
-std::unordered_set<int> TrafficSemaphore::getDirection() const {
+const MovementMask& TrafficSemaphore::getDirection() const {
     return direction;
-}
\ No newline at end of file
+}
+
+std::span<const TrafficSemaphore::Movement> TrafficSemaphore::getMovements() const {
+    return movements;
+}
+
+// Destinations and their arcs, computed once: conflict checks only AND/test the masks
+void TrafficSemaphore::setDirection(const std::unordered_set<int> &dir) {
+    for (const int destination : dir)
+        if (destination < 0 || destination >= TSEM_MAX_LOCATIONS)
+            throw runtime_error("TSEM: destination out of range");
+
+    direction.reset();
+    movements.clear();
+    for (const int destination : dir)
+    {
+        direction.set(destination);
+        movements.push_back({destination, arc(getLocation(), destination)});
+    }
+    std::ranges::sort(movements, {}, &Movement::destination);
+}
+
+MovementMask TrafficSemaphore::between(const int lo, const int hi) {
+    const int first = std::max(lo + 1, 0);
+    const int last = std::min(hi, TSEM_MAX_LOCATIONS);     // excluded
+
+    MovementMask mask;
+    if (first >= last)
+        return mask;
+
+    mask.set();
+    mask >>= TSEM_MAX_LOCATIONS - (last - first);
+    mask <<= first;
+    return mask;
+}
+
+/* Considers a Circular Approach (Locations go clockwise around the intersection)
+ *      from < to: from < x < to
+ *      otherwise: the arc wraps around, x > from or x < to
+ */
+MovementMask TrafficSemaphore::arc(const int from, const int to) {
+    if (from < to)
+        return between(from, to);
+    return between(from, TSEM_MAX_LOCATIONS) | between(-1, to);
+}
@@ -1,6 +1,8 @@
 #ifndef SEMAPHORE_TRAFFICSEMAPHORE_HPP
 #define SEMAPHORE_TRAFFICSEMAPHORE_HPP
 
+#include <bitset>
+#include <span>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -10,9 +12,25 @@
 
 using namespace std;
 
+#define TSEM_MAX_LOCATIONS 256      // width of the movement masks: TSEM Locations and destinations must be below it
+
+// Fixed-width set of Locations (bit i: Location i)
+using MovementMask = std::bitset<TSEM_MAX_LOCATIONS>;
+
 class TrafficSemaphore : public Semaphore{
+public:
+    /*  Movement from the TSEM's Location to one destination
+     *      arc: Locations swept going clockwise from the Location to the destination (both excluded)
+     */
+    struct Movement
+    {
+        int destination;
+        MovementMask arc;
+    };
+
 private:
-    std::unordered_set <int> direction;
+    MovementMask direction;             // destinations
+    std::vector<Movement> movements;    // one per destination, by destination
 
 public:
     // Constructor: creates a semaphore with ID (location) and direction
@@ -25,7 +43,14 @@ public:
     void switch_nextLight(TrafficColour colour,  bool emergency) override;
 
     // Additional utility
-    [[nodiscard]]std::unordered_set<int> getDirection() const;
+    [[nodiscard]] const MovementMask& getDirection() const;
+    [[nodiscard]] std::span<const Movement> getMovements() const;
+    void setDirection(const std::unordered_set<int> &dir);
+
+    // Locations strictly between 'lo' and 'hi' (empty if hi <= lo + 1)
+    static MovementMask between(int lo, int hi);
+    // Circular arc from 'from' to 'to' (both excluded): Locations x such that from < x < to, wrapping around
+    static MovementMask arc(int from, int to);
 };
 
 #endif //SEMAPHORE_TRAFFICSEMAPHORE_HPP
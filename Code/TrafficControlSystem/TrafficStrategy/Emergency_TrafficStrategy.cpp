@@ -1,58 +1,75 @@
 #include "TrafficStrategy.hpp"
 
-void StrategyEmergency::handleInternalEvent(TrafficControlSystem* tcs, const InternalEvent& receive)
+/* Emergency Strategy
+ *  - Identify all the currently ON semaphores which interfere with the EV passage
+ *  - Switch them off, and warn of the situation where it should be warned
+ */
+
+// Configuration of the active EVs (merged, in priority order): the phase machine is retargeted if it changes
+void StrategyEmergency::preempt(TrafficControlSystem* tcs)
 {
-    if (receive == InternalEvent::NEW_STATE_ENTERED)
+    if (const int ret = tcs->EVneedChangeConfiguration(); ret >= 0)
     {
-        if (const int ret = tcs->EVneedChangeConfiguration(); ret >= 0)
-        {
-            TrafficControlSystem::SwitchLightsData newConfiguration = tcs->organizeNextConfiguration(ret);
-            auto sendData = newConfiguration;
+        TrafficControlSystem::SwitchLightsData newConfiguration = tcs->organizeNextConfiguration(ret);
+        auto sendData = newConfiguration;
 
-            tcs->timerSwitchLight.fireImmediately(); // NOT WORKING WHEN YELLOW
-            tcs->switchLightQueue.send(std::move(sendData));
-        }
-        tcs->sendToCloud(tcs->getEmergency());
-
-        tcs->popEmergency();
-    }
-    // This case happens when an Emergency Vehicle Passes on a Yellow Light transition
-    else if (receive == InternalEvent::YELLOW_TIMEOUT)
-    {
-        tcs->timerSwitchLight.fireImmediately();
+        // Retargets the phase machine: a green ends at once, a yellow in progress runs to its end
+        tcs->queueTransition(sendData);
     }
 }
 
+void StrategyEmergency::handleInternalEvent(TrafficControlSystem* tcs, const InternalEvent& receive)
+{
+    if (receive == InternalEvent::NEW_STATE_ENTERED)
+        preempt(tcs);
+    else if (receive == InternalEvent::FAILURE_DETECTED)
+        tcs->switch_state(TrafficControlSystem::SystemState::FAILURE);
+}
+
 void StrategyEmergency::handleDDSEvent(TrafficControlSystem* tcs, const DDSEvent& receive)
 {
-    if (receive.qualifier == DDS_Event_Qualifier::EMERGENCY_FINISH)
+    if (receive.qualifier == DDS_Event_Qualifier::EMERGENCY_START)
     {
+        const tx_cloud::EmergencyContext emergencyContext(
+            receive.license_plate,
+            receive.location,
+            receive.direction,
+            receive.priority);
+
+        // Another EV (or one changing its priority/route): may join the preemption, or take it over
+        if (tcs->pushEmergency(emergencyContext))
+            preempt(tcs);
+    }
+    else if (receive.qualifier == DDS_Event_Qualifier::EMERGENCY_FINISH)
+    {
+        tcs->popEmergency(receive.license_plate);
+        if (tcs->numEmergencies() > 0)      // the EVs left waiting get their preemption
+        {
+            preempt(tcs);
+            return;
+        }
+
         TrafficControlSystem::SwitchLightsData outConfiguration = tcs->organizeNextConfiguration();
         outConfiguration.time = 5;
         //tcs->timerSwitchLight.timerRun(0);
         auto sendData = outConfiguration;
-        tcs->switchLightQueue.send(std::move(sendData)); // trigger Queue -> next configuration
+        tcs->queueTransition(sendData); // trigger Queue -> next configuration
         tcs->switch_state (TrafficControlSystem::SystemState::NORMAL);
     }
 }
 
-
-/* Emergency Strategy
- *  - Identify all the currently ON semaphores which interfere with the EV passage
- *  - Switch them off, and warn of the situation where it should be warned
- */
-void StrategyEmergency::controlOperation(TrafficControlSystem* tcs, Event& event)
+// Card validations wait for the return to Normal (dropped); configuration files are dropped. A reconfiguration is
+// applied: its plan is swapped in once back in Normal
+void StrategyEmergency::handleCloudReceiveEvent(TrafficControlSystem* tcs, const CloudReceiveType& receive)
 {
+    if (const auto update = std::get_if<rx_cloud::Component_update>(&receive))
+        tcs->updateComponent(*update);
+    else
+        dropConfigurationFile(receive);
+}
 
-    auto visitor = [tcs](auto&& receive)
-    {
-        using T = std::decay_t<decltype(receive)>;
-
-        if constexpr (std::is_same_v<T, InternalEvent>)
-            handleInternalEvent(tcs, receive);
-        else if constexpr (std::is_same_v<T, DDSEvent>)
-            handleDDSEvent(tcs, receive);
-    };
-
-    std::visit(visitor, event);
+// The upstream reference is kept for the return to Normal
+void StrategyEmergency::handleGreenWaveEvent(TrafficControlSystem* tcs, const GreenWaveEvent& receive)
+{
+    tcs->greenWaveReceived(receive);
 }
@@ -1,5 +1,16 @@
 #include "TrafficStrategy.hpp"
 
 // send intermittent yellow blink in the semaphores
-void StrategyFailure::controlOperation(TrafficControlSystem* tcs, Event& event)
-{}
\ No newline at end of file
+// The Watchdog already started it (TimerService thread); entering FAILURE otherwise starts it here. Every other event
+// is dropped (StrategyTable): the phase machine no longer drives the lights
+void StrategyFailure::handleInternalEvent(TrafficControlSystem* tcs, const InternalEvent& receive)
+{
+    if (receive == InternalEvent::NEW_STATE_ENTERED)
+        tcs->flashYellow();
+}
+
+// Dropped as well - configuration files free their payload slot
+void StrategyFailure::handleCloudReceiveEvent(TrafficControlSystem*, const CloudReceiveType& receive)
+{
+    dropConfigurationFile(receive);
+}
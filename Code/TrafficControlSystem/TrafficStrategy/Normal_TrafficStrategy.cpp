@@ -1,11 +1,8 @@
 #include "TrafficStrategy.hpp"
 
-#define MIN_SECONDS     10
-#define REDUCE_SECONDS  5
-
 void StrategyNormal::handleInternalEvent(TrafficControlSystem* tcs, const InternalEvent& receive)
 {
-    static TrafficControlSystem::SwitchLightsData newConfiguration;
+    TrafficControlSystem::SwitchLightsData newConfiguration = {};     // not static: several TCS in one process
     bool isYellow = false; // Enables setting Intermediary State
 
     bool shouldQueue = false;
@@ -15,6 +12,7 @@ void StrategyNormal::handleInternalEvent(TrafficControlSystem* tcs, const Intern
   //  case InternalEvent::NEW_STATE_ENTERED:
     case InternalEvent::LIGHTS_TIMEOUT:
         newConfiguration = tcs->organizeNextConfiguration();
+        tcs->timeGreen(newConfiguration);
         isYellow = true;
         shouldQueue = true;
         break;
@@ -23,6 +21,10 @@ void StrategyNormal::handleInternalEvent(TrafficControlSystem* tcs, const Intern
         // keep last Configuration, just switch out of yellow
         break;
 
+    case InternalEvent::FAILURE_DETECTED:
+        tcs->switch_state(TrafficControlSystem::SystemState::FAILURE);
+        return;
+
     default:
         return;
     }
@@ -30,7 +32,7 @@ void StrategyNormal::handleInternalEvent(TrafficControlSystem* tcs, const Intern
     auto sendData = newConfiguration;
 
     if (shouldQueue)
-        tcs->switchLightQueue.send(std::move(sendData));
+        tcs->queueTransition(sendData);
 }
 
 void StrategyNormal::handleDDSEvent(TrafficControlSystem* tcs, const DDSEvent& receive)
@@ -51,13 +53,10 @@ void StrategyNormal::handleDDSEvent(TrafficControlSystem* tcs, const DDSEvent& r
 void StrategyNormal::handlePedestrianButtonEvent(TrafficControlSystem* tcs, const PedestrianButtonEvent& receive)
 {
     std::cout << "PedestrianButtonEvent: loc " << receive.location << std::endl;
+    tcs->recordDemand(receive.location);
 
     if (!tcs->PSEM_Button_HasExtended(receive.location))
-    {
-        int remain = tcs->timerSwitchLight.getTime();
-        if (remain > MIN_SECONDS)
-            tcs->timerSwitchLight.timerRun(remain - REDUCE_SECONDS);
-    }
+        tcs->phaseCall(receive.location, PhaseCall::BUTTON);
 }
 
 void StrategyNormal::handlePedestrianRFIDEvent(TrafficControlSystem* tcs, const PedestrianRFIDEvent& receive)
@@ -65,6 +64,7 @@ void StrategyNormal::handlePedestrianRFIDEvent(TrafficControlSystem* tcs, const
     //   send to Cloud
     std::cout<<"PedestrianRFIDEvent:  loc "<< receive.location <<
                                     "  UUID: 0x" << std::hex << receive.uuid << "\n" << std::dec;
+    tcs->recordDemand(receive.location);
 
     // send to cloud mqueue
     tcs->sendToCloud(tx_cloud::ValidateRFID {receive.location, receive.uuid});
@@ -77,26 +77,21 @@ void StrategyNormal::handleCloudReceiveEvent(TrafficControlSystem* tcs, const Cl
     {
         const auto& value = std::get<rx_cloud::RFID_Validation> (receive);
         tcs->searchConfigurationForRFID(value.location);
+        tcs->phaseCall(value.location, PhaseCall::CARD);
     }
+    else if (const auto update = std::get_if<rx_cloud::Component_update>(&receive))
+        tcs->updateComponent(*update);
+    else
+        dropConfigurationFile(receive);
 }
 
-void StrategyNormal::controlOperation (TrafficControlSystem* tcs, Event& event)
+void StrategyNormal::handleVehicleDetectorEvent(TrafficControlSystem* tcs, const VehicleDetectorEvent& receive)
 {
-    auto visitor = [tcs](auto&& receive) {
-        using T = std::decay_t<decltype(receive)>;
-
-        if constexpr (std::is_same_v<T, InternalEvent>)
-            handleInternalEvent(tcs, receive);
-        else if constexpr (std::is_same_v<T, DDSEvent>)
-            handleDDSEvent(tcs, receive);
-        else if constexpr (std::is_same_v<T, PedestrianButtonEvent>)
-            handlePedestrianButtonEvent(tcs, receive);
-        else if constexpr (std::is_same_v<T, PedestrianRFIDEvent>)
-            handlePedestrianRFIDEvent(tcs, receive);
-        else if constexpr (std::is_same_v<T, CloudReceiveType>)
-            handleCloudReceiveEvent(tcs, receive);
-    };
-
-    std::visit (visitor, event);
+    tcs->recordDemand(receive.location);
+    tcs->phaseCall(receive.location, PhaseCall::VEHICLE);
 }
 
+void StrategyNormal::handleGreenWaveEvent(TrafficControlSystem* tcs, const GreenWaveEvent& receive)
+{
+    tcs->greenWaveReceived(receive);
+}
@@ -2,44 +2,60 @@
 
 #include "../Messages/Components/Cloud/QueueSendCloudTypes.hpp"
 #include "../Messages/EventsType.hpp"
+#include "../Messages/EventPayloads.hpp"
 
 #define SET_UP_CONFIGS 2
 
-int StrategySetUp::event_counter = 0;
-
-// Sets up the System: Based only on CloudReceiveType
-void StrategySetUp::controlOperation (TrafficControlSystem* tcs, Event& event)
+void StrategySetUp::handleInternalEvent(TrafficControlSystem* tcs, const InternalEvent& receive)
 {
-    if (std::holds_alternative<InternalEvent>(event))
+    if (receive == InternalEvent::NEW_STATE_ENTERED)
     {
-        const auto& receive = std::get<InternalEvent>(event);
-        if (receive == InternalEvent::NEW_STATE_ENTERED)
-        {
-            tx_cloud::Configure configuration;
-            tcs->sendToCloud(configuration);
-        }
+        tx_cloud::Configure configuration;
+        tcs->sendToCloud(configuration);
     }
+}
 
-    if (std::holds_alternative<CloudReceiveType>(event))
-    {
-        const auto& receive = std::get<CloudReceiveType>(event);
+void dropConfigurationFile(const CloudReceiveType& event)
+{
+    if (const auto psem = std::get_if<rx_cloud::PSEM_data>(&event))
+        EventPayloads::instance().release(psem->file);
+    else if (const auto tsem = std::get_if<rx_cloud::TSEM_data>(&event))
+        EventPayloads::instance().release(tsem->file);
+    else if (const auto update = std::get_if<rx_cloud::Component_update>(&event))
+        EventPayloads::instance().release(update->file);
+}
 
-        if (std::holds_alternative<rx_cloud::PSEM_data>(receive))
+// Sets up the System: Based only on CloudReceiveType - a file counts once its payload is taken
+void StrategySetUp::handleCloudReceiveEvent(TrafficControlSystem* tcs, const CloudReceiveType& receive)
+{
+    int received = 0;
+    if (std::holds_alternative<rx_cloud::PSEM_data>(receive))
+    {
+        const auto& data = std::get<rx_cloud::PSEM_data>(receive);
+        if (const auto file = EventPayloads::instance().take(data.file))
         {
-            event_counter ++;
-            const auto& data = std::get<rx_cloud::PSEM_data>(receive);
-            tcs->createComponents(data.file);
+            received = tcs->configurationFileReceived();
+            tcs->createComponents(file);
         }
-        else if (std::holds_alternative<rx_cloud::TSEM_data>(receive))
+        else
+            std::cerr << "PSEM configuration lost (no payload)\n";
+    }
+    else if (std::holds_alternative<rx_cloud::TSEM_data>(receive))
+    {
+        const auto& data = std::get<rx_cloud::TSEM_data>(receive);
+        if (const auto file = EventPayloads::instance().take(data.file))
         {
-            event_counter ++;
-            const auto& data = std::get<rx_cloud::TSEM_data>(receive);
-            tcs->createComponents(data.file);
+            received = tcs->configurationFileReceived();
+            tcs->createComponents(file);
         }
+        else
+            std::cerr << "TSEM configuration lost (no payload)\n";
     }
+    else
+        dropConfigurationFile(receive);     // no live reconfiguration before the Intersection is set up
 
     // If all HW configurations (2) are SET UP, find system configurations and then move to operational mode
-    if (event_counter == SET_UP_CONFIGS)
+    if (received == SET_UP_CONFIGS)
     {
         tcs->findConfigurations();
         // For components who have just been set up and require threads
@@ -47,9 +63,10 @@ void StrategySetUp::controlOperation (TrafficControlSystem* tcs, Event& event)
 
         // Put System in Initially Known State -  ALL RED
         TrafficControlSystem::SwitchLightsData startConfiguration = tcs->systemWarning();
-        tcs->switchLightQueue.send(std::move(startConfiguration));
+        tcs->queueTransition(startConfiguration);
 
         // Finally, switch state to NORMAL execution
         tcs->switch_state (TrafficControlSystem::SystemState::NORMAL);
+        tcs->startWatchdog();
     }
 }
@@ -0,0 +1,122 @@
+#ifndef TRAFFICCONTROLSYSTEM_STATEMACHINE_HPP
+#define TRAFFICCONTROLSYSTEM_STATEMACHINE_HPP
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <variant>
+
+#include "../Messages/EventsType.hpp"
+
+/*
+ *  State machine of the control loop as a (state x event type) table of handlers, built at compile time
+ *   *  Dispatch: table[state][event.index()](context, event) - one indirect call, no lookup, no vtable, no visit
+ *   *  Every pair is spelled out: On<handler> (the event type is the handler's parameter) or Ignore<type>.
+ *      A pair missing or given twice, a state missing or given twice, fails to compile
+ *
+ *  Context: the object the handlers drive (TrafficControlSystem); States: a scoped enum 0 .. STATES - 1
+ */
+
+namespace StateMachine
+{
+    inline constexpr size_t EVENT_KINDS = std::variant_size_v<Event>;
+
+    template <typename Context>
+    using Handler = void (*)(Context*, const Event&);
+
+    // Index of T among the Event alternatives
+    template <typename T, size_t I = 0>
+    consteval size_t kindOf()
+    {
+        static_assert(I < EVENT_KINDS, "StateMachine: not an Event alternative");
+        if constexpr (std::is_same_v<std::variant_alternative_t<I, Event>, T>)
+            return I;
+        else
+            return kindOf<T, I + 1>();
+    }
+
+    // Handles T: void handler(Context*, const T&)
+    template <auto Fn>
+    struct On;
+
+    template <typename C, typename T, void (*Fn)(C*, const T&)>
+    struct On<Fn>
+    {
+        using Type = T;
+        static void call(C* context, const Event& event) { Fn(context, *std::get_if<T>(&event)); }
+
+        template <typename Context>
+        static constexpr Handler<Context> handler()
+        {
+            static_assert(std::is_same_v<Context, C>, "StateMachine: handler of another context");
+            return &call;
+        }
+    };
+
+    // T is dropped in this state
+    template <typename T>
+    struct Ignore
+    {
+        using Type = T;
+        template <typename Context>
+        static void call(Context*, const Event&) {}
+
+        template <typename Context>
+        static constexpr Handler<Context> handler() { return &call<Context>; }
+    };
+
+    template <typename Context>
+    struct Row
+    {
+        size_t state;
+        std::array<Handler<Context>, EVENT_KINDS> handlers;
+    };
+
+    // Reached in a constant evaluation: compile error
+    inline void invalidTable(const char*) {}
+
+    template <typename Context, auto State, typename... Entries>
+    consteval Row<Context> row()
+    {
+        Row<Context> r{static_cast<size_t>(State), {}};
+        ([&]
+        {
+            Handler<Context>& slot = r.handlers[kindOf<typename Entries::Type>()];
+            if (slot)
+                invalidTable("event type handled twice in one state");
+            slot = Entries::template handler<Context>();
+        }(), ...);
+
+        for (const auto handler : r.handlers)
+            if (!handler)
+                invalidTable("event type missing in a state");
+        return r;
+    }
+
+    template <typename Context, size_t STATES>
+    using Table = std::array<std::array<Handler<Context>, EVENT_KINDS>, STATES>;
+
+    template <typename Context, size_t STATES, typename... Rows>
+    consteval Table<Context, STATES> table(const Rows&... rows)
+    {
+        static_assert(sizeof...(Rows) == STATES, "StateMachine: one row per state");
+        Table<Context, STATES> t{};
+        std::array<bool, STATES> defined{};
+        ([&]
+        {
+            if (rows.state >= STATES || defined[rows.state])
+                invalidTable("state defined twice, or out of range");
+            defined[rows.state] = true;
+            t[rows.state] = rows.handlers;
+        }(), ...);
+        return t;
+    }
+
+    template <typename Context, size_t STATES, typename State>
+    void dispatch(const Table<Context, STATES>& t, const State state, Context* context, const Event& event)
+    {
+        t[static_cast<size_t>(state)][event.index()](context, event);
+    }
+}
+
+#endif //TRAFFICCONTROLSYSTEM_STATEMACHINE_HPP
@@ -0,0 +1,61 @@
+#ifndef TRAFFICCONTROLSYSTEM_STRATEGYTABLE_HPP
+#define TRAFFICCONTROLSYSTEM_STRATEGYTABLE_HPP
+
+#include "StateMachine.hpp"
+#include "TrafficStrategy.hpp"
+
+/*
+ *  Control loop state machine: the handler of every (SystemState x event type) pair, checked at compile time
+ *  (StateMachine). Dispatched on the TCS thread for every event (handleEvent)
+ */
+
+#define SYSTEM_STATES 4
+
+namespace StrategyTable
+{
+    using State = TrafficControlSystem::SystemState;
+    using StateMachine::On;
+    using StateMachine::Ignore;
+
+    static_assert(static_cast<size_t>(State::FAILURE) == SYSTEM_STATES - 1, "StrategyTable: one row per SystemState");
+
+    inline constexpr StateMachine::Table<TrafficControlSystem, SYSTEM_STATES> table =
+        StateMachine::table<TrafficControlSystem, SYSTEM_STATES>(
+            StateMachine::row<TrafficControlSystem, State::SET_UP,
+                On<&StrategySetUp::handleInternalEvent>,
+                On<&StrategySetUp::handleCloudReceiveEvent>,
+                Ignore<PedestrianButtonEvent>,
+                Ignore<PedestrianRFIDEvent>,
+                Ignore<DDSEvent>,
+                Ignore<VehicleDetectorEvent>,
+                Ignore<GreenWaveEvent>>(),
+
+            StateMachine::row<TrafficControlSystem, State::NORMAL,
+                On<&StrategyNormal::handleInternalEvent>,
+                On<&StrategyNormal::handleDDSEvent>,
+                On<&StrategyNormal::handlePedestrianButtonEvent>,
+                On<&StrategyNormal::handlePedestrianRFIDEvent>,
+                On<&StrategyNormal::handleCloudReceiveEvent>,
+                On<&StrategyNormal::handleVehicleDetectorEvent>,
+                On<&StrategyNormal::handleGreenWaveEvent>>(),
+
+            StateMachine::row<TrafficControlSystem, State::EMERGENCY,
+                On<&StrategyEmergency::handleInternalEvent>,
+                On<&StrategyEmergency::handleDDSEvent>,
+                On<&StrategyEmergency::handleCloudReceiveEvent>,
+                On<&StrategyEmergency::handleGreenWaveEvent>,
+                Ignore<PedestrianButtonEvent>,
+                Ignore<PedestrianRFIDEvent>,
+                Ignore<VehicleDetectorEvent>>(),
+
+            StateMachine::row<TrafficControlSystem, State::FAILURE,     // the phase machine no longer drives the lights
+                On<&StrategyFailure::handleInternalEvent>,
+                On<&StrategyFailure::handleCloudReceiveEvent>,
+                Ignore<PedestrianButtonEvent>,
+                Ignore<PedestrianRFIDEvent>,
+                Ignore<DDSEvent>,
+                Ignore<VehicleDetectorEvent>,
+                Ignore<GreenWaveEvent>>());
+}
+
+#endif //TRAFFICCONTROLSYSTEM_STRATEGYTABLE_HPP
@@ -10,61 +10,57 @@
  *
  * These methods implement the Traffic Control System functions which control the system's
  * components, using different attributes => different controlling strategies
- * They only check the event they desire
+ * They only receive the events they handle (state machine: StrategyTable.hpp)
  */
 
 #include "../TrafficControlSystem.hpp"
 
 class TrafficControlSystem;
 
-/*--- STRATEGY PATTERN INTERFACE -------------------------------------------------------------------------------------*/
-class I_TrafficStrategy
-{
-public:
-  virtual ~I_TrafficStrategy()=default;
-  virtual void controlOperation (TrafficControlSystem* tcs, Event& event)=0;
-};
-
-/*--- STRATEGY PATTERN IMPLEMENTATIONS -------------------------------------------------------------------------------*/
+/*--- STRATEGIES ----------------------------------------------------------------------------------------------------*/
 
 /* Strategies developed for the following system states/operational modes:
    * SET UP
    * NORMAL
    * EMERGENCY
    * FAILURE
+ * One handler per event type a state reacts to; the (state x event type) table dispatching them, with the
+ * events each state drops: StrategyTable.hpp
  */
 
-class StrategySetUp : public I_TrafficStrategy
+struct StrategySetUp
 {
-  static int event_counter;
-public:
-  void controlOperation (TrafficControlSystem* tcs, Event& event) override;
+  static void handleInternalEvent(TrafficControlSystem* tcs, const InternalEvent& receive);
+  static void handleCloudReceiveEvent(TrafficControlSystem* tcs, const CloudReceiveType& receive);
 };
 
-class StrategyNormal : public I_TrafficStrategy
+struct StrategyNormal
 {
   static void handleInternalEvent(TrafficControlSystem* tcs, const InternalEvent& receive);
   static void handleDDSEvent(TrafficControlSystem* tcs, const DDSEvent& receive);
   static void handlePedestrianButtonEvent(TrafficControlSystem* tcs, const PedestrianButtonEvent& event);
   static void handlePedestrianRFIDEvent(TrafficControlSystem* tcs, const PedestrianRFIDEvent& event);
   static void handleCloudReceiveEvent(TrafficControlSystem* tcs, const CloudReceiveType& event);
-
-public:
-  void controlOperation (TrafficControlSystem* tcs, Event& event) override;
+  static void handleVehicleDetectorEvent(TrafficControlSystem* tcs, const VehicleDetectorEvent& event);
+  static void handleGreenWaveEvent(TrafficControlSystem* tcs, const GreenWaveEvent& event);
 };
 
-class StrategyEmergency : public I_TrafficStrategy
+struct StrategyEmergency
 {
+  static void preempt(TrafficControlSystem* tcs);
   static void handleInternalEvent(TrafficControlSystem* tcs, const InternalEvent& receive);
   static void handleDDSEvent(TrafficControlSystem* tcs, const DDSEvent& receive);
-public:
-  void controlOperation (TrafficControlSystem* tcs, Event& event) override;
+  static void handleCloudReceiveEvent(TrafficControlSystem* tcs, const CloudReceiveType& event);
+  static void handleGreenWaveEvent(TrafficControlSystem* tcs, const GreenWaveEvent& event);
 };
 
-class StrategyFailure : public I_TrafficStrategy
+struct StrategyFailure
 {
-public:
-  void controlOperation (TrafficControlSystem* tcs, Event& event) override;
+  static void handleInternalEvent(TrafficControlSystem* tcs, const InternalEvent& receive);
+  static void handleCloudReceiveEvent(TrafficControlSystem* tcs, const CloudReceiveType& event);
 };
 
+// Configuration files (TSEM_data, PSEM_data, Component_update) not applied: dropped, their payload slot freed
+void dropConfigurationFile(const CloudReceiveType& event);
+
 #endif //TRAFFICCONTROLSYSTEM_TRAFFICSTRATEGY_HPP
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "Watchdog.hpp"
+
+#include <cerrno>
+#include <limits>
+
+Watchdog::Watchdog(): clock(nullptr), queued(0), handled(0),
+    phaseDeadline(std::numeric_limits<double>::infinity()), running(false), fault(Fault::NONE), handledSeen(0),
+    stalledSince(0), tripCallback(nullptr), tripArg(nullptr)
+{
+    timer.onExpire(check, this);
+}
+
+int Watchdog::start(CppWrapper::Clock& time, void (*callback)(void*, Fault), void* arg)
+{
+    if (running.load())
+        return -EPERM;
+
+    clock = &time;
+    tripCallback = callback;
+    tripArg = arg;
+    fault = Fault::NONE;
+    handledSeen = handled.load();
+    stalledSince = clock->now();
+
+    // Timers on virtual time follow the clock of the control loop
+    if (auto virtualClock = dynamic_cast<CppWrapper::VirtualClock*>(clock))
+        timer.useClock(*virtualClock);
+
+    running = true;
+    timer.timerRunPeriodic(WATCHDOG_PERIOD);
+    return 0;
+}
+
+void Watchdog::stop()
+{
+    running = false;
+    timer.cancel();
+}
+
+void Watchdog::check(void* arg)
+{
+    const auto self = static_cast<Watchdog*>(arg);
+    if (!self->running.load())
+        return;
+
+    const double now = self->clock->now();
+    const uint64_t handled = self->handled.load(std::memory_order_relaxed);
+
+    // Idle, or progressing: not stalled
+    if (handled == self->queued.load(std::memory_order_relaxed) || handled != self->handledSeen)
+    {
+        self->handledSeen = handled;
+        self->stalledSince = now;
+    }
+
+    Fault fault = Fault::NONE;
+    if (now - self->stalledSince >= WATCHDOG_STALL)
+        fault = Fault::EVENT_STALL;
+    else if (now > self->phaseDeadline.load(std::memory_order_relaxed) + WATCHDOG_GRACE)
+        fault = Fault::PHASE_DEADLINE;
+
+    if (fault == Fault::NONE)
+        return;
+
+    self->stop();
+    self->fault = fault;
+    if (self->tripCallback)
+        self->tripCallback(self->tripArg, fault);
+}
+
+const char* Watchdog::describe(const Fault fault)
+{
+    switch (fault)
+    {
+    case Fault::EVENT_STALL:    return "event consumer stalled";
+    case Fault::PHASE_DEADLINE: return "phase deadline missed";
+    case Fault::NONE:           break;
+    }
+    return "none";
+}
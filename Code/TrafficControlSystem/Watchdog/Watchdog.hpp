@@ -0,0 +1,76 @@
+#ifndef TRAFFICCONTROLSYSTEM_WATCHDOG_HPP
+#define TRAFFICCONTROLSYSTEM_WATCHDOG_HPP
+
+#include <atomic>
+#include <cstdint>
+
+#include "../CppWrapper/CppWrapper.hpp"
+
+/*
+ *  Watchdog of the control loop: checked every WATCHDOG_PERIOD by a periodic Timer, on the TimerService thread
+ *  (or the one advancing the VirtualClock) - never on the threads it watches
+ *   *  Event consumer (TCS thread): events queued, and none handled for WATCHDOG_STALL seconds
+ *   *  Phase machine (t_switchLight): the step expected at a deadline (expectPhase) still not done
+ *      WATCHDOG_GRACE seconds after it
+ *   Detection: within WATCHDOG_STALL (or the deadline + WATCHDOG_GRACE) + WATCHDOG_PERIOD
+ *   Trips once: the callback runs on the checking thread, then the Watchdog stops
+ *
+ *   The watched threads only store atomics (relaxed counters, the next deadline): no lock, no clock read
+ *   on the event path
+ */
+
+#define WATCHDOG_PERIOD 0.25    // s between checks
+#define WATCHDOG_STALL 3.0      // s without an event handled, events waiting
+#define WATCHDOG_GRACE 1.0      // s past a phase deadline
+
+class Watchdog
+{
+public:
+    enum class Fault
+    {
+        NONE,
+        EVENT_STALL,
+        PHASE_DEADLINE
+    };
+
+private:
+    CppWrapper::Clock* clock;
+    CppWrapper::Timer timer;
+
+    std::atomic<uint64_t> queued;
+    std::atomic<uint64_t> handled;
+    std::atomic<double> phaseDeadline;      // infinity: no step expected
+    std::atomic<bool> running;
+    std::atomic<Fault> fault;               // last trip
+
+    // Checking thread only
+    uint64_t handledSeen;
+    double stalledSince;        // first check without progress, events waiting
+
+    void (*tripCallback)(void*, Fault);
+    void* tripArg;
+
+    static void check(void* arg);
+
+public:
+    Watchdog();
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    // Checks start on 'time' (the clock of the control loop): returns -EPERM if already running
+    int start(CppWrapper::Clock& time, void (*callback)(void*, Fault), void* arg);
+    void stop();
+    [[nodiscard]] bool isRunning() const { return running.load(); }
+    [[nodiscard]] Fault tripped() const { return fault.load(); }     // NONE until it trips
+
+    // Event consumer
+    void eventQueued() { queued.fetch_add(1, std::memory_order_relaxed); }
+    void eventHandled() { handled.fetch_add(1, std::memory_order_relaxed); }
+
+    // Phase machine: next step due at 'deadline' (clock time; infinity: none expected)
+    void expectPhase(double deadline) { phaseDeadline.store(deadline, std::memory_order_relaxed); }
+
+    static const char* describe(Fault fault);
+};
+
+#endif //TRAFFICCONTROLSYSTEM_WATCHDOG_HPP